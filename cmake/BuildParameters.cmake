@@ -34,7 +34,7 @@ endif()
 # Graphical option
 #-------------------------------------------------------------------------------
 option(REBUILD_SHADER "Rebuild GLSL/CG shader (developer option)")
-option(BUILD_REPLAY_LOADERS "Build GS replayer to ease testing (developer option)")
+option(BUILD_REPLAY_LOADERS "Build GS replayer and the standalone benchmarks to ease testing (developer option)")
 
 #-------------------------------------------------------------------------------
 # Path and lib option
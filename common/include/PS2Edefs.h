@@ -108,6 +108,16 @@ void CALLBACK GSsetFrameSkip(int frameskip);
 void CALLBACK GSreset();
 s32 CALLBACK GSfreeze(int mode, freezeData *data);
 
+// records the GS packet stream (see GSDump.h) until the given number of frames were written
+s32 CALLBACK GSstartDump(const char *filename, int frames);
+
+// non zero if the current renderer only uses the graphics device from GSvsync (and GSopen2 /
+// GSclose), so the other calls can be made away from the thread owning the device
+s32 CALLBACK GSpacketsOffDeviceThread();
+
+// where the GS keeps files between sessions (see GSSelectorCache.h), nothing is kept if NULL
+void CALLBACK GSsetCacheDir(const char *dir);
+
 #ifdef __cplusplus
 } // End extern "C"
 #endif
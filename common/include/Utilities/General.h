@@ -210,6 +210,14 @@ extern void MemProtect(void *baseaddr, size_t size, const PageProtectionMode &mo
 
 extern void Munmap(void *base, size_t size);
 
+// Shared memory object, the same memory can be mapped at several addresses.
+// Returns -1 when the platform doesn't support it.
+extern sptr CreateSharedMemory(size_t size);
+extern void DestroySharedMemory(sptr handle);
+
+// Maps size bytes from offset of a shared memory object over a reserved range at base.
+extern bool MapSharedMemory(sptr handle, size_t offset, void *base, size_t size, const PageProtectionMode &mode);
+
 template <uint size>
 void MemProtectStatic(u8 (&arr)[size], const PageProtectionMode &mode)
 {
@@ -31,9 +31,14 @@ struct PageFaultInfo
 {
     uptr addr;
 
-    PageFaultInfo(uptr address)
+    // Instruction pointer of the faulting thread, NULL when the platform doesn't provide it.
+    // A listener can change it to resume the execution somewhere else.
+    uptr *pc;
+
+    PageFaultInfo(uptr address, uptr *context_pc = NULL)
     {
         addr = address;
+        pc = context_pc;
     }
 };
 
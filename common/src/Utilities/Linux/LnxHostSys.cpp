@@ -22,7 +22,14 @@
 #include <sys/mman.h>
 #include <signal.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
 #include <unistd.h>
+#include <ucontext.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 // Apple uses the MAP_ANON define instead of MAP_ANONYMOUS, but they mean
 // the same thing.
@@ -35,7 +42,7 @@ extern void SignalExit(int sig);
 static const uptr m_pagemask = getpagesize() - 1;
 
 // Linux implementation of SIGSEGV handler.  Bind it using sigaction().
-static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *)
+static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *context)
 {
     // [TODO] : Add a thread ID filter to the Linux Signal handler here.
     // Rationale: On windows, the __try/__except model allows per-thread specific behavior
@@ -59,7 +66,16 @@ static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *)
     // so for now we lock this exception code unless someone can fix this better...
     Threading::ScopedLock lock(PageFault_Mutex);
 
-    Source_PageFault->Dispatch(PageFaultInfo((uptr)siginfo->si_addr & ~m_pagemask));
+    // Instruction pointer of the faulting thread, the recompilers can redirect it
+    // to a slow path when a fastmem access faults.
+    uptr *pc = NULL;
+#if defined(__M_X86_64) && defined(__APPLE__)
+    pc = (uptr *)&((ucontext_t *)context)->uc_mcontext->__ss.__rip;
+#elif defined(__M_X86_64) && defined(__linux__)
+    pc = (uptr *)&((ucontext_t *)context)->uc_mcontext.gregs[REG_RIP];
+#endif
+
+    Source_PageFault->Dispatch(PageFaultInfo((uptr)siginfo->si_addr & ~m_pagemask, pc));
 
     // resumes execution right where we left off (re-executes instruction that
     // caused the SIGSEGV).
@@ -165,6 +181,54 @@ void HostSys::Munmap(uptr base, size_t size)
 	    munmap((void *)base, size);
 }
 
+sptr HostSys::CreateSharedMemory(size_t size)
+{
+    int fd = -1;
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+    fd = syscall(SYS_memfd_create, "pcsx2", 0);
+#endif
+
+    if (fd < 0) {
+        // The name is only needed until the descriptor is opened
+        char name[64];
+        snprintf(name, sizeof(name), "/pcsx2_%d", (int)getpid());
+
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+            return -1;
+
+        shm_unlink(name);
+    }
+
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void HostSys::DestroySharedMemory(sptr handle)
+{
+    if (handle >= 0)
+        close((int)handle);
+}
+
+bool HostSys::MapSharedMemory(sptr handle, size_t offset, void *base, size_t size, const PageProtectionMode &mode)
+{
+    uint lnxmode = 0;
+
+    if (mode.CanWrite())
+        lnxmode |= PROT_WRITE;
+    if (mode.CanRead())
+        lnxmode |= PROT_READ;
+    if (mode.CanExecute())
+        lnxmode |= PROT_EXEC | PROT_READ;
+
+    return mmap(base, size, lnxmode, MAP_SHARED | MAP_FIXED, (int)handle, offset) == base;
+}
+
 void HostSys::MemProtect(void *baseaddr, size_t size, const PageProtectionMode &mode)
 {
 	/* TODO/FIXME - some other way to signify failure */
@@ -28,7 +28,12 @@ static long DoSysPageFaultExceptionFilter(EXCEPTION_POINTERS *eps)
     // Source_PageFault is a global variable with its own state information
     // so for now we lock this exception code unless someone can fix this better...
     Threading::ScopedLock lock(PageFault_Mutex);
-    Source_PageFault->Dispatch(PageFaultInfo((uptr)eps->ExceptionRecord->ExceptionInformation[1]));
+#ifdef _WIN64
+    uptr *pc = (uptr *)&eps->ContextRecord->Rip;
+#else
+    uptr *pc = (uptr *)&eps->ContextRecord->Eip;
+#endif
+    Source_PageFault->Dispatch(PageFaultInfo((uptr)eps->ExceptionRecord->ExceptionInformation[1], pc));
     return Source_PageFault->WasHandled() ? EXCEPTION_CONTINUE_EXECUTION : EXCEPTION_CONTINUE_SEARCH;
 }
 
@@ -124,6 +129,22 @@ void HostSys::Munmap(uptr base, size_t size)
 	    VirtualFree((void *)base, 0, MEM_RELEASE);
 }
 
+// Views of a file mapping can't be placed inside a reserved range before the placeholder
+// API (Windows 10 1803), so the shared memory mirrors aren't supported here.
+sptr HostSys::CreateSharedMemory(size_t size)
+{
+    return -1;
+}
+
+void HostSys::DestroySharedMemory(sptr handle)
+{
+}
+
+bool HostSys::MapSharedMemory(sptr handle, size_t offset, void *base, size_t size, const PageProtectionMode &mode)
+{
+    return false;
+}
+
 void HostSys::MemProtect(void *baseaddr, size_t size, const PageProtectionMode &mode)
 {
     DWORD OldProtect; // enjoy my uselessness, yo!
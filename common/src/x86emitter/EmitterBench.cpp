@@ -0,0 +1,126 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standalone x86emitter benchmark.  Checks the encoding of the instruction forms the
+// recompilers use the most and prints the size and the emission time of each.  What the EE
+// recompiler emits from them is checked against the interpreter, opcode by opcode, by
+// pcsx2/x86/ix86-32/OpcodeBench.cpp.  Exits with 1 when an encoding differs.
+//
+// usage: pcsx2_x86emitterBench [iterations]
+
+#include "PrecompiledHeader.h"
+#include "x86emitter.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+using namespace x86Emitter;
+
+// Utilities is normally linked into the libretro core, which provides it
+retro_log_printf_t log_cb;
+
+static u8 __pagealigned s_code[__pagesize * 4];
+
+struct EncodingCase
+{
+	const char* name;
+	void (*emit)();
+	const char* bytes; // expected encoding, in hex
+};
+
+static const EncodingCase s_encodings[] = {
+	{"mov r32, r32", [] { xMOV(eax, ecx); }, "89c8"},
+	{"mov r32, imm", [] { xMOV(edx, 0x12345678); }, "ba78563412"},
+	{"mov r32, [r+d8]", [] { xMOV(eax, ptr32[rcx + 8]); }, "8b4108"},
+	{"mov [rsp+d8], r32", [] { xMOV(ptr32[rsp + 4], eax); }, "89442404"},
+	{"add r32, imm8", [] { xADD(eax, 1); }, "83c001"},
+	{"add eax, imm32", [] { xADD(eax, 0x1000); }, "0500100000"},
+	{"and r32, imm32", [] { xAND(ecx, 0xff); }, "81e1ff000000"},
+	{"cmp r32, r32", [] { xCMP(eax, ecx); }, "39c8"},
+	{"test r32, r32", [] { xTEST(eax, eax); }, "85c0"},
+	{"shl r32, imm", [] { xSHL(eax, 2); }, "c1e002"},
+	{"sar r32, imm", [] { xSAR(edx, 31); }, "c1fa1f"},
+	{"imul r32, r32", [] { xMUL(eax, ecx); }, "0fafc1"},
+	{"movzx r32, r8", [] { xMOVZX(eax, cl); }, "0fb6c1"},
+	{"movsx r32, r16", [] { xMOVSX(eax, cx); }, "0fbfc1"},
+	{"lea r32, [b+i*4+d8]", [] { xLEA(eax, ptr[rdx * 4 + rcx + 16]); }, "8d449110"},
+	{"setl r8", [] { xSETL(al); }, "0f9cc0"},
+	{"cmovl r32, r32", [] { xCMOVL(eax, ecx); }, "0f4cc1"},
+	{"movaps x, x", [] { xMOVAPS(xmm0, xmm1); }, "0f28c1"},
+	{"paddd x, x", [] { xPADD.D(xmm0, xmm1); }, "660ffec1"},
+	{"pxor x, x", [] { xPXOR(xmm2, xmm2); }, "660fefd2"},
+	{"pshufd x, x, imm", [] { xPSHUF.D(xmm0, xmm1, 0x1b); }, "660f70c11b"},
+	{"movd x, r32", [] { xMOVDZX(xmm0, eax); }, "660f6ec0"},
+	{"movd r32, x", [] { xMOVD(eax, xmm0); }, "660f7ec0"},
+};
+
+static std::string ToHex(const u8* begin, const u8* end)
+{
+	static const char digits[] = "0123456789abcdef";
+
+	std::string str;
+	for (const u8* p = begin; p < end; p++)
+	{
+		str += digits[*p >> 4];
+		str += digits[*p & 15];
+	}
+	return str;
+}
+
+static double NanosecondsSince(std::chrono::steady_clock::time_point start, u32 count)
+{
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / count;
+}
+
+int main(int argc, char* argv[])
+{
+	const u32 iterations = argc > 1 ? (u32)strtoul(argv[1], nullptr, 10) : 100000;
+	int failures = 0;
+
+	printf("encodings:\n\n");
+	printf("  %-22s  size  ns/emit  result\n", "form");
+
+	for (const EncodingCase& c : s_encodings)
+	{
+		xSetPtr(s_code);
+		c.emit();
+		const std::string bytes = ToHex(s_code, xGetPtr());
+		const u32 size = xGetPtr() - s_code;
+
+		auto start = std::chrono::steady_clock::now();
+		for (u32 i = 0; i < iterations; i++)
+		{
+			// stay in the first page
+			if ((i & 255) == 0)
+				xSetPtr(s_code);
+			c.emit();
+		}
+		const double ns = NanosecondsSince(start, iterations);
+
+		const bool ok = bytes == c.bytes;
+		failures += !ok;
+
+		printf("  %-22s  %4u  %7.2f  %s", c.name, size, ns, ok ? "ok" : "FAILED");
+		if (!ok)
+			printf(" (%s, expected %s)", bytes.c_str(), c.bytes);
+		printf("\n");
+	}
+
+	printf("\n%d failed\n", failures);
+
+	return failures ? 1 : 0;
+}
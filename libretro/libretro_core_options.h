@@ -131,6 +131,23 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "disabled"
    },
+   {
+      INT_PCSX2_OPT_CDVD_READAHEAD,
+      "System: Disc Readahead",
+      "Disc Readahead",
+      "Number of disc reads kept in flight ahead of sequential access (streamed audio and video) for uncompressed images. Higher values help slow or network storage. The wait times are logged when the content is closed. (Content restart required)",
+      NULL,
+      "system_options",
+      {
+         {"0", "disabled"},
+         {"2", "2 reads"},
+         {"4", "4 reads (default)"},
+         {"8", "8 reads"},
+         {"16", "16 reads"},
+         {NULL, NULL},
+      },
+      "4"
+   },
    {
       BOOL_PCSX2_OPT_FASTBOOT,
       "System: Fast Boot",
@@ -200,6 +217,20 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "Auto"
    },
+   {
+      BOOL_PCSX2_OPT_SW_JIT_PREGENERATE,
+      "Video: Software Renderer Pregenerated Draw Functions",
+      "Software Renderer Pregenerated Draw Functions",
+      "Enabled: the draw functions the Software renderer used the most in previous sessions are generated on a background thread when the content starts, instead of stalling the first frames which need them. Content restart required.",
+      NULL,
+      "video_options",
+      {
+         {"disabled", NULL},
+         {"enabled", NULL},
+         {NULL, NULL},
+      },
+      "enabled"
+   },
    {
       INT_PCSX2_OPT_UPSCALE_MULTIPLIER,
       "Video: Internal Resolution",
@@ -691,6 +722,155 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "2"
    },
+   {
+      BOOL_PCSX2_OPT_THREADED_MTGS,
+      "Emulation: Threaded MTGS",
+      "Threaded MTGS",
+      "Enabled: GS packets are processed on a separate thread, the frontend only waits for finished frames. Only used with the Software and Null renderers, the hardware renderers have to draw on the frontend thread. Content restart required.",
+      NULL,
+      "emulation_options",
+      {
+         {"disabled", NULL},
+         {"enabled", NULL},
+         {NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      INT_PCSX2_OPT_THREADED_MTGS_LATENCY,
+      "Emulation: Threaded MTGS Frame Latency",
+      "Threaded MTGS Frame Latency",
+      "Number of frames the emulation may queue ahead of the presented one when Threaded MTGS is active, replaces 'Vsyncs in MTGS Queue'. 0 has the least input lag, higher values smooth out uneven frame times.",
+      NULL,
+      "emulation_options",
+      {
+         {"0", "0 frames"},
+         {"1", "1 frame (default)"},
+         {"2", "2 frames"},
+         {NULL, NULL},
+      },
+      "1"
+   },
+   {
+      BOOL_PCSX2_OPT_INCREMENTAL_SAVESTATES,
+      "Emulation: Incremental Savestates",
+      "Incremental Savestates",
+      "Enabled: in-memory states requested by the frontend (rewind, run-ahead) only store the memory pages that changed since the last full snapshot. Much faster than full states, but they can only be loaded during the same session. States saved to disk are always complete.",
+      NULL,
+      "emulation_options",
+      {
+         {"disabled", NULL},
+         {"enabled", NULL},
+         {NULL, NULL},
+      },
+      "enabled"
+   },
+   {
+      INT_PCSX2_OPT_GS_DUMP_FRAMES,
+      "Emulation: Record GS Dump",
+      "Record GS Dump",
+      "Changing this value records the given number of frames of GS packets to 'system/pcsx2/gsdumps'. The dump can be played back and benchmarked without the game with the GS replay loader (developer option).",
+      NULL,
+      "emulation_options",
+      {
+         {"0", "disabled"},
+         {"1", "1 frame"},
+         {"10", "10 frames"},
+         {"60", "60 frames"},
+         {"300", "300 frames"},
+         {NULL, NULL},
+      },
+      "0"
+   },
+   {
+      BOOL_PCSX2_OPT_FASTMEM,
+      "Emulation: EE Fastmem",
+      "EE Fastmem",
+      "Enabled: the recompiled EE loads and stores access a host mirror of the PS2 memory directly instead of looking up every address. Faster, only available on Linux and macOS 64-bit (restarts the recompiler).",
+      NULL,
+      "emulation_options",
+      {
+         {"disabled", NULL},
+         {"enabled", NULL},
+         {NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      BOOL_PCSX2_OPT_IPU_THREAD,
+      "Emulation: Threaded IPU",
+      "Threaded IPU",
+      "Enabled: the IDCT and colour conversion of FMV macroblocks run on a separate thread while the EE thread keeps parsing the stream, so FMVs cost the emulation thread less. The IPU timing seen by the game is unchanged.",
+      NULL,
+      "emulation_options",
+      {
+         {"disabled", NULL},
+         {"enabled", NULL},
+         {NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      BOOL_PCSX2_OPT_AUDIO_DYNAMIC_RATE,
+      "Emulation: Audio Dynamic Rate",
+      "Audio Dynamic Rate",
+      "Enabled: the audio is output at a steady rate per frame and resampled by up to 0.5% to follow the emulation speed, instead of passing on whatever was mixed during the frame. Smooths out audio crackling and stalls at the cost of about two frames of audio latency.",
+      NULL,
+      "emulation_options",
+      {
+         {"disabled", NULL},
+         {"enabled", NULL},
+         {NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      BOOL_PCSX2_OPT_EE_BLOCK_PROFILER,
+      "Emulation: EE Block Profiler",
+      "EE Block Profiler",
+      "Enabled: counts the executions of every recompiled EE block. The blocks the game spends the most cycles in and the code size emitted for each instruction are written to 'system/pcsx2/profiles' when this is disabled again or the content is closed. Slightly slower (developer option).",
+      NULL,
+      "emulation_options",
+      {
+         {"disabled", NULL},
+         {"enabled", NULL},
+         {NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      INT_PCSX2_OPT_SPU2_TRACE_SECONDS,
+      "Emulation: Record SPU2 Trace",
+      "Record SPU2 Trace",
+      "Changing this value records the given number of seconds of SPU2 register and DMA activity to 'system/pcsx2/spu2traces'. The trace can be replayed and benchmarked without the game with the SPU2 mixer benchmark (developer option).",
+      NULL,
+      "emulation_options",
+      {
+         {"0", "disabled"},
+         {"1", "1 second"},
+         {"5", "5 seconds"},
+         {"10", "10 seconds"},
+         {"30", "30 seconds"},
+         {NULL, NULL},
+      },
+      "0"
+   },
+   {
+      INT_PCSX2_OPT_IPU_TRACE_COMMANDS,
+      "Emulation: Record IPU Trace",
+      "Record IPU Trace",
+      "Changing this value records the given number of IPU decode commands (IDEC/BDEC) with the bitstream they decode to 'system/pcsx2/iputraces'. The trace can be replayed and benchmarked without the game with the IPU decoder benchmark (developer option).",
+      NULL,
+      "emulation_options",
+      {
+         {"0", "disabled"},
+         {"100", "100 commands"},
+         {"1000", "1000 commands"},
+         {"10000", "10000 commands"},
+         {NULL, NULL},
+      },
+      "0"
+   },
    {
       INT_PCSX2_OPT_EE_CLAMPING_MODE,
       "Emulation: EE/FPU Clamping Mode",
@@ -26,12 +26,20 @@
 #include "svnrev.h"
 #include "disk_control.h"
 #include "SPU2/Global.h"
+#include "SPU2/spu2.h"
+#include "SaveState.h"
+#include "Elfheader.h"
 #include "ps2/BiosTools.h"
 #include "memcard_retro.h"
+#include "state_keyframes.h"
 
 
 
 #include "MTVU.h"
+#include "x86/iR5900.h"
+#include "CDVD/IsoFileFormats.h"
+#include "IPU/IPU_Thread.h"
+#include "IPU/IPU_Trace.h"
 
 #ifdef PERF_TEST
 static struct retro_perf_callback perf_cb;
@@ -62,6 +70,16 @@ bool option_palette_conversion = false;
 bool hack_fb_conversion = false;
 bool hack_AutoFlush = false;
 bool hack_fast_invalidation = false;
+static bool option_incremental_savestates = false;
+static int option_gs_dump_frames = 0;
+static int option_spu2_trace_seconds = 0;
+static int option_ipu_trace_commands = 0;
+static bool option_threaded_mtgs = false;
+static bool option_ee_block_profiler = false;
+static bool option_fastmem = false;
+static bool option_ipu_thread = false;
+static retro_audio_sample_batch_t batch_cb = NULL;
+static double audio_frames_per_run = 48000 / (60.0 / 1.001);
 
 std::string sel_bios_path = "";
 retro_environment_t environ_cb;
@@ -95,6 +113,13 @@ static std::vector<std::string> bios_files;
 static std::vector<std::string> custom_memcard_list_slot1;
 static std::vector<std::string> custom_memcard_list_slot2;
 
+// savestates (see retro_serialize)
+static VmStateBuffer s_state_keyframe;
+static VmStateBuffer s_state_buffer;
+static VmStateBuffer s_state_plugin;
+static StateKeyframes s_keyframes;
+static size_t s_state_size = 0;
+
 void retro_set_video_refresh(retro_video_refresh_t cb)
 {
 	video_cb = cb;
@@ -319,6 +344,27 @@ void retro_init(void)
 	hack_fb_conversion = option_value(BOOL_PCSX2_OPT_USERHACK_FB_CONVERSION, KeyOptionBool::return_type);
 	hack_AutoFlush = option_value(BOOL_PCSX2_OPT_USERHACK_AUTO_FLUSH, KeyOptionBool::return_type);
 	hack_fast_invalidation = option_value(BOOL_PCSX2_OPT_USERHACK_FAST_INVALIDATION, KeyOptionBool::return_type);
+	option_incremental_savestates = option_value(BOOL_PCSX2_OPT_INCREMENTAL_SAVESTATES, KeyOptionBool::return_type);
+	option_gs_dump_frames = option_value(INT_PCSX2_OPT_GS_DUMP_FRAMES, KeyOptionInt::return_type);
+	option_spu2_trace_seconds = option_value(INT_PCSX2_OPT_SPU2_TRACE_SECONDS, KeyOptionInt::return_type);
+	option_ipu_trace_commands = option_value(INT_PCSX2_OPT_IPU_TRACE_COMMANDS, KeyOptionInt::return_type);
+	option_threaded_mtgs = option_value(BOOL_PCSX2_OPT_THREADED_MTGS, KeyOptionBool::return_type);
+	option_ee_block_profiler = option_value(BOOL_PCSX2_OPT_EE_BLOCK_PROFILER, KeyOptionBool::return_type);
+	recEEProfileBlocks(option_ee_block_profiler);
+	option_fastmem = option_value(BOOL_PCSX2_OPT_FASTMEM, KeyOptionBool::return_type);
+	recEEFastmem(option_fastmem);
+	option_ipu_thread = option_value(BOOL_PCSX2_OPT_IPU_THREAD, KeyOptionBool::return_type);
+	if (option_ipu_thread)
+		ipu_thread.Open();
+	InputIsoFile::SetReadaheadDepth(option_value(INT_PCSX2_OPT_CDVD_READAHEAD, KeyOptionInt::return_type));
+	SndOutSetDynamicRate(option_value(BOOL_PCSX2_OPT_AUDIO_DYNAMIC_RATE, KeyOptionBool::return_type));
+
+	wxFileName cache_dir(wxString(retroarch_system_path), "");
+	cache_dir.AppendDir("pcsx2");
+	cache_dir.AppendDir("cache");
+	if (!cache_dir.DirExists())
+		cache_dir.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+	GSsetCacheDir(cache_dir.DirExists() ? cache_dir.GetPath().ToStdString().c_str() : NULL);
 
 	wxFileName f_bios;
 	f_bios.Assign(option_value(STRING_PCSX2_OPT_BIOS, KeyOptionString::return_type));
@@ -442,6 +488,8 @@ void retro_deinit(void)
 	pcsx2->CleanupOnExit();
 	pcsx2->OnExit();
 
+	ipu_thread.Close();
+
 	bios_files.clear();
 	custom_memcard_list_slot1.clear();
 	custom_memcard_list_slot2.clear();
@@ -491,6 +539,7 @@ void retro_get_system_av_info(retro_system_av_info* info)
 		info->geometry.aspect_ratio = 16.0f / 9.0f;
 	info->timing.fps = (retro_get_region() == RETRO_REGION_NTSC) ? (60.0f / 1.001f) : 50.0f;
 	info->timing.sample_rate = 48000;
+	audio_frames_per_run = info->timing.sample_rate / info->timing.fps;
 }
 
 void retro_reset(void)
@@ -500,13 +549,37 @@ void retro_reset(void)
 	DiskControl::eject_state = false;
 }
 
+// With the threaded MTGS, the frame latency budget takes the place of the vsync queue size.
+static int vsync_queue_size()
+{
+	if (GetMTGS().IsThreaded())
+		return option_value(INT_PCSX2_OPT_THREADED_MTGS_LATENCY, KeyOptionInt::return_type);
+
+	return option_value(INT_PCSX2_OPT_VSYNC_MTGS_QUEUE, KeyOptionInt::return_type);
+}
+
 static void context_reset(void)
 {
 	GetMTGS().OpenGS();
+
+	if (option_threaded_mtgs)
+	{
+		if (GSpacketsOffDeviceThread())
+		{
+			GetMTGS().StartRingThread();
+			log_cb(RETRO_LOG_INFO, "Threaded MTGS enabled, frame latency %d\n", vsync_queue_size());
+		}
+		else
+			log_cb(RETRO_LOG_INFO, "Threaded MTGS is not supported by the hardware renderers, ignored.\n");
+	}
+
+	g_Conf->EmuOptions.GS.VsyncQueueSize = vsync_queue_size();
+	EmuConfig.GS.VsyncQueueSize = g_Conf->EmuOptions.GS.VsyncQueueSize;
 }
 
 static void context_destroy(void)
 {
+	GetMTGS().StopRingThread();
 	GetMTGS().FinishTaskInThread();
 
 	while (pcsx2->HasPendingEvents())
@@ -627,6 +700,9 @@ bool retro_load_game(const struct retro_game_info* game)
 
 	ResetContentStuffs();
 
+	s_keyframes.Invalidate();
+	s_state_size = 0;
+
 	const char* selected_bios = sel_bios_path.c_str();
 	if (selected_bios == NULL)
 	{
@@ -858,10 +934,16 @@ bool retro_load_game_special(unsigned game_type, const struct retro_game_info* i
 	return false;
 }
 
+static void write_ee_block_profile();
+
 void retro_unload_game(void)
 {
+	if (option_ee_block_profiler)
+		write_ee_block_profile();
+
 	//	GetMTGS().FinishTaskInThread();
 	//		GetMTGS().CloseGS();
+	GetMTGS().StopRingThread();
 	GetMTGS().FinishTaskInThread();
 
 	while (pcsx2->HasPendingEvents())
@@ -873,6 +955,149 @@ void retro_unload_game(void)
 }
 
 
+static bool pause_for_state();
+
+// GS packets are consumed on this thread (see SysMtgsThread::ExecuteTaskInThread), so the GS
+// can snapshot its state here without synchronizing with the MTGS, unless the threaded MTGS
+// is draining the ring.
+static void start_gs_dump(int frames)
+{
+	wxFileName dump_dir(wxString(retroarch_system_path), "");
+	dump_dir.AppendDir("pcsx2");
+	dump_dir.AppendDir("gsdumps");
+	if (!dump_dir.DirExists())
+		dump_dir.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+	wxFileName dump_file(dump_dir.GetPath(), wxDateTime::Now().Format(wxString::Format("%08X_%%Y%%m%%d%%H%%M%%S", ElfCRC)));
+	dump_file.SetExt("gs.gz");
+
+	const bool paused = GetMTGS().IsThreaded();
+	if (paused && !pause_for_state())
+		return;
+
+	const s32 result = GSstartDump(dump_file.GetFullPath().ToStdString().c_str(), frames);
+
+	if (paused)
+		GetCoreThread().Resume();
+
+	if (result == 0)
+		RetroMessager::Notification(wxString::Format("Recording %d frames to %s", frames, dump_file.GetFullName()).ToStdString().c_str(), true);
+	else
+		RetroMessager::Notification("Cannot record the GS dump", true);
+}
+
+static void start_spu2_trace(int seconds)
+{
+	wxFileName trace_dir(wxString(retroarch_system_path), "");
+	trace_dir.AppendDir("pcsx2");
+	trace_dir.AppendDir("spu2traces");
+	if (!trace_dir.DirExists())
+		trace_dir.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+	wxFileName trace_file(trace_dir.GetPath(), wxDateTime::Now().Format(wxString::Format("%08X_%%Y%%m%%d%%H%%M%%S", ElfCRC)));
+	trace_file.SetExt("spu2.gz");
+
+	// the SPU2 runs on the emulation thread, which has to be stopped while the trace starts
+	if (!pause_for_state())
+		return;
+
+	const s32 result = SPU2startTrace(trace_file.GetFullPath().ToStdString().c_str(), seconds * 48000);
+
+	GetCoreThread().Resume();
+
+	if (result == 0)
+		RetroMessager::Notification(wxString::Format("Recording %d seconds to %s", seconds, trace_file.GetFullName()).ToStdString().c_str(), true);
+	else
+		RetroMessager::Notification("Cannot record the SPU2 trace", true);
+}
+
+static void start_ipu_trace(int commands)
+{
+	wxFileName trace_dir(wxString(retroarch_system_path), "");
+	trace_dir.AppendDir("pcsx2");
+	trace_dir.AppendDir("iputraces");
+	if (!trace_dir.DirExists())
+		trace_dir.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+	wxFileName trace_file(trace_dir.GetPath(), wxDateTime::Now().Format(wxString::Format("%08X_%%Y%%m%%d%%H%%M%%S", ElfCRC)));
+	trace_file.SetExt("ipu.gz");
+
+	// the IPU runs on the emulation thread, which has to be stopped while the trace starts
+	if (!pause_for_state())
+		return;
+
+	const s32 result = IPUstartTrace(trace_file.GetFullPath().ToStdString().c_str(), commands);
+
+	GetCoreThread().Resume();
+
+	if (result == 0)
+		RetroMessager::Notification(wxString::Format("Recording %d IPU commands to %s", commands, trace_file.GetFullName()).ToStdString().c_str(), true);
+	else
+		RetroMessager::Notification("Cannot record the IPU trace", true);
+}
+
+static void write_ee_block_profile()
+{
+	wxFileName profile_dir(wxString(retroarch_system_path), "");
+	profile_dir.AppendDir("pcsx2");
+	profile_dir.AppendDir("profiles");
+	if (!profile_dir.DirExists())
+		profile_dir.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+	wxFileName profile_file(profile_dir.GetPath(), wxDateTime::Now().Format(wxString::Format("%08X_%%Y%%m%%d%%H%%M%%S_ee", ElfCRC)));
+	profile_file.SetExt("txt");
+
+	if (recEEWriteBlockProfile(profile_file.GetFullPath().ToStdString().c_str(), 500))
+		RetroMessager::Notification(wxString::Format("EE block profile written to %s", profile_file.GetFullName()).ToStdString().c_str(), true);
+	else
+		RetroMessager::Notification("Cannot write the EE block profile", true);
+}
+
+// The counters are compiled into the blocks, the recompiler is reset while the emulation
+// thread is stopped so the switch doesn't wait for the next recompiler reset.
+static void switch_ee_block_profiler(bool enable)
+{
+	if (!enable)
+		write_ee_block_profile();
+
+	recEEProfileBlocks(enable);
+
+	if (!pause_for_state())
+		return;
+
+	Cpu->Reset();
+
+	GetCoreThread().Resume();
+}
+
+// The loads and stores are compiled for the mirror or not, same switch as the profiler
+static void switch_fastmem(bool enable)
+{
+	recEEFastmem(enable);
+
+	if (!pause_for_state())
+		return;
+
+	Cpu->Reset();
+
+	GetCoreThread().Resume();
+}
+
+// Macroblocks in flight are completed when the thread is closed, the emulation thread is
+// stopped so that it doesn't parse any in the meantime.
+static void switch_ipu_thread(bool enable)
+{
+	const bool paused = pause_for_state();
+
+	if (enable)
+		ipu_thread.Open();
+	else
+		ipu_thread.Close();
+
+	if (paused)
+		GetCoreThread().Resume();
+}
+
 void retro_run(void)
 {
 	bool updated = false;
@@ -882,7 +1107,7 @@ void retro_run(void)
 		EmuConfig.GS.FrameSkipEnable = option_value(BOOL_PCSX2_OPT_FRAMESKIP, KeyOptionBool::return_type);
 		EmuConfig.GS.FramesToDraw = option_value(INT_PCSX2_OPT_FRAMES_TO_DRAW, KeyOptionInt::return_type);
 		EmuConfig.GS.FramesToSkip = option_value(INT_PCSX2_OPT_FRAMES_TO_SKIP, KeyOptionInt::return_type);
-		EmuConfig.GS.VsyncQueueSize = option_value(INT_PCSX2_OPT_VSYNC_MTGS_QUEUE, KeyOptionInt::return_type);
+		EmuConfig.GS.VsyncQueueSize = vsync_queue_size();
 		GSUpdateOptions();
 		Input::RumbleEnabled(
 			option_value(BOOL_PCSX2_OPT_GAMEPAD_RUMBLE_ENABLE, KeyOptionBool::return_type),
@@ -890,7 +1115,55 @@ void retro_run(void)
 		);
 		option_pad_left_deadzone = option_value(INT_PCSX2_OPT_GAMEPAD_L_DEADZONE, KeyOptionInt::return_type);
 		option_pad_right_deadzone = option_value(INT_PCSX2_OPT_GAMEPAD_R_DEADZONE, KeyOptionInt::return_type);
+		option_incremental_savestates = option_value(BOOL_PCSX2_OPT_INCREMENTAL_SAVESTATES, KeyOptionBool::return_type);
+		InputIsoFile::SetReadaheadDepth(option_value(INT_PCSX2_OPT_CDVD_READAHEAD, KeyOptionInt::return_type));
+		SndOutSetDynamicRate(option_value(BOOL_PCSX2_OPT_AUDIO_DYNAMIC_RATE, KeyOptionBool::return_type));
+
+		// the dump is only started when the value changes, not when the core starts with a stored value
+		const int gs_dump_frames = option_value(INT_PCSX2_OPT_GS_DUMP_FRAMES, KeyOptionInt::return_type);
+		if (gs_dump_frames != option_gs_dump_frames)
+		{
+			option_gs_dump_frames = gs_dump_frames;
+			if (gs_dump_frames > 0)
+				start_gs_dump(gs_dump_frames);
+		}
+
+		const int spu2_trace_seconds = option_value(INT_PCSX2_OPT_SPU2_TRACE_SECONDS, KeyOptionInt::return_type);
+		if (spu2_trace_seconds != option_spu2_trace_seconds)
+		{
+			option_spu2_trace_seconds = spu2_trace_seconds;
+			if (spu2_trace_seconds > 0)
+				start_spu2_trace(spu2_trace_seconds);
+		}
+
+		const int ipu_trace_commands = option_value(INT_PCSX2_OPT_IPU_TRACE_COMMANDS, KeyOptionInt::return_type);
+		if (ipu_trace_commands != option_ipu_trace_commands)
+		{
+			option_ipu_trace_commands = ipu_trace_commands;
+			if (ipu_trace_commands > 0)
+				start_ipu_trace(ipu_trace_commands);
+		}
 
+		const bool ee_block_profiler = option_value(BOOL_PCSX2_OPT_EE_BLOCK_PROFILER, KeyOptionBool::return_type);
+		if (ee_block_profiler != option_ee_block_profiler)
+		{
+			option_ee_block_profiler = ee_block_profiler;
+			switch_ee_block_profiler(ee_block_profiler);
+		}
+
+		const bool fastmem = option_value(BOOL_PCSX2_OPT_FASTMEM, KeyOptionBool::return_type);
+		if (fastmem != option_fastmem)
+		{
+			option_fastmem = fastmem;
+			switch_fastmem(fastmem);
+		}
+
+		const bool ipu_thread_enabled = option_value(BOOL_PCSX2_OPT_IPU_THREAD, KeyOptionBool::return_type);
+		if (ipu_thread_enabled != option_ipu_thread)
+		{
+			option_ipu_thread = ipu_thread_enabled;
+			switch_ipu_thread(ipu_thread_enabled);
+		}
 	}
 
 	Input::Update();
@@ -898,23 +1171,253 @@ void retro_run(void)
 	RETRO_PERFORMANCE_INIT(pcsx2_run);
 	RETRO_PERFORMANCE_START(pcsx2_run);
 
-	GetMTGS().ExecuteTaskInThread();
+	if (GetMTGS().IsThreaded())
+		GetMTGS().PresentFrame();
+	else
+		GetMTGS().ExecuteTaskInThread();
+
+	if (batch_cb)
+		SndOutDrain(batch_cb, audio_frames_per_run);
 
 	RETRO_PERFORMANCE_STOP(pcsx2_run);
 }
 
+// Savestates are a RetroStateHeader followed by a regular SaveStateBase stream: FreezeAll(),
+// then the GS and SPU2 freeze blocks.  When the frontend asks for fast (in-memory) states and
+// incremental savestates are enabled, states are taken as deltas of a resident keyframe, so
+// only the pages of EE/IOP memory, VU memory and GS local memory that changed since the
+// keyframe are copied.  Delta states are only loadable while their keyframe is resident.
+
+enum RetroStateFlags
+{
+	RetroState_Delta = 1 << 0,
+};
+
+struct RetroStateHeader
+{
+	u32 magic;
+	u32 version;
+	u32 flags;
+	u32 keyframe;	// keyframe id the state was taken against (0 for standalone states)
+	u32 size;		// payload size in bytes
+};
+
+static const u32 RetroStateMagic = 0x53325350; // "PS2S"
+
+template <typename FreezeFn>
+static void freeze_plugin(SaveStateBase& state, FreezeFn freeze)
+{
+	freezeData fP = {0, nullptr};
+	if (freeze(FREEZE_SIZE, &fP) != 0)
+		throw std::runtime_error("cannot get the plugin state size");
+
+	int size = fP.size;
+	state.Freeze(size);
+	if (size != fP.size)
+		throw std::runtime_error("plugin state size mismatch");
+
+	s_state_plugin.MakeRoomFor(size);
+	fP.data = (s8*)s_state_plugin.GetPtr();
+
+	if (state.IsSaving())
+	{
+		if (freeze(FREEZE_SAVE, &fP) != 0)
+			throw std::runtime_error("plugin state save failed");
+		state.FreezeMem(fP.data, size);
+	}
+	else
+	{
+		state.FreezeMem(fP.data, size);
+		if (freeze(FREEZE_LOAD, &fP) != 0)
+			throw std::runtime_error("plugin state load failed");
+	}
+}
+
+static void freeze_state(SaveStateBase& state)
+{
+	state.FreezeAll();
+	state.FreezeTag("GS");
+	freeze_plugin(state, GSfreeze);
+	state.FreezeTag("SPU2");
+	freeze_plugin(state, SPU2freeze);
+}
+
+// The EEcore is paused at its next vsync and the MTGS ring is drained, so that the machine
+// and the GS plugin agree on the state being saved or loaded.
+static bool pause_for_state()
+{
+	if (!GetCoreThread().HasActiveMachine())
+		return false;
+
+	GetMTGS().FinishTaskInThread();
+	GetCoreThread().Pause();
+	GetMTGS().FlushInThread();
+	return true;
+}
+
+static bool fast_savestates_requested()
+{
+	int av_enable = 0;
+	return environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable) && (av_enable & 4);
+}
+
+// Saves the machine state and returns the buffer holding its payload.
+static const VmStateBuffer& save_state(RetroStateHeader& header, bool incremental)
+{
+	header = {RetroStateMagic, g_SaveVersion, 0, 0, 0};
+
+	if (incremental && !s_keyframes.IsStale())
+	{
+		memDeltaSavingState saver(s_state_buffer, s_state_keyframe);
+		freeze_state(saver);
+		header.flags = RetroState_Delta;
+		header.keyframe = s_keyframes.GetResident();
+		header.size = saver.GetCurrentPos();
+
+		// Deltas keep growing as the machine drifts away from the keyframe, past half a
+		// full state it is cheaper to start over from a new one.
+		s_keyframes.PutDelta(header.size);
+
+		return s_state_buffer;
+	}
+
+	VmStateBuffer& buffer = incremental ? s_state_keyframe : s_state_buffer;
+	memSavingState saver(buffer);
+	freeze_state(saver);
+	header.size = saver.GetCurrentPos();
+
+	if (incremental)
+	{
+		header.keyframe = s_keyframes.Save(header.size);
+	}
+
+	return buffer;
+}
+
 size_t retro_serialize_size(void)
 {
-	return 0;
+	if (s_state_size)
+		return s_state_size;
+
+	if (!pause_for_state())
+		return 0;
+
+	try
+	{
+		RetroStateHeader header;
+		save_state(header, false);
+
+		// Delta states are never larger than a full state plus their page bitmaps.
+		s_state_size = sizeof(header) + header.size + _1mb;
+	}
+	catch (std::exception& ex)
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate: %s\n", ex.what());
+	}
+
+	GetCoreThread().Resume();
+	return s_state_size;
 }
 
 bool retro_serialize(void* data, size_t size)
 {
-	return false;
+	if (!pause_for_state())
+		return false;
+
+	RetroStateHeader header;
+	bool success = true;
+	const bool fast = fast_savestates_requested();
+
+	// A regular savestate should match the memory card files, runahead and netplay
+	// states are taken every frame and leave the cards to the writer thread
+	if (!fast)
+		FileMcd_Flush();
+
+	try
+	{
+		const VmStateBuffer& payload = save_state(header, option_incremental_savestates && fast);
+
+		if (sizeof(header) + header.size <= size)
+		{
+			memcpy(data, &header, sizeof(header));
+			memcpy((u8*)data + sizeof(header), payload.GetPtr(), header.size);
+		}
+		else
+		{
+			log_cb(RETRO_LOG_ERROR, "Savestate: state needs %u bytes, only %u available\n", (u32)(sizeof(header) + header.size), (u32)size);
+			success = false;
+		}
+	}
+	catch (std::exception& ex)
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate: %s\n", ex.what());
+		success = false;
+	}
+
+	GetCoreThread().Resume();
+	return success;
 }
+
 bool retro_unserialize(const void* data, size_t size)
 {
-	return false;
+	RetroStateHeader header;
+	if (size < sizeof(header))
+		return false;
+
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != RetroStateMagic || header.version != g_SaveVersion || header.size > size - sizeof(header))
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate: invalid or incompatible state\n");
+		return false;
+	}
+
+	const bool delta = header.flags & RetroState_Delta;
+	if (delta && !s_keyframes.IsResident(header.keyframe))
+	{
+		log_cb(RETRO_LOG_WARN, "Savestate: the keyframe of this incremental state is no longer available\n");
+		return false;
+	}
+
+	if (!pause_for_state())
+		return false;
+
+	// A keyframe that isn't resident anymore (rewinding past a newer one) becomes the
+	// reference again, so that the deltas taken against it can be loaded.
+	const bool adopt_keyframe = !delta && header.keyframe && !s_keyframes.IsResident(header.keyframe);
+	VmStateBuffer& buffer = adopt_keyframe ? s_state_keyframe : s_state_buffer;
+	buffer.MakeRoomFor(header.size);
+	memcpy(buffer.GetPtr(), (const u8*)data + sizeof(header), header.size);
+
+	if (adopt_keyframe)
+	{
+		s_keyframes.Adopt(header.keyframe, header.size);
+	}
+
+	bool success = true;
+
+	try
+	{
+		if (delta)
+		{
+			memDeltaLoadingState loader(buffer, s_state_keyframe);
+			freeze_state(loader);
+		}
+		else
+		{
+			memLoadingState loader(buffer);
+			freeze_state(loader);
+		}
+	}
+	catch (std::exception& ex)
+	{
+		log_cb(RETRO_LOG_ERROR, "Savestate: %s\n", ex.what());
+		success = false;
+	}
+
+	// resync the MTGS copy of the GS registers with the loaded ones.
+	GetMTGS().FlushInThread();
+	GetCoreThread().Resume();
+	return success;
 }
 
 unsigned retro_get_region(void)
@@ -945,15 +1448,14 @@ void retro_cheat_set(unsigned index, bool enabled, const char* code)
 {
 }
 
-retro_audio_sample_t sample_cb;
-
 void retro_set_audio_sample_batch(retro_audio_sample_batch_t cb)
 {
+	batch_cb = cb;
 }
 
+// The mixed audio is handed over in one batch per retro_run
 void retro_set_audio_sample(retro_audio_sample_t cb)
 {
-	sample_cb = cb;
 }
 
 void DspUpdate()
@@ -18,6 +18,13 @@
 #define BOOL_PCSX2_OPT_CONSERVATIVE_BUFFER                    "pcsx2_conservative_buffer"
 #define BOOL_PCSX2_OPT_ACCURATE_DATE                          "pcsx2_accurate_date"
 #define BOOL_PCSX2_OPT_PALETTE_CONVERSION                     "pcsx2_palette_conversion"
+#define BOOL_PCSX2_OPT_INCREMENTAL_SAVESTATES                 "pcsx2_incremental_savestates"
+#define BOOL_PCSX2_OPT_THREADED_MTGS                          "pcsx2_threaded_mtgs"
+#define BOOL_PCSX2_OPT_SW_JIT_PREGENERATE                     "pcsx2_sw_jit_pregenerate"
+#define BOOL_PCSX2_OPT_EE_BLOCK_PROFILER                      "pcsx2_ee_block_profiler"
+#define BOOL_PCSX2_OPT_FASTMEM                                "pcsx2_fastmem"
+#define BOOL_PCSX2_OPT_IPU_THREAD                             "pcsx2_ipu_thread"
+#define BOOL_PCSX2_OPT_AUDIO_DYNAMIC_RATE                     "pcsx2_audio_dynamic_rate"
 
 #define STRING_PCSX2_OPT_BIOS                                 "pcsx2_bios"
 #define STRING_PCSX2_OPT_RENDERER                             "pcsx2_renderer"
@@ -41,6 +48,7 @@
 #define INT_PCSX2_OPT_FXAA                                    "pcsx2_fxaa"
 #define INT_PCSX2_OPT_TEXTURE_FILTERING                       "pcsx2_texture_filtering"
 #define INT_PCSX2_OPT_VSYNC_MTGS_QUEUE                        "pcsx2_vsync_mtgs_queue"
+#define INT_PCSX2_OPT_THREADED_MTGS_LATENCY                   "pcsx2_threaded_mtgs_latency"
 #define INT_PCSX2_OPT_MIPMAPPING                              "pcsx2_mipmapping"
 #define INT_PCSX2_OPT_EE_CLAMPING_MODE                        "pcsx2_clamping_mode"
 #define INT_PCSX2_OPT_EE_ROUND_MODE                           "pcsx2_round_mode"
@@ -49,6 +57,10 @@
 #define INT_PCSX2_OPT_DITHERING                               "pcsx2_dithering"
 #define INT_PCSX2_OPT_GAMEPAD_L_DEADZONE                      "pcsx2_gamepad_l_deadzone"
 #define INT_PCSX2_OPT_GAMEPAD_R_DEADZONE                      "pcsx2_gamepad_r_deadzone"
+#define INT_PCSX2_OPT_GS_DUMP_FRAMES                          "pcsx2_gs_dump_frames"
+#define INT_PCSX2_OPT_SPU2_TRACE_SECONDS                      "pcsx2_spu2_trace_seconds"
+#define INT_PCSX2_OPT_IPU_TRACE_COMMANDS                      "pcsx2_ipu_trace_commands"
+#define INT_PCSX2_OPT_CDVD_READAHEAD                          "pcsx2_cdvd_readahead"
 
 #define INT_PCSX2_OPT_USERHACK_TEXTURE_OFFSET_X_HUNDREDS      "pcsx2_userhack_texture_offset_x_hundreds"
 #define INT_PCSX2_OPT_USERHACK_TEXTURE_OFFSET_X_TENS          "pcsx2_userhack_texture_offset_x_tens"
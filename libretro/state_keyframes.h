@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+// Bookkeeping of the keyframe the incremental savestates are taken against (see
+// retro_serialize).  The ids handed out only ever grow: loading an older keyframe makes
+// it the resident one again but never rewinds the generation, so a keyframe saved after
+// that can't reuse the id of one the frontend still holds deltas for.
+
+class StateKeyframes
+{
+	uint32_t m_generation = 0; // last id handed out
+	uint32_t m_resident = 0;   // id of the keyframe in memory, 0 for none
+	uint32_t m_size = 0;
+	bool m_stale = true;
+
+public:
+	// A new keyframe of size bytes was saved, returns its id
+	uint32_t Save(uint32_t size)
+	{
+		m_resident = ++m_generation;
+		m_size = size;
+		m_stale = false;
+		return m_resident;
+	}
+
+	// A keyframe saved earlier was loaded and is resident again
+	void Adopt(uint32_t id, uint32_t size)
+	{
+		m_resident = id;
+		m_generation = std::max(m_generation, id);
+		m_size = size;
+		m_stale = false;
+	}
+
+	// Deltas past half a keyframe are better started over from a new one
+	void PutDelta(uint32_t size)
+	{
+		if (size > m_size / 2)
+			m_stale = true;
+	}
+
+	void Invalidate() { m_stale = true; }
+
+	bool IsStale() const { return m_stale; }
+	bool IsResident(uint32_t id) const { return id != 0 && id == m_resident; }
+	uint32_t GetResident() const { return m_resident; }
+};
@@ -0,0 +1,78 @@
+// Checks of the incremental savestate keyframe bookkeeping (see state_keyframes.h).  Plays
+// save/load sequences the way retro_serialize/retro_unserialize drive it and checks which
+// deltas are still accepted.
+//
+// usage: pcsx2_StateKeyframesTest
+
+#include "state_keyframes.h"
+
+#include <cstdio>
+
+struct State
+{
+	uint32_t keyframe;
+	bool delta;
+};
+
+static StateKeyframes s_keyframes;
+static int failures = 0;
+
+static State SaveKeyframe(uint32_t size = 1000)
+{
+	return {s_keyframes.Save(size), false};
+}
+
+static State SaveDelta(uint32_t size = 100)
+{
+	State state = {s_keyframes.GetResident(), true};
+	s_keyframes.PutDelta(size);
+	return state;
+}
+
+// Same acceptance rules as retro_unserialize
+static bool Load(const State& state, uint32_t size = 1000)
+{
+	if (state.delta)
+		return s_keyframes.IsResident(state.keyframe);
+
+	if (state.keyframe && !s_keyframes.IsResident(state.keyframe))
+		s_keyframes.Adopt(state.keyframe, size);
+	return true;
+}
+
+static void Check(const char* name, bool ok)
+{
+	failures += !ok;
+	printf("  %-48s  %s\n", name, ok ? "ok" : "FAILED");
+}
+
+int main()
+{
+	const State k1 = SaveKeyframe();
+	const State d1 = SaveDelta();
+	SaveDelta();
+	const State k2 = SaveKeyframe();
+	const State d2 = SaveDelta();
+
+	Check("delta against the resident keyframe loads", Load(d2));
+	Check("delta against a replaced keyframe is rejected", !Load(d1));
+
+	Check("older keyframe loads", Load(k1));
+	Check("its deltas load again", Load(d1));
+	Check("deltas against the newer keyframe are rejected", !Load(d2));
+
+	const State k3 = SaveKeyframe();
+	Check("keyframe saved after it gets a new id", k3.keyframe != k1.keyframe && k3.keyframe != k2.keyframe);
+	Check("deltas against the newer keyframe stay rejected", !Load(d2));
+	Check("deltas against the older keyframe are rejected", !Load(d1));
+	Check("deltas against the new keyframe load", Load(SaveDelta()));
+
+	// Deltas past half a keyframe start a new one
+	SaveDelta(600);
+	Check("large delta marks the keyframe stale", s_keyframes.IsStale());
+	Check("next keyframe gets a new id", SaveKeyframe().keyframe > k3.keyframe);
+
+	printf("\n%d failed\n", failures);
+
+	return failures ? 1 : 0;
+}
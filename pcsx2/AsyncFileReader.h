@@ -24,6 +24,7 @@
 #	include <aio.h>
 #endif
 #include <memory>
+#include <vector>
 
 class AsyncFileReader
 {
@@ -53,6 +54,16 @@ public:
 	virtual void SetBlockSize(uint bytes) {}
 	virtual void SetDataOffset(int bytes) {}
 
+	// Queued reads, for the readahead of InputIsoFile.  Up to depth reads can be in flight,
+	// they complete in any order and are identified by their buffer.  They are independent
+	// of BeginRead/FinishRead and ReadSync.  SetQueueDepth returns the depth actually
+	// available, 0 when the reader can't queue reads.
+	virtual uint SetQueueDepth(uint depth) { return 0; }
+	virtual bool QueueRead(void* pBuffer, uint sector, uint count) { return false; }
+	// Returns the buffer of a completed queued read and sets result (bytes read or < 0 on
+	// error), NULL if none completed yet and block is false.
+	virtual void* ReapQueuedRead(bool block, int& result) { return NULL; }
+
 	uint GetBlockSize() const { return m_blocksize; }
 
 	const wxString& GetFilename() const
@@ -76,6 +87,10 @@ class FlatFileReader : public AsyncFileReader
 #elif defined(__linux__)
 	int m_fd; // FIXME don't know if overlap as an equivalent on linux
 	io_context_t m_aio_context;
+
+	// Queued reads, on their own context so they never complete a BeginRead
+	io_context_t m_queue_context;
+	std::vector<struct iocb> m_queue_iocbs; // free when data is NULL
 #elif defined(__POSIX__)
 	int m_fd; // TODO OSX don't know if overlap as an equivalent on OSX
 	struct aiocb m_aiocb;
@@ -102,6 +117,12 @@ public:
 
 	virtual void SetBlockSize(uint bytes) { m_blocksize = bytes; }
 	virtual void SetDataOffset(int bytes) { m_dataoffset = bytes; }
+
+#ifdef __linux__
+	virtual uint SetQueueDepth(uint depth);
+	virtual bool QueueRead(void* pBuffer, uint sector, uint count);
+	virtual void* ReapQueuedRead(bool block, int& result);
+#endif
 };
 
 class MultipartFileReader : public AsyncFileReader
@@ -4,6 +4,7 @@
 #include "CDVD/CompressedFileReaderUtils.h"
 
 #include <wx/dir.h>
+#include <thread>
 
 
 bool ChdFileReader::CanHandle(const wxString &fileName)
@@ -16,6 +17,7 @@ bool ChdFileReader::CanHandle(const wxString &fileName)
 
 bool ChdFileReader::Open(const wxString &fileName)
 {
+    Close();
 	  m_filename = fileName;
 
     chd_file *child = NULL;
@@ -95,30 +97,88 @@ bool ChdFileReader::Open(const wxString &fileName)
     sector_size = header->unitbytes;
     sector_count = header->unitcount;
     sectors_per_hunk = header->hunkbytes / sector_size;
+    hunk_size = header->hunkbytes;
+    hunk_count = header->totalhunks;
     hunk_buffer = new u8[header->hunkbytes];
-    current_hunk = -1;
 
     delete header;
+
+    chain.assign(chds, chds + chd_depth + 1);
+    cache.SetChunkSize(hunk_size);
+
+    uint threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    threads = std::min(threads, CHD_MAX_DECODE_THREADS);
+
+    for (uint i = 0; i < threads; i++) {
+      chd_file *chd = OpenChain();
+      if (chd == NULL)
+        break;
+      worker_files.push_back(chd);
+      worker_buffers.emplace_back(new u8[hunk_size]);
+    }
+
+    if (!worker_files.empty()) {
+      uint depth = std::min(std::max(CHD_PREFETCH_SIZE / hunk_size, 4u), 64u);
+      cache.StartPrefetch([this](PX_off_t offset, uint thread) { return FetchHunk(offset, thread); },
+                          depth, worker_files.size());
+    }
+
+    return true;
+}
+
+// Opens another handle on the same file, with its own decompressors.
+chd_file *ChdFileReader::OpenChain()
+{
+    chd_file *parent = NULL;
+
+    for (size_t d = chain.size(); d-- > 0;) {
+      chd_file *child = NULL;
+      chd_error error = chd_open(static_cast<const char*>(chain[d]), CHD_OPEN_READ, parent, &child);
+      if (error != CHDERR_NONE) {
+        log_cb(RETRO_LOG_ERROR, "chd_open return error: %s\n", chd_error_string(error));
+        if (parent != NULL)
+          chd_close(parent);
+        return NULL;
+      }
+      parent = child;
+    }
+
+    return parent;
+}
+
+bool ChdFileReader::ReadHunk(chd_file *chd, u32 hunk, u8 *buffer)
+{
+    chd_error error = chd_read(chd, hunk, buffer);
+    if (error != CHDERR_NONE) {
+        log_cb(RETRO_LOG_ERROR, "chd_read return error: %s\n", chd_error_string(error));
+        return false;
+    }
+    cache.Take(buffer, (PX_off_t)hunk * hunk_size, hunk_size, hunk_size);
     return true;
 }
 
+// Called from the cache prefetch threads
+bool ChdFileReader::FetchHunk(PX_off_t offset, uint thread)
+{
+    u32 hunk = offset / hunk_size;
+    if (hunk >= hunk_count)
+      return false;
+
+    return ReadHunk(worker_files[thread], hunk, worker_buffers[thread].get());
+}
+
 int ChdFileReader::ReadSync(void *pBuffer, uint sector, uint count)
 {
     u8 *dst = (u8 *) pBuffer;
     u32 hunk = sector / sectors_per_hunk;
     u32 sector_in_hunk = sector % sectors_per_hunk;
-    chd_error error;
 
     for (uint i = 0; i < count; i++) {
-      if (current_hunk != hunk) {
-        error = chd_read(ChdFile, hunk, hunk_buffer);
-        if (error != CHDERR_NONE) {
-            log_cb(RETRO_LOG_ERROR, "chd_read return error: %s\n", chd_error_string(error));
-            // return i * m_blocksize;
-        }
-        current_hunk = hunk;
+      PX_off_t offset = (PX_off_t)hunk * hunk_size + sector_in_hunk * sector_size;
+      if (cache.Read(dst + i * m_blocksize, offset, m_blocksize) < 0) {
+        ReadHunk(ChdFile, hunk, hunk_buffer);
+        memcpy(dst + i * m_blocksize, hunk_buffer + sector_in_hunk * sector_size, m_blocksize);
       }
-      memcpy(dst + i * m_blocksize, hunk_buffer + sector_in_hunk * sector_size, m_blocksize);
       sector_in_hunk++;
       if (sector_in_hunk >= sectors_per_hunk) {
         hunk++;
@@ -128,19 +188,46 @@ int ChdFileReader::ReadSync(void *pBuffer, uint sector, uint count)
     return m_blocksize * count;
 }
 
+// The hunks are queued for the decode threads ahead of the readahead, and FinishRead
+// copies them out of the cache, waiting for the ones still being decoded.
 void ChdFileReader::BeginRead(void *pBuffer, uint sector, uint count)
 {
-  // TODO: Check if libchdr can read asynchronously
-  async_read = ReadSync(pBuffer, sector, count);
+  PX_off_t first = (PX_off_t)(sector / sectors_per_hunk) * hunk_size;
+  PX_off_t last = (PX_off_t)((sector + count - 1) / sectors_per_hunk) * hunk_size;
+  cache.Prefetch(first, last - first + 1);
+
+  async_buffer = pBuffer;
+  async_sector = sector;
+  async_count = count;
 }
 
 int ChdFileReader::FinishRead()
 {
-	return async_read;
+	if (async_buffer == NULL)
+		return -1;
+
+	int res = ReadSync(async_buffer, async_sector, async_count);
+	async_buffer = NULL;
+	return res;
+}
+
+void ChdFileReader::CancelRead()
+{
+	async_buffer = NULL;
 }
 
 void ChdFileReader::Close()
 {
+    cache.StopPrefetch();
+    cache.LogStats("chd");
+    cache.Clear();
+
+    for (chd_file *chd : worker_files)
+      chd_close(chd);
+    worker_files.clear();
+    worker_buffers.clear();
+    chain.clear();
+
     if (hunk_buffer != NULL) {
       //free(hunk_buffer);
       delete[] hunk_buffer;
@@ -167,7 +254,9 @@ u32 ChdFileReader::GetBlockCount() const
     return sector_count;
 }
 ChdFileReader::ChdFileReader(void)
+  : cache(CHD_HUNKCACHE_SIZE_MB)
 {
   ChdFile = NULL;
   hunk_buffer = NULL;
+  async_buffer = NULL;
 };
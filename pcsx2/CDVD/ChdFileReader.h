@@ -1,7 +1,14 @@
 #pragma once
 #include "AsyncFileReader.h"
+#include "ChunksCache.h"
 #include "libchdr/chd.h"
 
+// Decoded hunks are cached, and the hunks after a sequential read are decoded ahead
+// by a few threads, each with its own handle since libchdr handles are not shared.
+static const uint CHD_HUNKCACHE_SIZE_MB = 32;
+static const uint CHD_PREFETCH_SIZE = 1024 * 1024;
+static const uint CHD_MAX_DECODE_THREADS = 4;
+
 class ChdFileReader : public AsyncFileReader
 {
     DeclareNoncopyableObject(ChdFileReader);
@@ -15,7 +22,7 @@ public:
 
     void BeginRead(void *pBuffer, uint sector, uint count) override;
     int FinishRead(void) override;
-    void CancelRead(void) override {};
+    void CancelRead(void) override;
 
     void Close(void) override;
     void SetBlockSize(uint blocksize);
@@ -24,11 +31,26 @@ public:
     ChdFileReader(void);
 
 private:
+    chd_file *OpenChain();
+    bool ReadHunk(chd_file *chd, u32 hunk, u8 *buffer);
+    bool FetchHunk(PX_off_t offset, uint thread);
+
     chd_file *ChdFile;
     u8 *hunk_buffer;
+    u32 hunk_size;
+    u32 hunk_count;
     u32 sector_size;
     u32 sector_count;
     u32 sectors_per_hunk;
-    u32 current_hunk;
-    u32 async_read;
+
+    // The opened file first, then its parents
+    std::vector<wxString> chain;
+
+    std::vector<chd_file *> worker_files;
+    std::vector<std::unique_ptr<u8[]>> worker_buffers;
+    ChunksCache cache;
+
+    void *async_buffer;
+    uint async_sector;
+    uint async_count;
 };
\ No newline at end of file
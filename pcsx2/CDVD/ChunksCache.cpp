@@ -16,43 +16,414 @@
 #include "PrecompiledHeader.h"
 #include "ChunksCache.h"
 
+static const u64 NO_CHUNK = ~0ull;
+
+// Slots are carved from slabs of about this size, allocated as the cache fills up.
+static const uint SLAB_SIZE = 8 * 1024 * 1024;
+
+static thread_local bool s_prefetchThread = false;
+
+ChunksCache::ChunksCache(uint initialLimitMb)
+	: m_chunkSize(0)
+	, m_limit((PX_off_t)initialLimitMb * 1024 * 1024)
+	, m_slotsPerSlab(1)
+	, m_used(0)
+	, m_head(NONE)
+	, m_tail(NONE)
+	, m_tableMask(0)
+	, m_lastChunk(NO_CHUNK)
+	, m_sequential(0)
+	, m_exit(false)
+	, m_depth(0)
+	, m_stats()
+{
+}
+
+ChunksCache::~ChunksCache()
+{
+	StopPrefetch();
+}
+
+void ChunksCache::SetChunkSize(uint bytes)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_chunkSize = bytes;
+	Reset();
+}
+
 void ChunksCache::SetLimit(uint megabytes)
 {
+	std::lock_guard<std::mutex> lock(m_lock);
 	m_limit = (PX_off_t)megabytes * 1024 * 1024;
-	MatchLimit();
+	Reset();
+}
+
+void ChunksCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	Reset();
+}
+
+void ChunksCache::Reset()
+{
+	m_slots.clear();
+	m_slabs.clear();
+	m_table.clear();
+	m_used = 0;
+	m_head = m_tail = NONE;
+	m_lastChunk = NO_CHUNK;
+	m_sequential = 0;
+	m_queue.clear();
+	m_stats = Stats();
+
+	if (m_chunkSize == 0)
+		return;
+
+	u32 count = (u32)std::max<PX_off_t>(1, m_limit / m_chunkSize);
+
+	m_slotsPerSlab = std::max(1u, SLAB_SIZE / m_chunkSize);
+	m_slots.resize(count);
+	m_slabs.resize((count + m_slotsPerSlab - 1) / m_slotsPerSlab);
+
+	// at most half full, so probe sequences stay short
+	u32 buckets = 1;
+	while (buckets < count * 2)
+		buckets <<= 1;
+
+	m_table.assign(buckets, NONE);
+	m_tableMask = buckets - 1;
+}
+
+static __fi u32 ChunkHash(u64 chunk)
+{
+	return (u32)((chunk * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+u32 ChunksCache::Find(u64 chunk) const
+{
+	if (m_table.empty())
+		return NONE;
+
+	for (u32 i = ChunkHash(chunk) & m_tableMask;; i = (i + 1) & m_tableMask)
+	{
+		u32 slot = m_table[i];
+		if (slot == NONE || m_slots[slot].chunk == chunk)
+			return slot;
+	}
+}
+
+void ChunksCache::Insert(u64 chunk, u32 slot)
+{
+	u32 i = ChunkHash(chunk) & m_tableMask;
+	while (m_table[i] != NONE)
+		i = (i + 1) & m_tableMask;
+
+	m_slots[slot].chunk = chunk;
+	m_table[i] = slot;
 }
 
-void ChunksCache::MatchLimit(bool removeAll)
+void ChunksCache::Erase(u64 chunk)
 {
-	std::list<CacheEntry*>::reverse_iterator rit;
-	while (!m_entries.empty() && (removeAll || m_size > m_limit))
+	u32 i = ChunkHash(chunk) & m_tableMask;
+	while (m_slots[m_table[i]].chunk != chunk)
+		i = (i + 1) & m_tableMask;
+
+	m_table[i] = NONE;
+
+	// Shift the rest of the probe sequence back, no tombstones needed
+	for (u32 j = (i + 1) & m_tableMask; m_table[j] != NONE; j = (j + 1) & m_tableMask)
+	{
+		u32 home = ChunkHash(m_slots[m_table[j]].chunk) & m_tableMask;
+		bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+		if (movable)
+		{
+			m_table[i] = m_table[j];
+			m_table[j] = NONE;
+			i = j;
+		}
+	}
+}
+
+void ChunksCache::Unlink(u32 slot)
+{
+	Slot& s = m_slots[slot];
+
+	if (s.prev != NONE)
+		m_slots[s.prev].next = s.next;
+	else
+		m_head = s.next;
+
+	if (s.next != NONE)
+		m_slots[s.next].prev = s.prev;
+	else
+		m_tail = s.prev;
+}
+
+void ChunksCache::LinkFront(u32 slot)
+{
+	Slot& s = m_slots[slot];
+
+	s.prev = NONE;
+	s.next = m_head;
+
+	if (m_head != NONE)
+		m_slots[m_head].prev = slot;
+	else
+		m_tail = slot;
+
+	m_head = slot;
+}
+
+u32 ChunksCache::AllocSlot()
+{
+	if (m_used < m_slots.size())
 	{
-		rit = m_entries.rbegin();
-		m_size -= (*rit)->size;
-		delete (*rit);
-		m_entries.pop_back();
+		u32 slot = m_used++;
+		std::unique_ptr<u8[]>& slab = m_slabs[slot / m_slotsPerSlab];
+		if (!slab)
+			slab.reset(new u8[(size_t)m_slotsPerSlab * m_chunkSize]);
+		return slot;
 	}
+
+	u32 slot = m_tail;
+	Unlink(slot);
+	Erase(m_slots[slot].chunk);
+	m_stats.evictions++;
+	return slot;
 }
 
-void ChunksCache::Take(void* pMallocedSrc, PX_off_t offset, int length, int coverage)
+void ChunksCache::Take(const void* pSrc, PX_off_t offset, int length, int coverage)
 {
-	m_entries.push_front(new CacheEntry(pMallocedSrc, offset, length, coverage));
-	m_size += length;
-	MatchLimit();
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_chunkSize == 0)
+		return;
+
+	pxAssert(offset % m_chunkSize == 0 && length <= coverage && coverage <= (int)m_chunkSize);
+
+	u64 chunk = offset / m_chunkSize;
+	u32 slot = Find(chunk);
+
+	if (slot == NONE)
+	{
+		slot = AllocSlot();
+		Insert(chunk, slot);
+	}
+	else
+	{
+		Unlink(slot);
+	}
+
+	Slot& s = m_slots[slot];
+	s.size = length;
+	s.coverage = coverage;
+	s.prefetched = s_prefetchThread;
+	if (length > 0)
+		memcpy(SlotData(slot), pSrc, length);
+
+	LinkFront(slot);
 }
 
 // By design, succeed only if the entire request is in a single cached chunk
 int ChunksCache::Read(void* pDest, PX_off_t offset, int length)
 {
-	for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	if (m_chunkSize == 0)
+		return -1;
+
+	u64 chunk = offset / m_chunkSize;
+	PX_off_t chunkOffset = (PX_off_t)chunk * m_chunkSize;
+
+	Readahead(chunk);
+
+	u32 slot = Find(chunk);
+
+	if (slot == NONE && IsInflight(chunk))
+	{
+		// Already being extracted, which is faster than starting over
+		m_stats.prefetch_waits++;
+		m_cv.wait(lock, [&] { return !IsInflight(chunk); });
+		slot = Find(chunk);
+	}
+
+	if (slot == NONE || offset + length > chunkOffset + m_slots[slot].coverage)
+	{
+		// The caller extracts it now, don't let the prefetch thread do it again
+		auto it = std::find(m_queue.begin(), m_queue.end(), chunk);
+		if (it != m_queue.end())
+			m_queue.erase(it);
+
+		m_stats.misses++;
+		return -1;
+	}
+
+	Slot& s = m_slots[slot];
+
+	m_stats.hits++;
+	if (s.prefetched)
+	{
+		m_stats.prefetch_hits++;
+		s.prefetched = false;
+	}
+
+	if (slot != m_head)
+	{
+		Unlink(slot);
+		LinkFront(slot); // Move to top (MRU)
+	}
+
+	return CopyAvailable(SlotData(slot), chunkOffset, s.size, pDest, offset, length);
+}
+
+void ChunksCache::Readahead(u64 chunk)
+{
+	if (!m_fetch || chunk == m_lastChunk)
+		return;
+
+	if (chunk == m_lastChunk + 1)
+	{
+		m_sequential++;
+	}
+	else
+	{
+		// Seek, whatever was queued is not going to be read soon
+		m_sequential = 0;
+		m_queue.clear();
+	}
+
+	m_lastChunk = chunk;
+
+	while (!m_queue.empty() && m_queue.front() <= chunk)
+		m_queue.pop_front();
+
+	if (m_sequential == 0)
+		return;
+
+	for (u64 next = chunk + 1; next <= chunk + m_depth; next++)
+	{
+		if (Find(next) == NONE && !IsInflight(next) && !IsQueued(next))
+			m_queue.push_back(next);
+	}
+
+	if (!m_queue.empty())
+		m_cv.notify_all();
+}
+
+void ChunksCache::PrefetchThread(uint index)
+{
+	s_prefetchThread = true;
+
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	while (true)
+	{
+		m_cv.wait(lock, [&] { return m_exit || !m_queue.empty(); });
+
+		if (m_exit)
+			break;
+
+		u64 chunk = m_queue.front();
+		m_queue.pop_front();
+
+		if (Find(chunk) != NONE || IsInflight(chunk))
+			continue;
+
+		m_inflight.push_back(chunk);
+		PX_off_t offset = (PX_off_t)chunk * m_chunkSize;
+
+		lock.unlock();
+		bool ok = m_fetch(offset, index);
+		lock.lock();
+
+		m_inflight.erase(std::find(m_inflight.begin(), m_inflight.end(), chunk));
+
+		if (ok)
+			m_stats.prefetched++;
+		else
+			m_queue.clear(); // end of file or a bad chunk, the read itself will report it
+
+		m_cv.notify_all();
+	}
+}
+
+void ChunksCache::StartPrefetch(FetchFunc fetch, uint depth, uint threads)
+{
+	StopPrefetch();
+
+	if (depth == 0 || threads == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_fetch = fetch;
+	m_depth = depth;
+	for (uint i = 0; i < threads; i++)
+		m_threads.emplace_back(&ChunksCache::PrefetchThread, this, i);
+}
+
+void ChunksCache::StopPrefetch()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_exit = true;
+		m_queue.clear();
+	}
+
+	m_cv.notify_all();
+
+	for (std::thread& t : m_threads)
+		t.join();
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_threads.clear();
+	m_exit = false;
+	m_fetch = nullptr;
+	m_lastChunk = NO_CHUNK;
+	m_sequential = 0;
+}
+
+// Queues the chunks of a read the caller is about to make ahead of the readahead,
+// without waiting for them.
+void ChunksCache::Prefetch(PX_off_t offset, int length)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (!m_fetch || m_chunkSize == 0 || length <= 0)
+		return;
+
+	u64 first = offset / m_chunkSize;
+	u64 last = (offset + length - 1) / m_chunkSize;
+
+	for (u64 chunk = last + 1; chunk-- > first;)
 	{
-		CacheEntry* e = *it;
-		if (e && offset >= e->offset && (offset + length) <= (e->offset + e->coverage))
+		if (Find(chunk) == NONE && !IsInflight(chunk))
 		{
-			if (it != m_entries.begin())
-				m_entries.splice(m_entries.begin(), m_entries, it); // Move to top (MRU)
-			return CopyAvailable(e->data, e->offset, e->size, pDest, offset, length);
+			auto it = std::find(m_queue.begin(), m_queue.end(), chunk);
+			if (it != m_queue.end())
+				m_queue.erase(it);
+			m_queue.push_front(chunk);
 		}
 	}
-	return -1;
+
+	m_cv.notify_all();
+}
+
+ChunksCache::Stats ChunksCache::GetStats()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	return m_stats;
+}
+
+void ChunksCache::LogStats(const char* name)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	const Stats& s = m_stats;
+
+	if (s.hits + s.misses == 0)
+		return;
+
+	log_cb(RETRO_LOG_INFO, "%s cache: %llu hits, %llu misses (%.1f%%), %llu prefetched, %llu prefetch hits, %llu prefetch waits, %llu evictions, %u of %u chunks used\n",
+		   name, (unsigned long long)s.hits, (unsigned long long)s.misses, 100.0 * s.hits / (s.hits + s.misses),
+		   (unsigned long long)s.prefetched, (unsigned long long)s.prefetch_hits, (unsigned long long)s.prefetch_waits,
+		   (unsigned long long)s.evictions, m_used, (u32)m_slots.size());
 }
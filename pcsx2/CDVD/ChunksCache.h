@@ -17,56 +17,120 @@
 
 #include "zlib_indexed.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #define CLAMP(val, minval, maxval) (std::min(maxval, std::max(minval, val)))
 
+// Cache of extracted data, in fixed size chunks at chunk size aligned offsets.
+//
+// Chunks live in slots of a slab arena which only grows up to the limit, a full cache
+// recycles the least recently used slot. Lookups go through an open addressed hash of
+// the chunk index, so they cost the same regardless of how many chunks are cached.
+//
+// Once the reader walks through consecutive chunks, background threads call the
+// owner's fetch function for the next few chunks, so that the decompression happens
+// before the game asks for them. The fetch function must Take() the chunk itself, and
+// gets the index of the calling thread for per thread decoder state.
 class ChunksCache
 {
 public:
-	ChunksCache(uint initialLimitMb)
-		: m_entries(0)
-		, m_size(0)
-		, m_limit(initialLimitMb * 1024 * 1024){};
-	~ChunksCache() { Clear(); };
+	typedef std::function<bool(PX_off_t offset, uint thread)> FetchFunc;
+
+	struct Stats
+	{
+		u64 hits;
+		u64 misses;
+		u64 prefetched;     // chunks extracted by the prefetch threads
+		u64 prefetch_hits;  // first hits on those, the rest were evicted or never read
+		u64 prefetch_waits; // misses which waited for a prefetch thread instead of extracting
+		u64 evictions;
+	};
+
+	ChunksCache(uint initialLimitMb);
+	~ChunksCache();
+
+	void SetChunkSize(uint bytes);
 	void SetLimit(uint megabytes);
-	void Clear() { MatchLimit(true); };
+	void Clear();
 
-	void Take(void* pMallocedSrc, PX_off_t offset, int length, int coverage);
+	void Take(const void* pSrc, PX_off_t offset, int length, int coverage);
 	int Read(void* pDest, PX_off_t offset, int length);
 
-	static int CopyAvailable(void* pSrc, PX_off_t srcOffset, int srcSize,
+	void StartPrefetch(FetchFunc fetch, uint depth, uint threads = 1);
+	void StopPrefetch();
+	void Prefetch(PX_off_t offset, int length);
+
+	Stats GetStats();
+	void LogStats(const char* name);
+
+	static int CopyAvailable(const void* pSrc, PX_off_t srcOffset, int srcSize,
 							 void* pDst, PX_off_t dstOffset, int maxCopySize)
 	{
 		int available = CLAMP(maxCopySize, 0, (int)(srcOffset + srcSize - dstOffset));
-		memcpy(pDst, (char*)pSrc + (dstOffset - srcOffset), available);
+		memcpy(pDst, (const char*)pSrc + (dstOffset - srcOffset), available);
 		return available;
 	};
 
 private:
-	class CacheEntry
+	static const u32 NONE = 0xffffffff;
+
+	struct Slot
 	{
-	public:
-		CacheEntry(void* pMallocedSrc, PX_off_t offset, int length, int coverage)
-			: data(pMallocedSrc)
-			, offset(offset)
-			, coverage(coverage)
-			, size(length){};
-
-		~CacheEntry()
-		{
-			if (data)
-				free(data);
-		};
-
-		void* data;
-		PX_off_t offset;
-		int coverage;
-		int size;
+		u64 chunk;
+		int size;     // bytes of data, less than coverage at the end of the file
+		int coverage; // bytes of the file this chunk accounts for
+		u32 prev;     // towards the most recently used
+		u32 next;     // towards the least recently used
+		bool prefetched;
 	};
 
-	std::list<CacheEntry*> m_entries;
-	void MatchLimit(bool removeAll = false);
-	PX_off_t m_size;
+	u8* SlotData(u32 slot) { return m_slabs[slot / m_slotsPerSlab].get() + (size_t)(slot % m_slotsPerSlab) * m_chunkSize; }
+
+	void Reset();
+	u32 Find(u64 chunk) const;
+	bool IsInflight(u64 chunk) const { return std::find(m_inflight.begin(), m_inflight.end(), chunk) != m_inflight.end(); }
+	bool IsQueued(u64 chunk) const { return std::find(m_queue.begin(), m_queue.end(), chunk) != m_queue.end(); }
+	void Insert(u64 chunk, u32 slot);
+	void Erase(u64 chunk);
+	void Unlink(u32 slot);
+	void LinkFront(u32 slot);
+	u32 AllocSlot();
+	void Readahead(u64 chunk);
+	void PrefetchThread(uint index);
+
+	std::mutex m_lock;
+
+	uint m_chunkSize;
 	PX_off_t m_limit;
+
+	std::vector<Slot> m_slots;
+	std::vector<std::unique_ptr<u8[]>> m_slabs;
+	u32 m_slotsPerSlab;
+	u32 m_used;
+	u32 m_head; // most recently used
+	u32 m_tail; // least recently used
+
+	std::vector<u32> m_table; // slot per bucket, NONE if empty
+	u32 m_tableMask;
+
+	u64 m_lastChunk;
+	uint m_sequential;
+
+	std::vector<std::thread> m_threads;
+	std::condition_variable m_cv;
+	std::deque<u64> m_queue;
+	std::vector<u64> m_inflight;
+	bool m_exit;
+	FetchFunc m_fetch;
+	uint m_depth;
+
+	Stats m_stats;
 };
 
 #undef CLAMP
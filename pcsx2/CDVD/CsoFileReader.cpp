@@ -97,6 +97,13 @@ bool CsoFileReader::Open(const wxString& fileName)
 		success = true;
 	}
 
+	if (success)
+	{
+		m_cache.SetChunkSize(m_frameSize);
+		m_cache.StartPrefetch([this](PX_off_t offset, uint) { return FetchFrame(offset); },
+							  std::min(std::max(CSO_PREFETCH_SIZE / m_frameSize, 2u), 32u));
+	}
+
 	if (!success)
 	{
 		Close();
@@ -179,10 +186,11 @@ bool CsoFileReader::InitializeBuffers()
 
 void CsoFileReader::Close()
 {
-	m_filename.Empty();
-#if CSO_USE_CHUNKSCACHE
+	m_cache.StopPrefetch();
+	m_cache.LogStats("cso");
 	m_cache.Clear();
-#endif
+
+	m_filename.Empty();
 
 	if (m_src)
 	{
@@ -230,29 +238,11 @@ int CsoFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 
 	while (remaining > 0)
 	{
-		int readBytes;
-
-#if CSO_USE_CHUNKSCACHE
-		// Try first to read from the cache.
-		readBytes = m_cache.Read(dest + bytes, pos + bytes, remaining);
-#else
-		readBytes = -1;
-#endif
-		if (readBytes < 0)
+		int readBytes = ReadFromFrame(dest + bytes, pos + bytes, remaining);
+		if (readBytes == 0)
 		{
-			readBytes = ReadFromFrame(dest + bytes, pos + bytes, remaining);
-			if (readBytes == 0)
-			{
-				// We hit EOF.
-				break;
-			}
-
-#if CSO_USE_CHUNKSCACHE
-			// Add the bytes into the cache.  We need to allocate a buffer for it.
-			void* cached = malloc(readBytes);
-			memcpy(cached, dest + bytes, readBytes);
-			m_cache.Take(cached, pos + bytes, readBytes, readBytes);
-#endif
+			// We hit EOF.
+			break;
 		}
 
 		bytes += readBytes;
@@ -277,16 +267,13 @@ int CsoFileReader::ReadFromFrame(u8* dest, u64 pos, int maxBytes)
 
 	// Grab the index data for the frame we're about to read.
 	const bool compressed = (m_index[frame + 0] & 0x80000000) == 0;
-	const u32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
-	const u32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
-
-	// Calculate where the compressed payload is (if compressed.)
-	const u64 frameRawPos = (u64)index0 << m_indexShift;
-	const u64 frameRawSize = (u64)(index1 - index0) << m_indexShift;
 
 	if (!compressed)
 	{
+		std::lock_guard<std::mutex> lock(m_decompressLock);
+
 		// Just read directly, easy.
+		const u64 frameRawPos = (u64)(m_index[frame + 0] & 0x7FFFFFFF) << m_indexShift;
 		if (PX_fseeko(m_src, m_dataoffset + frameRawPos + offset, SEEK_SET) != 0)
 		{
 			log_cb(RETRO_LOG_ERROR, "Unable to seek to uncompressed CSO data.\n");
@@ -296,30 +283,78 @@ int CsoFileReader::ReadFromFrame(u8* dest, u64 pos, int maxBytes)
 	}
 	else
 	{
-		// We don't need to decompress if we already did this same frame last time.
-		if (m_zlibBufferFrame != frame)
+		// Try first to read from the cache.
+		if (m_cache.Read(dest, pos, bytes) >= 0)
 		{
-			if (PX_fseeko(m_src, m_dataoffset + frameRawPos, SEEK_SET) != 0)
-			{
-				log_cb(RETRO_LOG_ERROR, "Unable to seek to compressed CSO data.\n");
-				return 0;
-			}
-			// This might be less bytes than frameRawSize in case of padding on the last frame.
-			// This is because the index positions must be aligned.
-			const u32 readRawBytes = fread(m_readBuffer, 1, frameRawSize, m_src);
-			if (!DecompressFrame(frame, readRawBytes))
-			{
-				return 0;
-			}
+			return bytes;
+		}
+
+		std::lock_guard<std::mutex> lock(m_decompressLock);
+
+		if (!LoadFrame(frame))
+		{
+			return 0;
 		}
 
-		// Now we just copy the offset data from the cache.
+		// Now we just copy the offset data from the buffer.
 		memcpy(dest, m_zlibBuffer + offset, bytes);
 	}
 
 	return bytes;
 }
 
+// Decompresses a frame into m_zlibBuffer and the cache, m_decompressLock must be held.
+bool CsoFileReader::LoadFrame(u32 frame)
+{
+	// We don't need to decompress if we already did this same frame last time.
+	if (m_zlibBufferFrame == frame)
+	{
+		return true;
+	}
+
+	const u32 index0 = m_index[frame + 0] & 0x7FFFFFFF;
+	const u32 index1 = m_index[frame + 1] & 0x7FFFFFFF;
+
+	// Calculate where the compressed payload is.
+	const u64 frameRawPos = (u64)index0 << m_indexShift;
+	const u64 frameRawSize = (u64)(index1 - index0) << m_indexShift;
+
+	if (PX_fseeko(m_src, m_dataoffset + frameRawPos, SEEK_SET) != 0)
+	{
+		log_cb(RETRO_LOG_ERROR, "Unable to seek to compressed CSO data.\n");
+		return false;
+	}
+	// This might be less bytes than frameRawSize in case of padding on the last frame.
+	// This is because the index positions must be aligned.
+	const u32 readRawBytes = fread(m_readBuffer, 1, frameRawSize, m_src);
+	if (!DecompressFrame(frame, readRawBytes))
+	{
+		return false;
+	}
+
+	m_cache.Take(m_zlibBuffer, (u64)frame << m_frameShift, m_frameSize, m_frameSize);
+	return true;
+}
+
+// Called from the cache prefetch thread.
+bool CsoFileReader::FetchFrame(u64 pos)
+{
+	if (pos >= m_totalSize)
+	{
+		return false;
+	}
+
+	const u32 frame = (u32)(pos >> m_frameShift);
+	if (m_index[frame] & 0x80000000)
+	{
+		// Uncompressed, nothing to gain.
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock(m_decompressLock);
+	return LoadFrame(frame);
+}
+
 bool CsoFileReader::DecompressFrame(u32 frame, u32 readBufferSize)
 {
 	m_z_stream->next_in = m_readBuffer;
@@ -15,22 +15,15 @@
 
 #pragma once
 
-// Based on testing, the overhead of using this cache is high.
-//
-// The test was done with CSO files using a block size of 16KB.
-// Cache hit rates were observed in the range of 25%.
-// Cache overhead added 35% to the overall read time.
-//
-// For this reason, it's currently disabled.
-#define CSO_USE_CHUNKSCACHE 0
-
 #include "AsyncFileReader.h"
 #include "ChunksCache.h"
 
 struct CsoHeader;
 typedef struct z_stream_s z_stream;
 
+// Decompressed frames are cached, and read ahead during sequential reads.
 static const uint CSO_CHUNKCACHE_SIZE_MB = 200;
+static const uint CSO_PREFETCH_SIZE = 128 * 1024;
 
 class CsoFileReader : public AsyncFileReader
 {
@@ -48,12 +41,8 @@ public:
 		, m_totalSize(0)
 		, m_src(0)
 		, m_z_stream(0)
-		,
-#if CSO_USE_CHUNKSCACHE
-		m_cache(CSO_CHUNKCACHE_SIZE_MB)
-		,
-#endif
-		m_bytesRead(0)
+		, m_cache(CSO_CHUNKCACHE_SIZE_MB)
+		, m_bytesRead(0)
 	{
 		m_blocksize = 2048;
 	};
@@ -85,6 +74,8 @@ private:
 	bool InitializeBuffers();
 	int ReadFromFrame(u8* dest, u64 pos, int maxBytes);
 	bool DecompressFrame(u32 frame, u32 readBufferSize);
+	bool LoadFrame(u32 frame);
+	bool FetchFrame(u64 pos);
 
 	u32 m_frameSize;
 	u8 m_frameShift;
@@ -98,9 +89,9 @@ private:
 	FILE* m_src;
 	z_stream* m_z_stream;
 
-#if CSO_USE_CHUNKSCACHE
+	// Guards the file and the zlib state, which the cache prefetch thread uses too
+	std::mutex m_decompressLock;
 	ChunksCache m_cache;
-#endif
 
 	// The result of a read is stored here between BeginRead() and FinishRead().
 	int m_bytesRead;
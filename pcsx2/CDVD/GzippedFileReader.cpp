@@ -170,6 +170,7 @@ GzippedFileReader::GzippedFileReader(void)
 	, m_cache(GZFILE_CACHE_SIZE_MB)
 {
 	m_blocksize = 2048;
+	m_cache.SetChunkSize(GZFILE_READ_CHUNK_SIZE);
 	AsyncPrefetchReset();
 };
 
@@ -338,6 +339,7 @@ bool GzippedFileReader::Open(const wxString& fileName)
 	};
 
 	AsyncPrefetchOpen();
+	m_cache.StartPrefetch([this](PX_off_t offset, uint) { return FetchChunk(offset); }, GZFILE_PREFETCH_CHUNKS);
 	return true;
 };
 
@@ -418,24 +420,37 @@ int GzippedFileReader::_ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRea
 
 	// Not available from cache. Decompress from optimal starting
 	// point in GZFILE_READ_CHUNK_SIZE chunks and cache each chunk.
+	std::lock_guard<std::mutex> lock(m_extractLock);
+
+	PX_off_t extractOffset;
+	res = ExtractChunks(offset, extractOffset);
+	if (res < 0)
+		return res;
+
+	return ChunksCache::CopyAvailable(m_extracted.data(), extractOffset, res, pBuffer, offset, bytesToRead);
+}
+
+// Extracts up to the end of the chunk containing offset into m_extracted, and caches
+// every chunk on the way. Returns the extracted size, m_extractLock must be held.
+int GzippedFileReader::ExtractChunks(PX_off_t offset, PX_off_t& extractOffset)
+{
+	uint maxInChunk = GZFILE_READ_CHUNK_SIZE - offset % GZFILE_READ_CHUNK_SIZE;
+
 	PTT s = NOW();
-	PX_off_t extractOffset = GetOptimalExtractionStart(offset); // guaranteed in GZFILE_READ_CHUNK_SIZE boundaries
+	extractOffset = GetOptimalExtractionStart(offset); // guaranteed in GZFILE_READ_CHUNK_SIZE boundaries
 	int size = offset + maxInChunk - extractOffset;
-	unsigned char* extracted = (unsigned char*)malloc(size);
+	if (m_extracted.size() < (size_t)size)
+		m_extracted.resize(size);
+	unsigned char* extracted = m_extracted.data();
 
 	int span = m_pIndex->span;
 	int spanix = extractOffset / span;
 	AsyncPrefetchCancel();
-	res = extract(m_src, m_pIndex, extractOffset, extracted, size, &(m_zstates[spanix].state));
+	int res = extract(m_src, m_pIndex, extractOffset, extracted, size, &(m_zstates[spanix].state));
 	if (res < 0)
-	{
-		free(extracted);
 		return res;
-	}
 	AsyncPrefetchChunk(getInOffset(&(m_zstates[spanix].state)));
 
-	int copied = ChunksCache::CopyAvailable(extracted, extractOffset, res, pBuffer, offset, bytesToRead);
-
 	if (m_zstates[spanix].state.isValid && (extractOffset + res) / span != offset / span)
 	{
 		// The state no longer matches this span.
@@ -451,19 +466,11 @@ int GzippedFileReader::_ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRea
 		m_zstates[spanix].Kill();
 	}
 
-	if (size <= GZFILE_READ_CHUNK_SIZE)
-		m_cache.Take(extracted, extractOffset, res, size);
-	else
-	{ // split into cacheable chunks
-		for (int i = 0; i < size; i += GZFILE_READ_CHUNK_SIZE)
-		{
-			int available = CLAMP(res - i, 0, GZFILE_READ_CHUNK_SIZE);
-			void* chunk = available ? malloc(available) : 0;
-			if (available)
-				memcpy(chunk, extracted + i, available);
-			m_cache.Take(chunk, extractOffset + i, available, std::min(size - i, GZFILE_READ_CHUNK_SIZE));
-		}
-		free(extracted);
+	// split into cacheable chunks
+	for (int i = 0; i < size; i += GZFILE_READ_CHUNK_SIZE)
+	{
+		int available = CLAMP(res - i, 0, GZFILE_READ_CHUNK_SIZE);
+		m_cache.Take(extracted + i, extractOffset + i, available, std::min(size - i, GZFILE_READ_CHUNK_SIZE));
 	}
 
 	int duration = NOW() - s;
@@ -476,11 +483,26 @@ int GzippedFileReader::_ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRea
 						duration);
 #endif
 
-	return copied;
+	return res;
+}
+
+// Called from the cache prefetch thread
+bool GzippedFileReader::FetchChunk(PX_off_t offset)
+{
+	std::lock_guard<std::mutex> lock(m_extractLock);
+
+	if (!m_pIndex || offset >= m_pIndex->uncompressed_size)
+		return false;
+
+	PX_off_t extractOffset;
+	return ExtractChunks(offset, extractOffset) > 0;
 }
 
 void GzippedFileReader::Close()
 {
+	m_cache.StopPrefetch();
+	m_cache.LogStats("gzip");
+
 	m_filename.Empty();
 	if (m_pIndex)
 	{
@@ -490,6 +512,7 @@ void GzippedFileReader::Close()
 
 	InitZstates(); // results in delete because no index
 	m_cache.Clear();
+	m_extracted = std::vector<u8>();
 
 	if (m_src)
 	{
@@ -24,6 +24,7 @@ typedef struct zstate Zstate;
 #define GZFILE_SPAN_DEFAULT (1048576L * 4)  /* distance between direct access points when creating a new index */
 #define GZFILE_READ_CHUNK_SIZE (256 * 1024) /* zlib extraction chunks size (at 0-based boundaries) */
 #define GZFILE_CACHE_SIZE_MB 200            /* cache size for extracted data. must be at least GZFILE_READ_CHUNK_SIZE (in MB)*/
+#define GZFILE_PREFETCH_CHUNKS 4            /* chunks extracted ahead by the cache prefetch thread during sequential reads */
 
 class GzippedFileReader : public AsyncFileReader
 {
@@ -73,6 +74,8 @@ private:
 	bool OkIndex(); // Verifies that we have an index, or try to create one
 	PX_off_t GetOptimalExtractionStart(PX_off_t offset);
 	int _ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRead);
+	int ExtractChunks(PX_off_t offset, PX_off_t& extractOffset);
+	bool FetchChunk(PX_off_t offset);
 	void InitZstates();
 
 	int mBytesRead;   // Temp sync read result when simulating async read
@@ -80,6 +83,10 @@ private:
 	Czstate* m_zstates;
 	FILE* m_src;
 
+	// Guards m_src, m_zstates and m_extracted, which the cache prefetch thread uses too
+	std::mutex m_extractLock;
+	std::vector<u8> m_extracted;
+
 	ChunksCache m_cache;
 
 #ifdef _WIN32
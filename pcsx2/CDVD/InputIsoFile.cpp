@@ -18,8 +18,11 @@
 #include "IopCommon.h"
 #include "IsoFileFormats.h"
 
+#include <chrono>
 #include <errno.h>
 
+uint InputIsoFile::s_readahead_depth = 4;
+
 static const char* nameFromType(int type)
 {
 	switch (type)
@@ -64,6 +67,12 @@ void InputIsoFile::BeginRead2(uint lsn)
 		return;
 	}
 
+	if (!m_readahead.empty())
+	{
+		BeginQueuedRead(lsn);
+		return;
+	}
+
 	m_read_lsn = lsn;
 	m_read_count = 1;
 
@@ -100,6 +109,23 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 			return ret;
 	}
 
+	if (m_active)
+	{
+		if (m_active->state == Readahead_InFlight)
+		{
+			auto start = std::chrono::steady_clock::now();
+			while (m_active->state == Readahead_InFlight && ReapSlot(true))
+				;
+			const auto waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+			m_readahead_waits[waited < 100 ? 0 : waited < 1000 ? 1 : waited < 10000 ? 2 : waited < 100000 ? 3 : 4]++;
+		}
+
+		if (m_active->state != Readahead_Ready)
+			return -1;
+		if (m_active->result < 0)
+			return m_active->result;
+	}
+
 	switch (mode)
 	{
 		case CDVD_MODE_2352:
@@ -140,7 +166,7 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 	length = end - _offset;
 
 	uint read_offset = (m_current_lsn - m_read_lsn) * m_blocksize;
-	memcpy(dst + diff, m_readbuffer + ndiff + read_offset, length);
+	memcpy(dst + diff, m_read_data + ndiff + read_offset, length);
 
 	if (m_type == ISOTYPE_CD && diff >= 12)
 	{
@@ -151,6 +177,152 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 	return 0;
 }
 
+void InputIsoFile::SetReadaheadDepth(uint depth)
+{
+	s_readahead_depth = std::min(depth, MaxReadaheadDepth);
+}
+
+bool InputIsoFile::QueueSlot(ReadaheadSlot& slot, uint lsn)
+{
+	slot.lsn = lsn;
+	slot.count = std::min(ReadUnit, m_blocks - lsn);
+	slot.stale = false;
+
+	if (!m_reader->QueueRead(slot.buffer.get(), slot.lsn, slot.count))
+		return false;
+
+	slot.state = Readahead_InFlight;
+	return true;
+}
+
+// Collects one completed read, returns false if there was none
+bool InputIsoFile::ReapSlot(bool block)
+{
+	int result;
+	void* buffer = m_reader->ReapQueuedRead(block, result);
+	if (!buffer)
+		return false;
+
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		if (slot.buffer.get() == buffer)
+		{
+			slot.state = slot.stale ? Readahead_Free : Readahead_Ready;
+			slot.result = result;
+			break;
+		}
+	}
+
+	return true;
+}
+
+void InputIsoFile::BeginQueuedRead(uint lsn)
+{
+	while (ReapSlot(false))
+		;
+
+	ReadaheadSlot* found = NULL;
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		if (slot.state != Readahead_Free && !slot.stale && lsn >= slot.lsn && lsn < slot.lsn + slot.count)
+			found = &slot;
+	}
+
+	const bool sequential = found || lsn == m_read_lsn + m_read_count;
+
+	m_readahead_reads++;
+	if (found)
+		m_readahead_hits++;
+
+	// Drop the reads behind this one, or all of them on a seek
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		if (&slot == found || (found && slot.lsn > lsn))
+			continue;
+
+		if (slot.state == Readahead_Ready)
+			slot.state = Readahead_Free;
+		else if (slot.state == Readahead_InFlight)
+			slot.stale = true;
+	}
+
+	if (!found)
+	{
+		// The dropped reads still in flight hold their slot until they complete
+		while (!found)
+		{
+			for (ReadaheadSlot& slot : m_readahead)
+			{
+				if (slot.state == Readahead_Free)
+				{
+					found = &slot;
+					break;
+				}
+			}
+
+			if (!found && !ReapSlot(true))
+				break;
+		}
+
+		pxAssert(found);
+
+		if (!QueueSlot(*found, lsn))
+		{
+			found->result = m_reader->ReadSync(found->buffer.get(), found->lsn, found->count);
+			found->state = Readahead_Ready;
+		}
+
+		m_readahead_next = found->lsn + found->count;
+	}
+
+	m_active = found;
+	m_read_lsn = found->lsn;
+	m_read_count = found->count;
+	m_read_data = found->buffer.get();
+
+	if (!sequential)
+		return;
+
+	for (ReadaheadSlot& slot : m_readahead)
+	{
+		if (m_readahead_next >= m_blocks)
+			break;
+
+		if (slot.state == Readahead_Free)
+		{
+			if (!QueueSlot(slot, m_readahead_next))
+				break;
+			m_readahead_next += slot.count;
+		}
+	}
+}
+
+void InputIsoFile::CloseReadahead()
+{
+	// The reads in flight write to the slots
+	for (;;)
+	{
+		bool inflight = false;
+		for (ReadaheadSlot& slot : m_readahead)
+			inflight |= slot.state == Readahead_InFlight;
+
+		if (!inflight || !ReapSlot(true))
+			break;
+	}
+
+	if (m_readahead_reads)
+	{
+		u64 waits = 0;
+		for (u64 count : m_readahead_waits)
+			waits += count;
+
+		log_cb(RETRO_LOG_INFO, "isoFile readahead: %llu reads, %llu queued ahead, waits: %llu none, %llu < 0.1ms, %llu < 1ms, %llu < 10ms, %llu < 100ms, %llu longer\n",
+			(unsigned long long)m_readahead_reads, (unsigned long long)m_readahead_hits, (unsigned long long)(m_readahead_reads - waits),
+			(unsigned long long)m_readahead_waits[0], (unsigned long long)m_readahead_waits[1], (unsigned long long)m_readahead_waits[2],
+			(unsigned long long)m_readahead_waits[3], (unsigned long long)m_readahead_waits[4]);
+	}
+}
+
 InputIsoFile::InputIsoFile()
 {
 	_init();
@@ -173,10 +345,18 @@ void InputIsoFile::_init()
 
 	m_read_inprogress = false;
 	m_read_count = 0;
+	m_read_data = m_readbuffer;
 	ReadUnit = 0;
 	m_current_lsn = -1;
 	m_read_lsn = -1;
 	m_reader = NULL;
+
+	m_readahead.clear();
+	m_active = NULL;
+	m_readahead_next = 0;
+	m_readahead_reads = 0;
+	m_readahead_hits = 0;
+	memset(m_readahead_waits, 0, sizeof(m_readahead_waits));
 }
 
 // Tests the specified filename to see if it is a supported ISO type.  This function typically
@@ -258,6 +438,14 @@ bool InputIsoFile::Open(const wxString& srcfile, bool testOnly)
 		m_reader = MultipartFileReader::DetectMultipart(m_reader);
 		if (m_reader != m_reader_old) // Not the same object the old one need to be deleted
 			delete m_reader_old;
+
+		// The compressed readers cache and read ahead on their own
+		m_readahead.resize(s_readahead_depth ? m_reader->SetQueueDepth(s_readahead_depth) : 0);
+		for (ReadaheadSlot& slot : m_readahead)
+		{
+			slot.buffer.reset(new u8[ReadUnit * m_blocksize]);
+			slot.state = Readahead_Free;
+		}
 	}
 
 	m_blocks = m_reader->GetBlockCount();
@@ -278,6 +466,8 @@ bool InputIsoFile::Open(const wxString& srcfile, bool testOnly)
 
 void InputIsoFile::Close()
 {
+	CloseReadahead();
+
 	delete m_reader;
 	m_reader = NULL;
 
@@ -19,6 +19,7 @@
 #include "AsyncFileReader.h"
 #include "CompressedFileReader.h"
 #include <memory>
+#include <vector>
 
 enum isoType
 {
@@ -39,6 +40,7 @@ class InputIsoFile
 	DeclareNoncopyableObject(InputIsoFile);
 
 	static const uint MaxReadUnit = 128;
+	static const uint MaxReadaheadDepth = 16;
 
 protected:
 	uint ReadUnit;
@@ -62,8 +64,40 @@ protected:
 	bool m_read_inprogress;
 	uint m_read_lsn;
 	uint m_read_count;
+	u8* m_read_data; // m_readbuffer or the buffer of m_active
 	u8 m_readbuffer[MaxReadUnit * CD_FRAMESIZE_RAW];
 
+	// Readahead ring, for the readers with queued reads.  A read which continues the
+	// previous one queues the following ReadUnit spans until depth reads are in flight,
+	// any other read discards them (the ones in flight are reaped and dropped).
+	enum ReadaheadState
+	{
+		Readahead_Free,
+		Readahead_InFlight,
+		Readahead_Ready,
+	};
+
+	struct ReadaheadSlot
+	{
+		std::unique_ptr<u8[]> buffer;
+		ReadaheadState state;
+		bool stale;
+		uint lsn;
+		uint count;
+		int result;
+	};
+
+	std::vector<ReadaheadSlot> m_readahead;
+	ReadaheadSlot* m_active;
+	uint m_readahead_next; // first lsn not queued yet
+
+	// Reads served and time spent waiting for them, reported on close
+	u64 m_readahead_reads;
+	u64 m_readahead_hits;
+	u64 m_readahead_waits[5]; // < 0.1ms, < 1ms, < 10ms, < 100ms, more
+
+	static uint s_readahead_depth;
+
 public:
 	InputIsoFile();
 	virtual ~InputIsoFile();
@@ -89,9 +123,18 @@ public:
 	void BeginRead2(uint lsn);
 	int FinishRead3(u8* dest, uint mode);
 
+	// Reads kept in flight ahead of a sequential access (0 disables the readahead), takes
+	// effect when the next image is opened
+	static void SetReadaheadDepth(uint depth);
+
 protected:
 	void _init();
 
+	void BeginQueuedRead(uint lsn);
+	bool QueueSlot(ReadaheadSlot& slot, uint lsn);
+	bool ReapSlot(bool block);
+	void CloseReadahead();
+
 	bool tryIsoType(u32 _size, s32 _offset, s32 _blockofs);
 	void FindParts();
 };
@@ -368,6 +368,15 @@ bool SymbolMap::GetLabelValue(const char* name, u32& dest) {
 	return false;
 }
 
+std::string SymbolMap::GetLabelString(u32 address) const {
+	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	auto it = activeLabels.find(address);
+	if (it == activeLabels.end())
+		return std::string();
+
+	return it->second.name;
+}
+
 void SymbolMap::AddData(u32 address, u32 size, DataType type, int moduleIndex) {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
 
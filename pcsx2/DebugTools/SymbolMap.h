@@ -72,6 +72,7 @@ public:
 
 	void AddLabel(const char* name, u32 address, int moduleIndex = -1);
 	bool GetLabelValue(const char* name, u32& dest);
+	std::string GetLabelString(u32 address) const;
 
 	void AddData(u32 address, u32 size, DataType type, int moduleIndex = -1);
 	u32 GetDataStart(u32 address) const;
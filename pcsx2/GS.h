@@ -19,6 +19,8 @@
 #include "System/SysThreads.h"
 #include "Gif.h"
 
+#include <thread>
+
 extern Fixed100 GetVerticalFrequency(void);
 extern __aligned16 u8 g_RealGSMem[Ps2MemSize::GSregs];
 
@@ -286,6 +288,20 @@ public:
 	uint			m_packet_size;		// size of the packet (data only, ie. not including the 16 byte command!)
 	uint			m_packet_writepos;	// index of the data location in the ringbuffer.
 
+#ifdef __LIBRETRO__
+	bool			m_FlushInThread;	// ExecuteTaskInThread returns once the ring is empty.
+
+	// Threaded mode: the ring is drained on m_RingThread instead of in retro_run.  The work
+	// which needs the graphics context (vsyncs and state changes) is handed back to the
+	// frontend thread, see PresentFrame.
+	std::thread		m_RingThread;
+	std::atomic<bool>	m_RingThreadExit;
+	std::atomic<int>	m_Handoff;
+	int				m_HandoffField;
+	Semaphore		m_sem_Handoff;		// posted by the ring thread when a handoff is waiting
+	Semaphore		m_sem_HandoffDone;	// posted by the frontend thread once it's handled
+#endif
+
 public:
 	SysMtgsThread();
 	virtual ~SysMtgsThread();
@@ -313,6 +329,14 @@ public:
 
 	void ExecuteTaskInThread();
 	void FinishTaskInThread();
+#ifdef __LIBRETRO__
+	void FlushInThread();
+
+	void StartRingThread();
+	void StopRingThread();
+	bool IsThreaded() const { return m_RingThread.joinable(); }
+	void PresentFrame();
+#endif
 	void OpenGS();
 	void CloseGS();
 
@@ -329,6 +353,19 @@ protected:
 
 	// Used internally by SendSimplePacket type functions
 	void _FinishSimplePacket();
+
+#ifdef __LIBRETRO__
+	enum HandoffType
+	{
+		Handoff_None,
+		Handoff_Vsync,
+		Handoff_StateCheck,
+	};
+
+	bool IsRingThread() const { return std::this_thread::get_id() == m_RingThread.get_id(); }
+	bool Handoff(HandoffType type, int field = 0);
+	bool ServiceHandoff();
+#endif
 };
 
 // GetMTGS() is a required external implementation. This function is *NOT* provided
@@ -20,6 +20,8 @@
 #include "yaml-cpp/yaml.h"
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <iterator>
 
 static std::string strToLower(std::string str)
 {
@@ -72,6 +74,26 @@ static std::vector<std::string> convertMultiLineStringToVector(const std::string
 	return lines;
 }
 
+static bool isValidGameFix(const std::string& fix)
+{
+	for (GamefixId id = GamefixId_FIRST; id < pxEnumEnd; id++)
+	{
+		if (wxString(EnumToString(id)).ToStdString() + "Hack" == fix)
+			return true;
+	}
+	return false;
+}
+
+static bool isValidSpeedHack(const std::string& speedHack)
+{
+	for (SpeedhackId id = SpeedhackId_FIRST; id < pxEnumEnd; id++)
+	{
+		if (wxString(EnumToString(id)).ToStdString() + "SpeedHack" == speedHack)
+			return true;
+	}
+	return false;
+}
+
 static GameDatabaseSchema::GameEntry entryFromYaml(const std::string serial, const YAML::Node& node)
 {
 	GameDatabaseSchema::GameEntry gameEntry;
@@ -95,17 +117,7 @@ static GameDatabaseSchema::GameEntry entryFromYaml(const std::string serial, con
 		// Validate game fixes, invalid ones will be dropped!
 		for (std::string& fix : node["gameFixes"].as<std::vector<std::string>>(std::vector<std::string>()))
 		{
-			bool fixValidated = false;
-			for (GamefixId id = GamefixId_FIRST; id < pxEnumEnd; id++)
-			{
-				std::string validFix =wxString(EnumToString(id)).ToStdString() + "Hack";
-				if (validFix == fix)
-				{
-					fixValidated = true;
-					break;
-				}
-			}
-			if (fixValidated)
+			if (isValidGameFix(fix))
 			{
 				gameEntry.gameFixes.push_back(fix);
 			} else
@@ -120,17 +132,7 @@ static GameDatabaseSchema::GameEntry entryFromYaml(const std::string serial, con
 			for (const auto& entry : speedHacksNode)
 			{
 				std::string speedHack = entry.first.as<std::string>();
-				bool speedHackValidated = false;
-				for (SpeedhackId id = SpeedhackId_FIRST; id < pxEnumEnd; id++)
-				{
-					std::string validSpeedHack = wxString(EnumToString(id)).ToStdString() + "SpeedHack";
-					if (validSpeedHack == speedHack)
-					{
-						speedHackValidated = true;
-						break;
-					}
-				}
-				if (speedHackValidated)
+				if (isValidSpeedHack(speedHack))
 				{
 					gameEntry.speedHacks[speedHack] = entry.second.as<int>();
 				} else
@@ -231,3 +233,126 @@ bool YamlGameDatabaseImpl::initDatabase(std::istream& stream)
 
 	return true;
 }
+
+bool BinaryGameDatabaseImpl::initDatabase(std::istream& stream)
+{
+	if (!stream)
+	{
+		log_cb(RETRO_LOG_ERROR, "[GameDB] Unable to open GameDB file.\n");
+		return false;
+	}
+
+	storage.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	return initDatabase(storage.data(), storage.size());
+}
+
+bool BinaryGameDatabaseImpl::initDatabase(const void* data, size_t size)
+{
+	entryCount = 0;
+
+	const GameIndexBinHeader* header = static_cast<const GameIndexBinHeader*>(data);
+	if (size < sizeof(*header) || header->magic != GAMEINDEX_BIN_MAGIC || header->version != GAMEINDEX_BIN_VERSION)
+	{
+		log_cb(RETRO_LOG_ERROR, "[GameDB] Not a binary GameDB (or another version)\n");
+		return false;
+	}
+
+	const u64 expected = sizeof(*header) + (u64)header->entryCount * sizeof(GameIndexBinEntry)
+		+ (u64)header->listCount * sizeof(u32) + header->stringsSize;
+
+	const u8* p = static_cast<const u8*>(data) + sizeof(*header);
+	strings = reinterpret_cast<const char*>(p) + header->entryCount * sizeof(GameIndexBinEntry) + header->listCount * sizeof(u32);
+
+	// every string offset is checked against the size, the last string has to be terminated
+	if (expected != size || header->stringsSize == 0 || strings[header->stringsSize - 1] != 0)
+	{
+		log_cb(RETRO_LOG_ERROR, "[GameDB] Truncated binary GameDB\n");
+		return false;
+	}
+
+	entries = reinterpret_cast<const GameIndexBinEntry*>(p);
+	lists = reinterpret_cast<const u32*>(p + header->entryCount * sizeof(GameIndexBinEntry));
+	listCount = header->listCount;
+	stringsSize = header->stringsSize;
+	entryCount = header->entryCount;
+
+	log_cb(RETRO_LOG_INFO, "[GameDB] %u entries in the binary GameDB\n", entryCount);
+	return true;
+}
+
+std::string BinaryGameDatabaseImpl::getString(u32 offset) const
+{
+	return offset < stringsSize ? std::string(strings + offset) : std::string();
+}
+
+GameDatabaseSchema::GameEntry BinaryGameDatabaseImpl::findGame(const std::string serial)
+{
+	std::string serialLower = strToLower(serial);
+	log_cb(RETRO_LOG_INFO, "[GameDB] Searching for '%s' in GameDB\n", serialLower.c_str());
+
+	const GameIndexBinEntry* end = entries + entryCount;
+	const GameIndexBinEntry* e = std::lower_bound(entries, end, serialLower,
+		[this](const GameIndexBinEntry& entry, const std::string& key) {
+			return entry.serial < stringsSize && strcmp(strings + entry.serial, key.c_str()) < 0;
+		});
+
+	GameDatabaseSchema::GameEntry gameEntry;
+
+	if (e == end || getString(e->serial) != serialLower)
+	{
+		log_cb(RETRO_LOG_ERROR, "[GameDB] Could not find '%s' in GameDB\n", serialLower.c_str());
+		gameEntry.isValid = false;
+		return gameEntry;
+	}
+
+	log_cb(RETRO_LOG_INFO, "[GameDB] Found '%s' in GameDB\n", serialLower.c_str());
+
+	const u64 count = e->gameFixes + e->speedHacks * 2 + e->memcardFilters + e->patches * 3;
+	if ((e->flags & GameIndexBin_Invalid) || e->lists + count > listCount)
+	{
+		gameEntry.isValid = false;
+		return gameEntry;
+	}
+
+	gameEntry.name = getString(e->name);
+	gameEntry.region = getString(e->region);
+	gameEntry.compat = static_cast<GameDatabaseSchema::Compatibility>(e->compat);
+	gameEntry.eeRoundMode = static_cast<GameDatabaseSchema::RoundMode>(e->eeRoundMode);
+	gameEntry.vuRoundMode = static_cast<GameDatabaseSchema::RoundMode>(e->vuRoundMode);
+	gameEntry.eeClampMode = static_cast<GameDatabaseSchema::ClampMode>(e->eeClampMode);
+	gameEntry.vuClampMode = static_cast<GameDatabaseSchema::ClampMode>(e->vuClampMode);
+
+	const u32* list = lists + e->lists;
+
+	// Validated like the yaml entries, invalid ones are dropped
+	for (u32 i = 0; i < e->gameFixes; i++)
+	{
+		std::string fix = getString(*list++);
+		if (isValidGameFix(fix))
+			gameEntry.gameFixes.push_back(fix);
+		else
+			log_cb(RETRO_LOG_ERROR, "[GameDB] Invalid gamefix: '%s', specified for serial: '%s'. Dropping!\n", fix.c_str(), serialLower.c_str());
+	}
+
+	for (u32 i = 0; i < e->speedHacks; i++, list += 2)
+	{
+		std::string speedHack = getString(list[0]);
+		if (isValidSpeedHack(speedHack))
+			gameEntry.speedHacks[speedHack] = (s32)list[1];
+		else
+			log_cb(RETRO_LOG_ERROR, "[GameDB] Invalid speedhack: '%s', specified for serial: '%s'. Dropping!\n", speedHack.c_str(), serialLower.c_str());
+	}
+
+	for (u32 i = 0; i < e->memcardFilters; i++)
+		gameEntry.memcardFilters.push_back(getString(*list++));
+
+	for (u32 i = 0; i < e->patches; i++, list += 3)
+	{
+		GameDatabaseSchema::Patch patchCol;
+		patchCol.author = getString(list[1]);
+		patchCol.patchLines = convertMultiLineStringToVector(getString(list[2]));
+		gameEntry.patches[getString(list[0])] = patchCol;
+	}
+
+	return gameEntry;
+}
@@ -17,6 +17,8 @@
 
 #include "yaml-cpp/yaml.h"
 
+#include "GameIndexBinary.h"
+
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -98,3 +100,24 @@ public:
 private:
 	std::unordered_map<std::string, GameDatabaseSchema::GameEntry> gameDb;
 };
+
+// Reads the table compiled from GameIndex.yaml by tools/gameindex2bin (see GameIndexBinary.h).
+// Nothing is decoded up front, findGame binary searches the serial and decodes that entry only.
+class BinaryGameDatabaseImpl : public IGameDatabase
+{
+public:
+	bool initDatabase(std::istream& stream) override;
+	// The table is used in place, data must outlive the database
+	bool initDatabase(const void* data, size_t size);
+	GameDatabaseSchema::GameEntry findGame(const std::string serial) override;
+private:
+	std::vector<u8> storage;
+	const GameIndexBinEntry* entries = nullptr;
+	const u32* lists = nullptr;
+	const char* strings = nullptr;
+	u32 entryCount = 0;
+	u32 listCount = 0;
+	u32 stringsSize = 0;
+
+	std::string getString(u32 offset) const;
+};
@@ -0,0 +1,77 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Pcsx2Types.h"
+
+/*
+
+Binary GameIndex, compiled from GameIndex.yaml by tools/gameindex2bin and read by
+BinaryGameDatabaseImpl.  Shared by both, so it only depends on the fixed size types.
+
+Layout (little endian):
+- GameIndexBinHeader
+- entries: GameIndexBinEntry[entryCount], sorted by serial (lower case, strcmp order)
+- lists: u32[listCount], the variable parts of the entries, an entry owns
+  gameFixes x [fix], speedHacks x [name, value], memcardFilters x [serial],
+  patches x [crc, author, content] starting at its lists index
+- strings: interned nul terminated strings, referenced by their offset
+
+The values are stored as written in the yaml (but for the lower case serials and crcs),
+the game fixes and speed hacks are validated when an entry is decoded.
+
+*/
+
+#define GAMEINDEX_BIN_MAGIC 0x42444750 // PGDB
+#define GAMEINDEX_BIN_VERSION 1
+
+struct GameIndexBinHeader
+{
+	u32 magic;
+	u32 version;
+	u32 entryCount;
+	u32 listCount;
+	u32 stringsSize;
+};
+
+enum GameIndexBinFlags
+{
+	GameIndexBin_Invalid = 1, // the yaml entry couldn't be read
+};
+
+struct GameIndexBinEntry
+{
+	u32 serial;
+	u32 name;
+	u32 region;
+	u32 lists;
+
+	s8 compat;
+	s8 eeRoundMode;
+	s8 vuRoundMode;
+	s8 eeClampMode;
+	s8 vuClampMode;
+	u8 flags;
+	u16 gameFixes;
+
+	u16 speedHacks;
+	u16 memcardFilters;
+	u16 patches;
+	u16 _padding;
+};
+
+static_assert(sizeof(GameIndexBinHeader) == 20, "GameIndexBinHeader is part of the file format");
+static_assert(sizeof(GameIndexBinEntry) == 32, "GameIndexBinEntry is part of the file format");
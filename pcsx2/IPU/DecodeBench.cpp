@@ -0,0 +1,232 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standalone IPU decoder benchmark.  Replays a trace recorded by the core ("Record IPU Trace"
+// option) once with each IDCT kernel the host supports, checks that every kernel outputs
+// the same quadwords as the C reference, and prints the macroblocks decoded per second.
+//
+// usage: pcsx2_IPUDecodeBench <trace.ipu.gz> [loops]
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+
+#include "IPU.h"
+#include "IPU_Trace.h"
+#include "mpeg2lib/Mpeg.h"
+
+#include <chrono>
+#include <cstdarg>
+
+struct DecodeBenchOutput
+{
+	std::vector<u128> qwords;
+
+	// Output quadwords by command, for the macroblock count
+	u64 idec_rgb32;
+	u64 idec_rgb16;
+	u64 bdec;
+
+	u64 Macroblocks() const
+	{
+		return idec_rgb32 / (sizeof(macroblock_rgb32) / 16) + idec_rgb16 / (sizeof(macroblock_rgb16) / 16) + bdec / (sizeof(macroblock_16) / 16);
+	}
+};
+
+// The core logs through the frontend, retro_init sets it
+static void DecodeBenchLog(enum retro_log_level level, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+// The output FIFO as IPU0 DMA empties it, the decoder carries on when there is room
+static void Drain(DecodeBenchOutput& out)
+{
+	while (ipuRegs.ctrl.OFC > 0)
+	{
+		u128 qw;
+		ipu_fifo.out.read(&qw, 1);
+		out.qwords.push_back(qw);
+
+		if (ipu_cmd.CMD == SCE_IPU_IDEC)
+			(decoder.ofm ? out.idec_rgb16 : out.idec_rgb32)++;
+		else if (ipu_cmd.CMD == SCE_IPU_BDEC)
+			out.bdec++;
+	}
+}
+
+// Runs the command until it's done or waits for input
+static void Pump(DecodeBenchOutput& out)
+{
+	while (true)
+	{
+		Drain(out);
+		IPUProcessInterrupt();
+
+		if (ipuRegs.ctrl.OFC == 0)
+			break;
+	}
+}
+
+static double Replay(const IPUTraceFile& trace, const IPUTraceState& state, DecodeBenchOutput& out, bool& overflow)
+{
+	state.Load();
+
+	// IDEC pauses when IPU0 DMA has nothing left to take, Drain() stands in for it
+	ipu0ch.qwc = 0xffff;
+
+	out.qwords.clear();
+	out.idec_rgb32 = out.idec_rgb16 = out.bdec = 0;
+
+	overflow = false;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	for (const IPUTraceFile::Event& e : trace.m_events)
+	{
+		switch (e.type)
+		{
+			case IPUTraceType::Ctrl:
+				ipuWrite32(IPU_CTRL, e.value);
+				break;
+			case IPUTraceType::Command:
+				ipuWrite32(IPU_CMD, e.value);
+				break;
+			case IPUTraceType::Data:
+				for (u32 i = 0; i < e.value; i++)
+				{
+					// The replay decodes as soon as it can, so the FIFO has room whenever it
+					// had some in the emulator
+					if (ipu_fifo.in.write((u32*)&trace.m_data[e.offset + i], 1) == 0)
+					{
+						Pump(out);
+
+						if (ipu_fifo.in.write((u32*)&trace.m_data[e.offset + i], 1) == 0)
+							overflow = true;
+					}
+				}
+				break;
+		}
+
+		Pump(out);
+	}
+
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <trace.ipu.gz> [loops]\n", argv[0]);
+		return 1;
+	}
+
+	const int loops = argc > 2 ? std::max(atoi(argv[2]), 1) : 5;
+
+	IPUTraceFile trace;
+
+	if (!trace.Load(argv[1]))
+	{
+		fprintf(stderr, "Cannot load %s\n", argv[1]);
+		return 1;
+	}
+
+	if (trace.m_state.size() != sizeof(IPUTraceState))
+	{
+		fprintf(stderr, "The trace was recorded by a different build\n");
+		return 1;
+	}
+
+	log_cb = DecodeBenchLog;
+
+	x86caps.Identify();
+
+	std::unique_ptr<IPUTraceState> state(new IPUTraceState);
+	memcpy(state.get(), trace.m_state.data(), sizeof(IPUTraceState));
+
+	ipuReset();
+
+	std::vector<const mpeg2_idct_kernel*> kernels;
+
+	for (uint i = 0; i < mpeg2_idct_kernel_count; i++)
+	{
+		if (mpeg2_idct_supported(mpeg2_idct_kernels[i]))
+			kernels.push_back(&mpeg2_idct_kernels[i]);
+	}
+
+	std::vector<DecodeBenchOutput> out(kernels.size());
+	std::vector<double> best(kernels.size(), 1e30);
+
+	int failed = 0;
+
+	// first round is a warm-up (and the comparison), as in GSReplay
+
+	for (int i = 0; i <= loops; i++)
+	{
+		for (size_t j = 0; j < kernels.size(); j++)
+		{
+			// the kernels take turns at each position, the replays get slower along a round
+			const size_t k = i > 0 ? (j + i) % kernels.size() : j;
+
+			mpeg2_idct_init(kernels[k]);
+
+			bool overflow;
+			const double t = Replay(trace, *state, out[k], overflow);
+
+			if (i > 0)
+			{
+				best[k] = std::min(best[k], t);
+				continue;
+			}
+
+			if (overflow)
+			{
+				fprintf(stderr, "%s: the input FIFO overflowed, the replay doesn't follow the trace\n", kernels[k]->name);
+				failed++;
+			}
+
+			// kernels[0] is the C reference
+			const auto diff = std::mismatch(out[0].qwords.begin(), out[0].qwords.end(), out[k].qwords.begin(), out[k].qwords.end(),
+				[](const u128& a, const u128& b) { return a.lo == b.lo && a.hi == b.hi; });
+
+			if (diff.first != out[0].qwords.end() || diff.second != out[k].qwords.end())
+			{
+				fprintf(stderr, "%s differs from %s at quadword %d\n", kernels[k]->name, kernels[0]->name, (int)(diff.first - out[0].qwords.begin()));
+				failed++;
+			}
+		}
+	}
+
+	const u64 macroblocks = out[0].Macroblocks();
+
+	printf("%s: %zu events, %zu input quadwords, %zu output quadwords, %llu macroblocks\n",
+		argv[1], trace.m_events.size(), trace.m_data.size(), out[0].qwords.size(), (unsigned long long)macroblocks);
+
+	for (size_t k = 0; k < kernels.size(); k++)
+	{
+		printf("%-8s %8.2f ms %10.0f macroblocks/s %6.2fx\n",
+			kernels[k]->name, best[k] * 1000, best[k] > 0 ? macroblocks / best[k] : 0.0,
+			best[k] > 0 ? best[0] / best[k] : 0.0);
+	}
+
+	printf("%d failed\n", failed);
+
+	return failed ? 1 : 0;
+}
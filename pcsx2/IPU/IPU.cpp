@@ -18,6 +18,8 @@
 
 #include "IPU.h"
 #include "IPUdma.h"
+#include "IPU_Thread.h"
+#include "IPU_Trace.h"
 #include "yuv2rgb.h"
 #include "mpeg2lib/Mpeg.h"
 
@@ -25,10 +27,23 @@
 #include "Gif.h"
 #include "Vif_Dma.h"
 #include <limits.h>
+
 #include "AppConfig.h"
 
 #include "Utilities/MemsetFast.inl"
 
+#if !defined(_M_SSE)
+#if defined(__GNUC__)
+#if defined(__SSE2__)
+#define _M_SSE 0x200
+#endif
+#endif
+
+#if !defined(_M_SSE) && (!defined(_WIN32) || defined(_M_AMD64) || defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _M_SSE 0x200
+#endif
+#endif
+
 // the BP doesn't advance and returns -1 if there is no data to be read
 __aligned16 tIPU_cmd ipu_cmd;
 __aligned16 tIPU_BP g_BP;
@@ -37,8 +52,8 @@ __aligned16 decoder_t decoder;
 void IPUWorker();
 
 // Quantization matrix
-static rgb16_t vqclut[16];			//clut conversion table
-static u8 s_thresh[2];				//thresholds for color conversions
+rgb16_t vqclut[16];			//clut conversion table
+u8 ipu_thresh[2];			//thresholds for color conversions
 int coded_block_pattern = 0;
 
 alignas(16) static u8 indx4[16*16/2];
@@ -63,11 +78,16 @@ __fi void IPUProcessInterrupt(void)
 
 void ipuReset(void)
 {
+	ipu_trace.reset();
+	ipu_thread.Reset();
+
 	memzero(ipuRegs);
 	memzero(g_BP);
 	memzero(decoder);
 
 	decoder.picture_structure = FRAME_PICTURE;      //default: progressive...my guess:P
+	mpeg2_reset_quant_matrix();
+	mpeg2_idct_init();
 
 	ipu_fifo.init();
 	ipu_cmd.clear();
@@ -78,14 +98,28 @@ void SaveStateBase::ipuFreeze()
 {
 	// Get a report of the status of the ipu variables when saving and loading savestates.
 	FreezeTag("IPU");
+
+	// The output FIFO and decoder are completed from the jobs of the IPU thread
+	if (IsSaving())
+		ipu_thread.Flush();
+	else
+	{
+		// A trace can't be replayed across a load
+		ipu_trace.reset();
+		ipu_thread.Reset();
+	}
+
 	Freeze(ipu_fifo);
 
 	Freeze(g_BP);
 	Freeze(vqclut);
-	Freeze(s_thresh);
+	Freeze(ipu_thresh);
 	Freeze(coded_block_pattern);
 	Freeze(decoder);
 	Freeze(ipu_cmd);
+
+	if (IsLoading())
+		mpeg2_reset_quant_matrix();
 }
 
 __fi u32 ipuRead32(u32 mem)
@@ -192,6 +226,17 @@ void ipuSoftReset(void)
 	hwIntcIrq(INTC_IPU); // required for FightBox
 }
 
+static __fi void TraceCommand(u32 value)
+{
+	if (ipu_trace)
+	{
+		if (ipu_trace->IsDone())
+			ipu_trace.reset();
+		else
+			ipu_trace->Command(value);
+	}
+}
+
 __fi bool ipuWrite32(u32 mem, u32 value)
 {
 	// Note: It's assumed that mem's input value is always in the 0x10002000 page
@@ -203,11 +248,15 @@ __fi bool ipuWrite32(u32 mem, u32 value)
 	switch (mem)
 	{
 		ipucase(IPU_CMD): // IPU_CMD
+			TraceCommand(value);
 			IPUCMD_WRITE(value);
 			IPUProcessInterrupt();
 			return false;
 
 		ipucase(IPU_CTRL): // IPU_CTRL
+			if (ipu_trace)
+				ipu_trace->Ctrl(value);
+
             // CTRL = the first 16 bits of ctrl [0x8000ffff], + value for the next 16 bits,
             // minus the reserved bits. (18-19; 27-29) [0x47f30000]
 			ipuRegs.ctrl.write(value);
@@ -233,6 +282,7 @@ __fi bool ipuWrite64(u32 mem, u64 value)
 	switch (mem)
 	{
 		ipucase(IPU_CMD):
+			TraceCommand((u32)value);
 			IPUCMD_WRITE((u32)value);
 			IPUProcessInterrupt();
 		return false;
@@ -387,6 +437,8 @@ static __ri bool ipuFDEC(u32 val)
 
 static bool ipuSETIQ(u32 val)
 {
+	mpeg2_reset_quant_matrix();
+
 	if ((val >> 27) & 1)
 	{
 		u8 (&niq)[64] = decoder.niq;
@@ -424,22 +476,30 @@ static __ri bool ipuCSC(tIPU_CMD_CSC csc)
 {
 	for (;ipu_cmd.index < (int)csc.MBC; ipu_cmd.index++)
 	{
-		for(;ipu_cmd.pos[0] < 48; ipu_cmd.pos[0]++)
+		// The macroblock is converted once, its output can take several calls
+		if (ipu_cmd.pos[0] < 48)
 		{
-			if (!getBits64((u8*)&decoder.mb8 + 8 * ipu_cmd.pos[0], 1)) return false;
+			for(;ipu_cmd.pos[0] < 48; ipu_cmd.pos[0]++)
+			{
+				if (!getBits64((u8*)&decoder.mb8 + 8 * ipu_cmd.pos[0], 1)) return false;
+			}
+
+			if (!ipu_thread.Submit(decoder.mb8, csc.DTE, csc.OFM))
+			{
+				ipu_csc(decoder.mb8, decoder.rgb32, 0, ipu_thresh);
+				if (csc.OFM)
+					ipu_dither(decoder.rgb32, decoder.rgb16, csc.DTE);
+			}
 		}
 
-		ipu_csc(decoder.mb8, decoder.rgb32, 0);
-		
 		if (csc.OFM)
 		{
-			ipu_dither(decoder.rgb32, decoder.rgb16, csc.DTE);
-			ipu_cmd.pos[1] += ipu_fifo.out.write(((u32*) & decoder.rgb16) + 4 * ipu_cmd.pos[1], 32 - ipu_cmd.pos[1]);
+			ipu_cmd.pos[1] += ipu_fifo.out.write((const u32*)ipu_thread.Output((u128*)&decoder.rgb16 + ipu_cmd.pos[1]), 32 - ipu_cmd.pos[1]);
 			if (ipu_cmd.pos[1] < 32) return false;
 		}
 		else
 		{
-			ipu_cmd.pos[1] += ipu_fifo.out.write(((u32*) & decoder.rgb32) + 4 * ipu_cmd.pos[1], 64 - ipu_cmd.pos[1]);
+			ipu_cmd.pos[1] += ipu_fifo.out.write((const u32*)ipu_thread.Output((u128*)&decoder.rgb32 + ipu_cmd.pos[1]), 64 - ipu_cmd.pos[1]);
 			if (ipu_cmd.pos[1] < 64) return false;
 		}
 
@@ -454,22 +514,30 @@ static __ri bool ipuPACK(tIPU_CMD_CSC csc)
 {
 	for (;ipu_cmd.index < (int)csc.MBC; ipu_cmd.index++)
 	{
-		for(;ipu_cmd.pos[0] < (int)sizeof(macroblock_rgb32) / 8; ipu_cmd.pos[0]++)
+		// The macroblock is converted once, its output can take several calls
+		if (ipu_cmd.pos[0] < (int)sizeof(macroblock_rgb32) / 8)
 		{
-			if (!getBits64((u8*)&decoder.rgb32 + 8 * ipu_cmd.pos[0], 1)) return false;
-		}
+			for(;ipu_cmd.pos[0] < (int)sizeof(macroblock_rgb32) / 8; ipu_cmd.pos[0]++)
+			{
+				if (!getBits64((u8*)&decoder.rgb32 + 8 * ipu_cmd.pos[0], 1)) return false;
+			}
 
-		ipu_dither(decoder.rgb32, decoder.rgb16, csc.DTE);
+			if (!ipu_thread.Submit(decoder.rgb32, csc.DTE, csc.OFM))
+			{
+				ipu_dither(decoder.rgb32, decoder.rgb16, csc.DTE);
+				if (!csc.OFM)
+					ipu_vq(decoder.rgb16, indx4, vqclut);
+			}
+		}
 
 		if (csc.OFM)
 		{
-			ipu_cmd.pos[1] += ipu_fifo.out.write(((u32*) & decoder.rgb16) + 4 * ipu_cmd.pos[1], 32 - ipu_cmd.pos[1]);
+			ipu_cmd.pos[1] += ipu_fifo.out.write((const u32*)ipu_thread.Output((u128*)&decoder.rgb16 + ipu_cmd.pos[1]), 32 - ipu_cmd.pos[1]);
 			if (ipu_cmd.pos[1] < 32) return false;
 		}
 		else
 		{
-			ipu_vq(decoder.rgb16, indx4);
-			ipu_cmd.pos[1] += ipu_fifo.out.write(((u32*)indx4) + 4 * ipu_cmd.pos[1], 8 - ipu_cmd.pos[1]);
+			ipu_cmd.pos[1] += ipu_fifo.out.write((const u32*)ipu_thread.OutputIndices(indx4) + 4 * ipu_cmd.pos[1], 8 - ipu_cmd.pos[1]);
 			if (ipu_cmd.pos[1] < 8) return false;
 		}
 
@@ -482,55 +550,140 @@ static __ri bool ipuPACK(tIPU_CMD_CSC csc)
 
 static void ipuSETTH(u32 val)
 {
-	s_thresh[0] = (val & 0x1ff);
-	s_thresh[1] = ((val >> 16) & 0x1ff);
+	ipu_thresh[0] = (val & 0x1ff);
+	ipu_thresh[1] = ((val >> 16) & 0x1ff);
 }
 
 // --------------------------------------------------------------------------------------
 //  CORE Functions (referenced from MPEG library)
 // --------------------------------------------------------------------------------------
-__fi void ipu_csc(macroblock_8& mb8, macroblock_rgb32& rgb32, int sgn)
+__fi void ipu_csc(const macroblock_8& mb8, macroblock_rgb32& rgb32, int sgn, const u8 (&thresh)[2])
 {
+	yuv2rgb(mb8, rgb32);
+
+	if (thresh[0] == 0 && thresh[1] == 0 && !sgn)
+		return;
+
+#if _M_SSE >= 0x200
+	// max(r, g, b) < thresh is the same as the three byte compares of the reference code,
+	// a zero threshold never matches so both cases of the reference code are covered
+	const __m128i t0 = _mm_set1_epi32(thresh[0]);
+	const __m128i t1 = _mm_set1_epi32(thresh[1]);
+	const __m128i rgb_mask = _mm_set1_epi32(0x00ffffff);
+	const __m128i byte_mask = _mm_set1_epi32(0x000000ff);
+	const __m128i alpha_40 = _mm_set1_epi32(0x40000000);
+	const __m128i sign = _mm_set1_epi32(sgn ? 0x808080 : 0);
+
+	__m128i* p = reinterpret_cast<__m128i*>(&rgb32);
+
+	for (int i = 0; i < 16 * 16 / 4; i++)
+	{
+		__m128i c = _mm_load_si128(p + i);
+
+		__m128i m = _mm_max_epu8(c, _mm_max_epu8(_mm_srli_epi32(c, 8), _mm_srli_epi32(c, 16)));
+		m = _mm_and_si128(m, byte_mask);
+
+		const __m128i lt0 = _mm_cmplt_epi32(m, t0);
+		const __m128i lt1 = _mm_andnot_si128(lt0, _mm_cmplt_epi32(m, t1));
+
+		const __m128i c40 = _mm_or_si128(_mm_and_si128(c, rgb_mask), alpha_40);
+		c = _mm_or_si128(_mm_andnot_si128(lt1, c), _mm_and_si128(lt1, c40));
+		c = _mm_andnot_si128(lt0, c);
+
+		_mm_store_si128(p + i, _mm_xor_si128(c, sign));
+	}
+#else
 	int i;
 	u8* p = (u8*)&rgb32;
 
-	yuv2rgb();
-
-	if (s_thresh[0] > 0)
+	if (thresh[0] > 0)
 	{
 		for (i = 0; i < 16*16; i++, p += 4)
 		{
-			if ((p[0] < s_thresh[0]) && (p[1] < s_thresh[0]) && (p[2] < s_thresh[0]))
+			if ((p[0] < thresh[0]) && (p[1] < thresh[0]) && (p[2] < thresh[0]))
 				*(u32*)p = 0;
-			else if ((p[0] < s_thresh[1]) && (p[1] < s_thresh[1]) && (p[2] < s_thresh[1]))
+			else if ((p[0] < thresh[1]) && (p[1] < thresh[1]) && (p[2] < thresh[1]))
 				p[3] = 0x40;
 		}
 	}
-	else if (s_thresh[1] > 0)
+	else if (thresh[1] > 0)
 	{
 		for (i = 0; i < 16*16; i++, p += 4)
 		{
-			if ((p[0] < s_thresh[1]) && (p[1] < s_thresh[1]) && (p[2] < s_thresh[1]))
+			if ((p[0] < thresh[1]) && (p[1] < thresh[1]) && (p[2] < thresh[1]))
 				p[3] = 0x40;
 		}
 	}
 	if (sgn)
 	{
+		// the threshold loops above leave p at the end of the macroblock
+		p = (u8*)&rgb32;
 		for (i = 0; i < 16*16; i++, p += 4)
 			*(u32*)p ^= 0x808080;
 	}
+#endif
 }
 
-__fi void ipu_vq(macroblock_rgb16& rgb16, u8* indx4)
+__fi void ipu_vq(const macroblock_rgb16& rgb16, u8* indx4, const rgb16_t (&clut)[16])
 {
+#if _M_SSE >= 0x200
+	// Distances are at most 3 * 31 * 31 so the search runs on 8 pixels in 16 bits lanes.
+	// Only a strictly smaller distance replaces the index, the lowest one wins on a tie
+	// like in the reference code.
+	__m128i clut_r[16], clut_g[16], clut_b[16];
+
+	for (int k = 0; k < 16; ++k)
+	{
+		clut_r[k] = _mm_set1_epi16(clut[k].r);
+		clut_g[k] = _mm_set1_epi16(clut[k].g);
+		clut_b[k] = _mm_set1_epi16(clut[k].b);
+	}
+
+	const __m128i mask5 = _mm_set1_epi16(0x1f);
+	const __m128i byte_mask = _mm_set1_epi32(0xff);
+
+	for (int i = 0; i < 16; ++i)
+	{
+		__m128i index[2];
+
+		for (int n = 0; n < 2; ++n)
+		{
+			const __m128i c = _mm_load_si128(reinterpret_cast<const __m128i*>(&rgb16.c[i][n * 8]));
+			const __m128i r = _mm_and_si128(c, mask5);
+			const __m128i g = _mm_and_si128(_mm_srli_epi16(c, 5), mask5);
+			const __m128i b = _mm_and_si128(_mm_srli_epi16(c, 10), mask5);
+
+			__m128i min_distance = _mm_set1_epi16(0x7fff);
+			__m128i idx = _mm_setzero_si128();
+
+			for (int k = 0; k < 16; ++k)
+			{
+				const __m128i dr = _mm_sub_epi16(r, clut_r[k]);
+				const __m128i dg = _mm_sub_epi16(g, clut_g[k]);
+				const __m128i db = _mm_sub_epi16(b, clut_b[k]);
+				const __m128i distance = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(dr, dr), _mm_mullo_epi16(dg, dg)), _mm_mullo_epi16(db, db));
+
+				const __m128i closer = _mm_cmplt_epi16(distance, min_distance);
+				min_distance = _mm_min_epi16(min_distance, distance);
+				idx = _mm_or_si128(_mm_andnot_si128(closer, idx), _mm_and_si128(closer, _mm_set1_epi16(k)));
+			}
+
+			// odd pixel in the high nibble
+			index[n] = _mm_and_si128(_mm_or_si128(idx, _mm_srli_epi32(idx, 12)), byte_mask);
+		}
+
+		const __m128i packed = _mm_packs_epi32(index[0], index[1]);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(&indx4[i * 8]), _mm_packus_epi16(packed, packed));
+	}
+#else
 	const auto closest_index = [&](int i, int j) {
 		u8 index = 0;
 		int min_distance = std::numeric_limits<int>::max();
 		for (u8 k = 0; k < 16; ++k)
 		{
-			const int dr = rgb16.c[i][j].r - vqclut[k].r;
-			const int dg = rgb16.c[i][j].g - vqclut[k].g;
-			const int db = rgb16.c[i][j].b - vqclut[k].b;
+			const int dr = rgb16.c[i][j].r - clut[k].r;
+			const int dg = rgb16.c[i][j].g - clut[k].g;
+			const int db = rgb16.c[i][j].b - clut[k].b;
 			const int distance = dr * dr + dg * dg + db * db;
 
 			// XXX: If two distances are the same which index is used?
@@ -547,6 +700,7 @@ __fi void ipu_vq(macroblock_rgb16& rgb16, u8* indx4)
 	for (int i = 0; i < 16; ++i)
 		for (int j = 0; j < 8; ++j)
 			indx4[i * 8 + j] = closest_index(i, 2 * j + 1) << 4 | closest_index(i, 2 * j);
+#endif
 }
 
 
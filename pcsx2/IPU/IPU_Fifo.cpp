@@ -17,6 +17,8 @@
 #include "Common.h"
 #include "IPU.h"
 #include "IPU/IPUdma.h"
+#include "IPU/IPU_Thread.h"
+#include "IPU/IPU_Trace.h"
 #include "mpeg2lib/Mpeg.h"
 
 __aligned16 IPU_Fifo ipu_fifo;
@@ -49,6 +51,7 @@ void IPU_Fifo_Input::clear()
 
 void IPU_Fifo_Output::clear()
 {
+	ipu_thread.Drop();
 	memzero(data);
 	ipuRegs.ctrl.OFC = 0;
 	readpos = 0;
@@ -69,6 +72,9 @@ int IPU_Fifo_Input::write(u32* pMem, int size)
 	g_BP.IFC += firsttrans;
 	transsize = firsttrans;
 
+	if (ipu_trace && firsttrans > 0)
+		ipu_trace->Data(pMem, firsttrans);
+
 	while (transsize-- > 0)
 	{
 		CopyQWC(&data[writepos], pMem);
@@ -118,7 +124,9 @@ int IPU_Fifo_Output::write(const u32 *value, uint size)
 		size -= transsize;
 		while (transsize > 0)
 		{
-			CopyQWC(&data[writepos], value);
+			// Quadwords of a macroblock the IPU thread is still converting are copied on read
+			if (!ipu_thread.Queue(writepos / 4, value))
+				CopyQWC(&data[writepos], value);
 			writepos = (writepos + 4) & 31;
 			value += 4;
 			--transsize;
@@ -140,6 +148,7 @@ void IPU_Fifo_Output::read(void *value, uint size)
 	//__m128 zeroreg = _mm_setzero_ps();
 	while (size > 0)
 	{
+		ipu_thread.Resolve(readpos / 4, &data[readpos]);
 		CopyQWC(value, &data[readpos]);
 		//_mm_store_ps((float*)&data[readpos], zeroreg);
 
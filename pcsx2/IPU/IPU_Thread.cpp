@@ -0,0 +1,399 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+
+#include "IPU.h"
+#include "IPU_Thread.h"
+
+#include "Utilities/MemsetFast.inl"
+
+#include <cstddef>
+
+static_assert(offsetof(decoder_t, mb16) - offsetof(decoder_t, mb8) == offsetof(IPU_Macroblock, mb16), "IPU_Macroblock must match decoder_t");
+static_assert(offsetof(decoder_t, rgb32) - offsetof(decoder_t, mb8) == offsetof(IPU_Macroblock, rgb32), "IPU_Macroblock must match decoder_t");
+static_assert(offsetof(decoder_t, rgb16) - offsetof(decoder_t, mb8) == offsetof(IPU_Macroblock, rgb16), "IPU_Macroblock must match decoder_t");
+
+IPU_Thread ipu_thread;
+
+// --------------------------------------------------------------------------------------
+//  IPU_Job (IPU thread)
+// --------------------------------------------------------------------------------------
+
+void IPU_Job::Convert()
+{
+	u8* base = (u8*)&mb;
+
+	// Blocks missing from the coded block pattern are zero
+	if (type == IPU_JOB_NONE)
+		memzero_sse_a(mb.mb16);
+
+	for (int i = 0; i < block_count; i++)
+	{
+		Block& block = blocks[i];
+
+		if (block.last < 0)
+			mpeg2_idct_copy(block.coeffs, base + block.offset, block.stride);
+		else
+			mpeg2_idct_add(block.last, block.coeffs, (s16*)(base + block.offset), block.stride);
+	}
+
+	switch (type)
+	{
+		case IPU_JOB_CSC:
+			ipu_csc(mb.mb8, mb.rgb32, sgn, thresh);
+			if (ofm)
+				ipu_dither(mb.rgb32, mb.rgb16, dte);
+			break;
+
+		case IPU_JOB_MB16:
+			ipu_mb8_to_mb16(mb.mb8, mb.mb16);
+			break;
+
+		case IPU_JOB_PACK:
+			ipu_dither(mb.rgb32, mb.rgb16, dte);
+			if (!ofm)
+				ipu_vq(mb.rgb16, indx4, clut);
+			break;
+
+		default:
+			break;
+	}
+}
+
+// --------------------------------------------------------------------------------------
+//  IPU_Thread
+// --------------------------------------------------------------------------------------
+
+IPU_Thread::IPU_Thread()
+	: m_submitted(0)
+	, m_done(0)
+	, m_waiting(false)
+	, m_exit(false)
+	, m_wait_for(0)
+	, m_building(nullptr)
+	, m_output(nullptr)
+{
+	memzero(m_pending);
+}
+
+IPU_Thread::~IPU_Thread()
+{
+	Stop();
+}
+
+void IPU_Thread::ExecuteTaskInThread()
+{
+	u64 done = m_done.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		if (done == m_submitted.load(std::memory_order_acquire))
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			// Set before the queue is checked again, Submit only notifies a waiting thread
+			m_waiting = true;
+			m_cv.wait(lock, [&] { return m_exit || done != m_submitted.load(); });
+			m_waiting = false;
+
+			if (done == m_submitted.load(std::memory_order_acquire))
+				return;
+
+			continue;
+		}
+
+		m_ring[done % RingSize].Convert();
+
+		// Sequentially consistent with m_wait_for, see WaitFor
+		m_done.store(++done);
+
+		const u64 wait_for = m_wait_for.load();
+		if (wait_for && done >= wait_for)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_done_cv.notify_one();
+		}
+	}
+}
+
+void IPU_Thread::Open()
+{
+	if (IsOpen())
+		return;
+
+	m_thread = std::thread(&IPU_Thread::ExecuteTaskInThread, this);
+}
+
+void IPU_Thread::Stop()
+{
+	if (!IsOpen())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_exit = true;
+	}
+
+	m_cv.notify_one();
+	m_thread.join();
+	m_exit = false;
+}
+
+// The decoder is left as if every macroblock had been converted inline, the EE thread
+// carries on from it.
+void IPU_Thread::Close()
+{
+	if (!IsOpen())
+		return;
+
+	Flush();
+	m_building = nullptr;
+	m_output = nullptr;
+
+	Stop();
+}
+
+void IPU_Thread::WaitFor(u64 count)
+{
+	// The job is usually about to be done, spin a little before sleeping
+	for (int i = 0; i < WaitSpins; i++)
+	{
+		if (m_done.load(std::memory_order_acquire) >= count)
+			return;
+
+		Threading::SpinWait();
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	// m_wait_for is stored before m_done is checked, and the IPU thread stores m_done before
+	// it checks m_wait_for, so one of them sees the other.  The IPU thread notifies under the
+	// mutex, the wakeup can't be lost between the check and the wait.
+	m_wait_for.store(count);
+	m_done_cv.wait(lock, [&] { return m_done.load() >= count; });
+	m_wait_for.store(0, std::memory_order_relaxed);
+}
+
+void IPU_Thread::WaitIdle()
+{
+	WaitFor(m_submitted.load(std::memory_order_relaxed));
+}
+
+bool IPU_Thread::Begin()
+{
+	if (!IsOpen())
+		return false;
+
+	// A job abandoned by a reset before it was submitted is simply overwritten
+	const u64 seq = m_submitted.load(std::memory_order_relaxed);
+	IPU_Job& job = m_ring[seq % RingSize];
+
+	// Reusing the entry of the job RingSize jobs back, the output FIFO can't hold
+	// quadwords of it anymore but make sure of it.
+	if (seq >= RingSize)
+	{
+		WaitFor(seq - RingSize + 1);
+
+		for (uint i = 0; i < ArraySize(m_pending); i++)
+		{
+			if (m_pending[i].src && m_pending[i].seq + RingSize <= seq)
+				Resolve(i, &ipu_fifo.out.data[i * 4]);
+		}
+	}
+
+	job.seq = seq;
+	job.block_count = 0;
+	m_building = &job;
+
+	return true;
+}
+
+bool IPU_Thread::Defer(s16 (&block)[64], void* dest, int stride, int last)
+{
+	if (!m_building)
+		return false;
+
+	pxAssert(m_building->block_count < (int)ArraySize(m_building->blocks));
+
+	IPU_Job::Block& deferred = m_building->blocks[m_building->block_count++];
+	memcpy(deferred.coeffs, block, sizeof(block));
+	deferred.last = last;
+	deferred.offset = (u8*)dest - (u8*)&decoder.mb8;
+	deferred.stride = stride;
+
+	// Leave the block as the IDCT would, the parser only sets the coded coefficients
+	if (last == 129 && (block[0] & 7) != 4)
+		block[0] = block[63] = 0;
+	else
+		memzero_sse_a(block);
+
+	return true;
+}
+
+bool IPU_Thread::Submit(IPU_JobType type, int sgn, int dte, int ofm)
+{
+	if (!m_building)
+		return false;
+
+	IPU_Job& job = *m_building;
+	job.type = type;
+	job.sgn = sgn;
+	job.dte = dte;
+	job.ofm = ofm;
+
+	switch (type)
+	{
+		case IPU_JOB_CSC:
+			memcpy(job.thresh, ipu_thresh, sizeof(job.thresh));
+			job.output_offset = ofm ? offsetof(IPU_Macroblock, rgb16) : offsetof(IPU_Macroblock, rgb32);
+			job.output_size = ofm ? sizeof(macroblock_rgb16) : sizeof(macroblock_rgb32);
+			break;
+
+		case IPU_JOB_PACK:
+			memcpy(job.clut, vqclut, sizeof(job.clut));
+			// indx4 isn't part of the decoder
+			job.output_offset = offsetof(IPU_Macroblock, rgb16);
+			job.output_size = ofm ? sizeof(macroblock_rgb16) : 0;
+			break;
+
+		default:
+			job.output_offset = offsetof(IPU_Macroblock, mb16);
+			job.output_size = sizeof(macroblock_16);
+			break;
+	}
+
+	m_building = nullptr;
+	m_output = &job;
+
+	m_submitted.store(job.seq + 1);
+	if (m_waiting)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_cv.notify_one();
+	}
+
+	return true;
+}
+
+bool IPU_Thread::Submit(const macroblock_8& mb8, int dte, int ofm)
+{
+	if (!Begin())
+		return false;
+
+	m_building->mb.mb8 = mb8;
+	return Submit(IPU_JOB_CSC, 0, dte, ofm);
+}
+
+bool IPU_Thread::Submit(const macroblock_rgb32& rgb32, int dte, int ofm)
+{
+	if (!Begin())
+		return false;
+
+	m_building->mb.rgb32 = rgb32;
+	return Submit(IPU_JOB_PACK, 0, dte, ofm);
+}
+
+const u128* IPU_Thread::Output(const u128* src) const
+{
+	if (!m_output)
+		return src;
+
+	const uptr offset = (uptr)src - (uptr)&decoder.mb8;
+	pxAssert(offset < sizeof(IPU_Macroblock));
+
+	return (const u128*)((u8*)&m_output->mb + offset);
+}
+
+const u8* IPU_Thread::OutputIndices(const u8* indx4) const
+{
+	return m_output ? m_output->indx4 : indx4;
+}
+
+bool IPU_Thread::Queue(uint slot, const void* src)
+{
+	if (!m_output)
+		return false;
+
+	// The tail of a macroblock started inline comes from the decoder
+	const uptr offset = (uptr)src - (uptr)m_output;
+	if (offset >= sizeof(IPU_Job))
+		return false;
+
+	if (m_done.load(std::memory_order_acquire) > m_output->seq)
+		return false;
+
+	m_pending[slot].seq = m_output->seq;
+	m_pending[slot].src = (const u128*)src;
+	return true;
+}
+
+void IPU_Thread::Resolve(uint slot, void* dst)
+{
+	Pending& pending = m_pending[slot];
+	if (!pending.src)
+		return;
+
+	WaitFor(pending.seq + 1);
+	CopyQWC(dst, pending.src);
+	pending.src = nullptr;
+}
+
+void IPU_Thread::Drop()
+{
+	memzero(m_pending);
+}
+
+void IPU_Thread::Replay(const IPU_Job& job)
+{
+	__aligned16 s16 coeffs[64];
+	u8* base = (u8*)&decoder.mb8;
+
+	for (int i = 0; i < job.block_count; i++)
+	{
+		const IPU_Job::Block& block = job.blocks[i];
+		memcpy(coeffs, block.coeffs, sizeof(coeffs));
+
+		if (block.last < 0)
+			mpeg2_idct_copy(coeffs, base + block.offset, block.stride);
+		else
+			mpeg2_idct_add(block.last, coeffs, (s16*)(base + block.offset), block.stride);
+	}
+}
+
+void IPU_Thread::Flush()
+{
+	WaitIdle();
+
+	for (uint i = 0; i < ArraySize(m_pending); i++)
+		Resolve(i, &ipu_fifo.out.data[i * 4]);
+
+	// The next macroblock is only started once the output of the previous one is in the
+	// FIFO, the blocks parsed so far go to the decoder.  Otherwise what's left of the
+	// output is taken from the decoder after a load.
+	if (m_building)
+		Replay(*m_building);
+	else if (m_output && m_output->output_size)
+		memcpy((u8*)&decoder.mb8 + m_output->output_offset, (u8*)&m_output->mb + m_output->output_offset, m_output->output_size);
+}
+
+void IPU_Thread::Reset()
+{
+	WaitIdle();
+	Drop();
+	m_building = nullptr;
+	m_output = nullptr;
+}
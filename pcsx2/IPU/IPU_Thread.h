@@ -0,0 +1,153 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "IPU.h"
+#include "mpeg2lib/Mpeg.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// --------------------------------------------------------------------------------------
+//  IPU_Thread
+// --------------------------------------------------------------------------------------
+// Optional IPU decode thread.  The EE thread still parses the bitstream, so everything the
+// EE can see (BP, IFC, OFC, TOP, CBP, ECD/SCD and the DMA/interrupt timing) is updated
+// exactly as when decoding inline.  What is left of a macroblock once it's parsed, the
+// IDCT, colour conversion, dithering and VQ, runs on the thread instead: the coefficients
+// are queued in a job, and the output FIFO takes the job's output quadwords before they
+// are computed.  They are filled in when IPU0 DMA (or a FIFO read) drains them, which
+// is the only place the EE thread can wait for the IPU thread.
+//
+// Jobs are created in order by the EE thread and consumed in order by the IPU thread,
+// through a single producer/single consumer ring.
+
+// Same layout as the buffers of decoder_t, so that ipu0_idx addresses both
+struct IPU_Macroblock
+{
+	macroblock_8 mb8;
+	macroblock_16 mb16;
+	macroblock_rgb32 rgb32;
+	macroblock_rgb16 rgb16;
+};
+
+enum IPU_JobType
+{
+	IPU_JOB_CSC,   // IDEC and CSC: colour conversion of mb8, dithered to rgb16 for OFM
+	IPU_JOB_MB16,  // BDEC intra: mb8 widened to mb16
+	IPU_JOB_NONE,  // BDEC non intra: the IDCT output is the macroblock
+	IPU_JOB_PACK,  // PACK: rgb32 dithered to rgb16, and VQ to indx4 without OFM
+};
+
+struct __aligned16 IPU_Job
+{
+	struct Block
+	{
+		__aligned16 s16 coeffs[64];
+		int last;    // -1 for an intra block (copied), the last coefficient for an added one
+		u32 offset;  // of the destination in IPU_Macroblock
+		int stride;
+	};
+
+	IPU_Macroblock mb;
+	__aligned16 u8 indx4[16 * 16 / 2];
+
+	Block blocks[6];
+	int block_count;
+
+	IPU_JobType type;
+	int sgn, dte, ofm;
+	u8 thresh[2];
+	rgb16_t clut[16];
+
+	u64 seq;
+	u32 output_offset, output_size; // of the buffer the output FIFO reads, for Flush
+
+	void Convert();
+};
+
+class IPU_Thread
+{
+	static const uint RingSize = 8; // the output FIFO references two jobs at most
+	static const int WaitSpins = 1000; // before WaitFor sleeps, about the time of a macroblock
+
+	IPU_Job m_ring[RingSize];
+
+	// Only written by the EE thread
+	__aligned(64) std::atomic<u64> m_submitted;
+	// Only written by the IPU thread
+	__aligned(64) std::atomic<u64> m_done;
+
+	std::atomic<bool> m_waiting;
+	std::atomic<bool> m_exit;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	// Job count the EE thread sleeps on in WaitFor (0 when it doesn't)
+	std::atomic<u64> m_wait_for;
+	std::condition_variable m_done_cv;
+	std::thread m_thread;
+
+	IPU_Job* m_building; // job of the macroblock being parsed
+	IPU_Job* m_output;   // job the output FIFO is fed from
+
+	// Output FIFO quadwords that are still to be taken from a job
+	struct Pending
+	{
+		u64 seq;
+		const u128* src;
+	} m_pending[8];
+
+	void ExecuteTaskInThread();
+	void Stop();
+	void WaitFor(u64 count);
+	void WaitIdle();
+	void Replay(const IPU_Job& job);
+
+public:
+	IPU_Thread();
+	~IPU_Thread();
+
+	void Open();
+	void Close();
+	bool IsOpen() const { return m_thread.joinable(); }
+
+	// EE thread, building a macroblock.  Return false when the thread isn't open or the
+	// macroblock was started without it, the caller then converts inline.
+	bool Begin();
+	bool Defer(s16 (&block)[64], void* dest, int stride, int last = -1);
+	bool Submit(IPU_JobType type, int sgn = 0, int dte = 0, int ofm = 0);
+	bool Submit(const macroblock_8& mb8, int dte, int ofm);
+	bool Submit(const macroblock_rgb32& rgb32, int dte, int ofm);
+
+	// Where the output FIFO takes the macroblock from, src points in decoder's buffers
+	const u128* Output(const u128* src) const;
+	const u8* OutputIndices(const u8* indx4) const;
+
+	// Output FIFO hooks
+	bool Queue(uint slot, const void* src);
+	void Resolve(uint slot, void* dst);
+	void Drop();
+
+	// Completes the output FIFO and decoder for a savestate, the thread keeps going
+	void Flush();
+	// Forgets everything in flight (reset, savestate loads)
+	void Reset();
+};
+
+extern IPU_Thread ipu_thread;
@@ -0,0 +1,199 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+
+#include "IPU.h"
+#include "IPU_Thread.h"
+#include "IPU_Trace.h"
+
+std::unique_ptr<IPUTrace> ipu_trace;
+
+s32 IPUstartTrace(const char* filename, u32 commands)
+{
+	// The output FIFO and decoder are completed as for a savestate
+	ipu_thread.Flush();
+
+	ipu_trace.reset(new IPUTrace(filename, commands));
+
+	if (!ipu_trace->IsOpen())
+	{
+		ipu_trace.reset();
+		return -1;
+	}
+
+	return 0;
+}
+
+void IPUTraceState::Save()
+{
+	fifo = ipu_fifo;
+	bp = g_BP;
+	decoder = ::decoder;
+	cmd = ipu_cmd;
+	memcpy(regs, &ipuRegs, sizeof(regs));
+	memcpy(vqclut, ::vqclut, sizeof(vqclut));
+	memcpy(thresh, ipu_thresh, sizeof(thresh));
+	coded_block_pattern = ::coded_block_pattern;
+}
+
+void IPUTraceState::Load() const
+{
+	ipu_thread.Reset();
+
+	ipu_fifo = fifo;
+	g_BP = bp;
+	::decoder = decoder;
+	ipu_cmd = cmd;
+	memcpy(&ipuRegs, regs, sizeof(regs));
+	memcpy(::vqclut, vqclut, sizeof(vqclut));
+	memcpy(ipu_thresh, thresh, sizeof(thresh));
+	::coded_block_pattern = coded_block_pattern;
+
+	mpeg2_reset_quant_matrix();
+}
+
+IPUTrace::IPUTrace(const std::string& fn, u32 commands)
+	: m_commands(commands)
+{
+	// fast compression level, the trace is written while the game runs
+	m_gz = gzopen(fn.c_str(), "wb1");
+
+	if (m_gz == nullptr)
+		return;
+
+	std::unique_ptr<IPUTraceState> state(new IPUTraceState);
+	state->Save();
+
+	const u32 size = sizeof(IPUTraceState);
+
+	Append(&IPUTraceMagic, 4);
+	Append(&size, 4);
+	Append(state.get(), size);
+}
+
+IPUTrace::~IPUTrace()
+{
+	if (m_gz)
+		gzclose(m_gz);
+}
+
+void IPUTrace::Append(const void* data, u32 size)
+{
+	if (m_gz == nullptr || size == 0)
+		return;
+
+	if (gzwrite(m_gz, data, size) != (int)size)
+	{
+		gzclose(m_gz);
+
+		m_gz = nullptr;
+	}
+}
+
+void IPUTrace::Ctrl(u32 value)
+{
+	const IPUTraceType type = IPUTraceType::Ctrl;
+
+	Append(&type, 1);
+	Append(&value, 4);
+}
+
+void IPUTrace::Command(u32 value)
+{
+	const IPUTraceType type = IPUTraceType::Command;
+
+	Append(&type, 1);
+	Append(&value, 4);
+
+	const u32 cmd = value >> 28;
+
+	if ((cmd == SCE_IPU_IDEC || cmd == SCE_IPU_BDEC) && m_commands > 0)
+		m_commands--;
+}
+
+void IPUTrace::Data(const u32* data, u32 size)
+{
+	const IPUTraceType type = IPUTraceType::Data;
+
+	Append(&type, 1);
+	Append(&size, 4);
+	Append(data, size * 16);
+}
+
+//
+
+bool IPUTraceFile::Load(const std::string& fn)
+{
+	gzFile gz = gzopen(fn.c_str(), "rb");
+
+	if (gz == nullptr)
+		return false;
+
+	auto read = [gz](void* dst, u32 size) -> bool {
+		return size == 0 || gzread(gz, dst, size) == (int)size;
+	};
+
+	u32 magic = 0;
+	u32 size = 0;
+
+	bool ok = read(&magic, 4) && magic == IPUTraceMagic && read(&size, 4);
+
+	if (ok)
+	{
+		m_state.resize(size);
+
+		ok = read(m_state.data(), size);
+	}
+
+	u8 type;
+
+	while (ok && gzread(gz, &type, 1) == 1)
+	{
+		Event e = {};
+
+		e.type = (IPUTraceType)type;
+
+		switch (e.type)
+		{
+			case IPUTraceType::Ctrl:
+			case IPUTraceType::Command:
+				ok = read(&e.value, 4);
+				break;
+			case IPUTraceType::Data:
+				ok = read(&e.value, 4);
+				if (ok)
+				{
+					e.offset = m_data.size();
+					m_data.resize(e.offset + e.value);
+					ok = read(&m_data[e.offset], e.value * 16);
+				}
+				break;
+			default:
+				ok = false;
+				break;
+		}
+
+		if (ok)
+			m_events.push_back(e);
+	}
+
+	ok = ok && gzeof(gz);
+
+	gzclose(gz);
+
+	return ok;
+}
@@ -0,0 +1,112 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "IPU.h"
+#include "mpeg2lib/Mpeg.h"
+
+#include <zlib.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+
+IPU trace, a recording of everything the EE gave to the IPU, used to replay the decoder
+outside of the emulator (see DecodeBench.cpp).
+
+Trace file format (gzip compressed):
+- [magic/4] [state size/4] [state data/size] [id/1] [data/?] .. [id/1] [data/?]
+
+The state is an IPUTraceState, so a trace only replays on the build that recorded it.
+
+Ctrl (id == 0), a write to IPU_CTRL
+- [value/4]
+
+Command (id == 1), a write to IPU_CMD
+- [value/4]
+
+Data (id == 2), quadwords taken by the input FIFO (IPU1 DMA or FIFO writes)
+- [size/4] [data/size*16]
+
+*/
+
+enum class IPUTraceType : u8
+{
+	Ctrl,
+	Command,
+	Data,
+};
+
+static const u32 IPUTraceMagic = 0x52545049; // "IPTR"
+
+// What ipuFreeze saves, once the IPU thread is flushed
+struct __aligned16 IPUTraceState
+{
+	IPU_Fifo fifo;
+	tIPU_BP bp;
+	decoder_t decoder;
+	tIPU_cmd cmd;
+	u8 regs[sizeof(IPUregisters)]; // IPUregisters has no default constructor
+	rgb16_t vqclut[16];
+	u8 thresh[2];
+	int coded_block_pattern;
+
+	void Save();
+	void Load() const;
+};
+
+class IPUTrace
+{
+	gzFile m_gz;
+	u32 m_commands; // IDEC and BDEC left to record
+
+	void Append(const void* data, u32 size);
+
+public:
+	IPUTrace(const std::string& fn, u32 commands);
+	~IPUTrace();
+
+	bool IsOpen() const { return m_gz != nullptr; }
+	bool IsDone() const { return m_gz == nullptr || m_commands == 0; }
+
+	void Ctrl(u32 value);
+	void Command(u32 value);
+	void Data(const u32* data, u32 size);
+};
+
+class IPUTraceFile
+{
+public:
+	struct Event
+	{
+		IPUTraceType type;
+		u32 value;     // Ctrl, Command, or the size of Data in quadwords
+		size_t offset; // Data, into m_data
+	};
+
+	std::vector<u8> m_state;
+	std::vector<u128> m_data;
+	std::vector<Event> m_events;
+
+public:
+	bool Load(const std::string& fn);
+};
+
+extern std::unique_ptr<IPUTrace> ipu_trace;
+
+// Records the next 'commands' IDEC and BDEC, and everything in between
+extern s32 IPUstartTrace(const char* filename, u32 commands);
@@ -0,0 +1,333 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks of the IPU decode thread (see IPU_Thread.h) against inline decoding.  Random
+// macroblocks go through the steps of the IDEC, BDEC, CSC and PACK commands, once with the
+// thread closed and once with it open, and out through the output FIFO, which is drained a
+// few quadwords at a time.  Some macroblocks are saved (Flush) or saved and loaded (Flush
+// then Reset) halfway.  Both runs must read the same quadwords and leave the same DCT blocks.
+//
+// usage: pcsx2_IPUThreadTest [macroblocks]
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+
+#include "IPU.h"
+#include "IPU_Thread.h"
+#include "mpeg2lib/Mpeg.h"
+#include "Utilities/MemsetFast.inl"
+
+#include <chrono>
+#include <cstdarg>
+
+enum ThreadTestCommand
+{
+	TEST_IDEC,
+	TEST_BDEC_INTRA,
+	TEST_BDEC,
+	TEST_CSC,
+	TEST_PACK,
+	TEST_COMMAND_COUNT,
+};
+
+static const char* const s_commandNames[TEST_COMMAND_COUNT] = {"IDEC", "BDEC intra", "BDEC", "CSC", "PACK"};
+
+// The inputs of a macroblock are drawn again from its seed for each run
+struct ThreadTestRandom
+{
+	u32 state;
+
+	explicit ThreadTestRandom(u32 seed)
+		: state(seed * 2654435761u + 1)
+	{
+	}
+
+	u32 operator()()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	u32 operator()(u32 n) { return (*this)() % n; }
+};
+
+struct ThreadTestOutput
+{
+	std::vector<u128> qwords;
+	std::vector<size_t> starts; // first quadword of each macroblock
+};
+
+static void ThreadTestLog(enum retro_log_level level, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+static void Drain(ThreadTestOutput& out, uint count)
+{
+	for (count = std::min(count, (uint)ipuRegs.ctrl.OFC); count > 0; count--)
+	{
+		u128 qw;
+		ipu_fifo.out.read(&qw, 1);
+		out.qwords.push_back(qw);
+	}
+}
+
+// The indices of PACK, the core keeps them out of the decoder
+static __aligned16 u8 s_indx4[16 * 16 / 2];
+
+// What a savestate does to the thread, a load restores what the save flushed
+static void SaveState(ThreadTestRandom& rng, bool load)
+{
+	ipu_thread.Flush();
+
+	if (load && rng(2))
+		ipu_thread.Reset();
+}
+
+static void RandomBlock(ThreadTestRandom& rng, s16 (&block)[64], int& last)
+{
+	memzero(block);
+	block[0] = (s16)(rng(2048) - 1024);
+	last = 63;
+
+	// The DC shortcut of mpeg2_idct_add, and the full IDCT it falls back to
+	if (rng(4) == 0)
+	{
+		last = 129;
+		if (rng(2))
+			block[0] = (block[0] & ~7) | 4;
+		return;
+	}
+
+	for (u32 n = rng(12); n > 0; n--)
+		block[rng(64)] = (s16)(rng(512) - 256);
+}
+
+static void Decode(u32 seed, ThreadTestOutput& out)
+{
+	ThreadTestRandom rng(seed);
+
+	const ThreadTestCommand command = (ThreadTestCommand)rng(TEST_COMMAND_COUNT);
+	const int sgn = rng(2), dte = rng(2), ofm = rng(2);
+
+	// Where the macroblock is saved: 0..5 before a block, 6 after the conversion, 7.. during
+	// the output, none most of the time
+	u32 save = rng(8) == 0 ? rng(12) : ~0u;
+
+	// The indices of PACK aren't part of a savestate, they can only be loaded between commands
+	const bool indices = command == TEST_PACK && !ofm;
+
+	out.starts.push_back(out.qwords.size());
+
+	// Output buffer of the decoder (or s_indx4), the thread can swap it for its own
+	const u128* src;
+	uint qwc;
+
+	if (command == TEST_CSC || command == TEST_PACK)
+	{
+		for (uint i = 0; i < sizeof(decoder.rgb32) / 4; i++)
+			((u32*)&decoder.rgb32)[i] = rng();
+		for (uint i = 0; i < sizeof(decoder.mb8) / 4; i++)
+			((u32*)&decoder.mb8)[i] = rng();
+
+		if (command == TEST_CSC)
+		{
+			if (!ipu_thread.Submit(decoder.mb8, dte, ofm))
+			{
+				ipu_csc(decoder.mb8, decoder.rgb32, 0, ipu_thresh);
+				if (ofm)
+					ipu_dither(decoder.rgb32, decoder.rgb16, dte);
+			}
+		}
+		else
+		{
+			if (!ipu_thread.Submit(decoder.rgb32, dte, ofm))
+			{
+				ipu_dither(decoder.rgb32, decoder.rgb16, dte);
+				if (!ofm)
+					ipu_vq(decoder.rgb16, s_indx4, vqclut);
+			}
+		}
+
+		if (indices)
+		{
+			src = (const u128*)s_indx4;
+			qwc = 8;
+		}
+		else
+		{
+			src = ofm ? (u128*)&decoder.rgb16 : (u128*)&decoder.rgb32;
+			qwc = ofm ? 32 : 64;
+		}
+	}
+	else
+	{
+		const bool intra = command != TEST_BDEC;
+		const u32 cbp = intra ? 63 : rng(64);
+
+		// Frame or field DCT
+		const bool field = rng(2);
+		const int offset = field ? 16 : 16 * 8;
+		const int stride = field ? 32 : 16;
+
+		memzero_sse_a(decoder.mb8);
+		if (command == TEST_IDEC)
+			memzero_sse_a(decoder.rgb32);
+		else
+			memzero_sse_a(decoder.mb16);
+
+		ipu_thread.Begin();
+
+		for (int i = 0; i < 6; i++)
+		{
+			if (save == (u32)i)
+				SaveState(rng, true);
+
+			if (!(cbp & (1 << i)))
+				continue;
+
+			int last;
+			RandomBlock(rng, decoder.DCTblock, last);
+
+			if (intra)
+			{
+				u8* const dest[6] = {(u8*)decoder.mb8.Y, (u8*)decoder.mb8.Y + 8, (u8*)decoder.mb8.Y + offset,
+					(u8*)decoder.mb8.Y + offset + 8, (u8*)decoder.mb8.Cb, (u8*)decoder.mb8.Cr};
+
+				if (!ipu_thread.Defer(decoder.DCTblock, dest[i], i < 4 ? stride : 8))
+					mpeg2_idct_copy(decoder.DCTblock, dest[i], i < 4 ? stride : 8);
+			}
+			else
+			{
+				s16* const dest[6] = {(s16*)decoder.mb16.Y, (s16*)decoder.mb16.Y + 8, (s16*)decoder.mb16.Y + offset,
+					(s16*)decoder.mb16.Y + offset + 8, (s16*)decoder.mb16.Cb, (s16*)decoder.mb16.Cr};
+
+				if (!ipu_thread.Defer(decoder.DCTblock, dest[i], i < 4 ? stride : 8, last))
+					mpeg2_idct_add(last, decoder.DCTblock, dest[i], i < 4 ? stride : 8);
+			}
+
+			// The parser only sets the coded coefficients of the next block
+			for (uint k = 0; k < sizeof(decoder.DCTblock) / 16; k++)
+				out.qwords.push_back(((u128*)decoder.DCTblock)[k]);
+		}
+
+		if (command == TEST_IDEC)
+		{
+			const bool deferred = ipu_thread.Submit(IPU_JOB_CSC, sgn, dte, ofm);
+
+			if (!deferred)
+				ipu_csc(decoder.mb8, decoder.rgb32, sgn, ipu_thresh);
+			if (!deferred && ofm)
+				ipu_dither(decoder.rgb32, decoder.rgb16, dte);
+
+			src = ofm ? (u128*)&decoder.rgb16 : (u128*)&decoder.rgb32;
+			qwc = ofm ? 32 : 64;
+		}
+		else
+		{
+			if (!ipu_thread.Submit(intra ? IPU_JOB_MB16 : IPU_JOB_NONE) && intra)
+				ipu_mb8_to_mb16(decoder.mb8, decoder.mb16);
+
+			src = (u128*)&decoder.mb16;
+			qwc = 48;
+		}
+	}
+
+	if (save == 6)
+		SaveState(rng, !indices);
+
+	// The output of the previous macroblock can still be in the FIFO
+	for (uint pos = 0; pos < qwc;)
+	{
+		const u128* const from = indices ? (const u128*)ipu_thread.OutputIndices(s_indx4) : ipu_thread.Output(src);
+		pos += ipu_fifo.out.write((const u32*)(from + pos), qwc - pos);
+
+		if (save >= 7 && pos >= save - 7)
+		{
+			SaveState(rng, !indices);
+			save = ~0u;
+		}
+
+		if (pos < qwc)
+			Drain(out, 1 + rng(8));
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const u32 macroblocks = argc > 1 ? std::max(atoi(argv[1]), 1) : 20000;
+
+	log_cb = ThreadTestLog;
+
+	x86caps.Identify();
+
+	ipuReset();
+
+	ThreadTestRandom rng(0);
+
+	for (u8& thresh : ipu_thresh)
+		thresh = rng(256);
+	for (rgb16_t& color : vqclut)
+		*(u16*)&color = rng(0x8000);
+
+	ThreadTestOutput out[2];
+	double time[2];
+
+	for (int run = 0; run < 2; run++)
+	{
+		if (run)
+			ipu_thread.Open();
+
+		ipuReset();
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		for (u32 i = 0; i < macroblocks; i++)
+			Decode(i, out[run]);
+
+		Drain(out[run], 8);
+		ipu_thread.Flush();
+
+		const auto end = std::chrono::high_resolution_clock::now();
+		time[run] = std::chrono::duration<double>(end - start).count();
+	}
+
+	ipu_thread.Close();
+
+	int failed = 0;
+
+	const auto diff = std::mismatch(out[0].qwords.begin(), out[0].qwords.end(), out[1].qwords.begin(), out[1].qwords.end(),
+		[](const u128& a, const u128& b) { return a.lo == b.lo && a.hi == b.hi; });
+
+	if (diff.first != out[0].qwords.end() || diff.second != out[1].qwords.end() || out[0].starts != out[1].starts)
+	{
+		const size_t qw = diff.first - out[0].qwords.begin();
+		const size_t mb = std::upper_bound(out[0].starts.begin(), out[0].starts.end(), qw) - out[0].starts.begin() - 1;
+		fprintf(stderr, "The thread differs at quadword %zu, macroblock %zu (%s)\n", qw, mb,
+			s_commandNames[ThreadTestRandom((u32)mb)(TEST_COMMAND_COUNT)]);
+		failed++;
+	}
+
+	printf("%u macroblocks, %zu quadwords, inline %.2f ms, thread %.2f ms\n",
+		macroblocks, out[0].qwords.size(), time[0] * 1000, time[1] * 1000);
+	printf("%d failed\n", failed);
+
+	return failed ? 1 : 0;
+}
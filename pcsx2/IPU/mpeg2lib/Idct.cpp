@@ -22,16 +22,24 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
-// [TODO] : There are modern SSE versions of idct (idct_mmx.c) in the mpeg2 libs that we
-// should probably upgrade to.  They use their own raw-style intrinsics and not the intel
-// compiler-integrated ones.
-
 #include "PrecompiledHeader.h"
 
 #include "Common.h"
 #include "IPU/IPU.h"
 #include "Mpeg.h"
 
+#if !defined(_M_SSE)
+#if defined(__GNUC__)
+#if defined(__SSE2__)
+#define _M_SSE 0x200
+#endif
+#endif
+
+#if !defined(_M_SSE) && (!defined(_WIN32) || defined(_M_AMD64) || defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _M_SSE 0x200
+#endif
+#endif
+
 #define W1 2841 /* 2048*sqrt (2)*cos (1*pi/16) */
 #define W2 2676 /* 2048*sqrt (2)*cos (2*pi/16) */
 #define W3 2408 /* 2048*sqrt (2)*cos (3*pi/16) */
@@ -45,9 +53,9 @@
  * to +-3826 - this is the worst case for a column IDCT where the
  * column inputs are 16-bit values.
  */
-static __aligned16 u8 clip_lut[1024];
+static __aligned16 u8 clip_lut[3840 * 2 + 256];
 
-#define CLIP(i) ((clip_lut+384)[(i)])
+#define CLIP(i) ((clip_lut+3840)[(i)])
 
 static __fi void BUTTERFLY(int& t0, int& t1, int w0, int w1, int d0, int d1)
 {
@@ -150,7 +158,8 @@ static __fi void idct_col (s16 * const block)
     block[8*7] = (a0 - b0) >> 17;
 }
 
-__ri void mpeg2_idct_copy(s16 * block, u8 * dest, const int stride)
+// Reference kernel, the SIMD ones are checked bit for bit against it (pcsx2_IPUDecodeBench)
+static void mpeg2_idct_copy_c(s16 * block, u8 * dest, const int stride)
 {
     int i;
 
@@ -159,7 +168,6 @@ __ri void mpeg2_idct_copy(s16 * block, u8 * dest, const int stride)
     for (i = 0; i < 8; i++)
 		idct_col (block + i);
 
-	__m128 zero = _mm_setzero_ps();
     do {
 		dest[0] = CLIP (block[0]);
 		dest[1] = CLIP (block[1]);
@@ -170,19 +178,16 @@ __ri void mpeg2_idct_copy(s16 * block, u8 * dest, const int stride)
 		dest[6] = CLIP (block[6]);
 		dest[7] = CLIP (block[7]);
 
-		_mm_store_ps((float*)block, zero);
+		memset(block, 0, 8 * sizeof(s16));
 
 		dest += stride;
 		block += 8;
     } while (--i);
 }
 
-
 // stride = increment for dest in 16-bit units (typically either 8 [128 bits] or 16 [256 bits]).
-__ri void mpeg2_idct_add (const int last, s16 * block, s16 * dest, const int stride)
+static void mpeg2_idct_add_c(const int last, s16 * block, s16 * dest, const int stride)
 {
-	// on the IPU, stride is always assured to be multiples of QWC (bottom 3 bits are 0).
-
     if (last != 129 || (block[0] & 7) == 4)
     {
 		int i;
@@ -191,29 +196,89 @@ __ri void mpeg2_idct_add (const int last, s16 * block, s16 * dest, const int str
 		for (i = 0; i < 8; i++)
 			idct_col (block + i);
 
-		__m128 zero = _mm_setzero_ps();
 		do {
-			_mm_store_ps((float*)dest, _mm_load_ps((float*)block));
-			_mm_store_ps((float*)block, zero);
+			memcpy(dest, block, 8 * sizeof(s16));
+			memset(block, 0, 8 * sizeof(s16));
 
 			dest += stride;
 			block += 8;
 		} while (--i);
-
     }
     else
     {
 		s16 DC = ((int)block[0] + 4) >> 3;
-		s16 dcf[2] = { DC, DC };
 		block[0] = block[63] = 0;
 
-		__m128 dc128 = _mm_set_ps1(*(float*)dcf);
-
-		for(int i=0; i<8; ++i)
-			_mm_store_ps((float*)(dest+(stride*i)), dc128);
+		for (int i = 0; i < 8; i++, dest += stride)
+			for (int j = 0; j < 8; j++)
+				dest[j] = DC;
     }
 }
 
+#if _M_SSE >= 0x200
+
+#define IDCT_SSE 0x200
+#define IDCT_COPY mpeg2_idct_copy_sse2
+#define IDCT_ADD mpeg2_idct_add_sse2
+#include "Idct.inl"
+
+// IdctSSE4.cpp and IdctAVX2.cpp
+extern void mpeg2_idct_copy_sse41(s16 * block, u8 * dest, int stride);
+extern void mpeg2_idct_add_sse41(int last, s16 * block, s16 * dest, int stride);
+extern void mpeg2_idct_copy_avx2(s16 * block, u8 * dest, int stride);
+extern void mpeg2_idct_add_avx2(int last, s16 * block, s16 * dest, int stride);
+
+const mpeg2_idct_kernel mpeg2_idct_kernels[] =
+{
+	{"C",      0,     mpeg2_idct_copy_c,     mpeg2_idct_add_c},
+	{"SSE2",   0x200, mpeg2_idct_copy_sse2,  mpeg2_idct_add_sse2},
+	{"SSE4.1", 0x401, mpeg2_idct_copy_sse41, mpeg2_idct_add_sse41},
+	{"AVX2",   0x501, mpeg2_idct_copy_avx2,  mpeg2_idct_add_avx2},
+};
+
+void (*mpeg2_idct_copy)(s16 * block, u8 * dest, int stride) = mpeg2_idct_copy_sse2;
+void (*mpeg2_idct_add)(int last, s16 * block, s16 * dest, int stride) = mpeg2_idct_add_sse2;
+
+#else
+
+const mpeg2_idct_kernel mpeg2_idct_kernels[] =
+{
+	{"C", 0, mpeg2_idct_copy_c, mpeg2_idct_add_c},
+};
+
+void (*mpeg2_idct_copy)(s16 * block, u8 * dest, int stride) = mpeg2_idct_copy_c;
+void (*mpeg2_idct_add)(int last, s16 * block, s16 * dest, int stride) = mpeg2_idct_add_c;
+
+#endif
+
+const uint mpeg2_idct_kernel_count = ArraySize(mpeg2_idct_kernels);
+
+bool mpeg2_idct_supported(const mpeg2_idct_kernel& kernel)
+{
+	if (kernel.sse >= 0x501)
+		return x86caps.hasAVX2;
+	if (kernel.sse >= 0x401)
+		return x86caps.hasStreamingSIMD4Extensions;
+
+	return true;
+}
+
+void mpeg2_idct_init(const mpeg2_idct_kernel* kernel)
+{
+	if (!kernel)
+	{
+		// The widest one the host has
+		for (const mpeg2_idct_kernel& k : mpeg2_idct_kernels)
+		{
+			if (mpeg2_idct_supported(k))
+				kernel = &k;
+		}
+	}
+
+	mpeg2_idct_copy = kernel->copy;
+	mpeg2_idct_add = kernel->add;
+}
+
 mpeg2_scan_pack::mpeg2_scan_pack()
 {
 	static const u8 mpeg2_scan_norm[64] = {
@@ -232,8 +297,8 @@ mpeg2_scan_pack::mpeg2_scan_pack()
 		53, 61, 22, 30,  7, 15, 23, 31, 38, 46, 54, 62, 39, 47, 55, 63
 	};
 
-	for (int i = -384; i < 640; i++)
-		clip_lut[i+384] = (i < 0) ? 0 : ((i > 255) ? 255 : i);
+	for (int i = -3840; i < 3840 + 256; i++)
+		clip_lut[i+3840] = (i < 0) ? 0 : ((i > 255) ? 255 : i);
 
 	for (int i = 0; i < 64; i++) {
 		int j = mpeg2_scan_norm[i];
@@ -0,0 +1,282 @@
+/*
+ * Idct.inl
+ * Copyright (C) 2000-2002 Michel Lespinasse <walken@zoy.org>
+ * Copyright (C) 1999-2000 Aaron Holtzman <aholtzma@ess.engr.uvic.ca>
+ * Modified by Florin for PCSX2 emu
+ *
+ * This file is part of mpeg2dec, a free MPEG-2 video stream decoder.
+ * See http://libmpeg2.sourceforge.net/ for updates.
+ *
+ * mpeg2dec is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * mpeg2dec is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+// SIMD IDCT kernel, included once per instruction set (see Idct.cpp):
+//  IDCT_SSE   0x200 (SSE2), 0x401 (SSE4.1) or 0x501 (AVX2), the file must be built for it
+//  IDCT_COPY  name of the mpeg2_idct_copy function
+//  IDCT_ADD   name of the mpeg2_idct_add function
+//
+// The same integer arithmetic as idct_row/idct_col, on the 8 rows (then the 8 columns) at once.
+// BUTTERFLY is a dot product of two 16 bits values, pmaddwd computes it exactly in 32 bits, so
+// the result is bit-exact with the C version (the row shortcut gives the same values too).
+
+// 2048*sqrt (2)*cos (k*pi/16), the W constants of Idct.cpp
+enum
+{
+	IDCT_W1 = 2841,
+	IDCT_W2 = 2676,
+	IDCT_W3 = 2408,
+	IDCT_W5 = 1609,
+	IDCT_W6 = 1108,
+	IDCT_W7 = 565,
+};
+
+// The 32 bits arithmetic of a pass, on 4 lanes (SSE) or 8 lanes (AVX2)
+static __fi __m128i idct_add32(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+static __fi __m128i idct_sub32(__m128i a, __m128i b) { return _mm_sub_epi32(a, b); }
+static __fi __m128i idct_madd(__m128i a, __m128i b) { return _mm_madd_epi16(a, b); }
+template<int i> static __fi __m128i idct_sra(__m128i a) { return _mm_srai_epi32(a, i); }
+template<int i> static __fi __m128i idct_sll(__m128i a) { return _mm_slli_epi32(a, i); }
+
+static __fi __m128i idct_set(__m128i, s32 x) { return _mm_set1_epi32(x); }
+
+static __fi __m128i idct_mul181(__m128i x)
+{
+#if IDCT_SSE >= 0x401
+	return _mm_mullo_epi32(x, _mm_set1_epi32(181));
+#else
+	// 181 = 128 + 32 + 16 + 4 + 1
+	__m128i r = _mm_add_epi32(_mm_slli_epi32(x, 7), _mm_slli_epi32(x, 5));
+	r = _mm_add_epi32(r, _mm_slli_epi32(x, 4));
+	r = _mm_add_epi32(r, _mm_slli_epi32(x, 2));
+	return _mm_add_epi32(r, x);
+#endif
+}
+
+#if IDCT_SSE >= 0x501
+
+static __fi __m256i idct_add32(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+static __fi __m256i idct_sub32(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+static __fi __m256i idct_madd(__m256i a, __m256i b) { return _mm256_madd_epi16(a, b); }
+template<int i> static __fi __m256i idct_sra(__m256i a) { return _mm256_srai_epi32(a, i); }
+template<int i> static __fi __m256i idct_sll(__m256i a) { return _mm256_slli_epi32(a, i); }
+
+static __fi __m256i idct_set(__m256i, s32 x) { return _mm256_set1_epi32(x); }
+static __fi __m256i idct_mul181(__m256i x) { return _mm256_mullo_epi32(x, _mm256_set1_epi32(181)); }
+
+#endif
+
+static __fi s32 idct_pair(s16 a, s16 b)
+{
+	return (u16)a | ((u32)(u16)b << 16);
+}
+
+static __fi void idct_transpose(__m128i (&v)[8])
+{
+	__m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+	__m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+	__m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+	__m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+	__m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+	__m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+	__m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+	__m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+
+	__m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	__m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	__m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	__m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	__m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	__m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	v[0] = _mm_unpacklo_epi64(b0, b4);
+	v[1] = _mm_unpackhi_epi64(b0, b4);
+	v[2] = _mm_unpacklo_epi64(b1, b5);
+	v[3] = _mm_unpackhi_epi64(b1, b5);
+	v[4] = _mm_unpacklo_epi64(b2, b6);
+	v[5] = _mm_unpackhi_epi64(b2, b6);
+	v[6] = _mm_unpacklo_epi64(b3, b7);
+	v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// The lanes of one pass, p[k] holds the interleaved inputs (d0,d2) (d3,d1) (d7,d4) (d5,d6)
+template<bool col, typename V>
+static __fi void idct_pass_lanes(const V (&p)[4], V (&out)[8])
+{
+	const V rnd = idct_set(p[0], col ? 65536 : 128);
+
+	V t0 = idct_add32(idct_madd(p[0], idct_set(p[0], idct_pair(2048, 2048))), rnd);
+	V t1 = idct_add32(idct_madd(p[0], idct_set(p[0], idct_pair(2048, -2048))), rnd);
+	V t2 = idct_madd(p[1], idct_set(p[0], idct_pair(IDCT_W6, IDCT_W2)));
+	V t3 = idct_madd(p[1], idct_set(p[0], idct_pair(-IDCT_W2, IDCT_W6)));
+
+	V a0 = idct_add32(t0, t2);
+	V a1 = idct_add32(t1, t3);
+	V a2 = idct_sub32(t1, t3);
+	V a3 = idct_sub32(t0, t2);
+
+	t0 = idct_madd(p[2], idct_set(p[0], idct_pair(IDCT_W7, IDCT_W1)));
+	t1 = idct_madd(p[2], idct_set(p[0], idct_pair(-IDCT_W1, IDCT_W7)));
+	t2 = idct_madd(p[3], idct_set(p[0], idct_pair(IDCT_W3, IDCT_W5)));
+	t3 = idct_madd(p[3], idct_set(p[0], idct_pair(-IDCT_W5, IDCT_W3)));
+
+	V b0 = idct_add32(t0, t2);
+	V b3 = idct_add32(t1, t3);
+	V b1, b2;
+
+	t0 = idct_sub32(t0, t2);
+	t1 = idct_sub32(t1, t3);
+
+	if (col)
+	{
+		t0 = idct_sra<8>(t0);
+		t1 = idct_sra<8>(t1);
+		b1 = idct_mul181(idct_add32(t0, t1));
+		b2 = idct_mul181(idct_sub32(t0, t1));
+	}
+	else
+	{
+		b1 = idct_sra<8>(idct_mul181(idct_add32(t0, t1)));
+		b2 = idct_sra<8>(idct_mul181(idct_sub32(t0, t1)));
+	}
+
+	out[0] = idct_add32(a0, b0);
+	out[1] = idct_add32(a1, b1);
+	out[2] = idct_add32(a2, b2);
+	out[3] = idct_add32(a3, b3);
+	out[4] = idct_sub32(a3, b3);
+	out[5] = idct_sub32(a2, b2);
+	out[6] = idct_sub32(a1, b1);
+	out[7] = idct_sub32(a0, b0);
+
+	for (int i = 0; i < 8; i++)
+	{
+		// The C code stores the int in a s16, keep the low bits instead of saturating.
+		// The column results always fit.
+		out[i] = col ? idct_sra<17>(out[i]) : idct_sra<16>(idct_sll<8>(out[i]));
+	}
+}
+
+// v[k] holds the input k of the 8 rows (columns), it receives the output k
+template<bool col>
+static __fi void idct_pass(__m128i (&v)[8])
+{
+	__m128i lo[4], hi[4];
+
+	lo[0] = _mm_unpacklo_epi16(v[0], v[2]); hi[0] = _mm_unpackhi_epi16(v[0], v[2]);
+	lo[1] = _mm_unpacklo_epi16(v[3], v[1]); hi[1] = _mm_unpackhi_epi16(v[3], v[1]);
+	lo[2] = _mm_unpacklo_epi16(v[7], v[4]); hi[2] = _mm_unpackhi_epi16(v[7], v[4]);
+	lo[3] = _mm_unpacklo_epi16(v[5], v[6]); hi[3] = _mm_unpackhi_epi16(v[5], v[6]);
+
+#if IDCT_SSE >= 0x501
+	// Both halves at once, the low lane holds the first 4 rows (columns)
+	__m256i p[4], r[8];
+
+	for (int i = 0; i < 4; i++)
+		p[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo[i]), hi[i], 1);
+
+	idct_pass_lanes<col>(p, r);
+
+	for (int i = 0; i < 8; i++)
+		v[i] = _mm_packs_epi32(_mm256_castsi256_si128(r[i]), _mm256_extracti128_si256(r[i], 1));
+#else
+	__m128i rlo[8], rhi[8];
+
+	idct_pass_lanes<col>(lo, rlo);
+	idct_pass_lanes<col>(hi, rhi);
+
+	for (int i = 0; i < 8; i++)
+		v[i] = _mm_packs_epi32(rlo[i], rhi[i]);
+#endif
+}
+
+static __fi void idct_simd(const s16* block, __m128i (&v)[8])
+{
+	for (int i = 0; i < 8; i++)
+		v[i] = _mm_load_si128((const __m128i*)block + i);
+
+	__m128i ac = _mm_insert_epi16(v[0], 0, 0);
+
+	for (int i = 1; i < 8; i++)
+		ac = _mm_or_si128(ac, v[i]);
+
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(ac, _mm_setzero_si128())) == 0xffff)
+	{
+		// Only the DC coefficient, the passes are slower than the C row shortcut there. Every
+		// row gets the shortcut, then each column is ((d0 << 11) + 65536) >> 17.
+		const s16 d0 = (s16)(block[0] << 3);
+		const __m128i dc = _mm_set1_epi16((d0 + 32) >> 6);
+
+		for (int i = 0; i < 8; i++)
+			v[i] = dc;
+
+		return;
+	}
+
+	idct_transpose(v);
+	idct_pass<false>(v);
+	idct_transpose(v);
+	idct_pass<true>(v);
+}
+
+void IDCT_COPY(s16* block, u8* dest, const int stride)
+{
+	__m128i v[8];
+
+	idct_simd(block, v);
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int i = 0; i < 8; i++)
+	{
+		// Same as CLIP, the column results are within its -3840..+4095 range
+		_mm_storel_epi64((__m128i*)dest, _mm_packus_epi16(v[i], v[i]));
+		_mm_store_si128((__m128i*)block + i, zero);
+
+		dest += stride;
+	}
+}
+
+// stride = increment for dest in 16-bit units (typically either 8 [128 bits] or 16 [256 bits]).
+void IDCT_ADD(const int last, s16* block, s16* dest, const int stride)
+{
+	// on the IPU, stride is always assured to be multiples of QWC (bottom 3 bits are 0).
+
+	if (last != 129 || (block[0] & 7) == 4)
+	{
+		__m128i v[8];
+
+		idct_simd(block, v);
+
+		const __m128i zero = _mm_setzero_si128();
+
+		for (int i = 0; i < 8; i++)
+		{
+			_mm_store_si128((__m128i*)dest, v[i]);
+			_mm_store_si128((__m128i*)block + i, zero);
+
+			dest += stride;
+		}
+	}
+	else
+	{
+		const __m128i dc = _mm_set1_epi16(((int)block[0] + 4) >> 3);
+		block[0] = block[63] = 0;
+
+		for (int i = 0; i < 8; i++)
+			_mm_store_si128((__m128i*)(dest + stride * i), dc);
+	}
+}
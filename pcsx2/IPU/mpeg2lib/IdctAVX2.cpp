@@ -0,0 +1,25 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// AVX2 IDCT kernel, only used when x86caps has it (see mpeg2_idct_init).  The file is built
+// with AVX2 enabled, so it doesn't include the core headers: an inline function of them
+// compiled here could be the copy the linker keeps.
+
+#include "Pcsx2Defs.h"
+
+#define IDCT_SSE 0x501
+#define IDCT_COPY mpeg2_idct_copy_avx2
+#define IDCT_ADD mpeg2_idct_add_avx2
+#include "Idct.inl"
@@ -191,8 +191,27 @@ extern int bitstream_init ();
 extern u32 UBITS(uint bits);
 extern s32 SBITS(uint bits);
 
-extern void mpeg2_idct_copy(s16 * block, u8* dest, int stride);
-extern void mpeg2_idct_add(int last, s16 * block, s16* dest, int stride);
+// IDCT kernels, from the reference C code to the widest SIMD one.  They give the same results
+// bit for bit, mpeg2_idct_init points mpeg2_idct_copy/add to the widest one the host supports
+// (or to the one given).
+struct mpeg2_idct_kernel
+{
+	const char* name;
+	int sse; // _M_SSE level it needs
+	void (*copy)(s16 * block, u8* dest, int stride);
+	void (*add)(int last, s16 * block, s16* dest, int stride);
+};
+
+extern const mpeg2_idct_kernel mpeg2_idct_kernels[];
+extern const uint mpeg2_idct_kernel_count;
+
+extern bool mpeg2_idct_supported(const mpeg2_idct_kernel& kernel);
+extern void mpeg2_idct_init(const mpeg2_idct_kernel* kernel = nullptr);
+
+extern void (*mpeg2_idct_copy)(s16 * block, u8* dest, int stride);
+extern void (*mpeg2_idct_add)(int last, s16 * block, s16* dest, int stride);
+
+extern void mpeg2_reset_quant_matrix();
 
 extern bool mpeg2sliceIDEC();
 extern bool mpeg2_slice();
@@ -202,9 +221,10 @@ extern int get_macroblock_modes();
 extern int get_motion_delta(const int f_code);
 extern int get_dmv();
 
-extern void ipu_csc(macroblock_8& mb8, macroblock_rgb32& rgb32, int sgn);
+extern void ipu_csc(const macroblock_8& mb8, macroblock_rgb32& rgb32, int sgn, const u8 (&thresh)[2]);
 extern void ipu_dither(const macroblock_rgb32& rgb32, macroblock_rgb16& rgb16, int dte);
-extern void ipu_vq(macroblock_rgb16& rgb16, u8* indx4);
+extern void ipu_vq(const macroblock_rgb16& rgb16, u8* indx4, const rgb16_t (&clut)[16]);
+extern void ipu_mb8_to_mb16(const macroblock_8& mb8, macroblock_16& mb16);
 
 extern int slice (u8 * buffer);
 
@@ -223,3 +243,7 @@ extern const int non_linear_quantizer_scale[];
 extern __aligned16 tIPU_BP g_BP;
 extern __aligned16 decoder_t decoder;
 
+// SETTH and SETVQ tables
+extern u8 ipu_thresh[2];
+extern rgb16_t vqclut[16];
+
@@ -48,7 +48,7 @@
 #endif
 #endif
 
-__ri void yuv2rgb()
+__ri void yuv2rgb(const macroblock_8& mb8, macroblock_rgb32& rgb32)
 {
 #if _M_SSE >= 0x200
 	// Suikoden Tactics FMV speed results: Reference - ~72fps, SSE2 - ~120fps
@@ -74,8 +74,8 @@ __ri void yuv2rgb()
 	for (int n = 0; n < 8; ++n) {
 		// could skip the loadl_epi64 but most SSE instructions require 128-bit
 		// alignment so two versions would be needed.
-		__m128i cb = _mm_loadl_epi64(reinterpret_cast<__m128i*>(&decoder.mb8.Cb[n][0]));
-		__m128i cr = _mm_loadl_epi64(reinterpret_cast<__m128i*>(&decoder.mb8.Cr[n][0]));
+		__m128i cb = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&mb8.Cb[n][0]));
+		__m128i cr = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&mb8.Cr[n][0]));
 
 		// (Cb - 128) << 8, (Cr - 128) << 8
 		cb = _mm_xor_si128(cb, c_bias);
@@ -88,7 +88,7 @@ __ri void yuv2rgb()
 		__m128i bc = _mm_mulhi_epi16(cb, bcb_coefficient);
 
 		for (int m = 0; m < 2; ++m) {
-			__m128i y = _mm_load_si128(reinterpret_cast<__m128i*>(&decoder.mb8.Y[n * 2 + m][0]));
+			__m128i y = _mm_load_si128(reinterpret_cast<const __m128i*>(&mb8.Y[n * 2 + m][0]));
 			y = _mm_subs_epu8(y, y_bias);
 			// Y << 8 for pixels 0, 2, 4, 6, 8, 10, 12, 14
 			__m128i y_even = _mm_slli_epi16(y, 8);
@@ -133,17 +133,14 @@ __ri void yuv2rgb()
 			__m128i rgba_hl = _mm_unpacklo_epi16(rg_h, ba_h);
 			__m128i rgba_hh = _mm_unpackhi_epi16(rg_h, ba_h);
 
-			_mm_store_si128(reinterpret_cast<__m128i*>(&decoder.rgb32.c[n * 2 + m][0]), rgba_ll);
-			_mm_store_si128(reinterpret_cast<__m128i*>(&decoder.rgb32.c[n * 2 + m][4]), rgba_lh);
-			_mm_store_si128(reinterpret_cast<__m128i*>(&decoder.rgb32.c[n * 2 + m][8]), rgba_hl);
-			_mm_store_si128(reinterpret_cast<__m128i*>(&decoder.rgb32.c[n * 2 + m][12]), rgba_hh);
+			_mm_store_si128(reinterpret_cast<__m128i*>(&rgb32.c[n * 2 + m][0]), rgba_ll);
+			_mm_store_si128(reinterpret_cast<__m128i*>(&rgb32.c[n * 2 + m][4]), rgba_lh);
+			_mm_store_si128(reinterpret_cast<__m128i*>(&rgb32.c[n * 2 + m][8]), rgba_hl);
+			_mm_store_si128(reinterpret_cast<__m128i*>(&rgb32.c[n * 2 + m][12]), rgba_hh);
 		}
 	}
 #else
 	// conforming implementation for reference, do not optimise
-	const macroblock_8& mb8 = decoder.mb8;
-	macroblock_rgb32& rgb32 = decoder.rgb32;
-
 	for (int y = 0; y < 16; y++)
 		for (int x = 0; x < 16; x++)
 		{
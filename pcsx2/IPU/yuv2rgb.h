@@ -15,4 +15,7 @@
 
 #pragma once
 
-extern void yuv2rgb();
+struct macroblock_8;
+struct macroblock_rgb32;
+
+extern void yuv2rgb(const macroblock_8& mb8, macroblock_rgb32& rgb32);
@@ -21,6 +21,7 @@ FlatFileReader::FlatFileReader(bool shareWrite) : shareWrite(shareWrite)
 	m_blocksize = 2048;
 	m_fd = -1;
 	m_aio_context = 0;
+	m_queue_context = 0;
 }
 
 FlatFileReader::~FlatFileReader(void)
@@ -82,15 +83,80 @@ void FlatFileReader::CancelRead(void)
 	//                struct io_event *result);
 }
 
+uint FlatFileReader::SetQueueDepth(uint depth)
+{
+	if (m_queue_context)
+	{
+		io_destroy(m_queue_context);
+		m_queue_context = 0;
+	}
+	m_queue_iocbs.clear();
+
+	if (depth == 0 || io_setup(depth, &m_queue_context))
+	{
+		m_queue_context = 0;
+		return 0;
+	}
+
+	m_queue_iocbs.resize(depth);
+	for (struct iocb& iocb : m_queue_iocbs)
+		iocb.data = NULL;
+
+	return depth;
+}
+
+bool FlatFileReader::QueueRead(void* pBuffer, uint sector, uint count)
+{
+	for (struct iocb& iocb : m_queue_iocbs)
+	{
+		if (iocb.data)
+			continue;
+
+		u64 offset = sector * (s64)m_blocksize + m_dataoffset;
+		struct iocb* iocbs = &iocb;
+
+		io_prep_pread(&iocb, m_fd, pBuffer, count * m_blocksize, offset);
+		iocb.data = pBuffer;
+
+		if (io_submit(m_queue_context, 1, &iocbs) != 1)
+		{
+			iocb.data = NULL;
+			return false;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void* FlatFileReader::ReapQueuedRead(bool block, int& result)
+{
+	struct io_event event;
+
+	if (!m_queue_context || io_getevents(m_queue_context, block ? 1 : 0, 1, &event, NULL) < 1)
+		return NULL;
+
+	void* buffer = event.data;
+	event.obj->data = NULL;
+	result = (int)(long)event.res;
+
+	return buffer;
+}
+
 void FlatFileReader::Close(void)
 {
 
 	if (m_fd != -1) close(m_fd);
 
 	io_destroy(m_aio_context);
+	if (m_queue_context)
+		io_destroy(m_queue_context);
 
 	m_fd = -1;
 	m_aio_context = 0;
+	m_queue_context = 0;
+	m_queue_iocbs.clear();
 }
 
 uint FlatFileReader::GetBlockCount(void) const
@@ -63,6 +63,13 @@ void SysMtgsThread::OnStart()
 
 	m_CopyDataTally		= 0;
 
+#ifdef __LIBRETRO__
+	m_FlushInThread		= false;
+	m_RingThreadExit	= false;
+	m_Handoff			= Handoff_None;
+	m_HandoffField		= 0;
+#endif
+
 	_parent::OnStart();
 }
 
@@ -222,7 +229,8 @@ class RingBufferLock {
 void SysMtgsThread::ExecuteTaskInThread()
 {
 #ifdef __LIBRETRO__
-	pxAssert(IsSelf());
+	const bool threaded = IsRingThread();
+	pxAssert(IsSelf() || threaded);
 #endif
 
 	// Threading info: run in MTGS thread
@@ -238,13 +246,24 @@ void SysMtgsThread::ExecuteTaskInThread()
 		busy.Release();
 #endif
 #ifdef __LIBRETRO__
-		while (wxTheApp->HasPendingEvents())
-			wxTheApp->ProcessPendingEvents();
-
-		while (!m_sem_event.WaitWithoutYield(wxTimeSpan::Millisecond()))
+		if (threaded)
+		{
+			while (!m_sem_event.WaitWithoutYield(wxTimeSpan::Millisecond()))
+			{
+				if (m_RingThreadExit.load(std::memory_order_acquire))
+					return;
+			}
+		}
+		else
 		{
 			while (wxTheApp->HasPendingEvents())
 				wxTheApp->ProcessPendingEvents();
+
+			while (!m_sem_event.WaitWithoutYield(wxTimeSpan::Millisecond()))
+			{
+				while (wxTheApp->HasPendingEvents())
+					wxTheApp->ProcessPendingEvents();
+			}
 		}
 #else
 		// Performance note: Both of these perform cancellation tests, but pthread_testcancel
@@ -252,6 +271,15 @@ void SysMtgsThread::ExecuteTaskInThread()
 		// to avoid it.
 
 		m_sem_event.WaitWithoutYield();
+#endif
+#ifdef __LIBRETRO__
+		// Opening and closing the GS needs the graphics context
+		if (threaded)
+		{
+			if (m_ExecMode != ExecMode_Opened && !Handoff(Handoff_StateCheck))
+				return;
+		}
+		else
 #endif
 		StateCheckInThread();
 #ifndef __LIBRETRO__
@@ -323,8 +351,20 @@ void SysMtgsThread::ExecuteTaskInThread()
 								((GSRegSIGBLID&)RingBuffer.Regs[0x1080])	= (GSRegSIGBLID&)remainder[2];
 
 								// CSR & 0x2000; is the pageflip id.
-								GSvsync(((u32&)RingBuffer.Regs[0x1000]) & 0x2000);
-								gsFrameSkip();
+#ifdef __LIBRETRO__
+								if (threaded)
+								{
+									// the packet is consumed once the frame was presented, so the
+									// EEcore can't run further ahead than its queued frame budget
+									if (!Handoff(Handoff_Vsync, ((u32&)RingBuffer.Regs[0x1000]) & 0x2000))
+										return;
+								}
+								else
+#endif
+								{
+									GSvsync(((u32&)RingBuffer.Regs[0x1000]) & 0x2000);
+									gsFrameSkip();
+								}
 
 								m_QueuedFrameCount.fetch_sub(1);
 								if (m_VsyncSignalListener.exchange(false))
@@ -397,7 +437,7 @@ void SysMtgsThread::ExecuteTaskInThread()
 				}
 			}
 #ifdef __LIBRETRO__
-			if(tag.command == GS_RINGTYPE_VSYNC)
+			if(tag.command == GS_RINGTYPE_VSYNC && !threaded)
 			{
 #ifndef __LIBRETRO__
 				busy.Release();
@@ -431,10 +471,143 @@ void SysMtgsThread::ExecuteTaskInThread()
 		if (m_VsyncSignalListener.exchange(false))
 			m_sem_Vsync.Post();
 
+#ifdef __LIBRETRO__
+		if (m_FlushInThread)
+			return;
+#endif
+
 		//log_cb(RETRO_LOG_WARN, "(MTGS Thread) Nothing to do!  ringpos=0x%06x\n", m_ReadPos );
 	}
 }
 
+#ifdef __LIBRETRO__
+// Processes everything queued in the ring (including any pending vsyncs) and synchronizes
+// the MTGS register copy.  The EEcore must be paused, or the ring could never be emptied.
+void SysMtgsThread::FlushInThread()
+{
+	pxAssert(IsSelf());
+
+	if (IsThreaded())
+	{
+		// the ring thread drains it, this thread presents the vsyncs on its way.  One wake is
+		// enough, the ring thread only goes back to sleep once the ring is empty.
+		m_sem_event.Post();
+		while (m_ReadPos.load(std::memory_order_acquire) != m_WritePos.load(std::memory_order_acquire))
+		{
+			if (m_sem_Handoff.WaitWithoutYield(wxTimeSpan::Millisecond()))
+				ServiceHandoff();
+		}
+
+		memcpy(RingBuffer.Regs, PS2MEM_GS, sizeof(RingBuffer.Regs));
+		return;
+	}
+
+	m_FlushInThread = true;
+	while (m_ReadPos.load(std::memory_order_relaxed) != m_WritePos.load(std::memory_order_acquire))
+	{
+		m_sem_event.Post();
+		ExecuteTaskInThread();
+	}
+	m_FlushInThread = false;
+
+	memcpy(RingBuffer.Regs, PS2MEM_GS, sizeof(RingBuffer.Regs));
+}
+
+// Drains the ring on a dedicated thread, so that retro_run only waits for the next frame
+// instead of processing all of its GS packets.  Only for renderers which don't need the
+// graphics context outside of GSvsync, see GSpacketsOffDeviceThread.
+void SysMtgsThread::StartRingThread()
+{
+	pxAssert(IsSelf());
+
+	if (IsThreaded())
+		return;
+
+	m_RingThreadExit = false;
+	m_Handoff = Handoff_None;
+	m_sem_Handoff.Reset();
+	m_sem_HandoffDone.Reset();
+	m_RingThread = std::thread([this] {
+		while (!m_RingThreadExit.load(std::memory_order_acquire))
+			ExecuteTaskInThread();
+	});
+
+	// the ring may already hold work which was posted for the frontend thread
+	m_sem_event.Post();
+}
+
+// Stops the ring thread, whatever is left in the ring is processed once it's restarted (or
+// by retro_run when it isn't).
+void SysMtgsThread::StopRingThread()
+{
+	if (!IsThreaded())
+		return;
+
+	m_RingThreadExit.store(true, std::memory_order_release);
+	m_sem_event.Post();
+	m_RingThread.join();
+	m_RingThread = std::thread();
+	m_RingThreadExit = false;
+	m_Handoff = Handoff_None;
+}
+
+// Ring thread: waits until the frontend thread did the work, false if the thread is stopping.
+bool SysMtgsThread::Handoff(HandoffType type, int field)
+{
+	m_HandoffField = field;
+	m_Handoff.store(type, std::memory_order_release);
+	m_sem_Handoff.Post();
+
+	while (!m_sem_HandoffDone.WaitWithoutYield(wxTimeSpan::Millisecond()))
+	{
+		if (m_RingThreadExit.load(std::memory_order_acquire))
+			return false;
+	}
+
+	return true;
+}
+
+// Frontend thread: does the work the ring thread is waiting on, true if it presented a frame.
+bool SysMtgsThread::ServiceHandoff()
+{
+	const int type = m_Handoff.exchange(Handoff_None, std::memory_order_acq_rel);
+
+	switch (type)
+	{
+		case Handoff_Vsync:
+			GSvsync(m_HandoffField);
+			gsFrameSkip();
+			break;
+
+		case Handoff_StateCheck:
+			StateCheckInThread();
+			break;
+
+		default:
+			return false;
+	}
+
+	m_sem_HandoffDone.Post();
+	return type == Handoff_Vsync;
+}
+
+// Threaded counterpart of ExecuteTaskInThread for retro_run: blocks until the ring thread
+// reaches the next vsync and presents it.
+void SysMtgsThread::PresentFrame()
+{
+	pxAssert(IsSelf() && IsThreaded());
+
+	while (true)
+	{
+		while (wxTheApp->HasPendingEvents())
+			wxTheApp->ProcessPendingEvents();
+
+		if (m_sem_Handoff.WaitWithoutYield(wxTimeSpan::Millisecond()) && ServiceHandoff())
+			return;
+	}
+}
+#endif
+
 void SysMtgsThread::FinishTaskInThread()
 {
 	if( m_SignalRingEnable.exchange(false) )
@@ -725,6 +725,7 @@ void eeMemoryReserve::Reset()
 
 void eeMemoryReserve::Decommit()
 {
+	vtlb_FastmemShutdown();
 	_parent::Decommit();
 	eeMem = NULL;
 }
@@ -814,6 +815,7 @@ void mmap_MarkCountedRamPage( u32 paddr )
 
 	m_PageProtectInfo[rampage].Mode = ProtMode_Write;
 	HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadOnly() );
+	vtlb_FastmemProtectRamPage( rampage, false );
 }
 
 // offset - offset of address relative to psM.
@@ -823,12 +825,35 @@ static __fi void mmap_ClearCpuBlock( uint offset )
 {
 	int rampage = offset >> 12;
 	HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadWrite() );
+	vtlb_FastmemProtectRamPage( rampage, true );
 	m_PageProtectInfo[rampage].Mode = ProtMode_Manual;
 	Cpu->Clear( m_PageProtectInfo[rampage].ReverseRamMap, 0x400 );
 }
 
 void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& handled )
 {
+	u32 vaddr;
+	if( vtlb_FastmemGetVAddr( info.addr, vaddr ) )
+	{
+		// A write through an alias of a protected ram page is a self-modifying code write
+		// like a direct one.  Any other fault is an access the mirror can't serve, the
+		// recompiled access is sent to the vtlb lookup for good.
+		auto vmv = vtlb_private::vtlbdata.vmap[vaddr >> 12];
+		if( eeMem && !vmv.isHandler(vaddr) )
+		{
+			uptr offset = vmv.assumePtr(vaddr) - (uptr)eeMem->Main;
+			if( offset < Ps2MemSize::MainRam && m_PageProtectInfo[offset >> 12].Mode == ProtMode_Write )
+			{
+				mmap_ClearCpuBlock( offset );
+				handled = true;
+				return;
+			}
+		}
+
+		handled = vtlb_DynBackpatchFastmem( info.pc );
+		return;
+	}
+
 	// get bad virtual address
 	uptr offset = info.addr - (uptr)eeMem->Main;
 	if( offset >= Ps2MemSize::MainRam ) return;
@@ -845,4 +870,5 @@ void mmap_ResetBlockTracking(void)
 {
 	memzero( m_PageProtectInfo );
 	if (eeMem) HostSys::MemProtect( eeMem->Main, Ps2MemSize::MainRam, PageAccess_ReadWrite() );
+	vtlb_FastmemUnprotectAll();
 }
@@ -55,6 +55,16 @@ std::vector<std::string> MemoryPatchDatabase::GetPatchLines(std::string key)
 	return patch_lines;
 }
 
+std::vector<std::string> MemoryPatchDatabase::GetKeys() const
+{
+	std::vector<std::string> keys;
+
+	for (const auto& entry : entries)
+		keys.push_back(entry.first);
+
+	return keys;
+}
+
 int MemoryPatchDatabase::DecompressEntry(std::string key, uint8_t* dest_buffer)
 {
 	int result = Z_ERRNO;
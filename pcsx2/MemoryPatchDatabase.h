@@ -19,6 +19,7 @@ public:
 	};
 
 	std::vector<std::string> GetPatchLines(std::string key);
+	std::vector<std::string> GetKeys() const;
 	void InitEntries();
 	void InitEntries(uint8_t* compressed_archive_as_byte_array, uint32_t archive_length);
 private:
@@ -21,6 +21,7 @@
 #include "Patch.h"
 #include "GameDatabase.h"
 #include "MemoryPatchDatabase.h"
+#include "PatchTableBinary.h"
 
 #include <memory>
 #include <vector>
@@ -31,15 +32,32 @@
 #include "cheats_60fps.h"
 #include "cheats_nointerlacing.h"
 
+// Precompiled by tools/pnach2bin, empty when the tool couldn't run
+#include "cheats_ws_bin.h"
+#include "cheats_60fps_bin.h"
+#include "cheats_nointerlacing_bin.h"
+
 #include "retro_messager.h"
 
-// This is a declaration for PatchMemory.cpp::_ApplyPatch where we're (patch.cpp)
+// This is a declaration for PatchMemory.cpp::_ApplyPatchRun where we're (patch.cpp)
 // the only consumer, so it's not made public via Patch.h
-// Applies a single patch line to emulation memory regardless of its "place" value.
-extern void _ApplyPatch(IniPatch* p);
+// Applies patch lines of a single cpu and type to emulation memory regardless of their "place" value.
+extern void _ApplyPatchRun(IniPatch* begin, IniPatch* end);
 
 static std::vector<IniPatch> Patch;
 
+// The enabled patches of each place in load order, cut in runs of patches of the
+// same cpu and type, so applying them doesn't go through the whole list and the
+// type dispatch for every line.
+struct PatchBucket
+{
+	std::vector<IniPatch> patches;
+	std::vector<std::pair<size_t, size_t>> runs; // [begin, end) in patches
+};
+
+static PatchBucket s_buckets[_PPT_END_MARKER];
+static size_t s_bucketed = 0; // Patch entries already sorted in the buckets
+
 struct PatchTextTable
 {
 	int				code;
@@ -165,6 +183,13 @@ void inifile_process(wxTextFile& f1)
 void ForgetLoadedPatches()
 {
 	Patch.clear();
+
+	for (PatchBucket& bucket : s_buckets)
+	{
+		bucket.patches.clear();
+		bucket.runs.clear();
+	}
+	s_bucketed = 0;
 }
 
 static int _LoadPatchFiles(const wxDirName& folderName, wxString& fileSpec, const wxString& friendlyName, int& numberFoundPatchFiles)
@@ -199,39 +224,65 @@ static int _LoadPatchFiles(const wxDirName& folderName, wxString& fileSpec, cons
 	return Patch.size() - before;
 }
 
-int Load60fpsPatchesFromDatabase(std::string gameCRC)
+// Appends the patches of a game from a table compiled by tools/pnach2bin.
+// Returns false if the table wasn't generated, the archive has to be read instead.
+static bool LoadPatchesFromTable(const unsigned char* table, unsigned int length, const std::string& gameCRC)
 {
-	static MemoryPatchDatabase *sixtyfps_database;
-	std::transform(gameCRC.begin(), gameCRC.end(), gameCRC.begin(), ::toupper);
+	const PatchTableBinHeader* header = (const PatchTableBinHeader*)table;
 
-	int before = Patch.size();
+	if (length < sizeof(*header)
+		|| header->magic != PATCH_TABLE_BIN_MAGIC
+		|| header->version != PATCH_TABLE_BIN_VERSION
+		|| length != sizeof(*header) + (u64)header->recordCount * sizeof(PatchTableBinRecord) + (u64)header->crcCount * sizeof(PatchTableBinCrc))
+		return false;
+
+	const PatchTableBinRecord* records = (const PatchTableBinRecord*)(header + 1);
+	const PatchTableBinCrc* index = (const PatchTableBinCrc*)(records + header->recordCount);
+	const PatchTableBinCrc* end = index + header->crcCount;
+
+	// The archives are indexed by the 8 digit file names
+	char* crcEnd;
+	const u32 crc = strtoul(gameCRC.c_str(), &crcEnd, 16);
+	if (gameCRC.length() != 8 || *crcEnd)
+		return true;
+
+	const PatchTableBinCrc* game = std::lower_bound(index, end, crc,
+		[](const PatchTableBinCrc& entry, u32 crc) { return entry.crc < crc; });
 
-	if (!sixtyfps_database)
+	if (game == end || game->crc != crc || game->first + (u64)game->count > header->recordCount)
+		return true;
+
+	for (const PatchTableBinRecord* r = records + game->first; r != records + game->first + game->count; r++)
 	{
-		sixtyfps_database = new MemoryPatchDatabase(cheats_60fps_zip, cheats_60fps_zip_len);
-		sixtyfps_database->InitEntries();
+		IniPatch iPatch = {0};
+		iPatch.enabled = 1;
+		iPatch.placetopatch = r->place;
+		iPatch.cpu = (patch_cpu_type)r->cpu;
+		iPatch.addr = r->addr;
+		iPatch.type = (patch_data_type)r->type;
+		iPatch.data = r->data;
+		Patch.push_back(iPatch);
 	}
-	std::vector<std::string> patch_lines = sixtyfps_database->GetPatchLines(gameCRC);
-
-	for (std::string line : patch_lines)
-		inifile_processString(line);
 
-	return Patch.size() - before;
+	return true;
 }
 
-int LoadWidescreenPatchesFromDatabase(std::string gameCRC)
+static int LoadPatchesFromDatabase(std::string gameCRC, const unsigned char* table, unsigned int tableLength,
+	MemoryPatchDatabase*& database, unsigned char* archive, unsigned int archiveLength)
 {
-	static MemoryPatchDatabase *widescreen_database;
 	std::transform(gameCRC.begin(), gameCRC.end(), gameCRC.begin(), ::toupper);
 
 	int before = Patch.size();
 
-	if (!widescreen_database)
+	if (LoadPatchesFromTable(table, tableLength, gameCRC))
+		return Patch.size() - before;
+
+	if (!database)
 	{
-		widescreen_database = new MemoryPatchDatabase(cheats_ws_zip, cheats_ws_zip_len);
-		widescreen_database->InitEntries();
+		database = new MemoryPatchDatabase(archive, archiveLength);
+		database->InitEntries();
 	}
-	std::vector<std::string> patch_lines = widescreen_database->GetPatchLines(gameCRC);
+	std::vector<std::string> patch_lines = database->GetPatchLines(gameCRC);
 
 	for (std::string line : patch_lines)
 		inifile_processString(line);
@@ -239,24 +290,25 @@ int LoadWidescreenPatchesFromDatabase(std::string gameCRC)
 	return Patch.size() - before;
 }
 
-int LoadNointerlacingPatchesFromDatabase(std::string gameCRC)
+int Load60fpsPatchesFromDatabase(std::string gameCRC)
 {
-	static MemoryPatchDatabase* nointerlacing_database;
-	std::transform(gameCRC.begin(), gameCRC.end(), gameCRC.begin(), ::toupper);
-
-	int before = Patch.size();
-
-	if (!nointerlacing_database)
-	{
-		nointerlacing_database = new MemoryPatchDatabase(cheats_nointerlacing_zip, cheats_nointerlacing_zip_len);
-		nointerlacing_database->InitEntries();
-	}
-	std::vector<std::string> patch_lines = nointerlacing_database->GetPatchLines(gameCRC);
+	static MemoryPatchDatabase *sixtyfps_database;
+	return LoadPatchesFromDatabase(gameCRC, cheats_60fps_bin, cheats_60fps_bin_len,
+		sixtyfps_database, cheats_60fps_zip, cheats_60fps_zip_len);
+}
 
-	for (std::string line : patch_lines)
-		inifile_processString(line);
+int LoadWidescreenPatchesFromDatabase(std::string gameCRC)
+{
+	static MemoryPatchDatabase *widescreen_database;
+	return LoadPatchesFromDatabase(gameCRC, cheats_ws_bin, cheats_ws_bin_len,
+		widescreen_database, cheats_ws_zip, cheats_ws_zip_len);
+}
 
-	return Patch.size() - before;
+int LoadNointerlacingPatchesFromDatabase(std::string gameCRC)
+{
+	static MemoryPatchDatabase* nointerlacing_database;
+	return LoadPatchesFromDatabase(gameCRC, cheats_nointerlacing_bin, cheats_nointerlacing_bin_len,
+		nointerlacing_database, cheats_nointerlacing_zip, cheats_nointerlacing_zip_len);
 }
 
 
@@ -363,12 +415,34 @@ error:
 	void patch(const wxString& cmd, const wxString& param) { patchHelper(cmd, param); }
 } // namespace PatchFunc
 
-// This is for applying patches directly to memory
-void ApplyLoadedPatches(patch_place_type place)
+// Sorts the patches loaded since the last call in the buckets
+static void BucketLoadedPatches()
 {
-	for (auto& i : Patch)
+	for (; s_bucketed < Patch.size(); s_bucketed++)
 	{
-		if (i.placetopatch == place)
-			_ApplyPatch(&i);
+		const IniPatch& p = Patch[s_bucketed];
+
+		if (!p.enabled || p.placetopatch < 0 || p.placetopatch >= _PPT_END_MARKER)
+			continue;
+
+		PatchBucket& bucket = s_buckets[p.placetopatch];
+
+		if (!bucket.patches.empty() && bucket.patches.back().cpu == p.cpu && bucket.patches.back().type == p.type)
+			bucket.runs.back().second++;
+		else
+			bucket.runs.emplace_back(bucket.patches.size(), bucket.patches.size() + 1);
+
+		bucket.patches.push_back(p);
 	}
 }
+
+// This is for applying patches directly to memory
+void ApplyLoadedPatches(patch_place_type place)
+{
+	BucketLoadedPatches();
+
+	PatchBucket& bucket = s_buckets[place];
+
+	for (const auto& run : bucket.runs)
+		_ApplyPatchRun(bucket.patches.data() + run.first, bucket.patches.data() + run.second);
+}
@@ -0,0 +1,67 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Pcsx2Types.h"
+
+/*
+
+Binary patch table, compiled from one of the embedded pnach archives (cheats_ws.zip,
+cheats_60fps.zip, ...) by tools/pnach2bin and read by Patch.cpp.  Shared by both, so
+it only depends on the fixed size types.
+
+Layout (little endian):
+- PatchTableBinHeader
+- records: PatchTableBinRecord[recordCount], the patch lines of a game are contiguous
+  and in file order
+- index: PatchTableBinCrc[crcCount], sorted by crc
+
+Only the valid patch=... lines are stored, already parsed the way PatchFunc::patch
+does it.  cpu and type hold patch_cpu_type and patch_data_type values (Patch.h).
+
+*/
+
+#define PATCH_TABLE_BIN_MAGIC 0x54415050 // PPAT
+#define PATCH_TABLE_BIN_VERSION 1
+
+struct PatchTableBinHeader
+{
+	u32 magic;
+	u32 version;
+	u32 recordCount;
+	u32 crcCount;
+};
+
+struct PatchTableBinRecord
+{
+	u64 data;
+	u32 addr;
+	u8 place;
+	u8 cpu;
+	u8 type;
+	u8 _padding;
+};
+
+struct PatchTableBinCrc
+{
+	u32 crc;
+	u32 first;
+	u32 count;
+};
+
+static_assert(sizeof(PatchTableBinHeader) == 16, "PatchTableBinHeader is part of the file format");
+static_assert(sizeof(PatchTableBinRecord) == 16, "PatchTableBinRecord is part of the file format");
+static_assert(sizeof(PatchTableBinCrc) == 12, "PatchTableBinCrc is part of the file format");
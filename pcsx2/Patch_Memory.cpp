@@ -385,39 +385,54 @@ void handle_extended_t(IniPatch *p)
 
 // Only used from Patch.cpp and we don't export this in any h file.
 // Patch.cpp itself declares this prototype, so make sure to keep in sync.
-void _ApplyPatch(IniPatch *p)
+// Applies a run of patch lines sharing the same cpu and type, the type is only
+// looked at once so the plain writes are a tight loop.
+void _ApplyPatchRun(IniPatch* begin, IniPatch* end)
 {
-	if (p->enabled == 0) return;
+	if (begin == end) return;
 
-	switch (p->cpu)
+	switch (begin->cpu)
 	{
 	case CPU_EE:
-		switch (p->type)
+		switch (begin->type)
 		{
 		case BYTE_T:
-			if (memRead8(p->addr) != (u8)p->data)
-				memWrite8(p->addr, (u8)p->data);
+			for (IniPatch* p = begin; p != end; p++)
+			{
+				if (memRead8(p->addr) != (u8)p->data)
+					memWrite8(p->addr, (u8)p->data);
+			}
 			break;
 
 		case SHORT_T:
-			if (memRead16(p->addr) != (u16)p->data)
-				memWrite16(p->addr, (u16)p->data);
+			for (IniPatch* p = begin; p != end; p++)
+			{
+				if (memRead16(p->addr) != (u16)p->data)
+					memWrite16(p->addr, (u16)p->data);
+			}
 			break;
 
 		case WORD_T:
-			if (memRead32(p->addr) != (u32)p->data)
-				memWrite32(p->addr, (u32)p->data);
+			for (IniPatch* p = begin; p != end; p++)
+			{
+				if (memRead32(p->addr) != (u32)p->data)
+					memWrite32(p->addr, (u32)p->data);
+			}
 			break;
 
 		case DOUBLE_T:
-			u64 mem;
-			memRead64(p->addr, &mem);
-			if (mem != p->data)
-				memWrite64(p->addr, &p->data);
+			for (IniPatch* p = begin; p != end; p++)
+			{
+				u64 mem;
+				memRead64(p->addr, &mem);
+				if (mem != p->data)
+					memWrite64(p->addr, &p->data);
+			}
 			break;
 
 		case EXTENDED_T:
-			handle_extended_t(p);
+			for (IniPatch* p = begin; p != end; p++)
+				handle_extended_t(p);
 			break;
 
 		default:
@@ -426,19 +441,28 @@ void _ApplyPatch(IniPatch *p)
 		break;
 
 	case CPU_IOP:
-		switch (p->type)
+		switch (begin->type)
 		{
 		case BYTE_T:
-			if (iopMemRead8(p->addr) != (u8)p->data)
-				iopMemWrite8(p->addr, (u8)p->data);
+			for (IniPatch* p = begin; p != end; p++)
+			{
+				if (iopMemRead8(p->addr) != (u8)p->data)
+					iopMemWrite8(p->addr, (u8)p->data);
+			}
 			break;
 		case SHORT_T:
-			if (iopMemRead16(p->addr) != (u16)p->data)
-				iopMemWrite16(p->addr, (u16)p->data);
+			for (IniPatch* p = begin; p != end; p++)
+			{
+				if (iopMemRead16(p->addr) != (u16)p->data)
+					iopMemWrite16(p->addr, (u16)p->data);
+			}
 			break;
 		case WORD_T:
-			if (iopMemRead32(p->addr) != (u32)p->data)
-				iopMemWrite32(p->addr, (u32)p->data);
+			for (IniPatch* p = begin; p != end; p++)
+			{
+				if (iopMemRead32(p->addr) != (u32)p->data)
+					iopMemWrite32(p->addr, (u32)p->data);
+			}
 			break;
 		default:
 			break;
@@ -0,0 +1,231 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standalone SPU2 mixer benchmark.  Replays a trace recorded by the core ("Record SPU2 Trace"
+// option) once mixing one sample at a time and once in blocks, checks that both produce the
+// same samples and interrupts, and prints the time taken by each.
+//
+// usage: pcsx2_SPU2MixBench <trace.spu2.gz> [loops]
+
+#include "PrecompiledHeader.h"
+#include "Global.h"
+#include "spu2.h"
+#include "Trace.h"
+#include "R3000A.h"
+#include "IopDma.h"
+
+#include <chrono>
+
+struct MixBenchOutput
+{
+	std::vector<s16> samples;
+	std::vector<u32> irqs; // Cycles << 2 | source
+};
+
+static MixBenchOutput* s_output = nullptr;
+
+// The SPU2 is normally linked into the core, which provides these.
+
+__aligned16 psxRegisters psxRegs;
+
+static size_t bench_samples(const int16_t* data, size_t frames)
+{
+	s_output->samples.insert(s_output->samples.end(), data, data + frames * 2);
+	return frames;
+}
+
+void spu2Irq()
+{
+	s_output->irqs.push_back(Cycles << 2 | 0);
+}
+
+void spu2DMA4Irq()
+{
+	SPU2interruptDMA4();
+	s_output->irqs.push_back(Cycles << 2 | 1);
+}
+
+void spu2DMA7Irq()
+{
+	SPU2interruptDMA7();
+	s_output->irqs.push_back(Cycles << 2 | 2);
+}
+
+static double Replay(const SPU2TraceFile& trace, bool block, MixBenchOutput& out, std::vector<u16>& dmaread)
+{
+	// ThawIt wants a writable block
+	std::vector<u8> state(trace.m_state);
+
+	SPU2Savestate::ThawIt((SPU2Savestate::DataBlock&)*state.data());
+
+	// not part of the savestate
+	NoiseLFSR = 0xC0FEu;
+	has_to_call_irq = false;
+
+	BlockMixing = block;
+
+	out.samples.clear();
+	out.irqs.clear();
+
+	s_output = &out;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	for (const SPU2TraceFile::Event& e : trace.m_events)
+	{
+		psxRegs.cycle = e.cycle;
+
+		switch (e.type)
+		{
+			case SPU2TraceType::Update:
+				SPU2async(0);
+				SndOutDrain(bench_samples, 0);
+				break;
+			case SPU2TraceType::Write:
+				SPU2write(e.addr, (u16)e.value);
+				break;
+			case SPU2TraceType::Read:
+				SPU2read(e.addr);
+				break;
+			case SPU2TraceType::DmaWrite:
+				if (e.core)
+					SPU2writeDMA7Mem((u16*)&trace.m_data[e.offset], e.value);
+				else
+					SPU2writeDMA4Mem((u16*)&trace.m_data[e.offset], e.value);
+				break;
+			case SPU2TraceType::DmaRead:
+				if (e.core)
+					SPU2readDMA7Mem(dmaread.data(), e.value);
+				else
+					SPU2readDMA4Mem(dmaread.data(), e.value);
+				break;
+		}
+	}
+
+	SndOutDrain(bench_samples, 0);
+
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double>(end - start).count();
+}
+
+// Returns the index of the first difference, or -1.
+template <typename T>
+static ptrdiff_t Compare(const std::vector<T>& a, const std::vector<T>& b)
+{
+	const auto diff = std::mismatch(a.begin(), a.end(), b.begin(), b.end());
+
+	if (diff.first == a.end() && diff.second == b.end())
+		return -1;
+
+	return diff.first - a.begin();
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <trace.spu2.gz> [loops]\n", argv[0]);
+		return 1;
+	}
+
+	const int loops = argc > 2 ? std::max(atoi(argv[2]), 1) : 5;
+
+	SPU2TraceFile trace;
+
+	if (!trace.Load(argv[1]))
+	{
+		fprintf(stderr, "Cannot load %s\n", argv[1]);
+		return 1;
+	}
+
+	if (SPU2init() != 0)
+	{
+		fprintf(stderr, "SPU2init failed\n");
+		return 1;
+	}
+
+	if (trace.m_state.size() != (size_t)SPU2Savestate::SizeIt())
+	{
+		fprintf(stderr, "The trace was recorded by a different build\n");
+		SPU2shutdown();
+		return 1;
+	}
+
+	// DMA reads complete on a later tick, the buffer must outlive them
+	u32 dmaread_size = 0;
+
+	for (const SPU2TraceFile::Event& e : trace.m_events)
+	{
+		if (e.type == SPU2TraceType::DmaRead)
+			dmaread_size = std::max(dmaread_size, e.value);
+	}
+
+	std::vector<u16> dmaread(dmaread_size);
+
+	MixBenchOutput out[2];
+
+	double best[2] = {1e30, 1e30};
+
+	// first round is a warm-up (and the comparison), as in GSReplay
+
+	for (int i = 0; i <= loops; i++)
+	{
+		for (int mode = 0; mode < 2; mode++)
+		{
+			const double t = Replay(trace, mode != 0, out[mode], dmaread);
+
+			if (i > 0)
+				best[mode] = std::min(best[mode], t);
+		}
+
+		if (i == 0)
+		{
+			const ptrdiff_t sample = Compare(out[0].samples, out[1].samples);
+			const ptrdiff_t irq = Compare(out[0].irqs, out[1].irqs);
+
+			if (sample >= 0 || irq >= 0)
+			{
+				if (sample >= 0)
+					fprintf(stderr, "Block mixing differs at sample %d\n", (int)(sample / 2));
+				if (irq >= 0)
+					fprintf(stderr, "Block mixing differs at interrupt %d\n", (int)irq);
+
+				SPU2shutdown();
+				return 1;
+			}
+		}
+	}
+
+	const size_t samples = out[0].samples.size() / 2;
+
+	printf("%s: %zu events, %zu samples (%.2f s), %zu interrupts, output identical\n",
+		argv[1], trace.m_events.size(), samples, samples / 48000.0, out[0].irqs.size());
+
+	static const char* names[2] = {"per sample", "block"};
+
+	for (int mode = 0; mode < 2; mode++)
+	{
+		printf("%-10s %8.2f ms %8.1f ns/sample %8.1fx realtime\n",
+			names[mode], best[mode] * 1000, samples ? best[mode] * 1e9 / samples : 0.0,
+			best[mode] > 0 ? samples / 48000.0 / best[mode] : 0.0);
+	}
+
+	printf("speedup %.2fx\n", best[1] > 0 ? best[0] / best[1] : 0.0);
+
+	SPU2shutdown();
+
+	return 0;
+}
@@ -16,8 +16,23 @@
 #include "PrecompiledHeader.h"
 #include "Global.h"
 
-/* Forward declaration */
-extern retro_audio_sample_t sample_cb;
+#if !defined(_M_SSE)
+#if defined(__GNUC__)
+#if defined(__SSE4_1__)
+#define _M_SSE 0x401
+#elif defined(__SSE2__)
+#define _M_SSE 0x200
+#endif
+#endif
+
+#if !defined(_M_SSE) && (!defined(_WIN32) || defined(_M_AMD64) || defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _M_SSE 0x200
+#endif
+#endif
+
+// Mix the voices a block of samples at a time whenever TimeUpdate has more than one tick
+// to catch up on (see MixVoiceBlock).  The output is identical either way.
+bool BlockMixing = true;
 
 static const s32 tbl_XA_Factor[16][2] =
 	{
@@ -80,6 +95,44 @@ static void __forceinline XA_decode_block(s16* buffer, const s16* block, s32& pr
 	const s32 pred1 = tbl_XA_Factor[id][0];
 	const s32 pred2 = tbl_XA_Factor[id][1];
 
+#if _M_SSE >= 0x200
+	// Expand the 28 nibbles up front: each one goes to the top of a 16 bit lane and gets
+	// the shift applied there, (n << 12) >> (shift - 16) being the same as (n << 28) >> shift.
+	// Only the predictor below is left serial, since every sample depends on the previous two.
+	alignas(16) s16 nibbles[32];
+
+	const __m128i mask = _mm_set1_epi8((char)0xF0);
+	const __m128i bytes = _mm_srli_si128(_mm_load_si128((const __m128i*)block), 2);
+	const __m128i lo = _mm_and_si128(_mm_slli_epi16(bytes, 4), mask);
+	const __m128i hi = _mm_and_si128(bytes, mask);
+	const __m128i count = _mm_cvtsi32_si128(shift - 16);
+
+	const __m128i lo0 = _mm_unpacklo_epi8(_mm_setzero_si128(), lo);
+	const __m128i hi0 = _mm_unpacklo_epi8(_mm_setzero_si128(), hi);
+	const __m128i lo1 = _mm_unpackhi_epi8(_mm_setzero_si128(), lo);
+	const __m128i hi1 = _mm_unpackhi_epi8(_mm_setzero_si128(), hi);
+
+	_mm_store_si128((__m128i*)&nibbles[0], _mm_sra_epi16(_mm_unpacklo_epi16(lo0, hi0), count));
+	_mm_store_si128((__m128i*)&nibbles[8], _mm_sra_epi16(_mm_unpackhi_epi16(lo0, hi0), count));
+	_mm_store_si128((__m128i*)&nibbles[16], _mm_sra_epi16(_mm_unpacklo_epi16(lo1, hi1), count));
+	_mm_store_si128((__m128i*)&nibbles[24], _mm_sra_epi16(_mm_unpackhi_epi16(lo1, hi1), count));
+
+	for (int i = 0; i < pcm_DecodedSamplesPerBlock; i += 2)
+	{
+		s32 pcm = nibbles[i] + (((pred1 * prev1) + (pred2 * prev2) + 32) >> 6);
+
+		Clampify(pcm, -0x8000, 0x7fff);
+		*(buffer++) = pcm;
+
+		s32 pcm2 = nibbles[i + 1] + (((pred1 * pcm) + (pred2 * prev1) + 32) >> 6);
+
+		Clampify(pcm2, -0x8000, 0x7fff);
+		*(buffer++) = pcm2;
+
+		prev2 = pcm;
+		prev1 = pcm2;
+	}
+#else
 	const s8* blockbytes = (s8*)&block[1];
 	const s8* blockend = &blockbytes[13];
 
@@ -100,6 +153,21 @@ static void __forceinline XA_decode_block(s16* buffer, const s16* block, s32& pr
 		prev2 = pcm;
 		prev1 = pcm2;
 	}
+#endif
+}
+
+// Sample of the current block being mixed by MixVoiceBlock, or -1 when mixing one sample
+// at a time.  Voice IRQs seen during a block are held back until the core stage of the
+// sample that raised them, so that spu2Irq still fires on the same tick.
+static int BlockSample = -1;
+static int BlockIrqSample[2];
+
+static __forceinline void VoiceIrqCall(int core)
+{
+	if (BlockSample < 0)
+		SetIrqCall(core);
+	else if (BlockSample < BlockIrqSample[core])
+		BlockIrqSample[core] = BlockSample;
 }
 
 static void __forceinline IncrementNextA(V_Core& thiscore, uint voiceidx)
@@ -113,7 +181,7 @@ static void __forceinline IncrementNextA(V_Core& thiscore, uint voiceidx)
 	{
 		if (Cores[i].IRQEnable && (vc.NextA == Cores[i].IRQA))
 		{
-			SetIrqCall(i);
+			VoiceIrqCall(i);
 		}
 	}
 
@@ -165,7 +233,7 @@ static __forceinline s32 GetNextDataBuffered(V_Core& thiscore, uint voiceidx)
 
 		for (int i = 0; i < 2; i++)
 			if (Cores[i].IRQEnable && Cores[i].IRQA == (vc.NextA & 0xFFFF8))
-				SetIrqCall(i);
+				VoiceIrqCall(i);
 
 		s16* memptr = GetMemPtr(vc.NextA & 0xFFFF8);
 		vc.LoopFlags = *memptr >> 8; // grab loop flags from the upper byte.
@@ -221,7 +289,7 @@ static __forceinline void GetNextDataDummy(V_Core& thiscore, uint voiceidx)
 	{
 		for (int i = 0; i < 2; i++)
 			if (Cores[i].IRQEnable && Cores[i].IRQA == (vc.NextA & 0xFFFF8))
-				SetIrqCall(i);
+				VoiceIrqCall(i);
 
 		vc.LoopFlags = *GetMemPtr(vc.NextA & 0xFFFF8) >> 8; // grab loop flags from the upper byte.
 
@@ -238,12 +306,13 @@ static __forceinline void GetNextDataDummy(V_Core& thiscore, uint voiceidx)
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
+u16 NoiseLFSR = 0xC0FEu;
+
 static s32 __forceinline GetNoiseValues(void)
 {
-	static u16 lfsr = 0xC0FEu;
-	u16 bit = lfsr ^ (lfsr << 3) ^ (lfsr << 4) ^ (lfsr << 5);
-	lfsr = (lfsr << 1) | (bit >> 15);
-	return (s16)lfsr;
+	u16 bit = NoiseLFSR ^ (NoiseLFSR << 3) ^ (NoiseLFSR << 4) ^ (NoiseLFSR << 5);
+	NoiseLFSR = (NoiseLFSR << 1) | (bit >> 15);
+	return (s16)NoiseLFSR;
 }
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -272,9 +341,9 @@ static __forceinline StereoOut32 ApplyVolume(const StereoOut32& data, const V_Vo
 		ApplyVolume(data.Right, volume.Right.Value));
 }
 
-static void __forceinline UpdatePitch(uint coreidx, uint voiceidx)
+// ModOutX is the output of the previous voice for this sample (Voices[voiceidx - 1].OutX)
+static void __forceinline UpdatePitch(V_Voice& vc, uint voiceidx, s32 ModOutX)
 {
-	V_Voice& vc(Cores[coreidx].Voices[voiceidx]);
 	s32 pitch;
 
 	// [Air] : re-ordered comparisons: Modulated is much more likely to be zero than voice,
@@ -284,7 +353,7 @@ static void __forceinline UpdatePitch(uint coreidx, uint voiceidx)
 	if ((vc.Modulated == 0) || (voiceidx == 0))
 		pitch = vc.Pitch;
 	else
-		pitch = GetClamped((vc.Pitch * (32768 + Cores[coreidx].Voices[voiceidx - 1].OutX)) >> 15, 0, 0x3fff);
+		pitch = GetClamped((vc.Pitch * (32768 + ModOutX)) >> 15, 0, 0x3fff);
 
 	pitch = std::min(pitch, 0x3FFF);
 	vc.SP += pitch;
@@ -380,7 +449,7 @@ __forceinline static s32 CubicInterpolate(
 // Uses standard template-style optimization techniques to statically generate five different
 // versions of this function (one for each type of interpolation).
 template <int InterpType>
-static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
+static __forceinline void AdvanceVoice(V_Core& thiscore, uint voiceidx)
 {
 	V_Voice& vc(thiscore.Voices[voiceidx]);
 
@@ -395,6 +464,14 @@ static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
 		vc.PV1 = GetNextDataBuffered(thiscore, voiceidx);
 		vc.SP -= 0x1000;
 	}
+}
+
+template <int InterpType>
+static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
+{
+	V_Voice& vc(thiscore.Voices[voiceidx]);
+
+	AdvanceVoice<InterpType>(thiscore, voiceidx);
 
 	const s32 mu = vc.SP + 0x1000;
 
@@ -454,7 +531,7 @@ static __forceinline StereoOut32 MixVoice(uint coreidx, uint voiceidx)
 	// have to run through all the motions of updating the voice regardless of it's
 	// audible status.  Otherwise IRQs might not trigger and emulation might fail.
 
-	UpdatePitch(coreidx, voiceidx);
+	UpdatePitch(vc, voiceidx, voiceidx ? thiscore.Voices[voiceidx - 1].OutX : 0);
 
 	StereoOut32 voiceOut(0, 0);
 	s32 Value = 0;
@@ -539,6 +616,334 @@ static __forceinline void MixCoreVoices(VoiceMixSet& dest, const uint coreidx)
 	}
 }
 
+// --------------------------------------------------------------------------------------
+//  Block mixing
+// --------------------------------------------------------------------------------------
+// While TimeUpdate catches up on several ticks nothing else can touch the voices, since
+// register writes and DMAs all call TimeUpdate first.  So each voice is run across the whole
+// block on its own: the serial part (volume slides, pitch, ADPCM fetch, ADSR) records its
+// state per sample, then interpolation, envelope, volume and gates run four samples at a
+// time.  The core stage (input, output areas, reverb) stays per sample, see MixBlockSample.
+//
+// This only matches Mix() when the voices don't read SPU2 ram written by the core stage
+// during the block, and when at most one voice pulls from the shared noise generator.
+// MixVoiceBlock declines otherwise and TimeUpdate falls back to Mix().
+
+static const uint MixBlockSize = 64;
+// Below this the per-block setup and hazard checks cost more than they save.
+static const uint MixBlockMinTicks = 4;
+
+// Per sample results, consumed by the core stage.
+alignas(16) static s32 BlockDry[2][2][MixBlockSize]; // [core][left/right][sample]
+alignas(16) static s32 BlockWet[2][2][MixBlockSize];
+alignas(16) static s32 BlockCapture[2][2][MixBlockSize]; // voice 1 and 3 output
+
+// Per voice scratch
+alignas(16) static s32 BlockPV[4][MixBlockSize]; // PV4..PV1, or the noise value in PV1
+alignas(16) static s32 BlockMu[MixBlockSize];
+alignas(16) static s32 BlockEnv[MixBlockSize];
+alignas(16) static s32 BlockActive[MixBlockSize];
+alignas(16) static s32 BlockVol[2][MixBlockSize];
+alignas(16) static s32 BlockValue[MixBlockSize];
+alignas(16) static s32 BlockModOutX[MixBlockSize]; // OutX of the previous voice
+
+#if _M_SSE >= 0x200
+// MulShr32 on four lanes.
+static __forceinline __m128i MulShr32x4(__m128i a, __m128i b)
+{
+#if _M_SSE >= 0x401
+	const __m128i even = _mm_mul_epi32(a, b);
+	const __m128i odd = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+#else
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+#endif
+
+	__m128i r = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_and_si128(odd, _mm_set_epi32(-1, 0, -1, 0)));
+
+#if _M_SSE < 0x401
+	// turn the unsigned high half into the signed one
+	r = _mm_sub_epi32(r, _mm_add_epi32(
+		_mm_and_si128(_mm_srai_epi32(a, 31), b),
+		_mm_and_si128(_mm_srai_epi32(b, 31), a)));
+#endif
+
+	return r;
+}
+
+// 32 bit wrapping multiply, like the scalar s32 * s32.
+static __forceinline __m128i MulLo32x4(__m128i a, __m128i b)
+{
+#if _M_SSE >= 0x401
+	return _mm_mullo_epi32(a, b);
+#else
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+	return _mm_unpacklo_epi32(
+		_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+// CatmullRomInterpolate on four lanes.
+static __forceinline __m128i CatmullRomInterpolate4(__m128i y0, __m128i y1, __m128i y2, __m128i y3, __m128i mu)
+{
+	const __m128i y1x3 = _mm_add_epi32(_mm_add_epi32(y1, y1), y1);
+	const __m128i y2x3 = _mm_add_epi32(_mm_add_epi32(y2, y2), y2);
+
+	const __m128i a3 = _mm_sub_epi32(_mm_add_epi32(y1x3, y3), _mm_add_epi32(y0, y2x3));
+	const __m128i a2 = _mm_sub_epi32(
+		_mm_add_epi32(_mm_slli_epi32(y0, 1), _mm_slli_epi32(y2, 2)),
+		_mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(y1, 2), y1), y3));
+	const __m128i a1 = _mm_sub_epi32(y2, y0);
+	const __m128i a0 = _mm_slli_epi32(y1, 1);
+
+	__m128i val = _mm_srai_epi32(MulLo32x4(a3, mu), 12);
+	val = _mm_srai_epi32(MulLo32x4(_mm_add_epi32(a2, val), mu), 12);
+	val = _mm_srai_epi32(MulLo32x4(_mm_add_epi32(a1, val), mu), 12);
+
+	return _mm_add_epi32(a0, val);
+}
+#endif
+
+// Whether the core stage leaves [start, start + size) of SPU2 ram alone during a block.
+static __forceinline bool BlockRangeIsStatic(u32 start, u32 size)
+{
+	const u32 end = start + size;
+
+	if (start < SPU2_DYN_MEMLINE || end > 0x100000)
+		return false;
+
+	for (int i = 0; i < 2; i++)
+	{
+		const V_Core& core(Cores[i]);
+
+		if (core.FxEnable && core.EffectsEndA < 0x100000 && start <= core.EffectsEndA && end > core.EffectsStartA)
+			return false;
+	}
+
+	return true;
+}
+
+static bool CanMixBlock(uint samples)
+{
+	// Pitch is clamped to 0x3fff, so a voice reads at most four samples per tick (plus the
+	// partial group skipped by GetNextDataDummy).  Round that up to ADPCM blocks, counting
+	// the one it is in and the header of the next.  Loops only go back to LoopStartA, which
+	// is either where it is now or a block on the way.
+
+	const u32 span = ((samples * 4 + 4) / pcm_DecodedSamplesPerBlock + 2) * pcm_WordsPerBlock;
+
+	int noise = 0;
+
+	for (int c = 0; c < 2; c++)
+	{
+		for (int v = 0; v < NUM_VOICES; v++)
+		{
+			const V_Voice& vc(Cores[c].Voices[v]);
+
+			if (vc.Noise && vc.ADSR.Phase > 0 && ++noise > 1)
+				return false;
+
+			if (!BlockRangeIsStatic(vc.NextA & ~7, span) || !BlockRangeIsStatic(vc.LoopStartA & ~7, span))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static __forceinline void MixVoiceSamples(uint coreidx, uint voiceidx, uint samples)
+{
+	V_Core& thiscore(Cores[coreidx]);
+	V_Voice& vc(thiscore.Voices[voiceidx]);
+
+	const bool noise = vc.Noise;
+	const bool sliding = vc.Volume.IsSliding();
+
+	// A voice that is off stays off until the next key on, so only its addresses
+	// need to be kept going.
+
+	if (vc.ADSR.Phase == 0)
+	{
+		for (uint s = 0; s < samples; s++)
+		{
+			BlockSample = s;
+
+			if (sliding)
+				vc.Volume.Update();
+
+			UpdatePitch(vc, voiceidx, BlockModOutX[s]);
+
+			while (vc.SP >= 0)
+				GetNextDataDummy(thiscore, voiceidx);
+
+			BlockModOutX[s] = vc.OutX;
+		}
+
+		BlockSample = -1;
+
+		if (voiceidx == 1 || voiceidx == 3)
+			memset(BlockCapture[coreidx][voiceidx >> 1], 0, samples * sizeof(s32));
+
+		return;
+	}
+
+	// Serial part, same steps as MixVoice
+
+	for (uint s = 0; s < samples; s++)
+	{
+		BlockSample = s;
+
+		if (sliding)
+			vc.Volume.Update();
+
+		BlockVol[0][s] = vc.Volume.Left.Value;
+		BlockVol[1][s] = vc.Volume.Right.Value;
+
+		UpdatePitch(vc, voiceidx, BlockModOutX[s]);
+
+		if (vc.ADSR.Phase > 0)
+		{
+			if (noise)
+				BlockPV[3][s] = GetNoiseValues();
+			else
+			{
+				AdvanceVoice<Interpolation>(thiscore, voiceidx);
+
+				BlockPV[0][s] = vc.PV4;
+				BlockPV[1][s] = vc.PV3;
+				BlockPV[2][s] = vc.PV2;
+				BlockPV[3][s] = vc.PV1;
+				BlockMu[s] = vc.SP + 0x1000;
+			}
+
+			CalculateADSR(thiscore, voiceidx);
+
+			BlockEnv[s] = vc.ADSR.Value;
+			BlockActive[s] = -1;
+		}
+		else
+		{
+			while (vc.SP >= 0)
+				GetNextDataDummy(thiscore, voiceidx);
+
+			BlockActive[s] = 0;
+		}
+	}
+
+	BlockSample = -1;
+
+	// Interpolation, envelope, volume and gates.  Lanes past the end of the block only
+	// ever reach the unused tail of the Block arrays.
+
+	const V_VoiceGates& gates(thiscore.VoiceGates[voiceidx]);
+
+#if _M_SSE >= 0x200
+	const __m128i DryL = _mm_set1_epi32(gates.DryL);
+	const __m128i DryR = _mm_set1_epi32(gates.DryR);
+	const __m128i WetL = _mm_set1_epi32(gates.WetL);
+	const __m128i WetR = _mm_set1_epi32(gates.WetR);
+
+	for (uint s = 0; s < samples; s += 4)
+	{
+		__m128i value = _mm_load_si128((__m128i*)&BlockPV[3][s]);
+
+		if (!noise)
+		{
+			value = CatmullRomInterpolate4(
+				_mm_load_si128((__m128i*)&BlockPV[0][s]),
+				_mm_load_si128((__m128i*)&BlockPV[1][s]),
+				_mm_load_si128((__m128i*)&BlockPV[2][s]),
+				value,
+				_mm_load_si128((__m128i*)&BlockMu[s]));
+		}
+
+		value = MulShr32x4(value, _mm_load_si128((__m128i*)&BlockEnv[s]));
+		value = _mm_and_si128(value, _mm_load_si128((__m128i*)&BlockActive[s]));
+
+		_mm_store_si128((__m128i*)&BlockValue[s], value);
+
+		value = _mm_slli_epi32(value, 1);
+
+		const __m128i left = MulShr32x4(value, _mm_load_si128((__m128i*)&BlockVol[0][s]));
+		const __m128i right = MulShr32x4(value, _mm_load_si128((__m128i*)&BlockVol[1][s]));
+
+		__m128i* dry = (__m128i*)&BlockDry[coreidx][0][s];
+		__m128i* dryr = (__m128i*)&BlockDry[coreidx][1][s];
+		__m128i* wet = (__m128i*)&BlockWet[coreidx][0][s];
+		__m128i* wetr = (__m128i*)&BlockWet[coreidx][1][s];
+
+		*dry = _mm_add_epi32(*dry, _mm_and_si128(left, DryL));
+		*dryr = _mm_add_epi32(*dryr, _mm_and_si128(right, DryR));
+		*wet = _mm_add_epi32(*wet, _mm_and_si128(left, WetL));
+		*wetr = _mm_add_epi32(*wetr, _mm_and_si128(right, WetR));
+	}
+#else
+	for (uint s = 0; s < samples; s++)
+	{
+		s32 value = BlockPV[3][s];
+
+		if (!noise)
+			value = CatmullRomInterpolate(BlockPV[0][s], BlockPV[1][s], BlockPV[2][s], value, BlockMu[s]);
+
+		value = MulShr32(value, BlockEnv[s]) & BlockActive[s];
+
+		BlockValue[s] = value;
+
+		const s32 left = ApplyVolume(value, BlockVol[0][s]);
+		const s32 right = ApplyVolume(value, BlockVol[1][s]);
+
+		BlockDry[coreidx][0][s] += left & gates.DryL;
+		BlockDry[coreidx][1][s] += right & gates.DryR;
+		BlockWet[coreidx][0][s] += left & gates.WetL;
+		BlockWet[coreidx][1][s] += right & gates.WetR;
+	}
+#endif
+
+	// OutX only changes on active samples; keep its history for the next voice's modulation.
+
+	s32 OutX = vc.OutX;
+
+	for (uint s = 0; s < samples; s++)
+	{
+		if (BlockActive[s])
+			OutX = BlockValue[s];
+
+		BlockModOutX[s] = OutX;
+	}
+
+	vc.OutX = OutX;
+
+	if (voiceidx == 1 || voiceidx == 3)
+		memcpy(BlockCapture[coreidx][voiceidx >> 1], BlockValue, samples * sizeof(s32));
+}
+
+// Runs the voice stage of up to 'ticks' samples ahead.  Returns the number of samples
+// mixed, which TimeUpdate then completes with MixBlockSample, or 0 to mix per sample.
+uint MixVoiceBlock(uint ticks)
+{
+	if (!BlockMixing || ticks < MixBlockMinTicks || Interpolation != 4)
+		return 0;
+
+	const uint samples = std::min(ticks, MixBlockSize);
+
+	if (!CanMixBlock(samples))
+		return 0;
+
+	memset(BlockDry, 0, sizeof(BlockDry));
+	memset(BlockWet, 0, sizeof(BlockWet));
+
+	BlockIrqSample[0] = BlockIrqSample[1] = samples;
+
+	for (uint coreidx = 0; coreidx < 2; coreidx++)
+		for (uint voiceidx = 0; voiceidx < NUM_VOICES; ++voiceidx)
+			MixVoiceSamples(coreidx, voiceidx, samples);
+
+	return samples;
+}
+
 StereoOut32 V_Core::Mix(const VoiceMixSet& inVoices, const StereoOut32& Input, const StereoOut32& Ext)
 {
 	MasterVol.Update();
@@ -611,31 +1016,23 @@ StereoOut32 V_Core::Mix(const VoiceMixSet& inVoices, const StereoOut32& Input, c
 	return TD + ApplyVolume(RV, FxVol);
 }
 
-// Gcc does not want to inline it when lto is enabled because some functions growth too much.
-// The function is big enought to see any speed impact. -- Gregory
-#ifndef __POSIX__
-__forceinline
-#endif
-	void
-	Mix()
+static __forceinline void ReadCoreInputs(StereoOut32* InputData)
 {
 	// Note: Playmode 4 is SPDIF, which overrides other inputs.
-	StereoOut32 InputData[2] =
-		{
-			// SPDIF is on Core 0:
-			// Fixme:
-			// 1. We do not have an AC3 decoder for the bitstream.
-			// 2. Games usually provide a normal ADMA stream as well and want to see it getting read!
-			/*(PlayMode&4) ? StereoOut32::Empty : */ ApplyVolume(Cores[0].ReadInput(), Cores[0].InpVol),
 
-			// CDDA is on Core 1:
-			(PlayMode & 8) ? StereoOut32(0, 0) : ApplyVolume(Cores[1].ReadInput(), Cores[1].InpVol)};
+	// SPDIF is on Core 0:
+	// Fixme:
+	// 1. We do not have an AC3 decoder for the bitstream.
+	// 2. Games usually provide a normal ADMA stream as well and want to see it getting read!
+	InputData[0] = /*(PlayMode&4) ? StereoOut32::Empty : */ ApplyVolume(Cores[0].ReadInput(), Cores[0].InpVol);
 
-	// Todo: Replace me with memzero initializer!
-	VoiceMixSet VoiceData[2] = {VoiceMixSet::Empty, VoiceMixSet::Empty}; // mixed voice data for each core.
-	MixCoreVoices(VoiceData[0], 0);
-	MixCoreVoices(VoiceData[1], 1);
+	// CDDA is on Core 1:
+	InputData[1] = (PlayMode & 8) ? StereoOut32(0, 0) : ApplyVolume(Cores[1].ReadInput(), Cores[1].InpVol);
+}
 
+// Core stage of one sample: mixes the voices with the inputs and effects and outputs it.
+static void MixCores(const VoiceMixSet* VoiceData, const StereoOut32* InputData)
+{
 	StereoOut32 Ext(Cores[0].Mix(VoiceData[0], InputData[0], StereoOut32(0, 0)));
 
 	if ((PlayMode & 4) || (Cores[0].Mute != 0))
@@ -674,10 +1071,59 @@ __forceinline
 
 		Out = clamp_mix(Out, SndOutVolumeShift);
 	}
-	sample_cb(Out.Left >> 12, Out.Right >> 12);
+	SndOutWrite(Out.Left >> 12, Out.Right >> 12);
 
 	// Update AutoDMA output positioning
 	OutPos++;
 	if (OutPos >= 0x200)
 		OutPos = 0;
 }
+
+// Gcc does not want to inline it when lto is enabled because some functions growth too much.
+// The function is big enought to see any speed impact. -- Gregory
+#ifndef __POSIX__
+__forceinline
+#endif
+	void
+	Mix()
+{
+	StereoOut32 InputData[2];
+	ReadCoreInputs(InputData);
+
+	// Todo: Replace me with memzero initializer!
+	VoiceMixSet VoiceData[2] = {VoiceMixSet::Empty, VoiceMixSet::Empty}; // mixed voice data for each core.
+	MixCoreVoices(VoiceData[0], 0);
+	MixCoreVoices(VoiceData[1], 1);
+
+	MixCores(VoiceData, InputData);
+}
+
+// Completes one sample of a block prepared by MixVoiceBlock, in place of Mix().
+void MixBlockSample(uint sample)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (BlockIrqSample[i] == (int)sample)
+			SetIrqCall(i);
+	}
+
+	// Write-back of raw voice data, as done by MixVoice
+	spu2M_WriteFast(0x400 + OutPos, BlockCapture[0][0][sample]);
+	spu2M_WriteFast(0x600 + OutPos, BlockCapture[0][1][sample]);
+	spu2M_WriteFast(0xc00 + OutPos, BlockCapture[1][0][sample]);
+	spu2M_WriteFast(0xe00 + OutPos, BlockCapture[1][1][sample]);
+
+	StereoOut32 InputData[2];
+	ReadCoreInputs(InputData);
+
+	const VoiceMixSet VoiceData[2] =
+		{
+			VoiceMixSet(
+				StereoOut32(BlockDry[0][0][sample], BlockDry[0][1][sample]),
+				StereoOut32(BlockWet[0][0][sample], BlockWet[0][1][sample])),
+			VoiceMixSet(
+				StereoOut32(BlockDry[1][0][sample], BlockDry[1][1][sample]),
+				StereoOut32(BlockWet[1][0][sample], BlockWet[1][1][sample]))};
+
+	MixCores(VoiceData, InputData);
+}
@@ -65,6 +65,10 @@ struct StereoOut32
 };
 
 extern void Mix();
+extern uint MixVoiceBlock(uint ticks);
+extern void MixBlockSample(uint sample);
+extern bool BlockMixing;
+extern u16 NoiseLFSR;
 extern s32 clamp_mix(s32 x, u8 bitshift = 0);
 
 extern StereoOut32 clamp_mix(const StereoOut32& sample, u8 bitshift = 0);
@@ -0,0 +1,121 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Global.h"
+
+#include <atomic>
+
+// Output ring between the mixer (core thread) and the frontend.  Mix() writes one frame per
+// tick, SndOutDrain hands what was buffered to the batch callback once per video frame.
+//
+// With the dynamic rate on, the drain outputs a steady number of frames per video frame and
+// keeps about two video frames of audio buffered.  The frames are resampled (linear) by up
+// to MaxRateDelta to hold that level when the emulation runs a bit faster or slower than
+// the host, so the frontend doesn't have to stall on the audio.
+
+static const u32 RingSize = 16384; // frames, power of two
+static const double MaxRateDelta = 0.005;
+
+static StereoOut16 s_ring[RingSize];
+static std::atomic<u32> s_write(0);
+static std::atomic<u32> s_read(0);
+
+// drain side
+static StereoOut16 s_batch[RingSize];
+static bool s_dynamic_rate = false;
+static double s_position = 0; // resampler position, in frames after s_read
+static double s_frames = 0;   // fraction of a frame left from the previous drain
+
+void SndOutWrite(s16 left, s16 right)
+{
+	const u32 write = s_write.load(std::memory_order_relaxed);
+
+	// Nobody drains (the frontend is paused or fast forwarding without audio)
+	if (write - s_read.load(std::memory_order_acquire) >= RingSize)
+		return;
+
+	s_ring[write & (RingSize - 1)] = StereoOut16(left, right);
+	s_write.store(write + 1, std::memory_order_release);
+}
+
+void SndOutSetDynamicRate(bool enable)
+{
+	s_dynamic_rate = enable;
+}
+
+void SndOutDrain(retro_audio_sample_batch_t batch, double framesPerRun)
+{
+	u32 read = s_read.load(std::memory_order_relaxed);
+	u32 avail = s_write.load(std::memory_order_acquire) - read;
+	u32 count = 0;
+
+	if (!s_dynamic_rate || framesPerRun <= 0)
+	{
+		for (; count < avail; count++)
+			s_batch[count] = s_ring[(read + count) & (RingSize - 1)];
+
+		read += avail;
+		s_position = 0;
+		s_frames = 0;
+	}
+	else
+	{
+		const double target = 2 * framesPerRun;
+
+		// Way behind (the frontend was paused), skip to the target latency
+		if (avail > 4 * target)
+		{
+			read += avail - (u32)target;
+			avail = (u32)target;
+			s_position = 0;
+		}
+
+		const double ratio = 1.0 + MaxRateDelta * std::max(-1.0, std::min(1.0, (avail - target) / target));
+
+		s_frames += framesPerRun;
+		const u32 wanted = (u32)s_frames;
+		s_frames -= wanted;
+
+		// the interpolation reads the next frame too
+		while (count < wanted && s_position + 1 < avail)
+		{
+			const u32 i = (u32)s_position;
+			const double frac = s_position - i;
+			const StereoOut16& a = s_ring[(read + i) & (RingSize - 1)];
+			const StereoOut16& b = s_ring[(read + i + 1) & (RingSize - 1)];
+
+			s_batch[count++] = StereoOut16(
+				(s16)(a.Left + (b.Left - a.Left) * frac),
+				(s16)(a.Right + (b.Right - a.Right) * frac));
+
+			s_position += ratio;
+		}
+
+		const u32 consumed = (u32)s_position;
+		read += consumed;
+		s_position -= consumed;
+	}
+
+	s_read.store(read, std::memory_order_release);
+
+	for (u32 done = 0; done < count;)
+	{
+		const size_t written = batch((const int16_t*)&s_batch[done], count - done);
+		if (written == 0)
+			break;
+		done += written;
+	}
+}
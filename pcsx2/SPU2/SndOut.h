@@ -27,6 +27,12 @@
 #define SndOutVolumeShift 12
 #define SndOutVolumeShift32 4 // shift up, not down, (formula = 16 - SndOutVolumeShift)
 
+// Output ring, see SndOut.cpp.  SndOutWrite is called by the mixer, SndOutDrain by the
+// frontend once per video frame (framesPerRun is the sample rate divided by the frame rate).
+extern void SndOutWrite(s16 left, s16 right);
+extern void SndOutDrain(retro_audio_sample_batch_t batch, double framesPerRun);
+extern void SndOutSetDynamicRate(bool enable);
+
 struct Stereo51Out16DplII;
 struct Stereo51Out32DplII;
 
@@ -0,0 +1,186 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Global.h"
+#include "Trace.h"
+
+SPU2Trace::SPU2Trace(const std::string& fn, u32 samples)
+	: m_start(Cycles)
+	, m_samples(samples)
+{
+	// fast compression level, the trace is written while the game runs
+	m_gz = gzopen(fn.c_str(), "wb1");
+
+	if (m_gz == nullptr)
+		return;
+
+	const u32 size = SPU2Savestate::SizeIt();
+	ScopedAlloc<u8> state(size);
+
+	SPU2Savestate::FreezeIt((SPU2Savestate::DataBlock&)*state.GetPtr());
+
+	Append(&SPU2TraceMagic, 4);
+	Append(&size, 4);
+	Append(state.GetPtr(), size);
+}
+
+SPU2Trace::~SPU2Trace()
+{
+	if (m_gz)
+		gzclose(m_gz);
+}
+
+void SPU2Trace::Append(const void* data, u32 size)
+{
+	if (m_gz == nullptr || size == 0)
+		return;
+
+	if (gzwrite(m_gz, data, size) != (int)size)
+	{
+		gzclose(m_gz);
+
+		m_gz = nullptr;
+	}
+}
+
+void SPU2Trace::Append(SPU2TraceType type, u32 cycle)
+{
+	Append(&type, 1);
+	Append(&cycle, 4);
+}
+
+bool SPU2Trace::IsDone() const
+{
+	return m_gz == nullptr || Cycles - m_start >= m_samples;
+}
+
+void SPU2Trace::Update(u32 cycle)
+{
+	Append(SPU2TraceType::Update, cycle);
+}
+
+void SPU2Trace::Write(u32 cycle, u32 addr, u16 value)
+{
+	Append(SPU2TraceType::Write, cycle);
+	Append(&addr, 4);
+	Append(&value, 2);
+}
+
+void SPU2Trace::Read(u32 cycle, u32 addr)
+{
+	Append(SPU2TraceType::Read, cycle);
+	Append(&addr, 4);
+}
+
+void SPU2Trace::DmaWrite(u32 cycle, int core, const u16* data, u32 size)
+{
+	const u8 c = core;
+
+	Append(SPU2TraceType::DmaWrite, cycle);
+	Append(&c, 1);
+	Append(&size, 4);
+	Append(data, size * 2);
+}
+
+void SPU2Trace::DmaRead(u32 cycle, int core, u32 size)
+{
+	const u8 c = core;
+
+	Append(SPU2TraceType::DmaRead, cycle);
+	Append(&c, 1);
+	Append(&size, 4);
+}
+
+//
+
+bool SPU2TraceFile::Load(const std::string& fn)
+{
+	gzFile gz = gzopen(fn.c_str(), "rb");
+
+	if (gz == nullptr)
+		return false;
+
+	auto read = [gz](void* dst, u32 size) -> bool {
+		return size == 0 || gzread(gz, dst, size) == (int)size;
+	};
+
+	u32 magic = 0;
+	u32 size = 0;
+
+	bool ok = read(&magic, 4) && magic == SPU2TraceMagic && read(&size, 4);
+
+	if (ok)
+	{
+		m_state.resize(size);
+
+		ok = read(m_state.data(), size);
+	}
+
+	u8 type;
+
+	while (ok && gzread(gz, &type, 1) == 1)
+	{
+		Event e = {};
+
+		e.type = (SPU2TraceType)type;
+
+		if (!read(&e.cycle, 4))
+		{
+			ok = false;
+			break;
+		}
+
+		switch (e.type)
+		{
+			case SPU2TraceType::Update:
+				break;
+			case SPU2TraceType::Write:
+			{
+				u16 value;
+				ok = read(&e.addr, 4) && read(&value, 2);
+				e.value = value;
+				break;
+			}
+			case SPU2TraceType::Read:
+				ok = read(&e.addr, 4);
+				break;
+			case SPU2TraceType::DmaWrite:
+				ok = read(&e.core, 1) && read(&e.value, 4);
+				if (ok)
+				{
+					e.offset = m_data.size();
+					m_data.resize(e.offset + e.value);
+					ok = read(&m_data[e.offset], e.value * 2);
+				}
+				break;
+			case SPU2TraceType::DmaRead:
+				ok = read(&e.core, 1) && read(&e.value, 4);
+				break;
+			default:
+				ok = false;
+				break;
+		}
+
+		if (ok)
+			m_events.push_back(e);
+	}
+
+	ok = ok && gzeof(gz);
+
+	gzclose(gz);
+
+	return ok;
+}
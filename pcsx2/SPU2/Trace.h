@@ -0,0 +1,102 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <zlib.h>
+#include <string>
+#include <vector>
+
+/*
+
+SPU2 trace, a recording of everything the IOP asked of the SPU2, used to replay the mixer
+outside of the emulator (see MixBench.cpp).
+
+Trace file format (gzip compressed):
+- [magic/4] [state size/4] [state data/size] [id/1] [cycle/4] [data/?] .. [id/1] [cycle/4] [data/?]
+
+The state is an SPU2 savestate, so a trace only replays on the build that recorded it.
+
+Update (id == 0)
+- none
+
+Write (id == 1)
+- [addr/4] [value/2]
+
+Read (id == 2)
+- [addr/4]
+
+DmaWrite (id == 3)
+- [core/1] [size/4] [data/size*2]
+
+DmaRead (id == 4)
+- [core/1] [size/4]
+
+*/
+
+enum class SPU2TraceType : u8
+{
+	Update,
+	Write,
+	Read,
+	DmaWrite,
+	DmaRead,
+};
+
+static const u32 SPU2TraceMagic = 0x52543253; // "S2TR"
+
+class SPU2Trace
+{
+	gzFile m_gz;
+	u32 m_start;
+	u32 m_samples;
+
+	void Append(const void* data, u32 size);
+	void Append(SPU2TraceType type, u32 cycle);
+
+public:
+	SPU2Trace(const std::string& fn, u32 samples);
+	~SPU2Trace();
+
+	bool IsOpen() const { return m_gz != nullptr; }
+	bool IsDone() const; // the requested samples have been mixed, or a write failed
+
+	void Update(u32 cycle);
+	void Write(u32 cycle, u32 addr, u16 value);
+	void Read(u32 cycle, u32 addr);
+	void DmaWrite(u32 cycle, int core, const u16* data, u32 size);
+	void DmaRead(u32 cycle, int core, u32 size);
+};
+
+class SPU2TraceFile
+{
+public:
+	struct Event
+	{
+		SPU2TraceType type;
+		u8 core;
+		u32 cycle;
+		u32 addr;   // Write, Read
+		u32 value;  // Write, or the size of a DMA in 16 bit words
+		size_t offset; // DmaWrite data, into m_data
+	};
+
+	std::vector<u8> m_state;
+	std::vector<u16> m_data;
+	std::vector<Event> m_events;
+
+public:
+	bool Load(const std::string& fn);
+};
@@ -48,6 +48,11 @@ struct V_VolumeLR
 	}
 };
 
+#define VOLFLAG_REVERSE_PHASE (1ul << 0)
+#define VOLFLAG_DECREMENT (1ul << 1)
+#define VOLFLAG_EXPONENTIAL (1ul << 2)
+#define VOLFLAG_SLIDE_ENABLE (1ul << 3)
+
 struct V_VolumeSlide
 {
 	// Holds the "original" value of the volume for this voice, prior to slides.
@@ -90,6 +95,12 @@ public:
 		Left.Update();
 		Right.Update();
 	}
+
+	// Update() does nothing unless a slide is enabled, which only a register write does
+	bool IsSliding() const
+	{
+		return ((Left.Mode | Right.Mode) & VOLFLAG_SLIDE_ENABLE) != 0;
+	}
 };
 
 struct V_ADSR
@@ -480,6 +491,7 @@ extern u32 Cycles;
 
 extern int PlayMode;
 
+extern bool has_to_call_irq;
 extern void SetIrqCall(int core);
 extern void InitADSR();
 
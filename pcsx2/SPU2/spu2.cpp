@@ -20,13 +20,28 @@
 #include "R3000A.h"
 #include "Utilities/pxStreams.h"
 #include "AppCoreThread.h"
-
-extern retro_audio_sample_t sample_cb;
+#include "Trace.h"
 
 int SampleRate = 48000;
 
 u32 lClocks = 0;
 
+static std::unique_ptr<SPU2Trace> s_trace;
+
+// Records the SPU2 activity of the next 'samples' ticks, see Trace.h.
+s32 SPU2startTrace(const char* filename, u32 samples)
+{
+	s_trace.reset(new SPU2Trace(filename, samples));
+
+	if (!s_trace->IsOpen())
+	{
+		s_trace.reset();
+		return -1;
+	}
+
+	return 0;
+}
+
 // --------------------------------------------------------------------------------------
 //  DMA 4/7 Callbacks from Core Emulator
 // --------------------------------------------------------------------------------------
@@ -42,6 +57,9 @@ void SPU2WriteMemAddr(int core, u32 value)
 
 void SPU2readDMA4Mem(u16* pMem, u32 size) // size now in 16bit units
 {
+	if (s_trace)
+		s_trace->DmaRead(psxRegs.cycle, 0, size);
+
 	TimeUpdate(psxRegs.cycle);
 
 	Cores[0].DoDMAread(pMem, size);
@@ -49,6 +67,9 @@ void SPU2readDMA4Mem(u16* pMem, u32 size) // size now in 16bit units
 
 void SPU2writeDMA4Mem(u16* pMem, u32 size) // size now in 16bit units
 {
+	if (s_trace)
+		s_trace->DmaWrite(psxRegs.cycle, 0, pMem, size);
+
 	TimeUpdate(psxRegs.cycle);
 
 	Cores[0].DoDMAwrite(pMem, size);
@@ -68,6 +89,9 @@ void SPU2interruptDMA7()
 
 void SPU2readDMA7Mem(u16* pMem, u32 size)
 {
+	if (s_trace)
+		s_trace->DmaRead(psxRegs.cycle, 1, size);
+
 	TimeUpdate(psxRegs.cycle);
 
 	Cores[1].DoDMAread(pMem, size);
@@ -75,6 +99,9 @@ void SPU2readDMA7Mem(u16* pMem, u32 size)
 
 void SPU2writeDMA7Mem(u16* pMem, u32 size)
 {
+	if (s_trace)
+		s_trace->DmaWrite(psxRegs.cycle, 1, pMem, size);
+
 	TimeUpdate(psxRegs.cycle);
 
 	Cores[1].DoDMAwrite(pMem, size);
@@ -170,6 +197,8 @@ void SPU2shutdown()
 {
 	SPU2close();
 
+	s_trace.reset();
+
 	safe_free(spu2regs);
 	safe_free(_spu2mem);
 	safe_free(pcm_cache_data);
@@ -177,6 +206,14 @@ void SPU2shutdown()
 
 void SPU2async(u32 cycles)
 {
+	if (s_trace)
+	{
+		if (s_trace->IsDone())
+			s_trace.reset();
+		else
+			s_trace->Update(psxRegs.cycle);
+	}
+
 	TimeUpdate(psxRegs.cycle);
 }
 
@@ -189,6 +226,9 @@ u16 SPU2read(u32 rmem)
 		core = 1;
 	}
 
+	if (s_trace)
+		s_trace->Read(psxRegs.cycle, rmem);
+
 	if (omem == 0x1f9001AC)
 		return Cores[core].DmaRead();
 
@@ -207,6 +247,9 @@ void SPU2write(u32 rmem, u16 value)
 	// If the SPU2 isn't in in sync with the IOP, samples can end up playing at rather
 	// incorrect pitches and loop lengths.
 
+	if (s_trace)
+		s_trace->Write(psxRegs.cycle, rmem, value);
+
 	TimeUpdate(psxRegs.cycle);
 
 	if (rmem >> 16 == 0x1f80)
@@ -31,6 +31,7 @@ s32 SPU2freeze(int mode, freezeData* data);
 void SPU2DoFreezeIn(pxInputStream& infp);
 void SPU2DoFreezeOut(void* dest);
 void SPU2configure();
+s32 SPU2startTrace(const char* filename, u32 samples);
 
 
 u32 SPU2ReadMemAddr(int core);
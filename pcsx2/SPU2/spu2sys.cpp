@@ -269,6 +269,51 @@ void V_Voice::Stop(void)
 #define TickInterval 768
 #define SanityInterval 4800
 
+static __forceinline void UpdateTick()
+{
+	if (has_to_call_irq)
+	{
+		has_to_call_irq = false;
+		spu2Irq();
+	}
+
+	//Update DMA4 interrupt delay counter
+	if (Cores[0].DMAICounter > 0)
+	{
+		Cores[0].DMAICounter -= TickInterval;
+		if (Cores[0].DMAICounter <= 0)
+		{
+			if (Cores[0].IsDMARead)
+				Cores[0].FinishDMAread();
+
+			Cores[0].MADR = Cores[0].TADR;
+			Cores[0].DMAICounter = 0;
+			spu2DMA4Irq();
+		}
+		else
+		{
+			Cores[0].MADR += TickInterval << 1;
+		}
+	}
+
+	//Update DMA7 interrupt delay counter
+	if (Cores[1].DMAICounter > 0)
+	{
+		Cores[1].DMAICounter -= TickInterval;
+		if (Cores[1].DMAICounter <= 0)
+		{
+			if (Cores[1].IsDMARead)
+				Cores[1].FinishDMAread();
+
+			Cores[1].MADR = Cores[1].TADR;
+			Cores[1].DMAICounter = 0;
+			spu2DMA7Irq();
+		}
+		else
+			Cores[1].MADR += TickInterval << 1;
+	}
+}
+
 __forceinline void TimeUpdate(u32 cClocks)
 {
 	u32 dClocks = cClocks - lClocks;
@@ -292,53 +337,23 @@ __forceinline void TimeUpdate(u32 cClocks)
 	//Update Mixing Progress
 	while (dClocks >= TickInterval)
 	{
-		if (has_to_call_irq)
-		{
-			has_to_call_irq = false;
-			spu2Irq();
-		}
+		// Mix the voices of as many ticks as possible in one go, the rest of each
+		// tick still runs in order below.
+		const uint block = MixVoiceBlock(dClocks / TickInterval);
 
-		//Update DMA4 interrupt delay counter
-		if (Cores[0].DMAICounter > 0)
+		for (uint sample = 0; sample < std::max(block, 1u); sample++)
 		{
-			Cores[0].DMAICounter -= TickInterval;
-			if (Cores[0].DMAICounter <= 0)
-			{
-				if (Cores[0].IsDMARead)
-					Cores[0].FinishDMAread();
-
-				Cores[0].MADR = Cores[0].TADR;
-				Cores[0].DMAICounter = 0;
-				spu2DMA4Irq();
-			}
-			else
-			{
-				Cores[0].MADR += TickInterval << 1;
-			}
-		}
+			UpdateTick();
 
-		//Update DMA7 interrupt delay counter
-		if (Cores[1].DMAICounter > 0)
-		{
-			Cores[1].DMAICounter -= TickInterval;
-			if (Cores[1].DMAICounter <= 0)
-			{
-				if (Cores[1].IsDMARead)
-					Cores[1].FinishDMAread();
+			dClocks -= TickInterval;
+			lClocks += TickInterval;
+			Cycles++;
 
-				Cores[1].MADR = Cores[1].TADR;
-				Cores[1].DMAICounter = 0;
-				spu2DMA7Irq();
-			}
+			if (block)
+				MixBlockSample(sample);
 			else
-				Cores[1].MADR += TickInterval << 1;
+				Mix();
 		}
-
-		dClocks -= TickInterval;
-		lClocks += TickInterval;
-		Cycles++;
-
-		Mix();
 	}
 }
 
@@ -283,3 +283,96 @@ void memLoadingState::FreezeMem( void* data, int size )
 	m_idx += size;
 	memcpy( data, src, size );
 }
+
+// --------------------------------------------------------------------------------------
+//  memDeltaSavingState / memDeltaLoadingState  (implementations)
+// --------------------------------------------------------------------------------------
+static __fi bool IsDeltaBlock( const VmStateBuffer& keyframe, int keyidx, int size )
+{
+	return (size >= DeltaPageSize) && (keyidx + size <= keyframe.GetSizeInBytes());
+}
+
+memDeltaSavingState::memDeltaSavingState( VmStateBuffer& save_to, const VmStateBuffer& keyframe )
+	: memSavingState( save_to )
+	, m_keyframe( keyframe )
+{
+	m_keyidx = 0;
+}
+
+// Layout of a delta block: one bit per page (set if the page differs from the keyframe),
+// followed by the contents of each flagged page in ascending order.
+void memDeltaSavingState::FreezeMem( void* data, int size )
+{
+	if (!IsDeltaBlock( m_keyframe, m_keyidx, size ))
+	{
+		_parent::FreezeMem( data, size );
+		m_keyidx += size;
+		return;
+	}
+
+	const u8* src	= (const u8*)data;
+	const u8* key	= m_keyframe.GetPtr( m_keyidx );
+	const int pages	= (size + DeltaPageSize - 1) / DeltaPageSize;
+	const int maplen	= (pages + 7) / 8;
+	const int mapidx	= m_idx;
+
+	m_memory->MakeRoomFor( m_idx + maplen );
+	memset( m_memory->GetPtr( mapidx ), 0, maplen );
+	m_idx += maplen;
+
+	for (int page = 0; page < pages; ++page)
+	{
+		const int offset = page * DeltaPageSize;
+		const int len = std::min( DeltaPageSize, size - offset );
+
+		if (memcmp( src + offset, key + offset, len ) == 0) continue;
+
+		// note: MakeRoomFor can reallocate, so the bitmap is always addressed through m_memory.
+		m_memory->MakeRoomFor( m_idx + len );
+		m_memory->GetPtr( mapidx )[page >> 3] |= 1 << (page & 7);
+		memcpy( m_memory->GetPtr( m_idx ), src + offset, len );
+		m_idx += len;
+	}
+
+	m_keyidx += size;
+}
+
+memDeltaLoadingState::memDeltaLoadingState( const VmStateBuffer& load_from, const VmStateBuffer& keyframe )
+	: memLoadingState( load_from )
+	, m_keyframe( keyframe )
+{
+	m_keyidx = 0;
+}
+
+void memDeltaLoadingState::FreezeMem( void* data, int size )
+{
+	if (!IsDeltaBlock( m_keyframe, m_keyidx, size ))
+	{
+		_parent::FreezeMem( data, size );
+		m_keyidx += size;
+		return;
+	}
+
+	u8* dest		= (u8*)data;
+	const u8* key	= m_keyframe.GetPtr( m_keyidx );
+	const u8* map	= m_memory->GetPtr( m_idx );
+	const int pages	= (size + DeltaPageSize - 1) / DeltaPageSize;
+
+	m_idx += (pages + 7) / 8;
+
+	for (int page = 0; page < pages; ++page)
+	{
+		const int offset = page * DeltaPageSize;
+		const int len = std::min( DeltaPageSize, size - offset );
+
+		if (map[page >> 3] & (1 << (page & 7)))
+		{
+			memcpy( dest + offset, m_memory->GetPtr( m_idx ), len );
+			m_idx += len;
+		}
+		else
+			memcpy( dest + offset, key + offset, len );
+	}
+
+	m_keyidx += size;
+}
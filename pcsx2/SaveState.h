@@ -199,3 +199,45 @@ public:
 	bool IsFinished() const { return m_idx >= m_memory->GetSizeInBytes(); }
 };
 
+// --------------------------------------------------------------------------------------
+//  Delta (keyframe-relative) memory states
+// --------------------------------------------------------------------------------------
+// Delta states are uncompressed memory states that are only meaningful alongside a keyframe:
+// a regular memSavingState image of the same machine.  Blocks of at least DeltaPageSize bytes
+// (main memory, VU memory, the GS local memory dump, ...) are compared page by page against
+// the matching block of the keyframe, and only a bitmap of the pages that differ plus the
+// pages themselves are stored.  Smaller blocks are stored verbatim.  The keyframe is never
+// modified by either class, so any number of delta states may be taken against it.
+//
+static const int DeltaPageSize = __pagesize;
+
+class memDeltaSavingState : public memSavingState
+{
+	typedef memSavingState _parent;
+
+protected:
+	const VmStateBuffer& m_keyframe;
+	int m_keyidx;		// read index into the keyframe (mirrors m_idx of a full state)
+
+public:
+	virtual ~memDeltaSavingState() = default;
+	memDeltaSavingState( VmStateBuffer& save_to, const VmStateBuffer& keyframe );
+
+	void FreezeMem( void* data, int size );
+};
+
+class memDeltaLoadingState : public memLoadingState
+{
+	typedef memLoadingState _parent;
+
+protected:
+	const VmStateBuffer& m_keyframe;
+	int m_keyidx;
+
+public:
+	virtual ~memDeltaLoadingState() = default;
+	memDeltaLoadingState( const VmStateBuffer& load_from, const VmStateBuffer& keyframe );
+
+	void FreezeMem( void* data, int size );
+};
+
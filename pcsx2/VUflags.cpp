@@ -101,5 +101,6 @@ __ri void VU_STAT_UPDATE(VURegs * VU)
 	if (VU->macflag & 0x00F0) newflag |= 0x2;
 	if (VU->macflag & 0x0F00) newflag |= 0x4;
 	if (VU->macflag & 0xF000) newflag |= 0x8;
-	VU->statusflag = (VU->statusflag&0xc30)|newflag|((VU->statusflag&0xf)<<6);
+	// The sticky bits keep every flag set since the last FSSET
+	VU->statusflag = (VU->statusflag&0xff0)|newflag|(newflag<<6);
 }
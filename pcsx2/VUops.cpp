@@ -1296,6 +1296,7 @@ static __fi void _vuOPMULA(VURegs * VU) {
 	VU->ACC.i.x = VU_MACx_UPDATE(VU, vuDouble(VU->VF[_Fs_].i.y) * vuDouble(VU->VF[_Ft_].i.z));
 	VU->ACC.i.y = VU_MACy_UPDATE(VU, vuDouble(VU->VF[_Fs_].i.z) * vuDouble(VU->VF[_Ft_].i.x));
 	VU->ACC.i.z = VU_MACz_UPDATE(VU, vuDouble(VU->VF[_Fs_].i.x) * vuDouble(VU->VF[_Ft_].i.y));
+	VU_MACw_CLEAR(VU);
 	VU_STAT_UPDATE(VU);
 }
 
@@ -1317,6 +1318,7 @@ static __fi void _vuOPMSUB(VURegs * VU) {
 	dst->i.x = VU_MACx_UPDATE(VU, vuDouble(VU->ACC.i.x) - fsy * ftz);
 	dst->i.y = VU_MACy_UPDATE(VU, vuDouble(VU->ACC.i.y) - fsz * ftx);
 	dst->i.z = VU_MACz_UPDATE(VU, vuDouble(VU->ACC.i.z) - fsx * fty);
+	VU_MACw_CLEAR(VU);
 	VU_STAT_UPDATE(VU);
 }
 
@@ -1417,14 +1419,15 @@ static __fi void _vuDIV(VURegs * VU) {
 	float ft = vuDouble(VU->VF[_Ft_].UL[_Ftf_]);
 	float fs = vuDouble(VU->VF[_Fs_].UL[_Fsf_]);
 
+	// I and D are set by each division, IS and DS stay set
 	VU->statusflag &= ~0x30;
 
 	if (ft == 0.0)
 	{
 		if (fs == 0.0)
-			VU->statusflag |= 0x10;
+			VU->statusflag |= 0x410;
 		else
-			VU->statusflag |= 0x20;
+			VU->statusflag |= 0x820;
 		if ((VU->VF[_Ft_].UL[_Ftf_] & 0x80000000) ^
 				(VU->VF[_Fs_].UL[_Fsf_] & 0x80000000))
 			VU->q.UL = 0xFF7FFFFF;
@@ -1445,7 +1448,7 @@ static __fi void _vuSQRT(VURegs * VU)
 	VU->statusflag &= ~0x30;
 
 	if (ft < 0.0 )
-		VU->statusflag |= 0x10;
+		VU->statusflag |= 0x410;
 	VU->q.F = sqrt(fabs(ft));
 	VU->q.F = vuDouble(VU->q.UL);
 }
@@ -1459,32 +1462,21 @@ static __fi void _vuRSQRT(VURegs * VU) {
 
 	if ( ft == 0.0 )
 	{
-		VU->statusflag |= 0x20;
-
-		if( fs != 0 )
-		{
-			if ((VU->VF[_Ft_].UL[_Ftf_] & 0x80000000) ^
-					(VU->VF[_Fs_].UL[_Fsf_] & 0x80000000))
-				VU->q.UL = 0xFF7FFFFF;
-			else
-				VU->q.UL = 0x7F7FFFFF;
-		}
+		// As DIV, 0/0 is invalid rather than a division by zero
+		if (fs == 0.0)
+			VU->statusflag |= 0x410;
 		else
-		{
-			if ((VU->VF[_Ft_].UL[_Ftf_] & 0x80000000) ^
-					(VU->VF[_Fs_].UL[_Fsf_] & 0x80000000))
-				VU->q.UL = 0x80000000;
-			else
-				VU->q.UL = 0;
-
-			VU->statusflag |= 0x10;
-		}
-
+			VU->statusflag |= 0x820;
+		if ((VU->VF[_Ft_].UL[_Ftf_] & 0x80000000) ^
+				(VU->VF[_Fs_].UL[_Fsf_] & 0x80000000))
+			VU->q.UL = 0xFF7FFFFF;
+		else
+			VU->q.UL = 0x7F7FFFFF;
 	}
 	else
 	{
 		if (ft < 0.0)
-			VU->statusflag |= 0x10;
+			VU->statusflag |= 0x410;
 
 		temp = sqrt(fabs(ft));
 		VU->q.F = fs / temp;
@@ -1797,8 +1789,9 @@ static __ri void _vuRGET(VURegs * VU) {
 }
 
 static __ri void _vuRNEXT(VURegs * VU) {
-	if (_Ft_ == 0) return;
+	// R moves on even when the result goes to VF00
 	AdvanceLFSR(VU);
+	if (_Ft_ == 0) return;
 	if (_X) VU->VF[_Ft_].UL[0] = VU->VI[REG_R].UL;
 	if (_Y) VU->VF[_Ft_].UL[1] = VU->VI[REG_R].UL;
 	if (_Z) VU->VF[_Ft_].UL[2] = VU->VI[REG_R].UL;
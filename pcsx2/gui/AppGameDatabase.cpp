@@ -18,9 +18,15 @@
 #include "App.h"
 #include "AppGameDatabase.h"
 #include "GameIndex.h"
+#include "GameIndexBin.h"
 
 AppGameDatabase& AppGameDatabase::Load()
 {
+	// Empty when the build couldn't run gameindex2bin (cross compiling)
+	useBinaryDb = GameIndex_bin_len && binaryDb.initDatabase(GameIndex_bin, GameIndex_bin_len);
+	if (useBinaryDb)
+		return *this;
+
 	std::string game_index(reinterpret_cast<const char*>(&GameIndex_yaml), GameIndex_yaml_len);
 	std::istringstream stream(game_index);
 	if (!this->initDatabase(stream))
@@ -28,6 +34,14 @@ AppGameDatabase& AppGameDatabase::Load()
 	return *this;
 }
 
+GameDatabaseSchema::GameEntry AppGameDatabase::findGame(const std::string serial)
+{
+	if (useBinaryDb)
+		return binaryDb.findGame(serial);
+
+	return YamlGameDatabaseImpl::findGame(serial);
+}
+
 AppGameDatabase* Pcsx2App::GetGameDatabase()
 {
 	pxAppResources& res(GetResourceCache());
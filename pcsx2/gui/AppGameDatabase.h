@@ -33,6 +33,13 @@ public:
 	}
 
 	AppGameDatabase& Load();
+
+	GameDatabaseSchema::GameEntry findGame(const std::string serial) override;
+
+private:
+	// Built with the core, GameIndex.yaml is only parsed when the table can't be used
+	BinaryGameDatabaseImpl binaryDb;
+	bool useBinaryDb = false;
 };
 
 static wxString compatToStringWX(GameDatabaseSchema::Compatibility compat)
@@ -24,7 +24,12 @@
 #include "svnrev.h"
 
 #include <wx/ffile.h>
+#include <chrono>
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include  "options_tools.h"
 
 static const int MCD_SIZE = 1024 * 8 * 16; // Legacy PSX card default size
@@ -142,11 +147,16 @@ static bool ConvertRAWtoNoECC(wxString file_in, wxString file_out)
 // --------------------------------------------------------------------------------------
 //  FileMemoryCard
 // --------------------------------------------------------------------------------------
-// Provides thread-safe direct file IO mapping.
+// Keeps every opened card image in memory.  The SIO path only touches the images, the
+// changed pages are written back by a writer thread once the game stops saving for a
+// moment (or after a few seconds of continuous writes), and synchronously by Flush and
+// on Close.
 //
 class FileMemoryCard
 {
 protected:
+	static const u32 PageShift = 12; // dirty tracking granularity (4k)
+
 	wxFFile m_file[8];
 	u8 m_effeffs[528 * 16];
 	SafeArray<u8> m_currentdata;
@@ -154,15 +164,33 @@ protected:
 	bool m_ispsx[8];
 	u32 m_chkaddr;
 
+	std::vector<u8> m_image[8];  // the whole file
+	std::vector<u64> m_dirty[8]; // one bit per page of m_image
+	u32 m_offset[8];             // header size, see Seek
+	u32 m_crcsize[8];            // bytes covered by the PSX checksum
+	u64 m_psxcrc[8];
+
+	// m_mutex guards the dirty bitmaps and the image writes (the writer thread reads
+	// the images), m_io_mutex orders the flushes so older data never lands last.
+	std::mutex m_mutex;
+	std::mutex m_io_mutex;
+	std::condition_variable m_cond;
+	std::thread m_writer;
+	bool m_quit;
+	bool m_pending;
+	std::chrono::steady_clock::time_point m_first_write;
+	std::chrono::steady_clock::time_point m_last_write;
+
 public:
 	FileMemoryCard();
-	virtual ~FileMemoryCard() = default;
+	virtual ~FileMemoryCard();
 
 	void Lock();
 	void Unlock();
 
 	void Open();
 	void Close();
+	void Flush();
 
 	s32 IsPresent(uint slot);
 	void GetSizeInfo(uint slot, McdSizeInfo& outways);
@@ -173,8 +201,14 @@ public:
 	u64 GetCRC(uint slot);
 
 protected:
-	bool Seek(wxFFile& f, u32 adr);
+	u32 GetOffset(u32 size) const;
 	bool Create(const wxString& mcdFile, uint sizeInMB);
+	bool Load(uint slot);
+
+	u8* Map(uint slot, u32 adr, u32 size);
+	void XorPSXCRC(uint slot, u32 pos, u32 size);
+	void MarkDirty(uint slot, u32 pos, u32 size);
+	void WriterThread();
 
 	wxString GetDisabledMessage(uint slot) const
 	{
@@ -245,12 +279,22 @@ FileMemoryCard::FileMemoryCard()
 {
 	memset8<0xff>(m_effeffs);
 	m_chkaddr = 0;
+	m_quit = false;
+	m_pending = false;
+}
+
+FileMemoryCard::~FileMemoryCard()
+{
+	Close();
 }
 
 void FileMemoryCard::Open()
 {
 	for (int slot = 0; slot < 8; ++slot)
 	{
+		// Resuming from a pause opens the cards again, keep the loaded images
+		if (m_file[slot].IsOpened())
+			continue;
 
 		if (FileMcd_IsMultitapSlot(slot))
 		{
@@ -327,29 +371,59 @@ void FileMemoryCard::Open()
 					wxsFormat("Access denied to memory card: \n\n%s\n\n %s\n", str.c_str(), GetDisabledMessage(slot).c_str()).c_str()
 			      );
 		}
-		else // Load checksum
+		else if (!Load(slot))
 		{
-			m_ispsx[slot] = m_file[slot].Length() == 0x20000;
-			m_chkaddr = 0x210;
+			log_cb(RETRO_LOG_ERROR,
+					wxsFormat("Could not read memory card: \n\n%s\n\n %s\n", str.c_str(), GetDisabledMessage(slot).c_str()).c_str()
+			      );
+			m_file[slot].Close();
+		}
+	}
 
-			if (!m_ispsx[slot] && !!m_file[slot].Seek(m_chkaddr))
-				m_file[slot].Read(&m_chksum[slot], 8);
+	for (int slot = 0; slot < 8; ++slot)
+	{
+		if (m_file[slot].IsOpened() && !m_writer.joinable())
+		{
+			m_quit = false;
+			m_writer = std::thread(&FileMemoryCard::WriterThread, this);
 		}
 	}
 }
 
 void FileMemoryCard::Close()
 {
+	if (m_writer.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_cond.notify_one();
+		m_writer.join();
+	}
+
 	for (int slot = 0; slot < 8; ++slot)
 	{
-		if (m_file[slot].IsOpened())
+		// Store checksum
+		if (m_file[slot].IsOpened() && !m_ispsx[slot] && m_image[slot].size() >= m_chkaddr + 8)
 		{
-			// Store checksum
-			if (!m_ispsx[slot] && !!m_file[slot].Seek(m_chkaddr))
-				m_file[slot].Write(&m_chksum[slot], 8);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			memcpy(&m_image[slot][m_chkaddr], &m_chksum[slot], 8);
+			MarkDirty(slot, m_chkaddr, 8);
+		}
+	}
 
+	Flush();
+
+	for (int slot = 0; slot < 8; ++slot)
+	{
+		if (m_file[slot].IsOpened())
+		{
 			m_file[slot].Close();
 
+			m_image[slot] = std::vector<u8>();
+			m_dirty[slot] = std::vector<u64>();
+
 			if (m_file[slot].GetName().EndsWith(".binx"))
 			{
 				wxString name = m_file[slot].GetName();
@@ -361,27 +435,210 @@ void FileMemoryCard::Close()
 	}
 }
 
-// Returns FALSE if the seek failed (is outside the bounds of the file).
-bool FileMemoryCard::Seek(wxFFile& f, u32 adr)
+// Writes the dirty pages of every card back to its file, adjacent pages in one go.
+void FileMemoryCard::Flush()
+{
+	struct Run
+	{
+		uint slot;
+		u32 pos;
+		std::vector<u8> data;
+	};
+
+	std::lock_guard<std::mutex> io_lock(m_io_mutex);
+	std::vector<Run> runs;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pending = false;
+
+		for (uint slot = 0; slot < 8; ++slot)
+		{
+			if (!m_file[slot].IsOpened())
+				continue;
+
+			std::vector<u64>& dirty = m_dirty[slot];
+			const u32 size = m_image[slot].size();
+			const u32 pages = (size + (1 << PageShift) - 1) >> PageShift;
+
+			for (u32 page = 0; page < pages;)
+			{
+				if (!dirty[page / 64])
+				{
+					page = (page | 63) + 1;
+					continue;
+				}
+
+				u32 end = page;
+				while (end < pages && (dirty[end / 64] & (1ull << (end % 64))))
+				{
+					dirty[end / 64] &= ~(1ull << (end % 64));
+					end++;
+				}
+
+				if (end != page)
+				{
+					const u32 pos = page << PageShift;
+					const u32 len = std::min(end << PageShift, size) - pos;
+					const u8* data = &m_image[slot][pos];
+					runs.push_back({slot, pos, std::vector<u8>(data, data + len)});
+				}
+
+				page = end + 1;
+			}
+		}
+	}
+
+	bool written[8] = {};
+
+	for (const Run& run : runs)
+	{
+		wxFFile& mcfp(m_file[run.slot]);
+
+		if (!mcfp.Seek(run.pos) || mcfp.Write(run.data.data(), run.data.size()) != run.data.size())
+			log_cb(RETRO_LOG_ERROR, "(FileMcd) Could not write %u bytes at %08X to the card in slot %u.\n", (u32)run.data.size(), run.pos, run.slot);
+
+		written[run.slot] = true;
+	}
+
+	for (uint slot = 0; slot < 8; ++slot)
+	{
+		if (!written[slot])
+			continue;
+
+		m_file[slot].Flush();
+
+		wxString name, ext;
+		wxFileName::SplitPath(m_file[slot].GetName(), NULL, NULL, &name, &ext);
+		log_cb(RETRO_LOG_INFO, "Memory Card %s written.\n", (const char*)(name + "." + ext).c_str());
+	}
+}
+
+void FileMemoryCard::WriterThread()
 {
-	const u32 size = f.Length();
+	// A save is a burst of sector writes, wait for the game to be done with the card
+	// (but don't hold the data back forever if it never is).
+	static const auto IdleDelay = std::chrono::milliseconds(500);
+	static const auto MaxDelay = std::chrono::seconds(5);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_quit)
+	{
+		if (!m_pending)
+		{
+			m_cond.wait(lock);
+			continue;
+		}
+
+		const auto deadline = std::min(m_last_write + IdleDelay, m_first_write + MaxDelay);
 
-	// If anyone knows why this filesize logic is here (it appears to be related to legacy PSX
-	// cards, perhaps hacked support for some special emulator-specific memcard formats that
-	// had header info?), then please replace this comment with something useful.  Thanks!  -- air
+		if (std::chrono::steady_clock::now() < deadline)
+		{
+			m_cond.wait_until(lock, deadline);
+			continue;
+		}
 
-	u32 offset = 0;
+		lock.unlock();
+		Flush();
+		lock.lock();
+	}
+}
 
+// If anyone knows why this filesize logic is here (it appears to be related to legacy PSX
+// cards, perhaps hacked support for some special emulator-specific memcard formats that
+// had header info?), then please replace this comment with something useful.  Thanks!  -- air
+u32 FileMemoryCard::GetOffset(u32 size) const
+{
 	if (size == MCD_SIZE + 64)
-		offset = 64;
-	else if (size == MCD_SIZE + 3904)
-		offset = 3904;
-	else
+		return 64;
+	if (size == MCD_SIZE + 3904)
+		return 3904;
+
+	return 0;
+}
+
+bool FileMemoryCard::Load(uint slot)
+{
+	wxFFile& mcfp(m_file[slot]);
+	const wxFileOffset length = mcfp.Length();
+
+	if (length <= 0 || length > 0x40000000)
+		return false;
+
+	const u32 size = (u32)length;
+
+	m_image[slot].resize(size);
+	if (!mcfp.Seek(0) || mcfp.Read(m_image[slot].data(), size) != size)
 	{
-		// perform sanity checks here?
+		m_image[slot] = std::vector<u8>();
+		return false;
 	}
 
-	return f.Seek(adr + offset);
+	const u32 pages = (size + (1 << PageShift) - 1) >> PageShift;
+	m_dirty[slot].assign((pages + 63) / 64, 0);
+	m_offset[slot] = GetOffset(size);
+
+	// Load checksum
+	m_ispsx[slot] = size == 0x20000;
+	m_chkaddr = 0x210;
+
+	if (!m_ispsx[slot] && size >= m_chkaddr + 8)
+		memcpy(&m_chksum[slot], &m_image[slot][m_chkaddr], 8);
+
+	// PSX cards are checksummed in 33792 byte chunks (528 * 64, 4k of u64), a partial
+	// chunk at the end isn't
+	m_crcsize[slot] = size - size % (528 * 64);
+	m_psxcrc[slot] = 0;
+	XorPSXCRC(slot, 0, m_crcsize[slot]);
+
+	return true;
+}
+
+// Returns the image bytes behind a card address, or NULL if they aren't all in the file.
+u8* FileMemoryCard::Map(uint slot, u32 adr, u32 size)
+{
+	const u64 pos = (u64)adr + m_offset[slot];
+
+	if (pos + size > m_image[slot].size())
+		return NULL;
+
+	return &m_image[slot][pos];
+}
+
+// Toggles the image words overlapping [pos, pos + size) in (or out of) the PSX checksum,
+// before and after a write, so GetCRC never has to go over the whole card.
+void FileMemoryCard::XorPSXCRC(uint slot, u32 pos, u32 size)
+{
+	if (!m_ispsx[slot])
+		return;
+
+	const u32 begin = pos & ~7;
+	const u32 end = std::min((pos + size + 7) & ~7, m_crcsize[slot]);
+
+	for (u32 i = begin; i < end; i += 8)
+		m_psxcrc[slot] ^= *(u64*)&m_image[slot][i];
+}
+
+// Must be called with m_mutex held.
+void FileMemoryCard::MarkDirty(uint slot, u32 pos, u32 size)
+{
+	if (size == 0)
+		return;
+
+	std::vector<u64>& dirty = m_dirty[slot];
+
+	for (u32 page = pos >> PageShift; page <= (pos + size - 1) >> PageShift; page++)
+		dirty[page / 64] |= 1ull << (page % 64);
+
+	m_last_write = std::chrono::steady_clock::now();
+
+	if (!m_pending)
+	{
+		m_pending = true;
+		m_first_write = m_last_write;
+		m_cond.notify_one();
+	}
 }
 
 // returns FALSE if an error occurred (either permission denied or disk full)
@@ -415,7 +672,7 @@ void FileMemoryCard::GetSizeInfo(uint slot, McdSizeInfo& outways)
 	outways.Xor = 18;                     // 0x12, XOR 02 00 00 10
 
 	if (pxAssert(m_file[slot].IsOpened()))
-		outways.McdSizeInSectors = m_file[slot].Length() / (outways.SectorSize + outways.EraseBlockSizeInSectors);
+		outways.McdSizeInSectors = m_image[slot].size() / (outways.SectorSize + outways.EraseBlockSizeInSectors);
 	else
 		outways.McdSizeInSectors = 0x4000;
 
@@ -430,41 +687,40 @@ bool FileMemoryCard::IsPSX(uint slot)
 
 s32 FileMemoryCard::Read(uint slot, u8* dest, u32 adr, int size)
 {
-	wxFFile& mcfp(m_file[slot]);
-	if (!mcfp.IsOpened())
+	if (!m_file[slot].IsOpened())
 	{
 		log_cb(RETRO_LOG_ERROR, "(FileMcd) Ignoring attempted read from disabled slot.\n");
 		memset(dest, 0, size);
 		return 1;
 	}
-	if (!Seek(mcfp, adr))
+
+	// No lock, the images are only modified on this thread
+	const u8* src = Map(slot, adr, size);
+	if (!src)
 		return 0;
-	return mcfp.Read(dest, size) != 0;
+
+	memcpy(dest, src, size);
+	return 1;
 }
 
 s32 FileMemoryCard::Save(uint slot, const u8* src, u32 adr, int size)
 {
-	wxFFile& mcfp(m_file[slot]);
-
-	if (!mcfp.IsOpened())
+	if (!m_file[slot].IsOpened())
 	{
 		log_cb(RETRO_LOG_ERROR, "(FileMcd) Ignoring attempted save/write to disabled slot.\n");
 		return 1;
 	}
 
-	if (m_ispsx[slot])
-	{
-		m_currentdata.MakeRoomFor(size);
-		for (int i = 0; i < size; i++)
-			m_currentdata[i] = src[i];
-	}
-	else
+	u8* dest = Map(slot, adr, size);
+	if (!dest)
+		return 0;
+
+	const u8* data = src;
+
+	if (!m_ispsx[slot])
 	{
-		if (!Seek(mcfp, adr))
-			return 0;
 		m_currentdata.MakeRoomFor(size);
-		mcfp.Read(m_currentdata.GetPtr(), size);
-
+		memcpy(m_currentdata.GetPtr(), dest, size);
 
 		for (int i = 0; i < size; i++)
 		{
@@ -484,77 +740,53 @@ s32 FileMemoryCard::Save(uint slot, const u8* src, u32 adr, int size)
 			for (u32 i = 0; i < loops; i++)
 				m_chksum[slot] ^= pdata[i];
 		}
-	}
 
-	if (!Seek(mcfp, adr))
-		return 0;
+		data = m_currentdata.GetPtr();
+	}
 
-	int status = mcfp.Write(m_currentdata.GetPtr(), size);
+	const u32 pos = adr + m_offset[slot];
 
-	if (status)
-	{
-		static auto last = std::chrono::time_point<std::chrono::system_clock>();
-
-		std::chrono::duration<float> elapsed = std::chrono::system_clock::now() - last;
-		if (elapsed > std::chrono::seconds(5))
-		{
-			wxString name, ext;
-			wxFileName::SplitPath(m_file[slot].GetName(), NULL, NULL, &name, &ext);
-			log_cb(RETRO_LOG_INFO, "Memory Card %s written.\n", (const char*)(name + "." + ext).c_str());
-			last = std::chrono::system_clock::now();
-		}
-		return 1;
-	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	XorPSXCRC(slot, pos, size);
+	memcpy(dest, data, size);
+	XorPSXCRC(slot, pos, size);
+	MarkDirty(slot, pos, size);
 
-	return 0;
+	return 1;
 }
 
 s32 FileMemoryCard::EraseBlock(uint slot, u32 adr)
 {
-	wxFFile& mcfp(m_file[slot]);
-
-	if (!mcfp.IsOpened())
+	if (!m_file[slot].IsOpened())
 	{
 		log_cb(RETRO_LOG_ERROR, "MemoryCard: Ignoring erase for disabled slot.\n");
 		return 1;
 	}
 
-	if (!Seek(mcfp, adr))
+	u8* dest = Map(slot, adr, sizeof(m_effeffs));
+	if (!dest)
 		return 0;
-	return mcfp.Write(m_effeffs, sizeof(m_effeffs)) != 0;
+
+	const u32 pos = adr + m_offset[slot];
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	XorPSXCRC(slot, pos, sizeof(m_effeffs));
+	memcpy(dest, m_effeffs, sizeof(m_effeffs));
+	XorPSXCRC(slot, pos, sizeof(m_effeffs));
+	MarkDirty(slot, pos, sizeof(m_effeffs));
+
+	return 1;
 }
 
 u64 FileMemoryCard::GetCRC(uint slot)
 {
-	wxFFile& mcfp(m_file[slot]);
-	if (!mcfp.IsOpened())
+	if (!m_file[slot].IsOpened())
 		return 0;
 
-	u64 retval = 0;
-
 	if (m_ispsx[slot])
-	{
-		if (!Seek(mcfp, 0))
-			return 0;
-
-		// Process the file in 4k chunks.  Speeds things up significantly.
-
-		u64 buffer[528 * 8]; // use 528 (sector size), ensures even divisibility
+		return m_psxcrc[slot];
 
-		const uint filesize = mcfp.Length() / sizeof(buffer);
-		for (uint i = filesize; i; --i)
-		{
-			mcfp.Read(&buffer, sizeof(buffer));
-			for (uint t = 0; t < ArraySize(buffer); ++t)
-				retval ^= buffer[t];
-		}
-	}
-	else
-	{
-		retval = m_chksum[slot];
-	}
-
-	return retval;
+	return m_chksum[slot];
 }
 
 // --------------------------------------------------------------------------------------
@@ -585,6 +817,11 @@ void FileMcd_EmuClose()
 	Mcd::impl.Close();
 }
 
+void FileMcd_Flush()
+{
+	Mcd::impl.Flush();
+}
+
 s32 FileMcd_IsPresent(uint port, uint slot)
 {
 	const uint combinedSlot = FileMcd_ConvertToSlot(port, slot);
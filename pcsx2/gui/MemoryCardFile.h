@@ -31,6 +31,7 @@ extern wxString FileMcd_GetDefaultName(uint slot);
 uint FileMcd_ConvertToSlot(uint port, uint slot);
 void FileMcd_EmuOpen();
 void FileMcd_EmuClose();
+void FileMcd_Flush();
 s32 FileMcd_IsPresent(uint port, uint slot);
 void FileMcd_GetSizeInfo(uint port, uint slot, McdSizeInfo* outways);
 bool FileMcd_IsPSX(uint port, uint slot);
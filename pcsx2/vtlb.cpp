@@ -38,6 +38,9 @@
 
 #include "Utilities/MemsetFast.inl"
 
+#include <bitset>
+#include <memory>
+
 using namespace R5900;
 using namespace vtlb_private;
 
@@ -54,6 +57,8 @@ static vtlbHandler UnmappedVirtHandler1;
 static vtlbHandler UnmappedPhyHandler0;
 static vtlbHandler UnmappedPhyHandler1;
 
+static void vtlb_FastmemRemap(u32 vaddr, u32 size);
+
 vtlb_private::VTLBPhysical vtlb_private::VTLBPhysical::fromPointer(sptr ptr) {
 	return VTLBPhysical(ptr);
 }
@@ -416,6 +421,8 @@ __fi u32 vtlb_V2P(u32 vaddr)
 //TODO: Add invalid paddr checks
 void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
 {
+	const u32 start = vaddr, total = size;
+
 	while (size > 0)
 	{
 		VTLBVirtual vmv;
@@ -438,10 +445,14 @@ void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
 		paddr += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_FastmemRemap(start, total);
 }
 
 void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
 {
+	const u32 start = vaddr, total = size;
+
 	uptr bu8 = (uptr)buffer;
 	while (size > 0)
 	{
@@ -450,10 +461,14 @@ void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
 		bu8 += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_FastmemRemap(start, total);
 }
 
 void vtlb_VMapUnmap(u32 vaddr,u32 size)
 {
+	const u32 start = vaddr, total = size;
+
 	while (size > 0)
 	{
 
@@ -467,6 +482,240 @@ void vtlb_VMapUnmap(u32 vaddr,u32 size)
 		vaddr += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_FastmemRemap(start, total);
+}
+
+// --------------------------------------------------------------------------------------
+//  Fastmem
+// --------------------------------------------------------------------------------------
+// The EE virtual space is mirrored in a 4GB host area, so the recompiled loads and stores
+// are a single access at fastmem_base + vaddr.  eeMem is moved to a shared memory object
+// and every virtual page which points into eeMem maps the same pages of that object.  The
+// other pages (handlers, iop ram, vu memory) are left inaccessible, their accesses fault
+// and the fault handler patches them to the vtlb lookup.
+//
+// The aliases of the main ram pages follow the write protection of the recompiled code
+// (see mmap_MarkCountedRamPage), a write through any mirror clears the blocks.
+
+static const size_t FASTMEM_AREA_SIZE = _4gb + _64kb; // guard for the accesses crossing the end
+
+static const uint FASTMEM_RAM_PAGES = Ps2MemSize::MainRam >> VTLB_PAGE_BITS;
+
+static_assert(offsetof(EEVM_MemoryAllocMess, Main) == 0, "the main ram must start the shared memory");
+
+// The area is never released, code compiled before a shutdown still faults in it
+static std::unique_ptr<VirtualMemoryManager> s_fastmem_area;
+static sptr s_fastmem_shm = -1;
+
+// main ram page + 1 mapped by each virtual page, 0 when it isn't a main ram alias
+static std::unique_ptr<u16[]> s_fastmem_vpage_ram;
+static std::vector<u32> s_fastmem_ram_aliases[FASTMEM_RAM_PAGES];
+
+// Always up to date, the protection is applied to the aliases mapped later
+static std::bitset<FASTMEM_RAM_PAGES> s_fastmem_ram_protected;
+
+// Offset of the page in eeMem, -1 when the page isn't backed by the shared memory
+static sptr vtlb_FastmemPageOffset(u32 vpage)
+{
+	const u32 vaddr = vpage << VTLB_PAGE_BITS;
+	const VTLBVirtual vmv = vtlbdata.vmap[vpage];
+
+	if (vmv.isHandler(vaddr))
+		return -1;
+
+	const uptr offset = vmv.assumePtr(vaddr) - (uptr)eeMem;
+	if (offset > sizeof(*eeMem) - VTLB_PAGE_SIZE || (offset & VTLB_PAGE_MASK))
+		return -1;
+
+	return offset;
+}
+
+static void vtlb_FastmemSetAlias(u32 vpage, sptr offset)
+{
+	const u16 ram = (offset >= 0 && offset < (sptr)Ps2MemSize::MainRam) ? (offset >> VTLB_PAGE_BITS) + 1 : 0;
+	const u16 old = s_fastmem_vpage_ram[vpage];
+
+	if (old != ram)
+	{
+		if (old)
+		{
+			std::vector<u32>& aliases = s_fastmem_ram_aliases[old - 1];
+			for (size_t i = 0; i < aliases.size(); i++)
+			{
+				if (aliases[i] == vpage)
+				{
+					aliases[i] = aliases.back();
+					aliases.pop_back();
+					break;
+				}
+			}
+		}
+
+		if (ram)
+			s_fastmem_ram_aliases[ram - 1].push_back(vpage);
+
+		s_fastmem_vpage_ram[vpage] = ram;
+	}
+
+	if (ram && s_fastmem_ram_protected[ram - 1])
+		HostSys::MemProtect(vtlbdata.fastmem_base + ((uptr)vpage << VTLB_PAGE_BITS), __pagesize, PageAccess_ReadOnly());
+}
+
+// Maps the virtual pages [vaddr, vaddr+size) again from the vmap.  Contiguous pages are
+// mapped together, vtlb_Init remaps the whole space with a handful of calls.
+static void vtlb_FastmemRemap(u32 vaddr, u32 size)
+{
+	if (!vtlbdata.fastmem_base)
+		return;
+
+	u32 vpage = vaddr >> VTLB_PAGE_BITS;
+	const u32 end = vpage + (size >> VTLB_PAGE_BITS);
+
+	while (vpage < end)
+	{
+		const sptr offset = vtlb_FastmemPageOffset(vpage);
+
+		u32 count = 1;
+		if (offset < 0)
+		{
+			while (vpage + count < end && vtlb_FastmemPageOffset(vpage + count) < 0)
+				count++;
+		}
+		else
+		{
+			while (vpage + count < end && vtlb_FastmemPageOffset(vpage + count) == offset + ((sptr)count << VTLB_PAGE_BITS))
+				count++;
+		}
+
+		u8* base = vtlbdata.fastmem_base + ((uptr)vpage << VTLB_PAGE_BITS);
+		const size_t bytes = (size_t)count << VTLB_PAGE_BITS;
+
+		bool mapped = false;
+		if (offset >= 0)
+			mapped = HostSys::MapSharedMemory(s_fastmem_shm, offset, base, bytes, PageAccess_ReadWrite());
+
+		// Unmapped pages go through the vtlb lookup once their accesses are patched
+		if (!mapped)
+			HostSys::MmapResetPtr(base, bytes);
+
+		for (u32 i = 0; i < count; i++)
+			vtlb_FastmemSetAlias(vpage + i, mapped ? offset + ((sptr)i << VTLB_PAGE_BITS) : -1);
+
+		vpage += count;
+	}
+}
+
+// Returns false when the host can't mirror the memory, the recompiler keeps the vtlb lookups.
+bool vtlb_FastmemInit(void)
+{
+#ifdef __M_X86_64
+	if (vtlbdata.fastmem_base)
+		return true;
+
+	if (!eeMem || !vtlbdata.vmap)
+		return false;
+
+	if (!s_fastmem_area)
+		s_fastmem_area.reset(new VirtualMemoryManager(0, FASTMEM_AREA_SIZE));
+
+	if (!s_fastmem_area->GetBase())
+		return false;
+
+	const size_t size = sizeof(*eeMem);
+
+	sptr shm = HostSys::CreateSharedMemory(size);
+	if (shm < 0)
+		return false;
+
+	// The private pages of eeMem are replaced by the shared memory, the content is carried over
+	std::unique_ptr<u8[]> content(new u8[size]);
+	memcpy(content.get(), eeMem, size);
+
+	if (!HostSys::MapSharedMemory(shm, 0, eeMem, size, PageAccess_ReadWrite()))
+	{
+		HostSys::MmapResetPtr(eeMem, size);
+		HostSys::MmapCommitPtr(eeMem, size, PageAccess_ReadWrite());
+		memcpy(eeMem, content.get(), size);
+		HostSys::DestroySharedMemory(shm);
+		return false;
+	}
+
+	memcpy(eeMem, content.get(), size);
+
+	s_fastmem_shm = shm;
+	s_fastmem_vpage_ram.reset(new u16[VTLB_VMAP_ITEMS]());
+
+	vtlbdata.fastmem_base = (u8*)s_fastmem_area->GetBase();
+	vtlb_FastmemRemap(0, (VTLB_VMAP_ITEMS-1)*VTLB_PAGE_SIZE);
+	vtlb_FastmemRemap((VTLB_VMAP_ITEMS-1)*VTLB_PAGE_SIZE, VTLB_PAGE_SIZE);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+// eeMem stays on the shared memory until it is decommitted, only the mirror is dropped.
+void vtlb_FastmemShutdown(void)
+{
+	if (!vtlbdata.fastmem_base)
+		return;
+
+	HostSys::MmapResetPtr(vtlbdata.fastmem_base, FASTMEM_AREA_SIZE);
+	vtlbdata.fastmem_base = NULL;
+
+	HostSys::DestroySharedMemory(s_fastmem_shm);
+	s_fastmem_shm = -1;
+
+	s_fastmem_vpage_ram.reset();
+	for (std::vector<u32>& aliases : s_fastmem_ram_aliases)
+		aliases.clear();
+}
+
+bool vtlb_FastmemActive(void)
+{
+	return vtlbdata.fastmem_base != NULL;
+}
+
+// Returns true when addr is in the mirror, vaddr receives the matching EE virtual address.
+bool vtlb_FastmemGetVAddr(uptr addr, u32& vaddr)
+{
+	if (!s_fastmem_area || !s_fastmem_area->GetBase())
+		return false;
+
+	const uptr offset = addr - (uptr)s_fastmem_area->GetBase();
+	if (offset >= FASTMEM_AREA_SIZE)
+		return false;
+
+	vaddr = (u32)offset;
+	return true;
+}
+
+void vtlb_FastmemProtectRamPage(u32 rampage, bool writable)
+{
+	s_fastmem_ram_protected[rampage] = !writable;
+
+	if (!vtlbdata.fastmem_base)
+		return;
+
+	const PageProtectionMode mode = writable ? PageAccess_ReadWrite() : PageAccess_ReadOnly();
+	for (u32 vpage : s_fastmem_ram_aliases[rampage])
+		HostSys::MemProtect(vtlbdata.fastmem_base + ((uptr)vpage << VTLB_PAGE_BITS), __pagesize, mode);
+}
+
+void vtlb_FastmemUnprotectAll(void)
+{
+	if (vtlbdata.fastmem_base)
+	{
+		for (u32 rampage = 0; rampage < FASTMEM_RAM_PAGES; rampage++)
+		{
+			if (s_fastmem_ram_protected[rampage])
+				vtlb_FastmemProtectRamPage(rampage, true);
+		}
+	}
+
+	s_fastmem_ram_protected.reset();
 }
 
 // vtlb_Init -- Clears vtlb handlers and memory mappings.
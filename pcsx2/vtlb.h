@@ -83,6 +83,14 @@ extern void vtlb_VMap(u32 vaddr,u32 paddr,u32 sz);
 extern void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 sz);
 extern void vtlb_VMapUnmap(u32 vaddr,u32 sz);
 
+//fastmem, mirror of the virtual mappings in a 4GB host area
+extern bool vtlb_FastmemInit(void);
+extern void vtlb_FastmemShutdown(void);
+extern bool vtlb_FastmemActive(void);
+extern bool vtlb_FastmemGetVAddr(uptr addr, u32& vaddr);
+extern void vtlb_FastmemProtectRamPage(u32 rampage, bool writable);
+extern void vtlb_FastmemUnprotectAll(void);
+
 //Memory functions
 
 template< typename DataType >
@@ -103,6 +111,9 @@ extern void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const );
 extern void vtlb_DynGenRead64_Const( u32 bits, u32 addr_const );
 extern void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const );
 
+extern bool vtlb_DynBackpatchFastmem(uptr* pc);
+extern void vtlb_DynFastmemReset(void);
+
 // --------------------------------------------------------------------------------------
 //  VtlbMemoryReserve
 // --------------------------------------------------------------------------------------
@@ -252,10 +263,13 @@ namespace vtlb_private
 
 		u32* ppmap;               //4MB (allocated by vtlb_init) // PS2 virtual to PS2 physical
 
+		u8* fastmem_base;         // PS2 virtual mirror, NULL when fastmem is disabled
+
 		MapData()
 		{
 			vmap = NULL;
 			ppmap = NULL;
+			fastmem_base = NULL;
 		}
 	};
 
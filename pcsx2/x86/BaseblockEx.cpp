@@ -16,6 +16,9 @@
 
 #include "PrecompiledHeader.h"
 #include "BaseblockEx.h"
+#include "DebugTools/SymbolMap.h"
+
+#include <algorithm>
 
 BASEBLOCKEX* BaseBlocks::New(u32 startpc, uptr fnptr)
 {
@@ -55,3 +58,164 @@ void BaseBlocks::Link(u32 pc, s32* jumpptr)
 	links.insert(std::pair<u32, uptr>(pc, (uptr)jumpptr));
 }
 
+// Forgets a link made by Link, the jump is left as is
+void BaseBlocks::Unlink(u32 pc, s32* jumpptr)
+{
+	std::pair<linkiter_t, linkiter_t> range = links.equal_range(pc);
+	for (linkiter_t i = range.first; i != range.second; ++i)
+	{
+		if (i->second == (uptr)jumpptr)
+		{
+			links.erase(i);
+			break;
+		}
+	}
+}
+
+
+u64* BaseBlockProfiler::Counter(u32 startpc)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	auto it = m_index.find(startpc);
+	if (it != m_index.end())
+		return &m_counts[it->second];
+
+	if (m_blocks.size() >= MaxBlocks)
+		return NULL;
+
+	u32 idx = m_blocks.size();
+	m_index[startpc] = idx;
+	m_blocks.push_back({startpc, 0, 0, 0, 0, 0});
+	m_counts[idx] = 0;
+
+	return &m_counts[idx];
+}
+
+void BaseBlockProfiler::Compiled(u32 startpc, u32 size, u32 x86size, u32 cycles, u32 entryConsts)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	auto it = m_index.find(startpc);
+	if (it == m_index.end())
+		return;
+
+	Block& block = m_blocks[it->second];
+	block.size = size;
+	block.x86size = x86size;
+	block.cycles = cycles;
+	block.compiles++;
+	block.entryConsts = entryConsts;
+}
+
+void BaseBlockProfiler::Emitted(const char* name, u32 x86size)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	Instruction& inst = m_instructions[name];
+	inst.count++;
+	inst.x86size += x86size;
+}
+
+void BaseBlockProfiler::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	m_blocks.clear();
+	m_index.clear();
+	m_instructions.clear();
+}
+
+bool BaseBlockProfiler::WriteReport(const char* filename, const char* cpu, u32 maxBlocks)
+{
+	struct Entry
+	{
+		const Block* block;
+		u64 count;
+		u64 cycles;
+	};
+
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	// The counters are read while the recompiled code may still increment them, the report
+	// can be a few executions off.
+	std::vector<Entry> entries;
+	entries.reserve(m_blocks.size());
+
+	u64 totalCount = 0, totalCycles = 0;
+	for (u32 i = 0; i < m_blocks.size(); i++)
+	{
+		const u64 count = m_counts[i];
+		const u64 cycles = count * m_blocks[i].cycles;
+
+		totalCount += count;
+		totalCycles += cycles;
+
+		if (count)
+			entries.push_back({&m_blocks[i], count, cycles});
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.cycles != b.cycles ? a.cycles > b.cycles : a.count > b.count;
+	});
+
+	FILE* fp = fopen(filename, "w");
+	if (!fp)
+		return false;
+
+	fprintf(fp, "%s block profile: %u blocks, %u executed, %llu executions, %llu guest cycles\n\n",
+		cpu, (u32)m_blocks.size(), (u32)entries.size(), (unsigned long long)totalCount, (unsigned long long)totalCycles);
+	fprintf(fp, "  cycles%%   cumul%%  pc        insts  x86size  compiles  consts       executions  symbol\n");
+
+	u64 cumul = 0;
+	for (u32 i = 0; i < entries.size() && i < maxBlocks; i++)
+	{
+		const Entry& e = entries[i];
+		cumul += e.cycles;
+
+		std::string symbol;
+		const u32 func = symbolMap.GetFunctionStart(e.block->startpc);
+		if (func != SymbolMap::INVALID_ADDRESS)
+		{
+			symbol = symbolMap.GetLabelString(func);
+			if (!symbol.empty() && func != e.block->startpc)
+			{
+				char offset[16];
+				snprintf(offset, sizeof(offset), "+0x%x", e.block->startpc - func);
+				symbol += offset;
+			}
+		}
+
+		fprintf(fp, "  %7.3f  %7.3f  %08x  %5u  %7u  %8u  %6u  %15llu  %s\n",
+			totalCycles ? 100.0 * e.cycles / totalCycles : 0.0,
+			totalCycles ? 100.0 * cumul / totalCycles : 0.0,
+			e.block->startpc, e.block->size, e.block->x86size, e.block->compiles, e.block->entryConsts,
+			(unsigned long long)e.count, symbol.c_str());
+	}
+
+	// Branches and jumps include their delay slot and the block exit
+	std::vector<std::pair<const char*, Instruction>> instructions(m_instructions.begin(), m_instructions.end());
+	std::sort(instructions.begin(), instructions.end(), [](const auto& a, const auto& b) {
+		return a.second.x86size != b.second.x86size ? a.second.x86size > b.second.x86size : strcmp(a.first, b.first) < 0;
+	});
+
+	u64 totalInsts = 0, totalSize = 0;
+	for (const auto& inst : instructions)
+	{
+		totalInsts += inst.second.count;
+		totalSize += inst.second.x86size;
+	}
+
+	fprintf(fp, "\n%s emitted code: %llu instructions, %llu bytes, %.2f bytes/instruction\n\n",
+		cpu, (unsigned long long)totalInsts, (unsigned long long)totalSize, totalInsts ? (double)totalSize / totalInsts : 0.0);
+	fprintf(fp, "  name          compiles         bytes  bytes/inst\n");
+
+	for (const auto& inst : instructions)
+	{
+		fprintf(fp, "  %-10s  %10llu  %12llu  %10.2f\n", inst.first,
+			(unsigned long long)inst.second.count, (unsigned long long)inst.second.x86size,
+			(double)inst.second.x86size / inst.second.count);
+	}
+
+	return fclose(fp) == 0;
+}
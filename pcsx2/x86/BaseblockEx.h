@@ -16,6 +16,9 @@
 #pragma once
 
 #include <map>			// used by BaseBlockEx
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 // Every potential jump point in the PS2's addressable memory has a BASEBLOCK
 // associated with it. So that means a BASEBLOCK for every 4 bytes of PS2
@@ -203,6 +206,7 @@ public:
 	}
 
 	void Link(u32 pc, s32* jumpptr);
+	void Unlink(u32 pc, s32* jumpptr);
 
 	__fi void Reset()
 	{
@@ -211,6 +215,55 @@ public:
 	}
 };
 
+// Opt-in execution counts of the recompiled blocks, to find out which blocks a game spends
+// its time in.  The recompiler emits an increment of Counter(startpc) in the prologue of
+// every block, so the counters live in this object (give it static storage, the code has
+// to be able to address them).  Blocks are keyed by their start pc, recompiling a block
+// keeps adding to the same counter.
+class BaseBlockProfiler
+{
+public:
+	static const u32 MaxBlocks = 0x20000;
+
+	struct Block
+	{
+		u32 startpc;
+		u32 size;		// in instructions, of the last compilation
+		u32 x86size;
+		u32 cycles;		// guest cycles of one execution
+		u32 compiles;
+		u32 entryConsts;	// GPRs assumed constant on entry, of the last compilation
+	};
+
+	// Code emitted per instruction, summed over all the compilations
+	struct Instruction
+	{
+		u64 count;
+		u64 x86size;
+	};
+
+protected:
+	__aligned16 u64 m_counts[MaxBlocks];
+	std::vector<Block> m_blocks;
+	std::unordered_map<u32, u32> m_index;
+	std::unordered_map<const char*, Instruction> m_instructions; // by opcode name
+	std::mutex m_lock;
+
+public:
+	BaseBlockProfiler() {}
+
+	// The counter of the block, NULL once MaxBlocks different blocks were seen
+	u64* Counter(u32 startpc);
+	void Compiled(u32 startpc, u32 size, u32 x86size, u32 cycles, u32 entryConsts = 0);
+	// name has static storage (the opcode tables)
+	void Emitted(const char* name, u32 x86size);
+	void Clear();
+
+	// Writes the maxBlocks blocks with the most guest cycles to a text file, followed by
+	// the emitted code size of each instruction
+	bool WriteReport(const char* filename, const char* cpu, u32 maxBlocks);
+};
+
 #define PC_GETBLOCK_(x, reclut) ((BASEBLOCK*)(reclut[((u32)(x)) >> 16] + (x)*(sizeof(BASEBLOCK)/4)))
 
 /**
@@ -1213,6 +1213,17 @@ void recPADSBH()
 		xPSRL.DQ(xRegisterSSE(EEREC_D), 8);
 		xPSLL.DQ(xRegisterSSE(EEREC_D), 8);
 	}
+	else if( EEREC_D == EEREC_T ) {
+		t0reg = _allocTempXMMreg(XMMT_INT, -1);
+
+		// t0reg - subs, EEREC_D - adds
+		xMOVDQA(xRegisterSSE(t0reg), xRegisterSSE(EEREC_S));
+		xPSUB.W(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
+		xPADD.W(xRegisterSSE(EEREC_D), xRegisterSSE(EEREC_S));
+
+		xMOVSD(xRegisterSSE(EEREC_D), xRegisterSSE(t0reg));
+		_freeXMMreg(t0reg);
+	}
 	else {
 		t0reg = _allocTempXMMreg(XMMT_INT, -1);
 
@@ -71,6 +71,17 @@ void recBranchCall( void (*func)(void) );
 void recCall( void (*func)(void) );
 u32 scaleblockcycles_clear(void);
 
+// EE block profiler, see BaseBlockProfiler
+void recEEProfileBlocks(bool enable);
+bool recEEWriteBlockProfile(const char* filename, u32 maxBlocks);
+
+// EE loads and stores through a host mirror of the virtual space, see vtlb_FastmemInit
+void recEEFastmem(bool enable);
+
+// Single instructions against the interpreter, see OpcodeBench.cpp
+u32 recEECompileInstruction(u32 pc);
+void recEERunInstruction(u32 pc);
+
 namespace R5900{
 namespace Dynarec {
 extern void recDoBranchImm( u32* jmpSkip, bool isLikely = false );
@@ -0,0 +1,631 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Standalone check of the EE recompiler against the interpreter.  Every opcode of the EE,
+// MMI and COP2 (VU0 macro mode) tables that neither branches nor raises an exception is
+// compiled alone through recRecompile, then run on random registers and memory, and the
+// GPR, HI/LO, SA and VU0 registers and the memory it touched are compared with what the
+// interpreter gives from the same state.  Prints the x86 size and the run time of each
+// opcode, both without the cost of an empty block.  The inputs are seeded, only the
+// timings change between two runs.  Exits with 1 when an opcode differs.
+//
+// usage: pcsx2_EEOpcodeBench [trials]
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+
+#include "R5900OpcodeTables.h"
+#include "VUmicro.h"
+#include "iR5900.h"
+#include "gui/AppConfig.h"
+#include "ps2/BiosTools.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <string>
+
+extern u32 disasmOpcode;
+
+using namespace R5900;
+
+// The instruction runs from the page of the EENULL thread, its blocks compare their code
+// instead of write protecting it
+static const u32 s_pc = 0x81000;
+
+// Loads and stores go there, away from the code
+static const u32 s_memBase = 0x00100000;
+static const u32 s_memSize = 0x00100000;
+
+static const u32 s_runs = 10000;
+
+struct OpcodeCase
+{
+	std::string name;
+	u32 code;   // the fixed fields
+	u32 random; // the fields taken at random
+	const OPCODE* opcode;
+	bool fmac;  // rounds a float result
+};
+
+// What an instruction may change
+struct __aligned16 OpcodeBenchState
+{
+	GPRregs gpr;
+	GPR_reg hi;
+	GPR_reg lo;
+	u32 sa;
+	VECTOR vf[32];
+	VECTOR acc;
+	REG_VI vi[32];
+
+	u32 address;
+	u8 mem[32];
+
+	void Save()
+	{
+		gpr = cpuRegs.GPR;
+		hi = cpuRegs.HI;
+		lo = cpuRegs.LO;
+		sa = cpuRegs.sa;
+		memcpy(vf, VU0.VF, sizeof(vf));
+		acc = VU0.ACC;
+		memcpy(vi, VU0.VI, sizeof(vi));
+		memcpy(mem, PSM(address), sizeof(mem));
+	}
+
+	void Load() const
+	{
+		cpuRegs.GPR = gpr;
+		cpuRegs.HI = hi;
+		cpuRegs.LO = lo;
+		cpuRegs.sa = sa;
+		memcpy(VU0.VF, vf, sizeof(vf));
+		VU0.ACC = acc;
+		memcpy(VU0.VI, vi, sizeof(vi));
+		memcpy(PSM(address), mem, sizeof(mem));
+
+		// The interpreter works on its own copies of the flags and Q, CTC2 keeps them in sync
+		VU0.statusflag = vi[REG_STATUS_FLAG].UL;
+		VU0.macflag = vi[REG_MAC_FLAG].UL;
+		VU0.clipflag = vi[REG_CLIP_FLAG].UL;
+		VU0.q.UL = vi[REG_Q].UL;
+	}
+};
+
+static void OpcodeBenchLog(enum retro_log_level level, const char* fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+// xorshift32, the runs are reproducible
+static u32 s_random = 0x2545f491;
+
+static u32 Random()
+{
+	s_random ^= s_random << 13;
+	s_random ^= s_random >> 17;
+	s_random ^= s_random << 5;
+	return s_random;
+}
+
+// Mostly small values and the edges, the cases where the sign and carry matter
+static u64 RandomInteger()
+{
+	const u64 value = (u64)Random() << 32 | Random();
+
+	switch (Random() >> 29)
+	{
+		case 0: return value & 0xff;
+		case 1: return (u64)-(s64)(value & 0xff);
+		case 2: return (u64)(s64)(s32)(0x80000000u ^ (value & 0xff));
+		case 3: return (u64)(s64)(s32)value;
+		default: return value;
+	}
+}
+
+// Normal floats, the recompiler clamps what the interpreter doesn't.  FTOI15 of them still
+// fits in 32 bits, the interpreter doesn't saturate.  The operands of an FMAC op get 12 bit
+// mantissas so that their products are exact, the interpreter rounds a double and the
+// recompiler rounds the product and the sum of MADD/MSUB each, which drifts apart when the
+// sum cancels.
+static u32 RandomFloat(bool fmac = false)
+{
+	const u32 bits = Random();
+
+	if ((bits & 15) == 0)
+		return 0;
+
+	return (bits & (fmac ? 0x807ff000 : 0x807fffff)) | (127 - 12 + Random() % 25) << 23;
+}
+
+static void RandomState(const OpcodeCase& c, u32 code, OpcodeBenchState& state)
+{
+	for (int i = 0; i < 32; i++)
+	{
+		state.gpr.r[i].UD[0] = i ? RandomInteger() : 0;
+		state.gpr.r[i].UD[1] = i ? RandomInteger() : 0;
+
+		for (int j = 0; j < 4; j++)
+			state.vf[i].UL[j] = i ? RandomFloat(c.fmac) : 0;
+		if (i == 0)
+			state.vf[0].f.w = 1.0f;
+
+		state.vi[i].UL = 0;
+	}
+
+	state.hi.UD[0] = RandomInteger();
+	state.hi.UD[1] = RandomInteger();
+	state.lo.UD[0] = RandomInteger();
+	state.lo.UD[1] = RandomInteger();
+	state.sa = Random() & 15;
+
+	for (int j = 0; j < 4; j++)
+		state.acc.UL[j] = RandomFloat();
+
+	for (int i = 1; i < 16; i++)
+		state.vi[i].UL = Random() & 0xffff;
+
+	state.vi[REG_STATUS_FLAG].UL = Random() & 0xfff;
+	state.vi[REG_MAC_FLAG].UL = Random() & 0xffff;
+	state.vi[REG_CLIP_FLAG].UL = Random() & 0xffffff;
+
+	state.vi[REG_R].UL = 0x3f800000 | (Random() & 0x7fffff);
+	state.vi[REG_I].UL = RandomFloat(c.fmac);
+	state.vi[REG_Q].UL = RandomFloat(c.fmac);
+
+	// The base of a load or store points to an aligned address in s_memBase
+	state.address = s_memBase;
+
+	if (c.opcode->flags & IS_MEMORY)
+	{
+		static const u32 sizes[] = {1, 1, 2, 4, 8, 16, 1, 1};
+		const u32 size = (c.opcode->flags & (IS_LEFT | IS_RIGHT)) ? 1 : sizes[c.opcode->flags & MEMTYPE_MASK];
+
+		const u32 target = s_memBase + ((Random() % (s_memSize - 32)) & ~(size - 1));
+		const u32 rs = (code >> 21) & 0x1f;
+
+		state.gpr.r[rs].SD[0] = (s32)(target - (s16)code);
+		state.address = target & ~15;
+	}
+
+	for (int i = 0; i < 32; i++)
+		state.mem[i] = (u8)Random();
+}
+
+static u32 RandomCode(const OpcodeCase& c)
+{
+	u32 code = c.code | (Random() & c.random);
+
+	// A load doesn't overwrite its base, the runs stay on the same address
+	if (c.opcode->flags & IS_MEMORY)
+	{
+		u32 rs = (code >> 21) & 0x1f;
+		const u32 rt = (code >> 16) & 0x1f;
+
+		if (rs == 0 || rs == rt)
+			rs = rt % 31 + 1;
+
+		code = (code & ~(0x1f << 21)) | rs << 21;
+	}
+
+	return code;
+}
+
+static std::string DisasmName(u32 code, const OPCODE& opcode)
+{
+	if (opcode.disasm == nullptr)
+		return opcode.Name;
+
+	std::string text;
+	disasmOpcode = code;
+	opcode.disasm(text);
+
+	std::string name;
+	for (char ch : text)
+	{
+		if (ch == '\t' || ch == ' ' || ch == '.')
+			break;
+		name += toupper(ch);
+	}
+	return name;
+}
+
+static bool Skipped(const char* name, const OPCODE& opcode)
+{
+	// branches, exceptions, the cache and the FPU
+	static const char* const skipped[] = {
+		"SYSCALL", "BREAK", "CACHE", "PREF", "LWC1", "SWC1",
+		"TGE", "TGEU", "TLT", "TLTU", "TEQ", "TNE", "TGEI", "TGEIU", "TLTI", "TLTIU", "TEQI", "TNEI",
+		// VU0 microprograms and memory
+		"VCALLMS", "VCALLMSR", "VLQI", "VSQI", "VLQD", "VSQD", "VILWR", "VISWR",
+		// the holes of the COP2 tables
+		"COP2",
+	};
+
+	if (opcode.flags & IS_BRANCH)
+		return true;
+
+	if (strstr(name, "Unknown") || strstr(name, "??"))
+		return true;
+
+	for (const char* s : skipped)
+	{
+		if (strcmp(name, s) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+static void AddCase(std::vector<OpcodeCase>& cases, u32 code, u32 random, const char* format = nullptr)
+{
+	const OPCODE& opcode = GetInstruction(code);
+	std::string name = (code >> 26) == 18 ? DisasmName(code, opcode) : opcode.Name;
+
+	if (format)
+		name = name + "." + format;
+
+	if (Skipped(name.c_str(), opcode))
+		return;
+
+	// The interpreter computes them in double and rounds once, the recompiler rounds each step
+	static const char* const fmac[] = {"VADD", "VSUB", "VMUL", "VMADD", "VMSUB", "VOPM"};
+	const bool rounds = std::any_of(std::begin(fmac), std::end(fmac), [&](const char* prefix) {
+		return name.compare(0, strlen(prefix), prefix) == 0;
+	});
+
+	cases.push_back({name, code, random, &opcode, rounds});
+}
+
+// The EE (with SPECIAL and REGIMM), MMI and COP2 tables, the other coprocessors are left out
+static void EECases(std::vector<OpcodeCase>& cases)
+{
+	for (u32 op = 0; op < 64; op++)
+	{
+		if (op == 1 || op == 16 || op == 17 || op == 18 || op == 28)
+			continue;
+
+		if (op == 0)
+		{
+			for (u32 funct = 0; funct < 64; funct++)
+				AddCase(cases, funct, 0x03ffffc0);
+		}
+		else
+			AddCase(cases, op << 26, 0x03ffffff);
+	}
+
+	for (u32 rt = 0; rt < 32; rt++)
+		AddCase(cases, 1 << 26 | rt << 16, 0x03e0ffff);
+}
+
+static void MMICases(std::vector<OpcodeCase>& cases)
+{
+	for (u32 funct = 0; funct < 64; funct++)
+	{
+		const u32 code = 28 << 26 | funct;
+
+		// MMI0-3 are indexed by the sa field
+		if (funct == 8 || funct == 9 || funct == 40 || funct == 41)
+		{
+			for (u32 sa = 0; sa < 32; sa++)
+				AddCase(cases, code | sa << 6, 0x03fff800);
+		}
+		// PMFHL and PMTHL take a format there, the others are undefined
+		else if (funct == 48)
+		{
+			static const char* const formats[] = {"LW", "UW", "SLW", "LH", "SH"};
+			for (u32 fmt = 0; fmt < ArraySize(formats); fmt++)
+				AddCase(cases, code | fmt << 6, 0x03fff800, formats[fmt]);
+		}
+		else if (funct == 49)
+			AddCase(cases, code, 0x03fff800, "LW");
+		else
+			AddCase(cases, code, 0x03ffffc0);
+	}
+}
+
+static void COP2Cases(std::vector<OpcodeCase>& cases)
+{
+	// QMFC2, CFC2, QMTC2 and CTC2, without the interlock and on the integer registers
+	for (u32 rs : {1, 2, 5, 6})
+		AddCase(cases, 18 << 26 | rs << 21, (rs == 2 || rs == 6) ? 0x001f7800 : 0x001ff800);
+
+	// OPMSUB and OPMULA are only defined for xyz
+	for (u32 funct = 0; funct < 60; funct++)
+	{
+		const u32 code = 18 << 26 | 1 << 25 | funct;
+		if (funct == 46)
+			AddCase(cases, code | 14 << 21, 0x001fffc0);
+		else
+			AddCase(cases, code, 0x01ffffc0);
+	}
+
+	for (u32 index = 0; index < 128; index++)
+	{
+		const u32 code = 18 << 26 | 1 << 25 | (index >> 2) << 6 | 0x3c | (index & 3);
+		if (index == 46)
+			AddCase(cases, code | 14 << 21, 0x001ff800);
+		else
+			AddCase(cases, code, 0x01fff800);
+	}
+}
+
+// Where the recompiler knowingly differs, these are reported but don't fail
+static const char* KnownDifference(const std::string& name)
+{
+	// The interpreter models the off by one of the PS2 multiplier in HI
+	if (name == "PMADDW" || name == "PMSUBW")
+		return "HI off by one";
+	return nullptr;
+}
+
+// The interpreter leaves the destination alone when ADD, ADDI, SUB, DADD, DADDI or DSUB
+// overflow, the recompiler writes the wrapped result.  Neither raises the exception.
+static bool Overflows(u32 code, const OpcodeBenchState& state)
+{
+	const s64 rs = state.gpr.r[(code >> 21) & 0x1f].SD[0];
+	const s64 rt = state.gpr.r[(code >> 16) & 0x1f].SD[0];
+	const s64 imm = (s16)code;
+
+	auto add32 = [](s64 a, s64 b) { const s64 r = (s64)(s32)a + (s32)b; return r != (s32)r; };
+	auto add64 = [](s64 a, s64 b) { const s64 r = (s64)((u64)a + (u64)b); return ((a ^ r) & (b ^ r)) < 0; };
+	auto sub64 = [](s64 a, s64 b) { const s64 r = (s64)((u64)a - (u64)b); return ((a ^ b) & (a ^ r)) < 0; };
+
+	switch (code >> 26)
+	{
+		case 0:
+			switch (code & 0x3f)
+			{
+				case 0x20: return add32(rs, rt);   // ADD
+				case 0x22: return add32(rs, -(s64)(s32)rt); // SUB
+				case 0x2c: return add64(rs, rt);   // DADD
+				case 0x2e: return sub64(rs, rt);   // DSUB
+			}
+			return false;
+		case 0x08: return add32(rs, imm);      // ADDI
+		case 0x18: return add64(rs, imm);      // DADDI
+	}
+	return false;
+}
+
+static void Interpret(u32 code)
+{
+	cpuRegs.pc = s_pc + 4;
+	cpuRegs.code = code;
+	GetInstruction(code).interpret();
+}
+
+// Floats within a unit in the last place
+static bool NearlyEqual(const void* a, const void* b, int size)
+{
+	for (int i = 0; i < size / 4; i++)
+	{
+		const u32 x = ((const u32*)a)[i];
+		const u32 y = ((const u32*)b)[i];
+
+		if (x != y && ((x ^ y) >> 31 || (x > y ? x - y : y - x) > 1))
+			return false;
+	}
+	return true;
+}
+
+// The first register that differs, or an empty string
+static std::string Compare(const OpcodeCase& c, const OpcodeBenchState& rec, const OpcodeBenchState& interp)
+{
+	char text[160];
+
+	auto diff = [&](const char* name, int index, const void* a, const void* b, int size) {
+		if (memcmp(a, b, size) == 0)
+			return false;
+
+		const u32* x = (const u32*)a;
+		const u32* y = (const u32*)b;
+		std::string got, expected;
+		for (int i = size / 4 - 1; i >= 0; i--)
+		{
+			char word[10];
+			snprintf(word, sizeof(word), "%08x", x[i]);
+			got += word;
+			snprintf(word, sizeof(word), "%08x", y[i]);
+			expected += word;
+		}
+		snprintf(text, sizeof(text), "%s%d %s, expected %s", name, index, got.c_str(), expected.c_str());
+		return true;
+	};
+
+	for (int i = 0; i < 32; i++)
+	{
+		if (diff("r", i, &rec.gpr.r[i], &interp.gpr.r[i], 16))
+			return text;
+	}
+
+	// QFSRV only uses the low 4 bits of SA, the recompiler only keeps them
+	const u32 recSA = rec.sa & 15, interpSA = interp.sa & 15;
+
+	if (diff("hi", 0, &rec.hi, &interp.hi, 16) || diff("lo", 0, &rec.lo, &interp.lo, 16) || diff("sa", 0, &recSA, &interpSA, 4))
+		return text;
+
+	for (int i = 0; i < 32; i++)
+	{
+		if (!(c.fmac && NearlyEqual(&rec.vf[i], &interp.vf[i], 16)) && diff("vf", i, &rec.vf[i], &interp.vf[i], 16))
+			return text;
+	}
+
+	if (!(c.fmac && NearlyEqual(&rec.acc, &interp.acc, 16)) && diff("acc", 0, &rec.acc, &interp.acc, 16))
+		return text;
+
+	// the integer registers, the flags and R, I and Q
+	for (int i = 0; i <= REG_Q; i++)
+	{
+		if (i != REG_ACC_FLAG && diff("vi", i, &rec.vi[i], &interp.vi[i], 4))
+			return text;
+	}
+
+	for (int i = 0; i < 32; i += 4)
+	{
+		if (diff("mem", i, &rec.mem[i], &interp.mem[i], 4))
+			return text;
+	}
+
+	return std::string();
+}
+
+static double NanosecondsSince(std::chrono::steady_clock::time_point start, u32 count)
+{
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / count;
+}
+
+struct OpcodeTiming
+{
+	u32 size;
+	double rec;
+	double interp;
+};
+
+static OpcodeTiming Time(u32 code, const OpcodeBenchState& state)
+{
+	OpcodeTiming timing;
+
+	*(u32*)PSM(s_pc) = code;
+	timing.size = recEECompileInstruction(s_pc);
+
+	state.Load();
+	auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < s_runs; i++)
+		recEERunInstruction(s_pc);
+	timing.rec = NanosecondsSince(start, s_runs);
+
+	state.Load();
+	start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < s_runs; i++)
+		Interpret(code);
+	timing.interp = NanosecondsSince(start, s_runs);
+
+	return timing;
+}
+
+int main(int argc, char* argv[])
+{
+	const u32 trials = argc > 1 ? std::max<u32>(strtoul(argv[1], nullptr, 10), 1) : 200;
+
+	log_cb = OpcodeBenchLog;
+
+	x86caps.Identify();
+	x86caps.SIMD_EstablishMXCSRmask();
+
+	g_Conf = std::make_unique<AppConfig>();
+
+	// The memory is mapped before the BIOS is loaded, none is needed here
+	GetVmMemory().ReserveAll();
+	try
+	{
+		GetVmMemory().ResetAll();
+	}
+	catch (Exception::BiosLoadFailed&)
+	{
+	}
+
+	recMicroVU0 vu0;
+	vu0.Reserve();
+	vu0.Reset();
+
+	recCpu.Reserve();
+	recCpu.Reset();
+
+	SetCPUState(EmuConfig.Cpu.sseMXCSR, EmuConfig.Cpu.sseVUMXCSR);
+
+	for (u32 i = 0; i < Ps2MemSize::MainRam; i += 4)
+		*(u32*)&eeMem->Main[i] = Random();
+
+	std::vector<OpcodeCase> tables[3];
+	EECases(tables[0]);
+	MMICases(tables[1]);
+	COP2Cases(tables[2]);
+	static const char* const tableNames[] = {"EE", "MMI", "COP2"};
+
+	// An empty block, sll r0, r0, 0
+	OpcodeBenchState state;
+	state.address = s_memBase;
+	state.Save();
+	const OpcodeTiming empty = Time(0, state);
+
+	printf("empty block: %u bytes, %.2f ns (recompiled), %.2f ns (interpreted)\n", empty.size, empty.rec, empty.interp);
+
+	int failures = 0;
+
+	for (int t = 0; t < 3; t++)
+	{
+		printf("\n%s:\n\n", tableNames[t]);
+		printf("  %-10s  bytes   rec ns  int ns  result\n", "opcode");
+
+		for (const OpcodeCase& c : tables[t])
+		{
+			u32 mismatches = 0;
+			u32 first = 0;
+			std::string what;
+
+			for (u32 i = 0; i < trials; i++)
+			{
+				u32 code;
+				do
+				{
+					code = RandomCode(c);
+					RandomState(c, code, state);
+				} while (Overflows(code, state));
+
+				OpcodeBenchState rec = state, interp = state;
+
+				state.Load();
+				*(u32*)PSM(s_pc) = code;
+				recEECompileInstruction(s_pc);
+				recEERunInstruction(s_pc);
+				rec.Save();
+
+				state.Load();
+				Interpret(code);
+				interp.Save();
+
+				const std::string diff = Compare(c, rec, interp);
+				if (!diff.empty() && mismatches++ == 0)
+				{
+					first = code;
+					what = diff;
+				}
+			}
+
+			const u32 code = RandomCode(c);
+			RandomState(c, code, state);
+			const OpcodeTiming timing = Time(code, state);
+
+			const char* const known = KnownDifference(c.name);
+			failures += mismatches != 0 && !known;
+
+			printf("  %-10s  %5d  %7.2f  %6.2f  %s", c.name.c_str(), (int)timing.size - (int)empty.size,
+				timing.rec - empty.rec, timing.interp - empty.interp, !mismatches ? "ok" : known ? "differs" : "FAILED");
+			if (mismatches)
+				printf(" (%u mismatches, %08x: %s)", mismatches, first, known ? known : what.c_str());
+			printf("\n");
+		}
+	}
+
+	printf("\n%d failed\n", failures);
+
+	return failures ? 1 : 0;
+}
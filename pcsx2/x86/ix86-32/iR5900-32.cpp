@@ -31,6 +31,8 @@
 
 #include "Patch.h"
 
+#include <unordered_set>
+
 #if !PCSX2_SEH
 #include "Utilities/FastJmp.h"
 #endif
@@ -100,6 +102,10 @@ static __aligned16 u8 manual_counter[Ps2MemSize::MainRam >> 12];
 static std::atomic<bool> eeRecIsReset(false);
 static std::atomic<bool> eeRecNeedsReset(false);
 static bool eeCpuExecuting = false;
+static BaseBlockProfiler recProfiler;
+static std::atomic<bool> recProfileRequested(false);
+static bool recProfileBlocks = false;
+static std::atomic<bool> recFastmemRequested(false);
 static bool g_resetEeScalingStats = false;
 static int g_patchesNeedRedo = 0;
 
@@ -276,6 +282,8 @@ static DynGenFunc* EnterRecompiledCode	= NULL;
 static DynGenFunc* ExitRecompiledCode	= NULL;
 static DynGenFunc* DispatchBlockDiscard = NULL;
 static DynGenFunc* DispatchPageReset    = NULL;
+static DynGenFunc* DispatchIndirectMiss = NULL;
+static DynGenFunc* DispatchEntryConstsMiss = NULL;
 
 // Note: scaleblockcycles() scales s_nBlockCycles respective to the EECycleRate value for manipulating the cycles of current block recompiling.
 // s_nBlockCycles is 3 bit fixed point.  Divide by 8 when done!
@@ -410,6 +418,215 @@ static DynGenFunc* _DynGen_DispatchPageReset()
 	return (DynGenFunc*)retval;
 }
 
+// --------------------------------------------------------------------------------------
+//  Indirect exit caches
+// --------------------------------------------------------------------------------------
+// The dynamic exits (jr, jalr, eret, ...) compare the new pc with an immediate and jump
+// straight to the block of that pc when it matches.  On a miss they call DispatchIndirectMiss,
+// which counts the misses per exit and links the exit to its target once the same pc came
+// up IndirectLinkThreshold times in a row.  The jump is linked through recBlocks like the
+// static exits, so clearing the target points it back to JITCompile.  Exits which keep
+// changing targets are turned into a plain jump to the dispatcher.
+
+// Not a valid pc, and not a sign extended imm8 so the compare always has an imm32 to patch
+static const u32 IndirectNone = 0x7ffffffd;
+static const u32 IndirectLinkThreshold = 4;
+static const u32 IndirectMaxRelinks = 8;
+
+struct IndirectSite
+{
+	u32* target;     // the imm32 of the compare
+	s32* jump;       // the rel32 of the jump to the block of target
+	u32 linked;      // pc the exit is linked to
+	u32 candidate;   // pc of the last misses
+	u32 misses;
+	u32 relinks;
+};
+
+// Keyed by the return address of the call to DispatchIndirectMiss (the end of the exit)
+static std::unordered_map<uptr, IndirectSite> s_indirectSites;
+
+static void recEmitIndirectExit()
+{
+	IndirectSite site = {};
+
+	xCMP(ptr32[&cpuRegs.pc], IndirectNone);
+	site.target = (u32*)xGetPtr() - 1;
+	site.jump = xJcc32(Jcc_Equal);
+	*site.jump = (s32)((uptr)JITCompile - (uptr)(site.jump + 1));
+	site.linked = IndirectNone;
+	site.candidate = IndirectNone;
+
+	xCALL((void*)DispatchIndirectMiss);
+
+	s_indirectSites[(uptr)xGetPtr()] = site;
+}
+
+static void __fastcall recIndirectMiss(uptr site_end)
+{
+	auto it = s_indirectSites.find(site_end);
+	if (it == s_indirectSites.end())
+		return;
+
+	IndirectSite& site = it->second;
+	const u32 newpc = cpuRegs.pc;
+
+	if (newpc != site.candidate)
+	{
+		site.candidate = newpc;
+		site.misses = 0;
+	}
+
+	if (++site.misses < IndirectLinkThreshold)
+		return;
+
+	if (site.linked != IndirectNone)
+	{
+		recBlocks.Unlink(HWADDR(site.linked), site.jump);
+
+		if (++site.relinks >= IndirectMaxRelinks)
+		{
+			// call DispatchIndirectMiss -> jmp DispatcherReg
+			u8* call = (u8*)site_end - 5;
+			*site.target = IndirectNone;
+			*call = 0xe9;
+			*(s32*)(call + 1) = (s32)((uptr)DispatcherReg - site_end);
+
+			s_indirectSites.erase(it);
+			return;
+		}
+	}
+
+	site.linked = newpc;
+	site.misses = 0;
+	*site.target = newpc;
+	recBlocks.Link(HWADDR(newpc), site.jump);
+}
+
+static DynGenFunc* _DynGen_DispatchIndirectMiss()
+{
+	u8* retval = xGetPtr();
+
+	// The return address identifies the exit, popping it keeps the stack aligned for the call
+	xPOP(arg1reg);
+	xFastCall((void*)recIndirectMiss);
+	xJMP((void*)DispatcherReg);
+
+	return (DynGenFunc*)retval;
+}
+
+// --------------------------------------------------------------------------------------
+//  Entry constants
+// --------------------------------------------------------------------------------------
+// The static exits record the constant GPRs they leave for their target.  When the target
+// is compiled, the ones all its recorded predecessors agree on and which the block uses as
+// a load/store base are assumed constant, so its memory accesses take the constant address
+// paths.  The assumptions are checked on entry (the block can also be reached from the
+// dispatcher or by a predecessor compiled later), a block entered with other values is
+// cleared and recompiled without them.
+
+static const u32 EntryConstsMax = 4;
+
+struct EntryConsts
+{
+	u32 mask;
+	u64 values[32];
+};
+
+// Keyed by the HWADDR of the target
+static std::unordered_map<u32, EntryConsts> s_entryConsts;
+static std::unordered_set<u32> s_entryConstsMissed;
+
+static void recRecordExitConsts(u32 newpc)
+{
+	const u32 mask = g_cpuHasConstReg & ~1u;
+	auto res = s_entryConsts.emplace(HWADDR(newpc), EntryConsts());
+	EntryConsts& entry = res.first->second;
+
+	if (res.second)
+	{
+		entry.mask = mask;
+		for (int r = 1; r < 32; r++)
+		{
+			if (mask & (1u << r))
+				entry.values[r] = g_cpuConstRegs[r].UD[0];
+		}
+		return;
+	}
+
+	for (int r = 1; r < 32; r++)
+	{
+		if ((entry.mask & (1u << r)) && (!(mask & (1u << r)) || entry.values[r] != g_cpuConstRegs[r].UD[0]))
+			entry.mask &= ~(1u << r);
+	}
+}
+
+// Emits the entry checks of the block and sets up the constants, returns their count
+static u32 recEmitEntryConsts(u32 startpc)
+{
+	// The hooks at the block entry must run once, and the TLB hack handles the addresses itself
+	if (EmuConfig.Gamefixes.GoemonTlbHack || HWADDR(startpc) == ElfEntry ||
+		(g_eeloadMain && HWADDR(startpc) == HWADDR(g_eeloadMain)) ||
+		(g_eeloadExec && HWADDR(startpc) == HWADDR(g_eeloadExec)))
+		return 0;
+
+	if (s_entryConstsMissed.count(HWADDR(startpc)))
+		return 0;
+
+	auto it = s_entryConsts.find(HWADDR(startpc));
+	if (it == s_entryConsts.end() || !it->second.mask)
+		return 0;
+
+	// The load/store bases (ldl/ldr, lq/sq and the 040-077 range but cache and pref)
+	u32 bases = 0;
+	for (u32 i = startpc; i < s_nEndBlock; i += 4)
+	{
+		const u32 code = *(u32*)PSM(i);
+		const u32 op = code >> 26;
+		if (op == 032 || op == 033 || op == 036 || op == 037 || (op >= 040 && op != 057 && op != 063))
+			bases |= 1u << ((code >> 21) & 0x1f);
+	}
+
+	const u32 mask = it->second.mask & bases;
+	u32 count = 0;
+
+	for (int r = 1; r < 32 && count < EntryConstsMax; r++)
+	{
+		if (!(mask & (1u << r)))
+			continue;
+
+		const u64 value = it->second.values[r];
+		xCMP(ptr32[&cpuRegs.GPR.r[r].UL[0]], (u32)value);
+		xJNE(DispatchEntryConstsMiss);
+		xCMP(ptr32[&cpuRegs.GPR.r[r].UL[1]], (u32)(value >> 32));
+		xJNE(DispatchEntryConstsMiss);
+
+		// Already in memory, nothing to flush
+		g_cpuConstRegs[r].UD[0] = value;
+		g_cpuHasConstReg |= 1u << r;
+		g_cpuFlushedConstReg |= 1u << r;
+		count++;
+	}
+
+	return count;
+}
+
+static void __fastcall recEntryConstsMiss()
+{
+	s_entryConstsMissed.insert(HWADDR(cpuRegs.pc));
+	recClear(cpuRegs.pc, 1);
+}
+
+static DynGenFunc* _DynGen_DispatchEntryConstsMiss()
+{
+	u8* retval = xGetPtr();
+
+	xFastCall((void*)recEntryConstsMiss);
+	xJMP((void*)ExitRecompiledCode);
+
+	return (DynGenFunc*)retval;
+}
+
 static void _DynGen_Dispatchers(void)
 {
 	// Recompiled code buffer for EE recompiler dispatchers!
@@ -432,6 +649,8 @@ static void _DynGen_Dispatchers(void)
 	EnterRecompiledCode  = _DynGen_EnterRecompiledCode();
 	DispatchBlockDiscard = _DynGen_DispatchBlockDiscard();
 	DispatchPageReset    = _DynGen_DispatchPageReset();
+	DispatchIndirectMiss = _DynGen_DispatchIndirectMiss();
+	DispatchEntryConstsMiss = _DynGen_DispatchEntryConstsMiss();
 
 	HostSys::MemProtectStatic( eeRecDispatchers, PageAccess_ExecOnly() );
 
@@ -511,10 +730,34 @@ static void recResetRaw(void)
 {
 	recAlloc();
 
+	// the counters are emitted into the blocks, so the profiler is switched along with the code
+	if (recProfileBlocks != recProfileRequested)
+	{
+		recProfileBlocks = recProfileRequested;
+		if (recProfileBlocks)
+			recProfiler.Clear();
+	}
+
+	// fastmem changes the code of every load and store, it is switched along with the code.
+	// The mirror is built without any protected page.
+	if (eeMem && recFastmemRequested != vtlb_FastmemActive())
+	{
+		mmap_ResetBlockTracking();
+
+		if (!recFastmemRequested)
+			vtlb_FastmemShutdown();
+		else if (!vtlb_FastmemInit())
+		{
+			log_cb(RETRO_LOG_WARN, "Fastmem isn't supported on this host, the EE recompiler keeps the vtlb lookups\n");
+			recFastmemRequested = false;
+		}
+	}
+
 	if( eeRecIsReset.exchange(true) ) return;
 	eeRecNeedsReset = false;
 
 	recMem->Reset();
+	vtlb_DynFastmemReset();
 	{
 		BASEBLOCK *base = (BASEBLOCK*)recLutReserve_RAM;
 		int memsize     = recLutSize;
@@ -531,6 +774,9 @@ static void recResetRaw(void)
 		memset( s_pInstCache, 0, sizeof(EEINST)*s_nInstCacheSize );
 
 	recBlocks.Reset();
+	s_indirectSites.clear();
+	s_entryConsts.clear();
+	s_entryConstsMissed.clear();
 	mmap_ResetBlockTracking();
 
 	x86SetPtr(*recMem);
@@ -652,11 +898,15 @@ static void iBranchTest(u32 newpc)
 		xSUB(eax, ptr[&g_nextEventCycle]);
 
 		if (newpc == 0xffffffff)
-			xJS( DispatcherReg );
+		{
+			xJNS( DispatcherEvent );
+			recEmitIndirectExit();
+		}
 		else
+		{
 			recBlocks.Link(HWADDR(newpc), xJcc32(Jcc_Signed));
-
-		xJMP( (void*)DispatcherEvent );
+			xJMP( (void*)DispatcherEvent );
+		}
 	}
 }
 
@@ -722,6 +972,15 @@ static void __fastcall recRecompile( const u32 startpc )
 
 	pxAssert(s_pCurBlockEx);
 
+	if (recProfileBlocks)
+	{
+		if (u64* counter = recProfiler.Counter(startpc))
+		{
+			xADD(ptr32[(u32*)counter], 1);
+			xADC(ptr32[(u32*)counter + 1], 0);
+		}
+	}
+
 	if (HWADDR(startpc) == EELOAD_START)
 	{
 		// The EELOAD _start function is the same across all BIOS versions
@@ -1028,9 +1287,12 @@ StartRecomp:
 
 	// Skip Recompilation if sceMpegIsEnd Pattern detected
 	bool doRecompilation = !skipMPEG_By_Pattern(startpc);
+	u32 entryConsts = 0;
 
 	if (doRecompilation)
 	{
+		entryConsts = recEmitEntryConsts(startpc);
+
 		// Finally: Generate x86 recompiled code!
 		g_pCurInstInfo = s_pInstCache;
 		while (!g_branch && pc < s_nEndBlock)
@@ -1107,6 +1369,7 @@ StartRecomp:
 			{
 				xMOV( ptr32[&cpuRegs.pc], pc );
 				xADD( ptr32[&cpuRegs.cycle], scaleblockcycles_calculation() );
+				recRecordExitConsts(pc);
 				recBlocks.Link( HWADDR(pc), xJcc32() );
 			}
 		}
@@ -1118,6 +1381,9 @@ StartRecomp:
 	pxAssert(xGetPtr() - recPtr < _64kb);
 	s_pCurBlockEx->x86size = xGetPtr() - recPtr;
 
+	if (recProfileBlocks)
+		recProfiler.Compiled(startpc, s_pCurBlockEx->size, s_pCurBlockEx->x86size, scaleblockcycles_calculation(), entryConsts);
+
 	recPtr = xGetPtr();
 
 	pxAssert( (g_cpuHasConstReg&g_cpuFlushedConstReg) == g_cpuHasConstReg );
@@ -1244,6 +1510,51 @@ static void recStep(void)
 {
 }
 
+// Takes effect with the next recompiler reset, reset the cpu while it's paused to switch it
+// right away.  The collected counts are kept until the profiler is switched on again.
+void recEEProfileBlocks(bool enable)
+{
+	recProfileRequested = enable;
+}
+
+// Takes effect with the next recompiler reset, like the profiler.
+void recEEFastmem(bool enable)
+{
+	recFastmemRequested = enable;
+}
+
+bool recEEWriteBlockProfile(const char* filename, u32 maxBlocks)
+{
+	return recProfiler.WriteReport(filename, "EE", maxBlocks);
+}
+
+// Compiles the instruction at pc as a block of its own, which returns to the caller when it
+// has run (see OpcodeBench.cpp).  The block at pc + 4 is replaced by the exit of the
+// recompiled code, any previous block at pc is cleared.  Returns the size of the code.
+u32 recEECompileInstruction(u32 pc)
+{
+	// The buffers are reset here when they're full, a reset in recRecompile would clear the
+	// exit.  recResetRaw does nothing while eeRecIsReset is set, as in recExecute.
+	eeRecIsReset = false;
+	if (recPtr >= (recMem->GetPtrEnd() - _64kb) || (recConstBufPtr - recConstBuf) >= RECCONSTBUF_SIZE - 64)
+		recResetRaw();
+
+	recClear(pc, 2);
+
+	recBlocks.New(HWADDR(pc + 4), (uptr)ExitRecompiledCode);
+	PC_GETBLOCK(pc + 4)->SetFnptr((uptr)ExitRecompiledCode);
+
+	recRecompile(pc);
+
+	return recBlocks.Get(HWADDR(pc))->x86size;
+}
+
+void recEERunInstruction(u32 pc)
+{
+	cpuRegs.pc = pc;
+	EnterRecompiledCode();
+}
+
 #if !PCSX2_SEH
 #	define SETJMP_CODE(x)  x
 	static fastjmp_buf m_SetJmp_StateCheck;
@@ -1395,6 +1706,7 @@ void SetBranchImm( u32 imm )
 
 	// end the current block
 	iFlushCall(FLUSH_EVERYTHING);
+	recRecordExitConsts(imm);
 	xMOV(ptr32[&cpuRegs.pc], imm);
 	iBranchTest(imm);
 }
@@ -1537,12 +1849,16 @@ void recompileNextInstruction(int delayslot)
 	else {
 		//If the COP0 DIE bit is disabled, cycles should be doubled.
 		s_nBlockCycles += opcode.cycles * (2 - ((cpuRegs.CP0.n.Config >> 18) & 0x1));
+		u8* start = xGetPtr();
 		try {
 			opcode.recompile();
 		} catch (Exception::FailedToAllocateRegister&) {
 			// Fall back to the interpreter
 			recCall(opcode.interpret);
 		}
+		// The delay slots are part of their branch
+		if (recProfileBlocks && !delayslot)
+			recProfiler.Emitted(opcode.Name, xGetPtr() - start);
 	}
 
 	if (!delayslot && (_getNumXMMwrite() > 2))
@@ -321,7 +321,7 @@ void recDIVconst(int upper)
 		quot = (g_cpuConstRegs[_Rs_].SL[0] < 0) ? 1 : -1;
 		rem = g_cpuConstRegs[_Rs_].SL[0];
 	}
-	recWritebackConstHILO((u64)quot|((u64)rem<<32), 0, upper);
+	recWritebackConstHILO((u64)(u32)quot|((u64)rem<<32), 0, upper);
 }
 
 void recDIV_const()
@@ -114,34 +114,35 @@ namespace vtlb_private
 	}
 
 	// ------------------------------------------------------------------------
-	static void DynGen_DirectRead( u32 bits, bool sign )
+	// addr is arg1reg once translated, or the fastmem base + arg1reg
+	static void DynGen_DirectRead( u32 bits, bool sign, const xAddressVoid& addr )
 	{
 		switch( bits )
 		{
 			case 8:
 				if( sign )
-					xMOVSX( eax, ptr8[arg1reg] );
+					xMOVSX( eax, ptr8[addr] );
 				else
-					xMOVZX( eax, ptr8[arg1reg] );
+					xMOVZX( eax, ptr8[addr] );
 				break;
 
 			case 16:
 				if( sign )
-					xMOVSX( eax, ptr16[arg1reg] );
+					xMOVSX( eax, ptr16[addr] );
 				else
-					xMOVZX( eax, ptr16[arg1reg] );
+					xMOVZX( eax, ptr16[addr] );
 				break;
 
 			case 32:
-				xMOV( eax, ptr[arg1reg] );
+				xMOV( eax, ptr[addr] );
 				break;
 
 			case 64:
-				iMOV64_Smart( ptr[arg2reg], ptr[arg1reg] );
+				iMOV64_Smart( ptr[arg2reg], ptr[addr] );
 				break;
 
 			case 128:
-				iMOV128_SSE( ptr[arg2reg], ptr[arg1reg] );
+				iMOV128_SSE( ptr[arg2reg], ptr[addr] );
 				break;
 
 			default:
@@ -150,7 +151,7 @@ namespace vtlb_private
 	}
 
 	// ------------------------------------------------------------------------
-	static void DynGen_DirectWrite( u32 bits )
+	static void DynGen_DirectWrite( u32 bits, const xAddressVoid& addr )
 	{
 		// TODO: x86Emitter can't use dil
 
@@ -159,26 +160,82 @@ namespace vtlb_private
 			//8 , 16, 32 : data on EDX
 			case 8:
 				xMOV( edx, arg2regd );
-				xMOV( ptr[arg1reg], dl );
+				xMOV( ptr[addr], dl );
 			break;
 
 			case 16:
-				xMOV( ptr[arg1reg], xRegister16(arg2reg) );
+				xMOV( ptr[addr], xRegister16(arg2reg) );
 			break;
 
 			case 32:
-				xMOV( ptr[arg1reg], arg2regd );
+				xMOV( ptr[addr], arg2regd );
 			break;
 
 			case 64:
-				iMOV64_Smart( ptr[arg1reg], ptr[arg2reg] );
+				iMOV64_Smart( ptr[addr], ptr[arg2reg] );
 			break;
 
 			case 128:
-				iMOV128_SSE( ptr[arg1reg], ptr[arg2reg] );
+				iMOV128_SSE( ptr[addr], ptr[arg2reg] );
 			break;
 		}
 	}
+
+	// ------------------------------------------------------------------------
+	// Fastmem: the access is emitted against the mirror of the virtual space (rbx holds its
+	// base), followed by the usual vtlb lookup.  The access jumps over the lookup until it
+	// faults once, the fault handler then patches its first bytes into a jump to the lookup.
+	//
+	struct FastmemSite
+	{
+		u8* code;	// start of the access, patched with the jump
+		u8* slow;	// vtlb lookup
+	};
+
+	// Sorted, the code is only appended until the next recompiler reset
+	static std::vector<FastmemSite> s_fastmem_sites;
+
+	static bool DynGen_UseFastmem( u32 bits )
+	{
+#ifdef __M_X86_64
+		// the spill of xmm0 by iMOV128_SSE can't be replayed by the lookup
+		return vtlbdata.fastmem_base && (bits != 128 || _hasFreeXMMreg());
+#else
+		return false;
+#endif
+	}
+
+	static u8* DynGen_FastmemBegin()
+	{
+		u8* code = xGetPtr();
+#ifdef __M_X86_64
+		xMOV64( rbx, (sptr)vtlbdata.fastmem_base );
+#endif
+		return code;
+	}
+
+	// Emits the jump over the lookup, returns the end of the jump for DynGen_FastmemEnd
+	static u8* DynGen_FastmemSite( u8* code )
+	{
+		xWrite8( 0xe9 );
+		xWrite32( 0 );
+		u8* done = xGetPtr();
+
+		pxAssert( done - code >= 10 ); // room for the patched jump
+
+		// a block that was dropped before its end can leave sites behind
+		while( !s_fastmem_sites.empty() && s_fastmem_sites.back().code >= code )
+			s_fastmem_sites.pop_back();
+
+		s_fastmem_sites.push_back( { code, done } );
+		return done;
+	}
+
+	static void DynGen_FastmemEnd( u8* done )
+	{
+		if( done )
+			*(s32*)(done - 4) = xGetPtr() - done;
+	}
 }
 
 // ------------------------------------------------------------------------
@@ -317,12 +374,22 @@ static void vtlb_SetWriteback(u32 *writeback)
 //                            Dynarec Load Implementations
 void vtlb_DynGenRead64(u32 bits)
 {
+	u8* fastmem = NULL;
+	if( DynGen_UseFastmem(bits) )
+	{
+		u8* code = DynGen_FastmemBegin();
+		DynGen_DirectRead( bits, false, rbx + arg1reg );
+		fastmem = DynGen_FastmemSite( code );
+	}
+
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 0, bits );
-	DynGen_DirectRead( bits, false );
+	DynGen_DirectRead( bits, false, arg1reg );
 
 	vtlb_SetWriteback(writeback);		// return target for indirect's call/ret
+
+	DynGen_FastmemEnd( fastmem );
 }
 
 // ------------------------------------------------------------------------
@@ -331,12 +398,22 @@ void vtlb_DynGenRead64(u32 bits)
 //   Returns read value in eax.
 void vtlb_DynGenRead32(u32 bits, bool sign)
 {
+	u8* fastmem = NULL;
+	if( DynGen_UseFastmem(bits) )
+	{
+		u8* code = DynGen_FastmemBegin();
+		DynGen_DirectRead( bits, sign, rbx + arg1reg );
+		fastmem = DynGen_FastmemSite( code );
+	}
+
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 0, bits, sign && bits < 32 );
-	DynGen_DirectRead( bits, sign );
+	DynGen_DirectRead( bits, sign, arg1reg );
 
 	vtlb_SetWriteback(writeback);
+
+	DynGen_FastmemEnd( fastmem );
 }
 
 // ------------------------------------------------------------------------
@@ -462,12 +539,22 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 
 void vtlb_DynGenWrite(u32 sz)
 {
+	u8* fastmem = NULL;
+	if( DynGen_UseFastmem(sz) )
+	{
+		u8* code = DynGen_FastmemBegin();
+		DynGen_DirectWrite( sz, rbx + arg1reg );
+		fastmem = DynGen_FastmemSite( code );
+	}
+
 	u32* writeback = DynGen_PrepRegs();
 
 	DynGen_IndirectDispatch( 1, sz );
-	DynGen_DirectWrite( sz );
+	DynGen_DirectWrite( sz, arg1reg );
 
 	vtlb_SetWriteback(writeback);
+
+	DynGen_FastmemEnd( fastmem );
 }
 
 
@@ -529,6 +616,39 @@ void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const )
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+//                            Fastmem Backpatching
+
+// Called by the page fault handler for an access to the mirror.  When pc is in a fastmem
+// access, the access is replaced by a jump to its vtlb lookup and the thread resumes there.
+bool vtlb_DynBackpatchFastmem(uptr* pc)
+{
+	if( !pc ) return false;
+
+	u8* code = (u8*)*pc;
+
+	auto it = std::upper_bound( s_fastmem_sites.begin(), s_fastmem_sites.end(), code,
+		[]( u8* p, const FastmemSite& site ) { return p < site.code; } );
+
+	if( it == s_fastmem_sites.begin() ) return false;
+	--it;
+
+	if( code >= it->slow ) return false;
+
+	// the recompiler memory is writable, the site is at least 10 bytes long
+	it->code[0] = 0xe9;
+	*(s32*)(it->code + 1) = it->slow - (it->code + 5);
+
+	*pc = (uptr)it->slow;
+	return true;
+}
+
+// The sites are dropped with the recompiled code
+void vtlb_DynFastmemReset(void)
+{
+	s_fastmem_sites.clear();
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 //							Extra Implementations
 
@@ -29,6 +29,96 @@ __ri void mVUcacheProg(microVU& mVU, microProgram& prog)
 		memcpy(prog.data, mVU.regs().Micro, 0x1000);
 	else
 		memcpy(prog.data, mVU.regs().Micro, 0x4000);
+	prog.hashState = 0;
+}
+
+// Hash of a micro memory word, the hash of a range is the sum of the hashes of its words
+static __fi u64 mVUhashWord(u32 idx, u32 word)
+{
+	u64 x = ((u64)idx << 32) | word;
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdull;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ull;
+	x ^= x >> 33;
+	return x;
+}
+
+// Marks micro memory words written, their hashes are updated by the next search
+static __fi void mVUdirtyMemHash(microVU& mVU, u32 addr, u32 size)
+{
+	u32 start = (addr & (mVU.microMemSize - 1)) / 4;
+	u32 end   = start + (size + 3) / 4;
+
+	if (end > mVU.progSize) { // Wraps around
+		start = 0;
+		end   = mVU.progSize;
+	}
+
+	mVU.prog.memDirtyStart = std::min(mVU.prog.memDirtyStart, start);
+	mVU.prog.memDirtyEnd   = std::max(mVU.prog.memDirtyEnd, end);
+}
+
+static void mVUupdateMemHash(microVU& mVU)
+{
+	microProgManager& p = mVU.prog;
+
+	if (p.memDirtyStart >= p.memDirtyEnd)
+		return;
+
+	const u32* micro = (u32*)mVU.regs().Micro;
+
+	for (u32 i = p.memDirtyStart; i < p.memDirtyEnd; i++)
+		p.memHash[i] = mVUhashWord(i, micro[i]);
+	for (u32 i = p.memDirtyStart; i < mVU.progSize; i++)
+		p.memHashSum[i + 1] = p.memHashSum[i] + p.memHash[i];
+
+	p.memDirtyStart = mVU.progSize;
+	p.memDirtyEnd   = 0;
+}
+
+// Compares the hash of the recompiled ranges of a program to the hash of the same ranges of
+// mVU.regs().Micro, false means the program can't match (true is only a candidate, see mVUcmpProg)
+static bool mVUcmpProgHash(microVU& mVU, microProgram& prog)
+{
+	if (prog.hashState == 0)
+	{
+		u64 hash = 0;
+		prog.hashState = 1;
+		for (const auto& range : *prog.ranges)
+		{
+			// Ranges still being recompiled, just do a full compare
+			if (range.start < 0 || range.end < range.start || range.end > (s32)mVU.microMemSize || ((range.start | range.end) & 3))
+			{
+				prog.hashState = -1;
+				break;
+			}
+			for (s32 i = range.start / 4; i < range.end / 4; i++)
+				hash += mVUhashWord(i, prog.data[i]);
+		}
+		prog.hash = hash;
+	}
+
+	if (prog.hashState < 0)
+		return true;
+
+	u64 hash = 0;
+	for (const auto& range : *prog.ranges)
+		hash += mVU.prog.memHashSum[range.end / 4] - mVU.prog.memHashSum[range.start / 4];
+
+	return hash == prog.hash;
+}
+
+static void mVUprintProgStats(microVU& mVU)
+{
+	const microProgStats& stats = mVU.prog.stats;
+
+	if (!stats.lookups)
+		return;
+
+	log_cb(RETRO_LOG_DEBUG, "microVU%d: %llu program searches, %.2f programs probed per search, %.1f%% reused, %llu hash collisions\n",
+		mVU.index, stats.lookups, (double)stats.probes / stats.lookups,
+		100.0 * stats.hits / stats.lookups, stats.verifies - stats.hits);
 }
 
 // Creates a new Micro Program
@@ -80,10 +170,17 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState)
 	microProgramList* list = mVU.prog.prog[mVU.regs().start_pc / 8];
 
 	if(!quick.prog) { // If null, we need to search for new program
+		mVUupdateMemHash(mVU);
+		mVU.prog.stats.lookups++;
 		std::deque<microProgram*>::iterator it(list->begin());
 		for ( ; it != list->end(); ++it) {
+			mVU.prog.stats.probes++;
+			if (!mVUcmpProgHash(mVU, *it[0]))
+				continue;
+			mVU.prog.stats.verifies++;
 			bool b = mVUcmpProg(mVU, *it[0], 0);
 			if (b) {
+				mVU.prog.stats.hits++;
 				quick.block = it[0]->block[startPC/8];
 				quick.prog  = it[0];
 				list->erase(it);
@@ -208,6 +305,11 @@ void mVUreset(microVU& mVU, bool resetReserve) {
 	mVU.prog.total		=  0;
 	mVU.prog.curFrame	=  0;
 
+	mVUprintProgStats(mVU);
+	memzero(mVU.prog.stats);
+	mVU.prog.memDirtyStart	=  0;
+	mVU.prog.memDirtyEnd	=  mVU.progSize;
+
 	// Setup Dynarec Cache Limits for Each Program
 	u8* z = mVU.cache;
 	mVU.prog.x86start	= z;
@@ -234,6 +336,8 @@ void mVUreset(microVU& mVU, bool resetReserve) {
 // Free Allocated Resources
 void mVUclose(microVU& mVU) {
 
+	mVUprintProgStats(mVU);
+
 	safe_delete  (mVU.cache_reserve);
 
 	// Delete Programs and Block Managers
@@ -249,6 +353,7 @@ void mVUclose(microVU& mVU) {
 
 // Clears Block Data in specified range
 __fi void mVUclear(mV, u32 addr, u32 size) {
+	mVUdirtyMemHash(mVU, addr, size);
 	if(!mVU.prog.cleared) {
 		mVU.prog.cleared = 1;		// Next execution searches/creates a new microprogram
 		memzero(mVU.prog.lpState); // Clear pipeline state
@@ -120,6 +120,8 @@ struct microProgram {
 	std::deque<microRange>* ranges;			   // The ranges of the microProgram that have already been recompiled
 	u32 startPC; // Start PC of this program
 	int idx;	 // Program index
+	u64 hash;	 // Sum of mVUhashWord() over the words of data[] in ranges
+	int hashState; // hash is (0 = stale, 1 = valid, -1 = ranges can't be hashed)
 };
 
 typedef std::deque<microProgram*> microProgramList;
@@ -129,6 +131,13 @@ struct microProgramQuick {
 	microProgram*		  prog;	 // The microProgram who is the owner of 'block'
 };
 
+struct microProgStats {
+	u64 lookups;  // Program searches (after micro memory writes)
+	u64 probes;   // Programs whose hash was compared to the micro memory
+	u64 verifies; // Programs compared byte for byte after a hash match
+	u64 hits;     // Searches that reused a cached program
+};
+
 struct microProgManager {
 	microIR<mProgSize>	IRinfo;				// IR information
 	microProgramList*	prog [mProgSize/2];	// List of microPrograms indexed by startPC values
@@ -142,6 +151,11 @@ struct microProgManager {
 	u8*					x86start;			// Start of program's rec-cache
 	u8*					x86end;				// Limit of program's rec-cache
 	microRegInfo		lpState;			// Pipeline state from where program left off (useful for continuing execution)
+	u64					memHash[mProgSize];	// mVUhashWord() of each word of mVU.regs().Micro
+	u64					memHashSum[mProgSize+1]; // Running sums of memHash (the hash of a range is the difference of 2 sums)
+	u32					memDirtyStart;		// First word of memHash written since the last search
+	u32					memDirtyEnd;		// Last word (+1) of memHash written since the last search
+	microProgStats		stats;				// Program search counters
 };
 
 static const uint mVUdispCacheSize	= __pagesize; // Dispatcher Cache Size (in bytes)
@@ -35,6 +35,7 @@ static __fi void mVUcheckIsSame(mV)
 static void mVUsetupRange(microVU& mVU, s32 pc, bool isStartPC)
 {
 	std::deque<microRange>*& ranges = mVUcurProg.ranges;
+	mVUcurProg.hashState = 0;
 
 	if (isStartPC) { // Check if startPC is already within a block we've recompiled
 		std::deque<microRange>::const_iterator it(ranges->begin());
@@ -21,6 +21,7 @@
 
 #include "GS.h"
 #include "GSUtil.h"
+#include "GSDump.h"
 #include "Renderers/SW/GSRendererSW.h"
 #include "Renderers/Null/GSRendererNull.h"
 #include "Renderers/Null/GSDeviceNull.h"
@@ -34,6 +35,9 @@
 
 #include "options_tools.h"
 
+#include <algorithm>
+#include <chrono>
+
 static bool is_d3d                  = false;
 GSRenderer* s_gs                    = NULL;
 static u8* s_basemem                = NULL;
@@ -278,6 +282,8 @@ EXPORT_C_(int) GSopen2(u32 flags)
 	}
 	stored_toggle_state = toggle_state;
 
+	theApp.SetConfig("jit_pregenerate", option_value(BOOL_PCSX2_OPT_SW_JIT_PREGENERATE, KeyOptionBool::return_type));
+
 	return _GSopen("", current_renderer);
 }
 
@@ -352,6 +358,210 @@ EXPORT_C GSsetFrameSkip(int frameskip)
 	s_gs->SetFrameSkip(frameskip);
 }
 
+EXPORT_C_(int) GSstartDump(const char* filename, int frames)
+{
+	if(s_gs == NULL || frames <= 0)
+		return -1;
+
+	return s_gs->StartDump(filename, frames) ? 0 : -1;
+}
+
+// Directory of the files the renderers keep between sessions, nothing is cached when empty.
+
+EXPORT_C GSsetCacheDir(const char* dir)
+{
+	// may come before GSinit
+	theApp.Init();
+
+	theApp.SetConfig("cache_dir", dir != NULL ? dir : "");
+}
+
+// The software renderer only touches its device to merge and present in VSync, the hardware
+// renderers issue device calls for every draw.
+
+EXPORT_C_(int) GSpacketsOffDeviceThread()
+{
+	const GSRendererType renderer = theApp.GetCurrentRendererType();
+
+	return s_gs != NULL && (renderer == GSRendererType::OGL_SW || renderer == GSRendererType::Null);
+}
+
+// Plays a dump back as fast as possible on a device-less renderer (GSRendererNull, or
+// GSRendererSW drawing into GSDeviceNull) and prints draw throughput and frame timings.
+// The GS state is restored from the dump before every loop, the first loop is not timed.
+
+EXPORT_C_(int) GSReplay(const char* filename, int renderer, int threads, int loops)
+{
+	GSDumpFile dump;
+
+	if(!dump.Load(filename))
+	{
+		fprintf(stderr, "GSReplay: cannot read dump %s\n", filename);
+		return -1;
+	}
+
+	if(dump.m_frames == 0)
+	{
+		fprintf(stderr, "GSReplay: %s does not contain any frame\n", filename);
+		return -1;
+	}
+
+	GSRendererType type = (GSRendererType)renderer;
+
+	if(type != GSRendererType::OGL_SW)
+		type = GSRendererType::Null;
+
+	delete s_gs;
+
+	s_gs = NULL;
+
+	theApp.SetCurrentRendererType(type);
+
+	if(type == GSRendererType::OGL_SW)
+		s_gs = new GSRendererSW(threads >= 0 ? threads : theApp.GetConfigI("extrathreads"));
+	else
+		s_gs = new GSRendererNull();
+
+	GSPrivRegSet* regs = (GSPrivRegSet*)_aligned_malloc(sizeof(GSPrivRegSet), 32);
+
+	memcpy(regs, dump.m_regs.data(), sizeof(GSPrivRegSet));
+
+	GSsetBaseMem((u8*)regs);
+
+	if(!s_gs->CreateDevice(new GSDeviceNull()))
+	{
+		GSshutdown();
+		s_basemem = NULL;
+		_aligned_free(regs);
+		return -1;
+	}
+
+	s_gs->SetGameCRC(dump.m_crc, 0);
+
+	GSFreezeData fd = {(int)dump.m_state.size(), dump.m_state.data()};
+
+	std::vector<u8> fifo;
+	std::vector<double> frame_ms;
+
+	frame_ms.reserve(dump.m_frames * std::max(loops, 1));
+
+	double total_ms = 0;
+
+	for(int i = 0; i <= std::max(loops, 1); i++)
+	{
+		if(s_gs->Defrost(&fd) != 0)
+		{
+			fprintf(stderr, "GSReplay: incompatible GS state in %s\n", filename);
+			break;
+		}
+
+		memcpy(regs, dump.m_regs.data(), sizeof(GSPrivRegSet));
+
+		// loop 0 warms up the texture caches and the scanline JIT
+
+		const bool timed = i > 0;
+
+		if(timed && i == 1)
+			s_gs->m_perfmon.Reset();
+
+		auto start = std::chrono::steady_clock::now();
+
+		for(const GSDumpFile::Packet& p : dump.m_packets)
+		{
+			switch(p.type)
+			{
+				case GSDumpType::Transfer:
+				{
+					const u8* data = (const u8*)&dump.m_data[p.offset];
+
+					switch(p.param)
+					{
+						case 0: s_gs->Transfer<0>(data, p.size / 16); break;
+						case 1: s_gs->Transfer<1>(data, p.size / 16); break;
+						case 2: s_gs->Transfer<2>(data, p.size / 16); break;
+						case 3: s_gs->Transfer<3>(data, p.size / 16); break;
+					}
+
+					break;
+				}
+				case GSDumpType::VSync:
+				{
+					s_gs->VSync(p.param);
+
+					auto now = std::chrono::steady_clock::now();
+
+					if(timed)
+						frame_ms.push_back(std::chrono::duration<double, std::milli>(now - start).count());
+
+					start = now;
+
+					break;
+				}
+				case GSDumpType::ReadFIFO2:
+					fifo.resize(p.size * 16);
+					s_gs->ReadFIFO(fifo.data(), p.size);
+					break;
+				case GSDumpType::Registers:
+					memcpy(regs, &dump.m_data[p.offset], sizeof(GSPrivRegSet));
+					break;
+			}
+		}
+	}
+
+	if(!frame_ms.empty())
+	{
+		for(double ms : frame_ms)
+			total_ms += ms;
+
+		std::vector<double> sorted(frame_ms);
+
+		std::sort(sorted.begin(), sorted.end());
+
+		const double seconds = total_ms / 1000;
+		const GSPerfMon& pm = s_gs->m_perfmon;
+
+		fprintf(stdout, "%s: %s renderer, %d frames x %d loops\n", filename,
+			type == GSRendererType::OGL_SW ? "SW" : "Null", dump.m_frames, std::max(loops, 1));
+		fprintf(stdout, "  %.2f fps, %.0f draws/s, %.0f prims/s, %.0f vertices/s\n",
+			frame_ms.size() / seconds,
+			pm.Get(GSPerfMon::Draw) / seconds,
+			pm.Get(GSPerfMon::Prim) / seconds,
+			pm.Get(GSPerfMon::Vertex) / seconds);
+		fprintf(stdout, "  frame time (ms): avg %.3f, min %.3f, median %.3f, p99 %.3f, max %.3f\n",
+			total_ms / frame_ms.size(),
+			sorted.front(),
+			sorted[sorted.size() / 2],
+			sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)],
+			sorted.back());
+
+		// draws per flush reason, and the state changes which kept the primitives queued
+
+		for(int merged = 0; merged < 2; merged++)
+		{
+			std::string line;
+
+			for(int i = 0; i < (int)GSFlushReason::Last; i++)
+			{
+				const GSFlushReason r = (GSFlushReason)i;
+				const u64 count = merged ? pm.GetMerges(r) : pm.GetFlushes(r);
+
+				if(count > 0)
+					line += format("%s%s %llu", line.empty() ? "" : ", ", GSPerfMon::GetName(r), (unsigned long long)count);
+			}
+
+			fprintf(stdout, "  %s: %s\n", merged ? "merged" : "flushes", line.empty() ? "none" : line.c_str());
+		}
+	}
+
+	GSshutdown();
+
+	s_basemem = NULL;
+
+	_aligned_free(regs);
+
+	return frame_ms.empty() ? -1 : 0;
+}
+
 std::string format(const char* fmt, ...)
 {
 	int size;
@@ -556,17 +766,20 @@ void GSdxApp::Init()
 	m_current_configuration["accurate_blending_unit"]                     = "1";
 	m_current_configuration["AspectRatio"]                                = "1";
 	m_current_configuration["autoflush_sw"]                               = "1";
+	m_current_configuration["cache_dir"]                                  = "";
 	m_current_configuration["clut_load_before_draw"]                      = "0";
 	m_current_configuration["crc_hack_level"]                             = std::to_string(static_cast<s8>(CRCHackLevel::Automatic));
 	m_current_configuration["CrcHacksExclusions"]                         = "";
 	m_current_configuration["disable_hw_gl_draw"]                         = "0";
 	m_current_configuration["dithering_ps2"]                              = "2";
 	m_current_configuration["extrathreads"]                               = "2";
+	m_current_configuration["extrathreads_binning"]                       = "0";
 	m_current_configuration["extrathreads_height"]                        = "4";
 	m_current_configuration["filter"]                                     = std::to_string(static_cast<s8>(BiFiltering::PS2));
 	m_current_configuration["force_texture_clear"]                        = "0";
 	m_current_configuration["fxaa"]                                       = "0";
 	m_current_configuration["interlace"]                                  = "7";
+	m_current_configuration["jit_pregenerate"]                            = "1";
 	m_current_configuration["large_framebuffer"]                          = "0";
 	m_current_configuration["linear_present"]                             = "1";
 	m_current_configuration["MaxAnisotropy"]                              = "0";
@@ -0,0 +1,178 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "GSDump.h"
+
+GSDump::GSDump(const std::string& fn, u32 crc, const GSFreezeData& fd, const GSPrivRegSet* regs, int frames)
+	: m_frames(frames)
+{
+	// fast compression level, the dump is written from the GS thread while the game runs
+	m_gz = gzopen(fn.c_str(), "wb1");
+
+	if(m_gz == NULL)
+		return;
+
+	Append(&crc, 4);
+	Append(&fd.size, 4);
+	Append(fd.data, fd.size);
+	Append(regs, sizeof(*regs));
+}
+
+GSDump::~GSDump()
+{
+	if(m_gz)
+		gzclose(m_gz);
+}
+
+void GSDump::Append(const void* data, u32 size)
+{
+	if(m_gz == NULL || size == 0)
+		return;
+
+	if(gzwrite(m_gz, data, size) != (int)size)
+	{
+		// disk full or similar, drop the dump rather than leaving a truncated packet behind
+
+		gzclose(m_gz);
+
+		m_gz = NULL;
+	}
+}
+
+void GSDump::Transfer(int index, const u8* mem, u32 size)
+{
+	if(size == 0)
+		return;
+
+	Append((u8)GSDumpType::Transfer);
+	Append((u8)index);
+	Append(&size, 4);
+	Append(mem, size);
+}
+
+void GSDump::ReadFIFO(u32 size)
+{
+	if(size == 0)
+		return;
+
+	Append((u8)GSDumpType::ReadFIFO2);
+	Append(&size, 4);
+}
+
+bool GSDump::VSync(int field, const GSPrivRegSet* regs)
+{
+	Append((u8)GSDumpType::Registers);
+	Append(regs, sizeof(*regs));
+
+	Append((u8)GSDumpType::VSync);
+	Append((u8)field);
+
+	return m_gz == NULL || --m_frames <= 0;
+}
+
+//
+
+GSDumpFile::GSDumpFile()
+	: m_crc(0)
+	, m_frames(0)
+{
+}
+
+bool GSDumpFile::Load(const std::string& fn)
+{
+	gzFile gz = gzopen(fn.c_str(), "rb");
+
+	if(gz == NULL)
+		return false;
+
+	// gzread returns 0 at the end of the stream, which only happens between two packets in a valid dump
+
+	auto read = [gz](void* dst, u32 size) -> bool
+	{
+		return size == 0 || gzread(gz, dst, size) == (int)size;
+	};
+
+	auto read_payload = [&](u32 size) -> bool
+	{
+		size_t offset = m_data.size();
+
+		m_data.resize(offset + (size + 15) / 16);
+
+		return read(&m_data[offset], size);
+	};
+
+	bool ok = true;
+
+	int state_size = 0;
+
+	m_regs.resize(sizeof(GSPrivRegSet) / 16);
+
+	ok = read(&m_crc, 4) && read(&state_size, 4) && state_size >= 0;
+
+	if(ok)
+	{
+		m_state.resize(state_size);
+
+		ok = read(m_state.data(), state_size) && read(m_regs.data(), sizeof(GSPrivRegSet));
+	}
+
+	u8 type;
+
+	while(ok && gzread(gz, &type, 1) == 1)
+	{
+		Packet p;
+
+		p.type = (GSDumpType)type;
+		p.param = 0;
+		p.size = 0;
+		p.offset = m_data.size();
+
+		switch(p.type)
+		{
+			case GSDumpType::Transfer:
+				ok = read(&p.param, 1) && read(&p.size, 4) && (p.size & 15) == 0 && read_payload(p.size);
+				break;
+			case GSDumpType::VSync:
+				ok = read(&p.param, 1);
+				m_frames++;
+				break;
+			case GSDumpType::ReadFIFO2:
+				ok = read(&p.size, 4);
+				break;
+			case GSDumpType::Registers:
+				p.size = sizeof(GSPrivRegSet);
+				ok = read_payload(p.size);
+				break;
+			default:
+				ok = false;
+				break;
+		}
+
+		if(ok)
+			m_packets.push_back(p);
+	}
+
+	ok = ok && gzeof(gz);
+
+	gzclose(gz);
+
+	return ok;
+}
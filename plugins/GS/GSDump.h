@@ -0,0 +1,96 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "GS.h"
+#include <zlib.h>
+#include <vector>
+
+/*
+
+Dump file format (gzip compressed):
+- [crc/4] [state size/4] [state data/size] [PMODE/0x2000] [id/1] [data/?] .. [id/1] [data/?]
+
+Transfer data (id == 0)
+- [path/1] [size/4] [data/size]
+
+VSync data (id == 1)
+- [field/1]
+
+ReadFIFO2 data (id == 2)
+- [size/4]
+
+Regs data (id == 3)
+- [PMODE/0x2000]
+
+*/
+
+enum class GSDumpType : u8
+{
+	Transfer,
+	VSync,
+	ReadFIFO2,
+	Registers,
+};
+
+class GSDump
+{
+	gzFile m_gz;
+	int m_frames;
+
+	void Append(const void* data, u32 size);
+	void Append(u8 c) {Append(&c, sizeof(c));}
+
+public:
+	GSDump(const std::string& fn, u32 crc, const GSFreezeData& fd, const GSPrivRegSet* regs, int frames);
+	virtual ~GSDump();
+
+	bool IsOpen() const {return m_gz != NULL;}
+
+	void Transfer(int index, const u8* mem, u32 size);
+	void ReadFIFO(u32 size);
+	bool VSync(int field, const GSPrivRegSet* regs); // returns true when the dump is complete
+};
+
+class GSDumpFile
+{
+public:
+	struct Packet
+	{
+		GSDumpType type;
+		u8 param;		// path (Transfer) or field (VSync)
+		u32 size;		// bytes (Transfer, Registers) or qwords (ReadFIFO2)
+		size_t offset;	// into m_data, in qwords
+	};
+
+	u32 m_crc;
+	std::vector<u8> m_state;
+	std::vector<GSVector4i> m_regs;		// GSPrivRegSet
+	std::vector<GSVector4i> m_data;		// transfer and register payloads, qword aligned
+	std::vector<Packet> m_packets;
+	int m_frames;
+
+public:
+	GSDumpFile();
+
+	bool Load(const std::string& fn);
+};
@@ -114,6 +114,9 @@ GSLocalMemory::GSLocalMemory()
 
 	memset(m_vm8, 0, m_vmsize);
 
+	memset(m_page_gen, 0, sizeof(m_page_gen));
+	m_gen = 0;
+
 	for(int bp = 0; bp < 32; bp++)
 	{
 		for(int y = 0; y < 32; y++) for(int x = 0; x < 64; x++)
@@ -709,6 +712,22 @@ std::vector<GSVector2i>* GSLocalMemory::GetPage2TileMap(const GIFRegTEX0& TEX0)
 	return p2t;
 }
 
+void GSLocalMemory::WritePages(const u32* pages, u32 psm)
+{
+	u32 msk = m_psm[psm].msk;
+
+	for(const u32* p = pages; *p != GSOffset::EOP; p++)
+	{
+		u32 page = *p;
+
+		if(msk & 0x3f) m_page_gen[0][page]++;
+		if(msk & 0x40) m_page_gen[1][page]++;
+		if(msk & 0x80) m_page_gen[2][page]++;
+	}
+
+	m_gen++;
+}
+
 ////////////////////
 
 template<int psm, int bsx, int bsy, int alignment>
@@ -132,6 +132,12 @@ public:
 
 	GSClut m_clut;
 
+	// Write generation of each page, the sources of the texture cache compare them on lookup
+	// instead of being invalidated by every transfer. The 24 bits formats and the 4 bits high
+	// formats don't share any bits, each group of bits has its own counter.
+	u32 m_page_gen[3][MAX_PAGES];
+	u32 m_gen; // bumped with any page
+
 protected:
 	bool m_use_fifo_alloc;
 
@@ -192,6 +198,17 @@ public:
 	GSPixelOffset4* GetPixelOffset4(const GIFRegFRAME& FRAME, const GIFRegZBUF& ZBUF);
 	std::vector<GSVector2i>* GetPage2TileMap(const GIFRegTEX0& TEX0);
 
+	// page generation
+
+	void WritePages(const u32* pages, u32 psm);
+
+	__forceinline u32 GetPageGen(u32 page, u32 msk) const
+	{
+		return ((msk & 0x3f) ? m_page_gen[0][page] : 0)
+			+ ((msk & 0x40) ? m_page_gen[1][page] : 0)
+			+ ((msk & 0x80) ? m_page_gen[2][page] : 0);
+	}
+
 	// address
 
 	static u32 BlockNumber32(int x, int y, u32 bp, u32 bw)
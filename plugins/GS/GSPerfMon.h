@@ -0,0 +1,114 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "Pcsx2Types.h"
+#include <cstring>
+
+// Why the queued primitives were sent to the renderer, see GSState::Flush. Mostly the register
+// whose write changed the drawing state, the rest are the transfers and the frontend calls.
+
+enum class GSFlushReason : u8
+{
+	PRIM,
+	TEX0,
+	CLUT,
+	CLAMP,
+	TEX1,
+	XYOFFSET,
+	PRMODE,
+	TEXCLUT,
+	SCANMSK,
+	MIPTBP,
+	TEXA,
+	FOGCOL,
+	SCISSOR,
+	ALPHA,
+	DIMX,
+	DTHE,
+	COLCLAMP,
+	TEST,
+	PABE,
+	FBA,
+	FRAME,
+	ZBUF,
+	Transfer,
+	TextureUpload,
+	AutoFlush,
+	ReadFIFO,
+	VSync,
+	SaveState,
+	Last,
+};
+
+// Running totals of the work submitted to the renderer, read back by the replayer.
+
+class GSPerfMon
+{
+public:
+	enum counter_t
+	{
+		Frame,
+		Draw,
+		Prim,
+		Vertex,
+		CounterLast,
+	};
+
+protected:
+	u64 m_counters[CounterLast];
+	u64 m_flushes[(int)GSFlushReason::Last];
+	u64 m_merges[(int)GSFlushReason::Last];
+
+public:
+	GSPerfMon() {Reset();}
+
+	void Reset()
+	{
+		memset(m_counters, 0, sizeof(m_counters));
+		memset(m_flushes, 0, sizeof(m_flushes));
+		memset(m_merges, 0, sizeof(m_merges));
+	}
+
+	void Put(counter_t c, u64 val = 1) {m_counters[c] += val;}
+	u64 Get(counter_t c) const {return m_counters[c];}
+
+	// a flush drew the queued primitives, a merge kept them queued across a state change
+	void PutFlush(GSFlushReason r) {m_flushes[(int)r]++;}
+	void PutMerge(GSFlushReason r) {m_merges[(int)r]++;}
+	u64 GetFlushes(GSFlushReason r) const {return m_flushes[(int)r];}
+	u64 GetMerges(GSFlushReason r) const {return m_merges[(int)r];}
+
+	static const char* GetName(GSFlushReason r)
+	{
+		static const char* names[] =
+		{
+			"PRIM", "TEX0", "CLUT", "CLAMP", "TEX1", "XYOFFSET", "PRMODE", "TEXCLUT", "SCANMSK", "MIPTBP",
+			"TEXA", "FOGCOL", "SCISSOR", "ALPHA", "DIMX", "DTHE", "COLCLAMP", "TEST", "PABE", "FBA",
+			"FRAME", "ZBUF", "transfer", "texture upload", "auto flush", "read fifo", "vsync", "save state",
+		};
+
+		static_assert(sizeof(names) / sizeof(names[0]) == (int)GSFlushReason::Last, "missing flush reason name");
+
+		return names[(int)r];
+	}
+};
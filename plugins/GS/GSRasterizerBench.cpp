@@ -0,0 +1,342 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+// Thread scaling of the software rasterizer, see GSRasterizerList.
+//
+// Draws a few synthetic scenes (small sprites, clustered triangles, full screen passes) with
+// 0 extra threads, then with 1, 2, 4, ... threads in the interleaved and the binned modes, and
+// prints the frame time and the speedup of each. The scanline function only blends the draw
+// counter into a 32-bit buffer, "work" times per pixel, which depends on the draw order, so
+// every run is also checked against the single-threaded result. The scenes are seeded.
+//
+// usage: pcsx2_GSRasterizerBench [frames] [max threads] [work]
+
+#include "GS.h"
+#include "Renderers/SW/GSRasterizer.h"
+
+#include <chrono>
+
+EXPORT_C_(int) GSinit();
+
+// The GS library is normally linked into the libretro core, which provides these.
+
+retro_environment_t environ_cb;
+retro_video_refresh_t video_cb;
+retro_log_printf_t log_cb;
+struct retro_hw_render_callback hw_render;
+
+int option_upscale_mult = 1;
+bool option_palette_conversion = false;
+bool hack_fb_conversion = false;
+bool hack_AutoFlush = false;
+bool hack_fast_invalidation = false;
+
+static bool bench_environment(unsigned cmd, void* data)
+{
+	return false;
+}
+
+static void bench_log(enum retro_log_level level, const char* fmt, ...)
+{
+	if(level < RETRO_LOG_WARN)
+		return;
+
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+static const int s_width = 640;
+static const int s_height = 448;
+
+static u32 s_fb[s_width * s_height];
+static int s_work = 8;
+
+class BenchDrawScanline : public IDrawScanline
+{
+	static thread_local u32 s_color;
+
+	static void SetupPrim(const GSVertexSW* vertex, const u32* index, const GSVertexSW& dscan)
+	{
+	}
+
+	static void __fastcall DrawScanline(int pixels, int left, int top, const GSVertexSW& scan)
+	{
+		u32* RESTRICT p = &s_fb[top * s_width + left];
+
+		for(int i = 0; i < pixels; i++)
+		{
+			u32 c = p[i];
+
+			for(int j = 0; j < s_work; j++)
+			{
+				c = (c ^ s_color) * 0x01000193;
+			}
+
+			p[i] = c;
+		}
+	}
+
+public:
+	BenchDrawScanline()
+	{
+		m_sp = SetupPrim;
+		m_ds = DrawScanline;
+	}
+
+	void BeginDraw(const GSRasterizerData* data)
+	{
+		s_color = (u32)data->counter;
+	}
+
+	void EndDraw(u64 frame, int actual, int total)
+	{
+	}
+};
+
+thread_local u32 BenchDrawScanline::s_color;
+
+// xorshift32, the scenes are reproducible
+static u32 s_random = 0x2545f491;
+
+static int Random(int n)
+{
+	s_random ^= s_random << 13;
+	s_random ^= s_random >> 17;
+	s_random ^= s_random << 5;
+
+	return (int)(s_random % (u32)n);
+}
+
+struct Scene
+{
+	const char* name;
+	std::vector<std::shared_ptr<GSRasterizerData>> draws;
+};
+
+static std::shared_ptr<GSRasterizerData> CreateDraw(GS_PRIM_CLASS primclass, const std::vector<GSVector2>& positions)
+{
+	std::shared_ptr<GSRasterizerData> data(new GSRasterizerData());
+
+	int count = (int)positions.size();
+
+	data->primclass = primclass;
+	data->buff = (u8*)_aligned_malloc(sizeof(GSVertexSW) * count + sizeof(u32) * count, 64);
+	data->vertex = (GSVertexSW*)data->buff;
+	data->vertex_count = count;
+	data->index = (u32*)(data->buff + sizeof(GSVertexSW) * count);
+	data->index_count = count;
+	data->scissor = GSVector4i(0, 0, s_width, s_height);
+
+	GSVector4 bbox = GSVector4(positions[0]).xyxy();
+
+	for(int i = 0; i < count; i++)
+	{
+		GSVertexSW& v = data->vertex[i];
+
+		v.p = GSVector4(positions[i].x, positions[i].y, 0.0f, 0.0f);
+		v.t = GSVector4::zero();
+		v.c = GSVector4::zero();
+
+		data->index[i] = i;
+
+		bbox = bbox.min(v.p.xyxy()).xyzw(bbox.max(v.p.xyxy()));
+	}
+
+	data->bbox = GSVector4i(bbox.floor().xyzw(bbox.ceil()));
+
+	return data;
+}
+
+static void CreateScenes(std::vector<Scene>& scenes)
+{
+	std::vector<GSVector2> p;
+
+	// 2D, batches of small sprites all over the screen
+
+	scenes.push_back({"sprites 16x16, 2000 draws x 8"});
+
+	for(int i = 0; i < 2000; i++)
+	{
+		p.clear();
+
+		for(int j = 0; j < 8; j++)
+		{
+			float x = (float)Random(s_width - 16);
+			float y = (float)Random(s_height - 16);
+
+			p.push_back(GSVector2(x, y));
+			p.push_back(GSVector2(x + 16, y + 16));
+		}
+
+		scenes.back().draws.push_back(CreateDraw(GS_SPRITE_CLASS, p));
+	}
+
+	// 3D, meshes of small triangles around a point
+
+	scenes.push_back({"triangles, 1000 draws x 32"});
+
+	for(int i = 0; i < 1000; i++)
+	{
+		p.clear();
+
+		int cx = 48 + Random(s_width - 96);
+		int cy = 48 + Random(s_height - 96);
+
+		for(int j = 0; j < 32 * 3; j++)
+		{
+			p.push_back(GSVector2(cx - 48 + Random(96) + Random(16) / 16.0f, cy - 48 + Random(96) + Random(16) / 16.0f));
+		}
+
+		scenes.back().draws.push_back(CreateDraw(GS_TRIANGLE_CLASS, p));
+	}
+
+	// post processing, full screen passes drawn as two sprites
+
+	scenes.push_back({"full screen, 32 draws x 2"});
+
+	for(int i = 0; i < 32; i++)
+	{
+		p.clear();
+		p.push_back(GSVector2(0.0f, 0.0f));
+		p.push_back(GSVector2(s_width / 2.0f, (float)s_height));
+		p.push_back(GSVector2(s_width / 2.0f, 0.0f));
+		p.push_back(GSVector2((float)s_width, (float)s_height));
+
+		scenes.back().draws.push_back(CreateDraw(GS_SPRITE_CLASS, p));
+	}
+}
+
+static u32 Checksum()
+{
+	u32 hash = 0x811c9dc5;
+
+	for(u32 c : s_fb)
+	{
+		hash = (hash ^ c) * 0x01000193;
+	}
+
+	return hash;
+}
+
+// Returns the average frame time in ms, the checksum of the result in crc
+static double Run(const Scene& scene, int threads, bool binning, int frames, u32& crc)
+{
+	theApp.SetConfig("extrathreads_binning", binning ? 1 : 0);
+
+	IRasterizer* rl = GSRasterizerList::Create<BenchDrawScanline>(threads);
+
+	memset(s_fb, 0, sizeof(s_fb));
+
+	double ms = 0;
+
+	// frame 0 warms up the caches and starts the threads
+
+	for(int i = 0; i <= frames; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		for(const auto& data : scene.draws)
+		{
+			rl->Queue(data);
+		}
+
+		rl->Sync();
+
+		if(i > 0)
+			ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	delete rl;
+
+	crc = Checksum();
+
+	return ms / frames;
+}
+
+int main(int argc, char* argv[])
+{
+	int frames = argc > 1 ? std::max(atoi(argv[1]), 1) : 20;
+	int max_threads = argc > 2 ? atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+	s_work = argc > 3 ? std::max(atoi(argv[3]), 0) : s_work;
+
+	environ_cb = bench_environment;
+	log_cb = bench_log;
+
+	if(GSinit() != 0)
+	{
+		fprintf(stderr, "GSinit failed\n");
+		return 1;
+	}
+
+	std::vector<int> counts;
+
+	for(int i = 1; i < max_threads; i *= 2)
+		counts.push_back(i);
+
+	counts.push_back(std::max(max_threads, 1));
+
+	std::vector<Scene> scenes;
+
+	CreateScenes(scenes);
+
+	int failures = 0;
+
+	for(const Scene& scene : scenes)
+	{
+		u32 reference;
+
+		double base = Run(scene, 0, false, frames, reference);
+
+		printf("%s, %d frames, work %d\n\n", scene.name, frames, s_work);
+		printf("  threads  interleaved ms  speedup  binned ms  speedup\n");
+		printf("  %7d  %14.3f  %7.2f  %9s  %7s\n", 0, base, 1.0, "", "");
+
+		for(int threads : counts)
+		{
+			u32 crc[2];
+
+			double interleaved = Run(scene, threads, false, frames, crc[0]);
+			double binned = Run(scene, threads, true, frames, crc[1]);
+
+			printf("  %7d  %14.3f  %7.2f  %9.3f  %7.2f", threads, interleaved, base / interleaved, binned, base / binned);
+
+			for(int i = 0; i < 2; i++)
+			{
+				if(crc[i] != reference)
+				{
+					printf("  %s FAILED (%08x, expected %08x)", i ? "binned" : "interleaved", crc[i], reference);
+
+					failures++;
+				}
+			}
+
+			printf("\n");
+		}
+
+		printf("\n");
+	}
+
+	printf("%d failed\n", failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+// Headless GS dump player, see GSReplay() in GS.cpp.
+//
+// usage: pcsx2_GSReplayLoader <dump.gs.gz> [sw|null] [loops] [extra threads]
+
+#include "GS.h"
+
+EXPORT_C_(int) GSinit();
+EXPORT_C_(int) GSReplay(const char* filename, int renderer, int threads, int loops);
+
+// The GS library is normally linked into the libretro core, which provides these.
+// The replayer never creates an OpenGL device, so they are only stubs.
+
+retro_environment_t environ_cb;
+retro_video_refresh_t video_cb;
+retro_log_printf_t log_cb;
+struct retro_hw_render_callback hw_render;
+
+int option_upscale_mult = 1;
+bool option_palette_conversion = false;
+bool hack_fb_conversion = false;
+bool hack_AutoFlush = false;
+bool hack_fast_invalidation = false;
+
+static bool replay_environment(unsigned cmd, void* data)
+{
+	return false;
+}
+
+static void replay_log(enum retro_log_level level, const char* fmt, ...)
+{
+	if(level < RETRO_LOG_WARN)
+		return;
+
+	va_list args;
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc < 2)
+	{
+		fprintf(stderr, "usage: %s <dump.gs.gz> [sw|null] [loops] [extra threads]\n", argv[0]);
+		return 1;
+	}
+
+	environ_cb = replay_environment;
+	log_cb = replay_log;
+
+	GSRendererType renderer = GSRendererType::OGL_SW;
+
+	if(argc > 2 && strcmp(argv[2], "null") == 0)
+		renderer = GSRendererType::Null;
+
+	int loops = argc > 3 ? atoi(argv[3]) : 1;
+	int threads = argc > 4 ? atoi(argv[4]) : -1;
+
+	if(GSinit() != 0)
+	{
+		fprintf(stderr, "GSinit failed\n");
+		return 1;
+	}
+
+	return GSReplay(argv[1], (int)renderer, threads, loops) == 0 ? 0 : 1;
+}
@@ -47,6 +47,7 @@ GSState::GSState()
 
 	// this hack will be called only once while system init
 	m_userhacks_auto_flush      = hack_AutoFlush;
+	m_merge_unused_state        = !m_clut_load_before_draw;
 
 	// these hack will be calledat every frame draw
 	m_userhacks_wildhack        = false;
@@ -137,6 +138,31 @@ void GSState::SetRegsMem(u8* basemem)
 	m_regs = (GSPrivRegSet*)basemem;
 }
 
+bool GSState::StartDump(const std::string& fn, int frames)
+{
+	GSFreezeData fd = {0, NULL};
+
+	Freeze(&fd, true);
+
+	std::vector<u8> state(fd.size);
+
+	fd.data = state.data();
+
+	if(Freeze(&fd, false) != 0)
+		return false;
+
+	m_dump = std::unique_ptr<GSDump>(new GSDump(fn, m_crc, fd, m_regs, frames));
+
+	if(!m_dump->IsOpen())
+	{
+		m_dump.reset();
+
+		return false;
+	}
+
+	return true;
+}
+
 void GSState::SetFrameSkip(int skip)
 {
 	if(m_frameskip == skip) return;
@@ -637,10 +663,10 @@ __forceinline void GSState::ApplyPRIM(u32 prim)
 	if(GSUtil::GetPrimClass(m_env.PRIM.PRIM) == GSUtil::GetPrimClass(prim & 7)) // NOTE: assume strips/fans are converted to lists
 	{
 		if((m_env.PRIM.U32[0] ^ prim) & 0x7f8) // all fields except PRIM
-			Flush();
+			Flush(GSFlushReason::PRIM);
 	}
 	else
-		Flush();
+		Flush(GSFlushReason::PRIM);
 
 	m_env.PRIM.U32[0] = prim;
 	m_env.PRMODE._PRIM = prim;
@@ -741,8 +767,10 @@ template<int i> void GSState::ApplyTEX0(GIFRegTEX0& TEX0)
 
 	u64 mask = 0x1f78001fffffffffull; // TBP0 TBW PSM TW TH TCC TFX CPSM CSA
 
-	if(wt || PRIM->CTXT == i && ((TEX0.U64 ^ m_env.CTXT[i].TEX0.U64) & mask))
-		Flush();
+	if(wt)
+		Flush(GSFlushReason::CLUT);
+	else if(PRIM->CTXT == i && ((TEX0.U64 ^ m_env.CTXT[i].TEX0.U64) & mask))
+		FlushIfUsed(GSFlushReason::TEX0, PRIM->TME);
 
 	TEX0.CPSM &= 0xa; // 1010b
 
@@ -886,7 +914,7 @@ template<int i> void GSState::GIFRegHandlerTEX0(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerCLAMP(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->CLAMP != m_env.CTXT[i].CLAMP)
-		Flush();
+		FlushIfUsed(GSFlushReason::CLAMP, PRIM->TME);
 
 	m_env.CTXT[i].CLAMP = (GSVector4i)r->CLAMP;
 }
@@ -903,7 +931,7 @@ void GSState::GIFRegHandlerNOP(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerTEX1(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->TEX1 != m_env.CTXT[i].TEX1)
-		Flush();
+		FlushIfUsed(GSFlushReason::TEX1, PRIM->TME);
 
 	m_env.CTXT[i].TEX1 = (GSVector4i)r->TEX1;
 }
@@ -929,8 +957,8 @@ template<int i> void GSState::GIFRegHandlerXYOFFSET(const GIFReg* RESTRICT r)
 {
 	GSVector4i o = (GSVector4i)r->XYOFFSET & GSVector4i::x0000ffff();
 
-	if(!o.eq(m_env.CTXT[i].XYOFFSET))
-		Flush();
+	if(PRIM->CTXT == i && !o.eq(m_env.CTXT[i].XYOFFSET) && !RebaseVertices(o))
+		Flush(GSFlushReason::XYOFFSET);
 
 	m_env.CTXT[i].XYOFFSET = o;
 
@@ -942,7 +970,7 @@ template<int i> void GSState::GIFRegHandlerXYOFFSET(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerPRMODECONT(const GIFReg* RESTRICT r)
 {
 	if(r->PRMODECONT != m_env.PRMODECONT)
-		Flush();
+		Flush(GSFlushReason::PRMODE);
 
 	m_env.PRMODECONT.AC = r->PRMODECONT.AC;
 
@@ -956,7 +984,7 @@ void GSState::GIFRegHandlerPRMODECONT(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerPRMODE(const GIFReg* RESTRICT r)
 {
 	if(!m_env.PRMODECONT.AC)
-		Flush();
+		Flush(GSFlushReason::PRMODE);
 
 	u32 _PRIM = m_env.PRMODE._PRIM;
 	m_env.PRMODE = (GSVector4i)r->PRMODE;
@@ -970,7 +998,7 @@ void GSState::GIFRegHandlerPRMODE(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerTEXCLUT(const GIFReg* RESTRICT r)
 {
 	if(r->TEXCLUT != m_env.TEXCLUT)
-		Flush();
+		FlushIfUsed(GSFlushReason::TEXCLUT, PRIM->TME);
 
 	m_env.TEXCLUT = (GSVector4i)r->TEXCLUT;
 }
@@ -978,7 +1006,7 @@ void GSState::GIFRegHandlerTEXCLUT(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerSCANMSK(const GIFReg* RESTRICT r)
 {
 	if(r->SCANMSK != m_env.SCANMSK)
-		Flush();
+		Flush(GSFlushReason::SCANMSK);
 
 	m_env.SCANMSK = (GSVector4i)r->SCANMSK;
 }
@@ -986,7 +1014,7 @@ void GSState::GIFRegHandlerSCANMSK(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerMIPTBP1(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->MIPTBP1 != m_env.CTXT[i].MIPTBP1)
-		Flush();
+		FlushIfUsed(GSFlushReason::MIPTBP, PRIM->TME);
 
 	m_env.CTXT[i].MIPTBP1 = (GSVector4i)r->MIPTBP1;
 }
@@ -994,7 +1022,7 @@ template<int i> void GSState::GIFRegHandlerMIPTBP1(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerMIPTBP2(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->MIPTBP2 != m_env.CTXT[i].MIPTBP2)
-		Flush();
+		FlushIfUsed(GSFlushReason::MIPTBP, PRIM->TME);
 
 	m_env.CTXT[i].MIPTBP2 = (GSVector4i)r->MIPTBP2;
 }
@@ -1002,7 +1030,7 @@ template<int i> void GSState::GIFRegHandlerMIPTBP2(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerTEXA(const GIFReg* RESTRICT r)
 {
 	if(r->TEXA != m_env.TEXA)
-		Flush();
+		FlushIfUsed(GSFlushReason::TEXA, PRIM->TME);
 
 	m_env.TEXA = (GSVector4i)r->TEXA;
 }
@@ -1010,7 +1038,7 @@ void GSState::GIFRegHandlerTEXA(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerFOGCOL(const GIFReg* RESTRICT r)
 {
 	if(r->FOGCOL != m_env.FOGCOL)
-		Flush();
+		FlushIfUsed(GSFlushReason::FOGCOL, PRIM->FGE);
 
 	m_env.FOGCOL = (GSVector4i)r->FOGCOL;
 }
@@ -1022,7 +1050,7 @@ void GSState::GIFRegHandlerTEXFLUSH(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerSCISSOR(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->SCISSOR != m_env.CTXT[i].SCISSOR)
-		Flush();
+		Flush(GSFlushReason::SCISSOR);
 
 	m_env.CTXT[i].SCISSOR = (GSVector4i)r->SCISSOR;
 
@@ -1034,7 +1062,7 @@ template<int i> void GSState::GIFRegHandlerSCISSOR(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerALPHA(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->ALPHA != m_env.CTXT[i].ALPHA)
-		Flush();
+		FlushIfUsed(GSFlushReason::ALPHA, PRIM->ABE || PRIM->AA1);
 
 	m_env.CTXT[i].ALPHA = (GSVector4i)r->ALPHA;
 
@@ -1049,7 +1077,7 @@ void GSState::GIFRegHandlerDIMX(const GIFReg* RESTRICT r)
 
 	if(r->DIMX != m_env.DIMX)
 	{
-		Flush();
+		Flush(GSFlushReason::DIMX);
 
 		update = true;
 	}
@@ -1065,7 +1093,7 @@ void GSState::GIFRegHandlerDIMX(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerDTHE(const GIFReg* RESTRICT r)
 {
 	if(r->DTHE != m_env.DTHE)
-		Flush();
+		Flush(GSFlushReason::DTHE);
 
 	m_env.DTHE = (GSVector4i)r->DTHE;
 }
@@ -1073,7 +1101,7 @@ void GSState::GIFRegHandlerDTHE(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerCOLCLAMP(const GIFReg* RESTRICT r)
 {
 	if(r->COLCLAMP != m_env.COLCLAMP)
-		Flush();
+		Flush(GSFlushReason::COLCLAMP);
 
 	m_env.COLCLAMP = (GSVector4i)r->COLCLAMP;
 }
@@ -1081,7 +1109,7 @@ void GSState::GIFRegHandlerCOLCLAMP(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerTEST(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->TEST != m_env.CTXT[i].TEST)
-		Flush();
+		Flush(GSFlushReason::TEST);
 
 	m_env.CTXT[i].TEST = (GSVector4i)r->TEST;
 }
@@ -1089,7 +1117,7 @@ template<int i> void GSState::GIFRegHandlerTEST(const GIFReg* RESTRICT r)
 void GSState::GIFRegHandlerPABE(const GIFReg* RESTRICT r)
 {
 	if(r->PABE != m_env.PABE)
-		Flush();
+		Flush(GSFlushReason::PABE);
 
 	m_env.PABE = (GSVector4i)r->PABE;
 }
@@ -1097,7 +1125,7 @@ void GSState::GIFRegHandlerPABE(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerFBA(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->FBA != m_env.CTXT[i].FBA)
-		Flush();
+		Flush(GSFlushReason::FBA);
 
 	m_env.CTXT[i].FBA = (GSVector4i)r->FBA;
 }
@@ -1105,7 +1133,7 @@ template<int i> void GSState::GIFRegHandlerFBA(const GIFReg* RESTRICT r)
 template<int i> void GSState::GIFRegHandlerFRAME(const GIFReg* RESTRICT r)
 {
 	if(PRIM->CTXT == i && r->FRAME != m_env.CTXT[i].FRAME)
-		Flush();
+		Flush(GSFlushReason::FRAME);
 
 	if((m_env.CTXT[i].FRAME.U32[0] ^ r->FRAME.U32[0]) & 0x3f3f01ff) // FBP FBW PSM
 	{
@@ -1155,7 +1183,7 @@ template<int i> void GSState::GIFRegHandlerZBUF(const GIFReg* RESTRICT r)
 	}
 
 	if(PRIM->CTXT == i && ZBUF != m_env.CTXT[i].ZBUF)
-		Flush();
+		Flush(GSFlushReason::ZBUF);
 
 	if((m_env.CTXT[i].ZBUF.U32[0] ^ ZBUF.U32[0]) & 0x3f0001ff) // ZBP PSM
 	{
@@ -1211,7 +1239,7 @@ void GSState::GIFRegHandlerTRXREG(const GIFReg* RESTRICT r)
 
 void GSState::GIFRegHandlerTRXDIR(const GIFReg* RESTRICT r)
 {
-	Flush();
+	Flush(GSFlushReason::Transfer);
 
 	m_env.TRXDIR = (GSVector4i)r->TRXDIR;
 
@@ -1222,6 +1250,8 @@ void GSState::GIFRegHandlerTRXDIR(const GIFReg* RESTRICT r)
 			break;
 		case 1: // local -> host
 			m_tr.Init(m_env.TRXPOS.SSAX, m_env.TRXPOS.SSAY, m_env.BITBLTBUF);
+			// the FIFO is read later (InitReadFIFO), the renderer can already start fetching the data
+			PrefetchLocalMem(m_env.BITBLTBUF, GSVector4i(m_env.TRXPOS.SSAX, m_env.TRXPOS.SSAY, m_env.TRXPOS.SSAX + m_env.TRXREG.RRW, m_env.TRXPOS.SSAY + m_env.TRXREG.RRH));
 			break;
 		case 2: // local -> local
 			Move();
@@ -1241,13 +1271,73 @@ void GSState::GIFRegHandlerHWREG(const GIFReg* RESTRICT r)
 		Write((u8*)r, 8); // Haunting Ground
 }
 
-void GSState::Flush()
+void GSState::Flush(GSFlushReason reason)
 {
 	const int len = m_tr.end - m_tr.start;
 	if (len > 0)
 		FlushWrite(len);
 	if(m_index.tail > 0)
-		FlushPrim();
+		FlushPrim(reason);
+}
+
+void GSState::FlushIfUsed(GSFlushReason reason, bool used)
+{
+	// The queued primitives don't read the register (texture state without TME, ...), keep
+	// queuing so that the next draw goes out with them. Game specific hacks may look at these
+	// registers regardless, their games always flush.
+
+	if(used || !m_merge_unused_state)
+	{
+		Flush(reason);
+	}
+	else if(m_index.tail > 0)
+	{
+		m_perfmon.PutMerge(reason);
+	}
+}
+
+bool GSState::RebaseVertices(const GSVector4i& o)
+{
+	// Sprites drawn one by one at a moving XYOFFSET (text, HUDs, particles). Moving the queued
+	// vertices by the same amount keeps their window coordinates, so the next primitives can
+	// join them. Only whole primitives, the vertices of a partial one are still waiting for the
+	// new offset, and only a bounded number since the whole queue gets rewritten every time.
+
+	if(m_index.tail == 0)
+		return true;
+
+	if(m_vertex.head != m_vertex.tail || m_vertex.tail > 1024)
+		return false;
+
+	const int dx = o.x - (int)m_context->XYOFFSET.OFX;
+	const int dy = o.y - (int)m_context->XYOFFSET.OFY;
+
+	int minx = 0xffff, miny = 0xffff, maxx = 0, maxy = 0;
+
+	for(size_t j = 0; j < m_vertex.tail; j++)
+	{
+		const GIFRegXYZ& XYZ = m_vertex.buff[j].XYZ;
+
+		minx = std::min<int>(minx, XYZ.X);
+		miny = std::min<int>(miny, XYZ.Y);
+		maxx = std::max<int>(maxx, XYZ.X);
+		maxy = std::max<int>(maxy, XYZ.Y);
+	}
+
+	if(minx + dx < 0 || miny + dy < 0 || maxx + dx > 0xffff || maxy + dy > 0xffff)
+		return false;
+
+	for(size_t j = 0; j < m_vertex.tail; j++)
+	{
+		GIFRegXYZ& XYZ = m_vertex.buff[j].XYZ;
+
+		XYZ.X = (u16)(XYZ.X + dx);
+		XYZ.Y = (u16)(XYZ.Y + dy);
+	}
+
+	m_perfmon.PutMerge(GSFlushReason::XYOFFSET);
+
+	return true;
 }
 
 void GSState::FlushWrite(const int len)
@@ -1268,8 +1358,10 @@ void GSState::FlushWrite(const int len)
 	m_tr.start += len;
 }
 
-void GSState::FlushPrim()
+void GSState::FlushPrim(GSFlushReason reason)
 {
+	m_perfmon.PutFlush(reason);
+
 	// Some games (Harley Davidson/Virtua Fighter) do dirty trick with multiple contexts cluts
 	// In doubt, always reload the clut before a draw.
 	// Note: perf impact is likely slow enough as WriteTest will likely be false.
@@ -1315,6 +1407,10 @@ void GSState::FlushPrim()
 	{
 		m_vt.Update(m_vertex.buff, m_index.buff, m_vertex.tail, m_index.tail, GSUtil::GetPrimClass(PRIM->PRIM));
 
+		m_perfmon.Put(GSPerfMon::Draw);
+		m_perfmon.Put(GSPerfMon::Prim, m_index.tail / GSUtil::GetClassVertexCount(m_vt.m_primclass));
+		m_perfmon.Put(GSPerfMon::Vertex, m_vertex.tail);
+
 		m_context->SaveReg();
 
 		try {
@@ -1384,7 +1480,7 @@ void GSState::Write(const u8* mem, int len)
 
 	if(PRIM->TME && (blit.DBP == m_context->TEX0.TBP0 || blit.DBP == m_context->TEX0.CBP)) // TODO: hmmmm
 		if(m_index.tail > 0)
-			FlushPrim();
+			FlushPrim(GSFlushReason::TextureUpload);
 
 	if(m_tr.end == 0 && len >= m_tr.total)
 	{
@@ -1663,7 +1759,10 @@ void GSState::SoftReset(u32 mask)
 
 void GSState::ReadFIFO(u8* mem, int size)
 {
-	Flush();
+	Flush(GSFlushReason::ReadFIFO);
+
+	if(m_dump)
+		m_dump->ReadFIFO(size);
 
 	size *= 16;
 
@@ -1874,6 +1973,9 @@ template<int index> void GSState::Transfer(const u8* mem, u32 size)
 			path.nloop = 0;
 		}
 	}
+
+	if(m_dump && mem > start)
+		m_dump->Transfer(index, start, (u32)(mem - start));
 }
 
 template<class T> static void WriteState(u8*& dst, T* src, size_t len = sizeof(T))
@@ -1899,7 +2001,7 @@ int GSState::Freeze(GSFreezeData* fd, bool sizeonly)
 	if(!fd->data || fd->size < m_sssize)
 		return -1;
 
-	Flush();
+	Flush(GSFlushReason::SaveState);
 
 	u8* data = fd->data;
 
@@ -1985,7 +2087,7 @@ int GSState::Defrost(const GSFreezeData* fd)
 	if(version > m_version)
 		return -1;
 
-	Flush();
+	Flush(GSFlushReason::SaveState);
 
 	Reset();
 
@@ -2094,6 +2196,8 @@ void GSState::SetGameCRC(u32 crc, int options)
 	// (if  a solution does exist)
 	if (m_game.title == CRC::HarleyDavidson)
 		m_clut_load_before_draw = true;
+
+	m_merge_unused_state = m_game.title == CRC::NoTitle && !m_clut_load_before_draw;
 }
 
 void GSState::UpdateContext()
@@ -2378,7 +2482,7 @@ __forceinline void GSState::VertexKick(u32 skip)
 
 	if (auto_flush && PRIM->TME && (GIFREG_FRAME_BLOCK(m_context->FRAME) == m_context->TEX0.TBP0))
 		if(m_index.tail > 0)
-			FlushPrim();
+			FlushPrim(GSFlushReason::AutoFlush);
 }
 
 void GSState::GetTextureMinMax(GSVector4i& r, const GIFRegTEX0& TEX0, const GIFRegCLAMP& CLAMP, bool linear)
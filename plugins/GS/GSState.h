@@ -34,6 +34,8 @@
 #include "Renderers/Common/GSDevice.h"
 #include "GSCrc.h"
 #include "GSAlignedClass.h"
+#include "GSPerfMon.h"
+#include "GSDump.h"
 
 struct GSFrameInfo
 {
@@ -160,6 +162,7 @@ protected:
 	int m_userhacks_skipdraw;
 	int m_userhacks_skipdraw_offset;
 	bool m_userhacks_auto_flush;
+	bool m_merge_unused_state;
 
 	GSVertex m_v;
 	float m_q;
@@ -185,6 +188,8 @@ protected:
 
 	void UpdateVertexKick();
 
+	bool RebaseVertices(const GSVector4i& o);
+
 	void GrowVertexBuffer();
 
 	template<u32 prim, bool auto_flush>
@@ -215,6 +220,8 @@ public:
 	bool m_NTSC_Saturation;
 	bool m_nativeres;
 	int m_mipmap;
+	GSPerfMon m_perfmon;
+	std::unique_ptr<GSDump> m_dump;
 
 public:
 	GSState();
@@ -233,13 +240,15 @@ public:
 	float GetTvRefreshRate();
 
 	virtual void Reset();
-	void Flush();
-	void FlushPrim();
+	void Flush(GSFlushReason reason);
+	void FlushIfUsed(GSFlushReason reason, bool used);
+	void FlushPrim(GSFlushReason reason);
 	void FlushWrite(const int len);
 	virtual void Draw() = 0;
 	virtual void PurgePool() = 0;
 	virtual void InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r) {}
 	virtual void InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut = false) {}
+	virtual void PrefetchLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r) {}
 
 	void Move();
 	void Write(const u8* mem, int len);
@@ -255,5 +264,6 @@ public:
 	virtual void SetGameCRC(u32 crc, int options);
 	void SetFrameSkip(int skip);
 	void SetRegsMem(u8* basemem);
+	bool StartDump(const std::string& fn, int frames);
 };
 
@@ -30,12 +30,15 @@
 
 #include "../SW/GSScanlineEnvironment.h"
 
+#include <mutex>
+
 template<class KEY, class VALUE> class GSFunctionMap
 {
 protected:
 	struct ActivePtr
 	{
 		VALUE f;
+		u64 hits;
 	};
 
 	std::unordered_map<KEY, VALUE> m_map;
@@ -81,8 +84,16 @@ public:
 			m_active = m_map_active[key] = p;
 		}
 
+		m_active->hits++;
+
 		return m_active->f;
 	}
+
+	// Adds the number of lookups of every key since the map was created to hits.
+	void GetHits(std::unordered_map<KEY, u64>& hits) const
+	{
+		for(auto &i : m_map_active) hits[i.first] += i.second->hits;
+	}
 };
 
 class GSCodeGenerator : public Xbyak::CodeGenerator
@@ -97,22 +108,37 @@ public:
 	}
 };
 
+// The generated functions may also be requested from another thread than the one drawing with
+// them (see Prepare), the code buffer and the generated function table are shared under m_lock.
+
 template<class CG, class KEY, class VALUE>
 class GSCodeGeneratorFunctionMap : public GSFunctionMap<KEY, VALUE>
 {
+	std::string m_name;
 	void* m_param;
 	std::unordered_map<u64, VALUE> m_cgmap;
 	GSCodeBuffer m_cb;
+	std::mutex m_lock;
 
 public:
 	GSCodeGeneratorFunctionMap(const char* name, void* param)
-		: m_param(param) { }
+		: m_name(name), m_param(param) { }
 	~GSCodeGeneratorFunctionMap() { }
 
+	const std::string& GetName() const {return m_name;}
+
+	// Generates the function ahead of its first use.
+	void Prepare(KEY key)
+	{
+		GetDefaultFunction(key);
+	}
+
 	VALUE GetDefaultFunction(KEY key)
 	{
 		VALUE ret = NULL;
 
+		std::lock_guard<std::mutex> lock(m_lock);
+
 		auto i = m_cgmap.find(key);
 
 		if(i != m_cgmap.end())
@@ -249,7 +249,12 @@ GSVector2i GSRenderer::GetInternalResolution()
 
 void GSRenderer::VSync(int field)
 {
-	Flush();
+	Flush(GSFlushReason::VSync);
+
+	m_perfmon.Put(GSPerfMon::Frame);
+
+	if(m_dump && m_dump->VSync(field, m_regs))
+		m_dump.reset();
 
 	if(!Merge(field ? 1 : 0))
 		return;
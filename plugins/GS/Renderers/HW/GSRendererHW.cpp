@@ -738,6 +738,8 @@ void GSRendererHW::MergeSprite(GSTextureCache::Source* tex)
 
 void GSRendererHW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r)
 {
+	m_tc->CancelReads();
+
 	m_tc->InvalidateVideoMem(m_mem.GetOffset(BITBLTBUF.DBP, BITBLTBUF.DBW, BITBLTBUF.DPSM), r);
 }
 
@@ -748,6 +750,13 @@ void GSRendererHW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 	m_tc->InvalidateLocalMem(m_mem.GetOffset(BITBLTBUF.SBP, BITBLTBUF.SBW, BITBLTBUF.SPSM), r);
 }
 
+void GSRendererHW::PrefetchLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r)
+{
+	m_tc->CancelReads();
+
+	m_tc->InvalidateLocalMem(m_mem.GetOffset(BITBLTBUF.SBP, BITBLTBUF.SBW, BITBLTBUF.SPSM), r, true);
+}
+
 u16 GSRendererHW::Interpolate_UV(float alpha, int t0, int t1)
 {
 	const float t = (1.0f - alpha) * t0 + alpha * t1;
@@ -1081,6 +1090,9 @@ void GSRendererHW::RoundSpriteOffset()
 
 void GSRendererHW::Draw()
 {
+	// the targets are about to change, drop the readbacks started for a transfer
+	m_tc->CancelReads();
+
 	if(IsBadFrame())
 		return;
 
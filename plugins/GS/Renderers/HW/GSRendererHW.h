@@ -190,6 +190,7 @@ public:
 	GSTexture* GetFeedbackOutput();
 	void InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r);
 	void InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut = false);
+	void PrefetchLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r);
 	void Draw();
 
 	// Called by the texture cache to know if current texture is useful
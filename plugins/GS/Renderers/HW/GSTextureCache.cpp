@@ -77,6 +77,8 @@ void GSTextureCache::RemovePartial()
 
 void GSTextureCache::RemoveAll()
 {
+	CancelReads();
+
 	m_src.RemoveAll();
 
 	for(int type = 0; type < 2; type++)
@@ -717,12 +719,22 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 
 	off->GetPages(rect, pages, &r);
 
-	bool found = false;
+	// The other sources compare the page generations when they are looked up
+	m_renderer->m_mem.WritePages(pages, psm);
+
+	alignas(16) u32 written[MAX_PAGES / 32] = {};
 
 	for(const u32* p = pages; *p != GSOffset::EOP; p++)
 	{
 		u32 page = *p;
 
+		written[page >> 5] |= 1 << (page & 31);
+
+		if(m_src.m_eager[page] == 0)
+		{
+			continue;
+		}
+
 		auto& list = m_src.m_map[page];
 		for(auto i = list.begin(); i != list.end(); )
 		{
@@ -731,41 +743,17 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 
 			if(GSUtil::HasSharedBits(psm, s->m_TEX0.PSM))
 			{
-				bool b = bp == s->m_TEX0.TBP0;
-
 				if(!s->m_target)
 				{
 					if(m_disable_partial_invalidation && s->m_repeating)
 					{
 						m_src.RemoveAt(s);
 					}
-					else
-					{
-						u32* RESTRICT valid = s->m_valid;
-
-						// Invalidate data of input texture
-						if(s->m_repeating)
-						{
-							// Note: very hot path on snowbling engine game
-							for(const GSVector2i& k : s->m_p2t[page])
-							{
-								valid[k.x] &= k.y;
-							}
-						}
-						else
-						{
-							valid[page] = 0;
-						}
-
-						s->m_complete = false;
-
-						found |= b;
-					}
 				}
 				else
 				{
 					// render target used as input texture
-					b |= bp == s->m_from_target_TEX0.TBP0;
+					bool b = bp == s->m_TEX0.TBP0 || bp == s->m_from_target_TEX0.TBP0;
 
 					if (!b)
 						b = s->Overlaps(bp, bw, psm, rect);
@@ -779,6 +767,28 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 		}
 	}
 
+	// Is there an input texture at bp which got written
+	bool found = false;
+
+	for(Source* s : m_src.m_map[bp >> 5])
+	{
+		if(s->m_target || s->m_TEX0.TBP0 != bp || !GSUtil::HasSharedBits(psm, s->m_TEX0.PSM))
+		{
+			continue;
+		}
+
+		for(size_t i = 0; i < countof(written); i++)
+		{
+			if(s->m_pages_as_bit[i] & written[i])
+			{
+				found = true;
+				break;
+			}
+		}
+
+		if(found) break;
+	}
+
 	if(!target) return;
 
 	for(int type = 0; type < 2; type++)
@@ -864,8 +874,14 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 
 // Goal: retrive the data from the GPU to the GS memory.
 // Called each time you want to read from the GS memory
-void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
+void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r, bool prefetch)
 {
+	// prefetch: the memory is read later (local -> host transfer), only start the readbacks
+	void (GSTextureCache::*read)(Target*, const GSVector4i&) = &GSTextureCache::Read;
+
+	if(prefetch)
+		read = &GSTextureCache::StartRead;
+
 	u32 bp = off->bp;
 	u32 psm = off->psm;
 	//u32 bw = off->bw;
@@ -876,7 +892,7 @@ void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
 			for(auto t : m_dst[DepthStencil]) {
 				if(GSUtil::HasSharedBits(bp, psm, t->m_TEX0.TBP0, t->m_TEX0.PSM)) {
 					if (GSUtil::HasCompatibleBits(psm, t->m_TEX0.PSM))
-						Read(t, r.rintersect(t->m_valid));
+						(this->*read)(t, r.rintersect(t->m_valid));
 				}
 			}
 		}
@@ -914,12 +930,12 @@ void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
 				if (t->m_32_bits_fmt && t->m_TEX0.PSM > PSM_PSMCT24)
 					t->m_TEX0.PSM = PSM_PSMCT32;
 				if (GSTextureCache::m_disable_partial_invalidation) {
-					Read(t, r.rintersect(t->m_valid));
+					(this->*read)(t, r.rintersect(t->m_valid));
 				} else {
 					if (r.x == 0 && r.y == 0) // Full screen read?
-						Read(t, t->m_valid);
+						(this->*read)(t, t->m_valid);
 					else // Block level read?
-						Read(t, r.rintersect(t->m_valid));
+						(this->*read)(t, r.rintersect(t->m_valid));
 				}
 			}
 		}
@@ -1514,6 +1530,17 @@ GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFR
 
 		GSOffset* off = m_renderer->m_context->offset.tex;
 		m_pages_as_bit = off->GetPagesAsBits(m_TEX0);
+
+		// Nothing is valid yet, only the later writes matter
+		const GSLocalMemory& mem = m_renderer->m_mem;
+		u32 msk = GSLocalMemory::m_psm[m_TEX0.PSM].msk;
+
+		for(u32 page = 0; page < MAX_PAGES; page++)
+		{
+			m_page_gen[page] = mem.GetPageGen(page, msk);
+		}
+
+		m_mem_gen = mem.m_gen;
 	}
 }
 
@@ -1522,10 +1549,65 @@ GSTextureCache::Source::~Source()
 	_aligned_free(m_write.rect);
 }
 
+// Drop the blocks of the pages written since the last lookup
+
+void GSTextureCache::Source::Validate()
+{
+	const GSLocalMemory& mem = m_renderer->m_mem;
+
+	if(m_target || m_mem_gen == mem.m_gen)
+	{
+		return;
+	}
+
+	m_mem_gen = mem.m_gen;
+
+	u32 msk = GSLocalMemory::m_psm[m_TEX0.PSM].msk;
+
+	for(size_t i = 0; i < MAX_PAGES / 32; i++)
+	{
+		u32 p = m_pages_as_bit[i];
+
+		unsigned long j;
+
+		while(_BitScanForward(&j, p))
+		{
+			p ^= 1U << j;
+
+			u32 page = (i << 5) + j;
+			u32 gen = mem.GetPageGen(page, msk);
+
+			if(m_page_gen[page] == gen)
+			{
+				continue;
+			}
+
+			m_page_gen[page] = gen;
+
+			if(m_repeating)
+			{
+				// Note: very hot path on snowbling engine game
+				for(const GSVector2i& k : m_p2t[page])
+				{
+					m_valid[k.x] &= k.y;
+				}
+			}
+			else
+			{
+				m_valid[page] = 0;
+			}
+
+			m_complete = false;
+		}
+	}
+}
+
 void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
 {
 	Surface::UpdateAge();
 
+	Validate();
+
 	if(layer == 0 && (m_complete || m_target))
 	{
 		return;
@@ -1855,10 +1937,13 @@ void GSTextureCache::SourceMap::Add(Source* s, const GIFRegTEX0& TEX0, GSOffset*
 		size_t page = TEX0.TBP0 >> 5;
 
 		s->m_erase_it[page] = m_map[page].InsertFront(s);
+		m_eager[page]++;
 
 		return;
 	}
 
+	bool eager = IsEager(s);
+
 	// The source pointer will be stored/duplicated in all m_map[array of pages]
 	for(size_t i = 0; i < countof(m_pages); i++)
 	{
@@ -1877,6 +1962,9 @@ void GSTextureCache::SourceMap::Add(Source* s, const GIFRegTEX0& TEX0, GSOffset*
 				p ^= 1U << j;
 
 				e[j] = m[j].InsertFront(s);
+
+				if(eager)
+					m_eager[(i << 5) + j]++;
 			}
 		}
 	}
@@ -1892,6 +1980,8 @@ void GSTextureCache::SourceMap::RemoveAll()
 	{
 		m_map[i].clear();
 	}
+
+	memset(m_eager, 0, sizeof(m_eager));
 }
 
 void GSTextureCache::SourceMap::RemoveAt(Source* s)
@@ -1902,9 +1992,12 @@ void GSTextureCache::SourceMap::RemoveAt(Source* s)
 	{
 		const size_t page = s->m_TEX0.TBP0 >> 5;
 		m_map[page].EraseIndex(s->m_erase_it[page]);
+		m_eager[page]--;
 	}
 	else
 	{
+		bool eager = IsEager(s);
+
 		for(size_t i = 0; i < countof(m_pages); i++)
 		{
 			if(u32 p = s->m_pages_as_bit[i])
@@ -1922,6 +2015,9 @@ void GSTextureCache::SourceMap::RemoveAt(Source* s)
 					p ^= 1U << j;
 
 					m[j].EraseIndex(e[j]);
+
+					if(eager)
+						m_eager[(i << 5) + j]--;
 				}
 			}
 		}
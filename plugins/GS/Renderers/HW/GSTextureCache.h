@@ -106,6 +106,7 @@ public:
 
 		void Write(const GSVector4i& r, int layer);
 		void Flush(u32 count, int layer);
+		void Validate();
 
 	public:
 		std::shared_ptr<Palette> m_palette_obj;
@@ -125,6 +126,9 @@ public:
 		// Keep a GSTextureCache::SourceMap::m_map iterator to allow fast erase
 		std::array<u16, MAX_PAGES> m_erase_it;
 		u32* m_pages_as_bit;
+		// GSLocalMemory page generations of the last validation
+		u32 m_page_gen[MAX_PAGES];
+		u32 m_mem_gen;
 
 	public:
 		Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, u8* temp, bool dummy_container = false);
@@ -180,9 +184,12 @@ public:
 		std::unordered_set<Source*> m_surfaces;
 		std::array<FastList<Source*>, MAX_PAGES> m_map;
 		u32 m_pages[16]; // bitmap of all pages
+		u32 m_eager[MAX_PAGES]; // sources which can't be invalidated on lookup
 		bool m_used;
 
-		SourceMap() : m_used(false) {memset(m_pages, 0, sizeof(m_pages));}
+		SourceMap() : m_used(false) {memset(m_pages, 0, sizeof(m_pages)); memset(m_eager, 0, sizeof(m_eager));}
+
+		bool IsEager(const Source* s) const {return s->m_target || (s->m_repeating && m_disable_partial_invalidation);}
 
 		void Add(Source* s, const GIFRegTEX0& TEX0, GSOffset* off);
 		void RemoveAll();
@@ -233,6 +240,10 @@ public:
 	virtual ~GSTextureCache();
 	virtual void Read(Target* t, const GSVector4i& r) = 0;
 	virtual void Read(Source* t, const GSVector4i& r) = 0;
+	// Starts the readback of a target that will be Read soon, so that Read doesn't have to
+	// wait for the GPU. Only valid until the next draw, CancelReads drops them.
+	virtual void StartRead(Target* t, const GSVector4i& r) {}
+	virtual void CancelReads() {}
 	void RemoveAll();
 	void RemovePartial();
 
@@ -245,7 +256,7 @@ public:
 	void InvalidateVideoMemType(int type, u32 bp);
 	void InvalidateVideoMemSubTarget(GSTextureCache::Target* rt);
 	void InvalidateVideoMem(GSOffset* off, const GSVector4i& r, bool target = true);
-	void InvalidateLocalMem(GSOffset* off, const GSVector4i& r);
+	void InvalidateLocalMem(GSOffset* off, const GSVector4i& r, bool prefetch = false);
 
 	void IncAge();
 	bool UserHacks_HalfPixelOffset;
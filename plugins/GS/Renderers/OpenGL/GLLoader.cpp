@@ -156,6 +156,7 @@ namespace GLLoader {
 	bool found_GL_ARB_shader_storage_buffer_object = false;
 	bool found_GL_ARB_compute_shader = false;
 	bool found_GL_ARB_texture_view = false; // maybe older gpu can support it ?
+	bool found_GL_ARB_get_program_binary = false;
 
 	// Mandatory in the future
 	bool found_GL_ARB_multi_bind = false;
@@ -273,6 +274,8 @@ namespace GLLoader {
 			optional("GL_ARB_sparse_texture2");
 			// GL4.0
 			found_GL_ARB_gpu_shader5 = optional("GL_ARB_gpu_shader5");
+			// GL4.1
+			found_GL_ARB_get_program_binary = optional("GL_ARB_get_program_binary");
 			// GL4.2
 			found_GL_ARB_shader_image_load_store = optional("GL_ARB_shader_image_load_store");
 			// GL4.3
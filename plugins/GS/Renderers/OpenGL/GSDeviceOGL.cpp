@@ -1767,6 +1767,7 @@ GSDeviceOGL::~GSDeviceOGL()
 	for (u32 key = 0; key < countof(m_om_dss); key++) delete m_om_dss[key];
 
 	PboPool::Destroy();
+	PboReadPool::Destroy();
 
 	// Must be done after the destruction of all shader/program objects
 	delete m_shader;
@@ -2006,6 +2007,7 @@ bool GSDeviceOGL::Create()
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 		PboPool::Init();
+		PboReadPool::Init();
 	}
 
 	// ****************************************************************
@@ -2067,6 +2069,18 @@ void GSDeviceOGL::CreateTextureFX()
 
 	// Help to debug FS in apitrace
 	m_apitrace = CompilePS(PSSelector());
+
+	// Warm up the pixel shaders of the previous sessions, they are loaded from
+	// the program binary cache so it is much faster than compiling them on the fly
+	if (!GLLoader::buggy_sso_dual_src) {
+		for (u64 key : m_shader->GetPSSelectors()) {
+			PSSelector sel;
+			sel.key = key;
+
+			if (m_ps.find(sel) == m_ps.end())
+				m_ps[sel] = CompilePS(sel);
+		}
+	}
 }
 
 bool GSDeviceOGL::Reset(int w, int h)
@@ -2914,6 +2928,7 @@ void GSDeviceOGL::SetupPipeline(const VSSelector& vsel, const GSSelector& gsel,
 	{
 		ps = CompilePS(psel);
 		m_ps[psel] = ps;
+		m_shader->AddPSSelector(psel);
 	}
 	else
 		ps = i->second;
@@ -0,0 +1,283 @@
+/*
+ *	Copyright (C) 2011-2013 Gregory hainaut
+ *	Copyright (C) 2007-2009 Gabest
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "../../stdafx.h"
+#include "GSProgramCacheOGL.h"
+#include "svnrev.h"
+
+#define PROGRAM_CACHE_MAGIC 0x504f4753 // SGOP
+#define PROGRAM_CACHE_VERSION 1
+#define PROGRAM_CACHE_MAX_PROGRAMS 8192
+#define PROGRAM_CACHE_MAX_SELECTORS 4096
+
+static u64 fnv1a(u64 hash, const void* data, size_t size)
+{
+	const u8* p = (const u8*)data;
+
+	for (size_t i = 0; i < size; i++)
+		hash = (hash ^ p[i]) * 0x100000001b3ull;
+
+	return hash;
+}
+
+GSProgramCacheOGL::GSProgramCacheOGL(const std::string& dir)
+	: m_driver(0)
+	, m_dirty(false)
+{
+	if (dir.empty() || !GLLoader::found_GL_ARB_get_program_binary)
+		return;
+
+	if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri)
+		return;
+
+	// The extension can be exposed without any format (Mesa without its disk cache)
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats <= 0) {
+		fprintf(stdout, "INFO: program binaries aren't supported by the driver\n");
+		return;
+	}
+
+	m_path = dir + "/gsogl_programs.bin";
+	m_driver = GetDriverId();
+
+	Load();
+}
+
+GSProgramCacheOGL::~GSProgramCacheOGL()
+{
+	if (m_dirty)
+		Save();
+}
+
+u64 GSProgramCacheOGL::GetBuildId()
+{
+	static const char* build =
+#ifdef GIT_REV
+		GIT_REV " "
+#endif
+		__DATE__ " " __TIME__;
+
+	return fnv1a(0xcbf29ce484222325ull, build, strlen(build));
+}
+
+u64 GSProgramCacheOGL::GetDriverId()
+{
+	u64 hash = 0xcbf29ce484222325ull;
+
+	const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+
+	for (GLenum name : names) {
+		const char* s = (const char*)glGetString(name);
+		if (s)
+			hash = fnv1a(hash, s, strlen(s) + 1);
+	}
+
+	return hash;
+}
+
+u64 GSProgramCacheOGL::Hash(GLenum type, const char* const* sources, int count)
+{
+	u64 hash = fnv1a(0xcbf29ce484222325ull, &type, sizeof(type));
+
+	for (int i = 0; i < count; i++)
+		hash = fnv1a(hash, sources[i], strlen(sources[i]) + 1);
+
+	return hash;
+}
+
+void GSProgramCacheOGL::Load()
+{
+	FILE* fp = fopen(m_path.c_str(), "rb");
+
+	if (fp == NULL)
+		return;
+
+	struct {u32 magic, version; u64 driver, build; u32 selectors, programs;} header;
+
+	bool ok = fread(&header, sizeof(header), 1, fp) == 1
+		&& header.magic == PROGRAM_CACHE_MAGIC
+		&& header.version == PROGRAM_CACHE_VERSION
+		&& header.driver == m_driver
+		&& header.selectors <= PROGRAM_CACHE_MAX_SELECTORS
+		&& header.programs <= PROGRAM_CACHE_MAX_PROGRAMS;
+
+	if (ok) {
+		std::vector<u64> selectors(header.selectors);
+
+		ok = selectors.empty() || fread(selectors.data(), sizeof(u64), selectors.size(), fp) == selectors.size();
+
+		if (ok && header.build == GetBuildId()) {
+			for (u64 sel : selectors)
+				AddPSSelector(sel);
+		}
+	}
+
+	for (u32 i = 0; ok && i < header.programs; i++) {
+		struct {u64 key; u32 format, size;} entry;
+
+		if (fread(&entry, sizeof(entry), 1, fp) != 1 || entry.size == 0 || entry.size > 0x1000000) {
+			ok = false;
+			break;
+		}
+
+		Binary& b = m_binaries[entry.key];
+		b.format = entry.format;
+		b.data.resize(entry.size);
+		b.used = false;
+
+		ok = fread(b.data.data(), entry.size, 1, fp) == 1;
+	}
+
+	fclose(fp);
+
+	if (!ok) {
+		// another driver or a truncated file, it gets rewritten at the end of the session
+		fprintf(stdout, "INFO: discarding the program binary cache %s\n", m_path.c_str());
+
+		m_binaries.clear();
+		m_ps_selectors.clear();
+		m_ps_seen.clear();
+	}
+
+	// Loading the selectors isn't a change
+	m_dirty = !ok;
+}
+
+void GSProgramCacheOGL::Save()
+{
+	// Programs of this session first, the stale ones fill what is left
+	std::vector<const std::pair<const u64, Binary>*> entries;
+
+	for (int used = 1; used >= 0; used--) {
+		for (const auto& b : m_binaries) {
+			if (b.second.used == !!used && entries.size() < PROGRAM_CACHE_MAX_PROGRAMS)
+				entries.push_back(&b);
+		}
+	}
+
+	size_t selectors = std::min<size_t>(m_ps_selectors.size(), PROGRAM_CACHE_MAX_SELECTORS);
+
+	// written next to the old file and renamed over it, a crash never leaves half a file behind
+	std::string tmp = m_path + ".tmp";
+
+	FILE* fp = fopen(tmp.c_str(), "wb");
+
+	if (fp == NULL)
+		return;
+
+	struct {u32 magic, version; u64 driver, build; u32 selectors, programs;} header;
+
+	header.magic = PROGRAM_CACHE_MAGIC;
+	header.version = PROGRAM_CACHE_VERSION;
+	header.driver = m_driver;
+	header.build = GetBuildId();
+	header.selectors = (u32)selectors;
+	header.programs = (u32)entries.size();
+
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+	ok = ok && (selectors == 0 || fwrite(m_ps_selectors.data(), sizeof(u64), selectors, fp) == selectors);
+
+	for (size_t i = 0; ok && i < entries.size(); i++) {
+		const Binary& b = entries[i]->second;
+
+		struct {u64 key; u32 format, size;} entry = {entries[i]->first, b.format, (u32)b.data.size()};
+
+		ok = fwrite(&entry, sizeof(entry), 1, fp) == 1
+			&& fwrite(b.data.data(), b.data.size(), 1, fp) == 1;
+	}
+
+	ok = fclose(fp) == 0 && ok;
+
+	if (ok) {
+		remove(m_path.c_str());
+		ok = rename(tmp.c_str(), m_path.c_str()) == 0;
+	}
+
+	if (!ok)
+		remove(tmp.c_str());
+}
+
+GLuint GSProgramCacheOGL::Get(u64 key)
+{
+	auto it = m_binaries.find(key);
+
+	if (it == m_binaries.end())
+		return 0;
+
+	Binary& b = it->second;
+
+	GLuint p = glCreateProgram();
+	glProgramParameteri(p, GL_PROGRAM_SEPARABLE, GL_TRUE);
+	glProgramBinary(p, b.format, b.data.data(), b.data.size());
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(p, GL_LINK_STATUS, &status);
+
+	if (status != GL_TRUE) {
+		// The driver is free to refuse a binary, the program is rebuilt from the source
+		glDeleteProgram(p);
+		m_binaries.erase(it);
+		m_dirty = true;
+		return 0;
+	}
+
+	b.used = true;
+
+	return p;
+}
+
+void GSProgramCacheOGL::Put(u64 key, GLuint program)
+{
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+	GLint size = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+
+	if (status != GL_TRUE || size <= 0)
+		return;
+
+	Binary b;
+	b.data.resize(size);
+	b.used = true;
+
+	GLsizei written = 0;
+	glGetProgramBinary(program, size, &written, &b.format, b.data.data());
+
+	if (written <= 0)
+		return;
+
+	b.data.resize(written);
+
+	m_binaries[key] = std::move(b);
+	m_dirty = true;
+}
+
+void GSProgramCacheOGL::AddPSSelector(u64 sel)
+{
+	if (!IsEnabled() || !m_ps_seen.insert(sel).second)
+		return;
+
+	m_ps_selectors.push_back(sel);
+	m_dirty = true;
+}
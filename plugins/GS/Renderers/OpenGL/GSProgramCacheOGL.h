@@ -0,0 +1,89 @@
+/*
+ *	Copyright (C) 2011-2013 Gregory hainaut
+ *	Copyright (C) 2007-2009 Gabest
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Pcsx2Types.h"
+
+#include "GLLoader.h"
+
+/*
+
+On-disk cache of the linked separable programs (glGetProgramBinary/glProgramBinary) and of the
+pixel shader selectors used by the previous sessions, so GSDeviceOGL can load them up front
+instead of compiling them in the middle of a frame.
+
+A program is keyed by the hash of its full glsl source (the generated header holds the selector
+macros). The whole file is keyed by the driver strings, a driver update throws it away.
+
+File format:
+- [magic/4] [version/4] [driver/8] [build id/8] [selector count/4] [program count/4]
+- [ps selector/8] ..
+- [source hash/8] [binary format/4] [binary size/4] [binary] ..
+
+The selector bit fields are only stable within a build, the selectors of another build are dropped
+but the programs are kept.
+
+*/
+
+class GSProgramCacheOGL
+{
+	struct Binary
+	{
+		GLenum format;
+		std::vector<u8> data;
+		bool used;
+	};
+
+	std::string m_path;
+	u64 m_driver;
+	bool m_dirty;
+
+	std::unordered_map<u64, Binary> m_binaries;
+	std::vector<u64> m_ps_selectors;
+	std::unordered_set<u64> m_ps_seen;
+
+	static u64 GetBuildId();
+	static u64 GetDriverId();
+
+	void Load();
+	void Save();
+
+public:
+	GSProgramCacheOGL(const std::string& dir);
+	~GSProgramCacheOGL();
+
+	bool IsEnabled() const {return !m_path.empty();}
+
+	static u64 Hash(GLenum type, const char* const* sources, int count);
+
+	// Returns 0 when the program isn't cached or the driver rejected the binary
+	GLuint Get(u64 key);
+	void Put(u64 key, GLuint program);
+
+	void AddPSSelector(u64 sel);
+	const std::vector<u64>& GetPSSelectors() const {return m_ps_selectors;}
+};
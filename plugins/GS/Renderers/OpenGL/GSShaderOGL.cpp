@@ -146,6 +146,7 @@ static const char common_glsl_shader_raw[] =
 GSShaderOGL::GSShaderOGL() : 
 	  m_pipeline(0)
 	, m_common_header(common_glsl_shader_raw, common_glsl_shader_raw + sizeof(common_glsl_shader_raw)/sizeof(*common_glsl_shader_raw))
+	, m_cache(theApp.GetConfigS("cache_dir"))
 {
 	// Create a default pipeline
 	m_pipeline = LinkPipeline("HW pipe", 0, 0, 0);
@@ -313,7 +314,30 @@ GLuint GSShaderOGL::Compile(const std::string& glsl_file, const std::string& ent
 	sources[1] = m_common_header.data();
 	sources[2] = glsl_h_code;
 
-	program = glCreateShaderProgramv(type, shader_nb, sources);
+	if (m_cache.IsEnabled()) {
+		u64 key = GSProgramCacheOGL::Hash(type, sources, shader_nb);
+
+		program = m_cache.Get(key);
+
+		if (program == 0) {
+			// Same as glCreateShaderProgramv but the binary must be retrievable
+			GLuint shader = glCreateShader(type);
+			glShaderSource(shader, shader_nb, sources, NULL);
+			glCompileShader(shader);
+
+			program = glCreateProgram();
+			glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			glAttachShader(program, shader);
+			glLinkProgram(program);
+			glDetachShader(program, shader);
+			glDeleteShader(shader);
+
+			m_cache.Put(key, program);
+		}
+	} else {
+		program = glCreateShaderProgramv(type, shader_nb, sources);
+	}
 
 	m_prog_to_delete.push_back(program);
 
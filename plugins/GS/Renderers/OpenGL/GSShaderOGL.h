@@ -27,6 +27,7 @@
 #include "Pcsx2Types.h"
 
 #include "GLLoader.h"
+#include "GSProgramCacheOGL.h"
 
 class GSShaderOGL {
 	GLuint m_pipeline;
@@ -39,6 +40,8 @@ class GSShaderOGL {
 	std::string GenGlslHeader(const std::string& entry, GLenum type, const std::string& macro);
 	std::vector<char> m_common_header;
 
+	GSProgramCacheOGL m_cache;
+
 	public:
 	GSShaderOGL();
 	~GSShaderOGL();
@@ -49,6 +52,10 @@ class GSShaderOGL {
 	GLuint Compile(const std::string& glsl_file, const std::string& entry, GLenum type, const char* glsl_h_code, const std::string& macro_sel = "");
 	GLuint LinkPipeline(const std::string& pretty_print, GLuint vs, GLuint gs, GLuint ps);
 
+	// Pixel shader selectors of the previous sessions, only when the programs are cached
+	void AddPSSelector(u64 sel) { m_cache.AddPSSelector(sel); }
+	const std::vector<u64>& GetPSSelectors() const { return m_cache.GetPSSelectors(); }
+
 	// Same as above but for not separated build
 	void BindProgram(GLuint vs, GLuint gs, GLuint ps);
 	void BindProgram(GLuint p);
@@ -27,79 +27,124 @@ GSTextureCacheOGL::GSTextureCacheOGL(GSRenderer* r)
 {
 }
 
-void GSTextureCacheOGL::Read(Target* t, const GSVector4i& r)
+GSTextureCacheOGL::~GSTextureCacheOGL()
 {
-	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
-		return;
-
-	const GIFRegTEX0& TEX0 = t->m_TEX0;
+	CancelReads();
+}
 
-	GLuint fmt;
-	int ps_shader;
+bool GSTextureCacheOGL::GetReadFormat(const GIFRegTEX0& TEX0, GLuint& fmt, int& ps_shader)
+{
 	switch (TEX0.PSM)
 	{
 		case PSM_PSMCT32:
 		case PSM_PSMCT24:
 			fmt = GL_RGBA8;
 			ps_shader = ShaderConvert_COPY;
-			break;
+			return true;
 
 		case PSM_PSMCT16:
 		case PSM_PSMCT16S:
 			fmt = GL_R16UI;
 			ps_shader = ShaderConvert_RGBA8_TO_16_BITS;
-			break;
+			return true;
 
 		case PSM_PSMZ32:
 		case PSM_PSMZ24:
 			fmt = GL_R32UI;
 			ps_shader = ShaderConvert_FLOAT32_TO_32_BITS;
-			break;
+			return true;
 
 		case PSM_PSMZ16:
 		case PSM_PSMZ16S:
 			fmt = GL_R16UI;
 			ps_shader = ShaderConvert_FLOAT32_TO_32_BITS;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+GSTexture* GSTextureCacheOGL::CopyOffscreen(Target* t, const GSVector4i& r, GLuint fmt, int ps_shader)
+{
+	GSVector4 src = GSVector4(r) * GSVector4(t->m_texture->GetScale()).xyxy() / GSVector4(t->m_texture->GetSize()).xyxy();
+
+	return m_renderer->m_dev->CopyOffscreen(t->m_texture, src, r.width(), r.height(), fmt, ps_shader);
+}
+
+void GSTextureCacheOGL::WritePixels(const GIFRegTEX0& TEX0, const GSTexture::GSMap& m, const GSVector4i& r)
+{
+	// TODO: block level write
+
+	GSOffset* off = m_renderer->m_mem.GetOffset(TEX0.TBP0, TEX0.TBW, TEX0.PSM);
+
+	switch(TEX0.PSM)
+	{
+		case PSM_PSMCT32:
+		case PSM_PSMZ32:
+			m_renderer->m_mem.WritePixel32(m.bits, m.pitch, off, r);
+			break;
+		case PSM_PSMCT24:
+		case PSM_PSMZ24:
+			m_renderer->m_mem.WritePixel24(m.bits, m.pitch, off, r);
+			break;
+		case PSM_PSMCT16:
+		case PSM_PSMCT16S:
+		case PSM_PSMZ16:
+		case PSM_PSMZ16S:
+			m_renderer->m_mem.WritePixel16(m.bits, m.pitch, off, r);
 			break;
 
 		default:
-			return;
+			ASSERT(0);
 	}
+}
 
+void GSTextureCacheOGL::Read(Target* t, const GSVector4i& r)
+{
+	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
+		return;
 
-	GSVector4 src = GSVector4(r) * GSVector4(t->m_texture->GetScale()).xyxy() / GSVector4(t->m_texture->GetSize()).xyxy();
+	const GIFRegTEX0& TEX0 = t->m_TEX0;
 
-	if(GSTexture* offscreen = m_renderer->m_dev->CopyOffscreen(t->m_texture, src, r.width(), r.height(), fmt, ps_shader))
+	// Started by StartRead, the copy should be done by now
+
+	for (auto i = m_reads.begin(); i != m_reads.end(); ++i)
+	{
+		if (i->t == t && i->texture == t->m_texture && i->TEX0.U64 == TEX0.U64 && i->r.eq(r))
+		{
+			GSTexture::GSMap m;
+
+			bool done = static_cast<GSTextureOGL*>(i->offscreen)->FinishRead(m);
+
+			if (done)
+				WritePixels(TEX0, m, r);
+
+			m_renderer->m_dev->Recycle(i->offscreen);
+
+			m_reads.erase(i);
+
+			if (done)
+				return;
+
+			break;
+		}
+	}
+
+	GLuint fmt;
+	int ps_shader;
+
+	if (!GetReadFormat(TEX0, fmt, ps_shader))
+		return;
+
+	if(GSTexture* offscreen = CopyOffscreen(t, r, fmt, ps_shader))
 	{
 		GSTexture::GSMap m;
 		GSVector4i r_offscreen(0, 0, r.width(), r.height());
 
 		if(offscreen->Map(m, &r_offscreen))
 		{
-			// TODO: block level write
-
-			GSOffset* off = m_renderer->m_mem.GetOffset(TEX0.TBP0, TEX0.TBW, TEX0.PSM);
-
-			switch(TEX0.PSM)
-			{
-				case PSM_PSMCT32:
-				case PSM_PSMZ32:
-					m_renderer->m_mem.WritePixel32(m.bits, m.pitch, off, r);
-					break;
-				case PSM_PSMCT24:
-				case PSM_PSMZ24:
-					m_renderer->m_mem.WritePixel24(m.bits, m.pitch, off, r);
-					break;
-				case PSM_PSMCT16:
-				case PSM_PSMCT16S:
-				case PSM_PSMZ16:
-				case PSM_PSMZ16S:
-					m_renderer->m_mem.WritePixel16(m.bits, m.pitch, off, r);
-					break;
-
-				default:
-					ASSERT(0);
-			}
+			WritePixels(TEX0, m, r);
 
 			offscreen->Unmap();
 		}
@@ -109,6 +154,44 @@ void GSTextureCacheOGL::Read(Target* t, const GSVector4i& r)
 	}
 }
 
+void GSTextureCacheOGL::StartRead(Target* t, const GSVector4i& r)
+{
+	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
+		return;
+
+	GLuint fmt;
+	int ps_shader;
+
+	if (!GetReadFormat(t->m_TEX0, fmt, ps_shader))
+		return;
+
+	if(GSTexture* offscreen = CopyOffscreen(t, r, fmt, ps_shader))
+	{
+		GSVector4i r_offscreen(0, 0, r.width(), r.height());
+
+		if (static_cast<GSTextureOGL*>(offscreen)->StartRead(r_offscreen))
+		{
+			m_reads.push_back({t, t->m_texture, t->m_TEX0, r, offscreen});
+		}
+		else
+		{
+			m_renderer->m_dev->Recycle(offscreen);
+		}
+	}
+}
+
+void GSTextureCacheOGL::CancelReads()
+{
+	for (const PendingRead& read : m_reads)
+	{
+		static_cast<GSTextureOGL*>(read.offscreen)->CancelRead();
+
+		m_renderer->m_dev->Recycle(read.offscreen);
+	}
+
+	m_reads.clear();
+}
+
 void GSTextureCacheOGL::Read(Source* t, const GSVector4i& r)
 {
 	const GIFRegTEX0& TEX0 = t->m_TEX0;
@@ -27,12 +27,30 @@
 
 class GSTextureCacheOGL final : public GSTextureCache
 {
+	struct PendingRead
+	{
+		Target* t;
+		GSTexture* texture; // t->m_texture, t->m_TEX0 when started, t may have been recycled since
+		GIFRegTEX0 TEX0;
+		GSVector4i r;
+		GSTexture* offscreen;
+	};
+
+	std::vector<PendingRead> m_reads;
+
+	bool GetReadFormat(const GIFRegTEX0& TEX0, GLuint& fmt, int& ps_shader);
+	GSTexture* CopyOffscreen(Target* t, const GSVector4i& r, GLuint fmt, int ps_shader);
+	void WritePixels(const GIFRegTEX0& TEX0, const GSTexture::GSMap& m, const GSVector4i& r);
+
 protected:
 	int Get8bitFormat() { return GL_R8;}
 
 	void Read(Target* t, const GSVector4i& r);
 	void Read(Source* t, const GSVector4i& r);
+	void StartRead(Target* t, const GSVector4i& r);
+	void CancelReads();
 
 public:
 	GSTextureCacheOGL(GSRenderer* r);
+	virtual ~GSTextureCacheOGL();
 };
@@ -137,8 +137,84 @@ namespace PboPool {
 	}
 }
 
+// Ring of persistently mapped memory for the readbacks of the offscreen textures. A readback
+// takes the next free range of the ring and is fenced, the CPU only waits on its own fence. It is
+// the same ring as PboPool but in the other direction. A position counts the bytes since the
+// start, the range stays valid until the ring wrapped over it.
+namespace PboReadPool {
+
+	const  u32 m_pbo_size = 32*1024*1024;
+
+	GLuint m_buffer;
+	u64    m_position;
+	const u8* m_map;
+
+	// Coherent so the data is visible as soon as the fence is signaled
+	const GLbitfield common_flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLbitfield create_flags = common_flags | GL_CLIENT_STORAGE_BIT;
+
+	void Init() {
+		glGenBuffers(1, &m_buffer);
+
+		BindPbo();
+
+		glObjectLabel(GL_BUFFER, m_buffer, -1, "Readback PBO");
+
+		glBufferStorage(GL_PIXEL_PACK_BUFFER, m_pbo_size, NULL, create_flags);
+		m_map      = (const u8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_pbo_size, common_flags);
+		m_position = 0;
+
+		UnbindPbo();
+	}
+
+	void Destroy() {
+		m_map      = NULL;
+		m_position = 0;
+
+		glDeleteBuffers(1, &m_buffer);
+	}
+
+	void BindPbo() {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
+	}
+
+	void UnbindPbo() {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	bool Reserve(u32 size, u64& position) {
+		// Note: keep offset aligned for SSE/AVX
+		size = (size + 63) & ~0x3F;
+
+		if (!m_map || size > m_pbo_size)
+			return false;
+
+		// Don't split a readback at the end of the ring
+		if (m_position % m_pbo_size + size > m_pbo_size)
+			m_position += m_pbo_size - m_position % m_pbo_size;
+
+		position = m_position;
+		m_position += size;
+
+		return true;
+	}
+
+	bool Valid(u64 position) {
+		return m_position - position <= m_pbo_size;
+	}
+
+	uptr Offset(u64 position) {
+		return (uptr)(position % m_pbo_size);
+	}
+
+	const u8* Map(u64 position) {
+		return m_map + Offset(position);
+	}
+}
+
 GSTextureOGL::GSTextureOGL(int type, int w, int h, int format, GLuint fbo_read, bool mipmap)
 	: m_clean(false), m_generate_mipmap(true), m_local_buffer(nullptr), m_r_x(0), m_r_y(0), m_r_w(0), m_r_h(0), m_layer(0)
+	, m_read_fence(0), m_read_position(0), m_read_pitch(0)
 {
 	// OpenGL didn't like dimensions of size 0
 	m_size.x = std::max(1,w);
@@ -320,6 +396,8 @@ GSTextureOGL::~GSTextureOGL()
 			GLState::tex_unit[i] = 0;
 	}
 
+	CancelRead();
+
 	glDeleteTextures(1, &m_texture_id);
 
 	GLState::available_vram += m_mem_usage;
@@ -397,7 +475,8 @@ bool GSTextureOGL::Map(GSMap& m, const GSVector4i* _r, int layer)
 
 	if (m_type == GSTexture::Offscreen) {
 		// The fastest way will be to use a PBO to read the data asynchronously. Unfortunately GSdx
-		// architecture is waiting the data right now.
+		// architecture is waiting the data right now. StartRead does it for the reads known in
+		// advance (local -> host transfers).
 
 #ifdef GL_EXT_TEX_SUB_IMAGE
 		// Maybe it is as good as the code below. I don't know
@@ -459,6 +538,73 @@ void GSTextureOGL::Unmap()
 	}
 }
 
+// Asynchronous version of Map for the offscreen textures. StartRead queues the copy of r to the
+// readback ring, FinishRead waits for it. False when the ring is too small or got overwritten
+// since, the caller falls back to Map.
+bool GSTextureOGL::StartRead(const GSVector4i& r)
+{
+	ASSERT(m_type == GSTexture::Offscreen);
+
+	CancelRead();
+
+	u32 row_byte = r.width() << m_int_shift;
+	u32 map_size = r.height() * row_byte;
+
+	if (!PboReadPool::Reserve(map_size, m_read_position))
+		return false;
+
+	m_read_pitch = row_byte;
+
+	PboReadPool::BindPbo();
+
+	// In case a target is 16 bits (GT4)
+	glPixelStorei(GL_PACK_ALIGNMENT, 1u << m_int_shift);
+
+#ifdef GL_EXT_TEX_SUB_IMAGE
+	glGetTextureSubImage(m_texture_id, GL_TEX_LEVEL_0, r.x, r.y, 0, r.width(), r.height(), 1, m_int_format, m_int_type, map_size, (void*)PboReadPool::Offset(m_read_position));
+#else
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo_read);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture_id, 0);
+
+	glReadPixels(r.x, r.y, r.width(), r.height(), m_int_format, m_int_type, (void*)PboReadPool::Offset(m_read_position));
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, GL_DEFAULT_FRAMEBUFFER);
+#endif
+
+	PboReadPool::UnbindPbo();
+
+	m_read_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	return true;
+}
+
+bool GSTextureOGL::FinishRead(GSMap& m)
+{
+	if (!m_read_fence)
+		return false;
+
+	glClientWaitSync(m_read_fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+
+	glDeleteSync(m_read_fence);
+	m_read_fence = 0;
+
+	if (!PboReadPool::Valid(m_read_position))
+		return false;
+
+	m.bits = (u8*)PboReadPool::Map(m_read_position);
+	m.pitch = m_read_pitch;
+
+	return true;
+}
+
+void GSTextureOGL::CancelRead()
+{
+	if (m_read_fence) {
+		glDeleteSync(m_read_fence);
+		m_read_fence = 0;
+	}
+}
+
 void GSTextureOGL::GenerateMipmap()
 {
 	if (m_generate_mipmap && m_max_layer > 1) {
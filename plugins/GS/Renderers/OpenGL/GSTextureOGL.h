@@ -40,6 +40,19 @@ namespace PboPool {
 	void Destroy();
 }
 
+namespace PboReadPool {
+	inline void BindPbo();
+	inline void UnbindPbo();
+
+	inline bool Reserve(u32 size, u64& position);
+	inline bool Valid(u64 position);
+	inline uptr Offset(u64 position);
+	inline const u8* Map(u64 position);
+
+	void Init();
+	void Destroy();
+}
+
 class GSTextureOGL final : public GSTexture
 {
 	private:
@@ -66,6 +79,11 @@ class GSTextureOGL final : public GSTexture
 		// Allow to track size of allocated memory
 		u32 m_mem_usage;
 
+		// Pending copy to the readback ring (StartRead)
+		GLsync m_read_fence;
+		u64 m_read_position;
+		u32 m_read_pitch;
+
 	public:
 		explicit GSTextureOGL(int type, int w, int h, int format, GLuint fbo_read, bool mipmap);
 		virtual ~GSTextureOGL();
@@ -73,6 +91,9 @@ class GSTextureOGL final : public GSTexture
 		bool Update(const GSVector4i& r, const void* data, int pitch, int layer = 0) final;
 		bool Map(GSMap& m, const GSVector4i* r = NULL, int layer = 0) final;
 		void Unmap() final;
+		bool StartRead(const GSVector4i& r);
+		bool FinishRead(GSMap& m);
+		void CancelRead();
 		void GenerateMipmap() final;
 
 		bool IsBackbuffer() { return (m_type == GSTexture::Backbuffer); }
@@ -112,6 +112,12 @@ void GSDrawScanline::EndDraw(u64 frame, int actual, int total)
 {
 }
 
+void GSDrawScanline::GetFunctionHits(std::unordered_map<u64, u64>& sp, std::unordered_map<u64, u64>& ds) const
+{
+	m_sp_map.GetHits(sp);
+	m_ds_map.GetHits(ds);
+}
+
 void GSDrawScanline::DrawRect(const GSVector4i& r, const GSVertexSW& v)
 {
 	ASSERT(r.y >= 0);
@@ -72,5 +72,9 @@ public:
 	void BeginDraw(const GSRasterizerData* data);
 	void EndDraw(u64 frame, int actual, int total);
 
+	void PrepareSetupPrim(u64 key) {m_sp_map.Prepare(key);}
+	void PrepareDrawScanline(u64 key) {m_ds_map.Prepare(key);}
+	void GetFunctionHits(std::unordered_map<u64, u64>& sp, std::unordered_map<u64, u64>& ds) const;
+
 	void DrawRect(const GSVector4i& r, const GSVertexSW& v);
 };
@@ -129,7 +129,12 @@ int GSRasterizer::GetPixels(bool reset)
 
 void GSRasterizer::Draw(GSRasterizerData* data)
 {
-	if(data->vertex != NULL && data->vertex_count == 0 || data->index != NULL && data->index_count == 0) return;
+	Draw(data, data->index, data->index_count, data->scissor);
+}
+
+void GSRasterizer::Draw(GSRasterizerData* data, const u32* index, int index_count, const GSVector4i& scissor)
+{
+	if(data->vertex != NULL && data->vertex_count == 0 || index != NULL && index_count == 0) return;
 
 	m_pixels.actual = 0;
 	m_pixels.total = 0;
@@ -139,16 +144,16 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 	const GSVertexSW* vertex = data->vertex;
 	const GSVertexSW* vertex_end = data->vertex + data->vertex_count;
 
-	const u32* index = data->index;
-	const u32* index_end = data->index + data->index_count;
+	const u32* index_end = index + index_count;
 
 	u32 tmp_index[] = {0, 1, 2};
 
-	bool scissor_test = !data->bbox.eq(data->bbox.rintersect(data->scissor));
+	bool scissor_test = !data->bbox.eq(data->bbox.rintersect(scissor));
 
-	m_scissor = data->scissor;
-	m_fscissor_x = GSVector4(data->scissor).xzxz();
-	m_fscissor_y = GSVector4(data->scissor).ywyw();
+	m_scissor = scissor;
+	m_scissor_top = data->scissor.top;
+	m_fscissor_x = GSVector4(scissor).xzxz();
+	m_fscissor_y = GSVector4(scissor).ywyw();
 
 	switch(data->primclass)
 	{
@@ -156,11 +161,11 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 		if(scissor_test)
 		{
-			DrawPoint<true>(vertex, data->vertex_count, index, data->index_count);
+			DrawPoint<true>(vertex, data->vertex_count, index, index_count);
 		}
 		else
 		{
-			DrawPoint<false>(vertex, data->vertex_count, index, data->index_count);
+			DrawPoint<false>(vertex, data->vertex_count, index, index_count);
 		}
 
 		break;
@@ -783,6 +788,11 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const u32* index)
 
 	GSVector4i r(v[0].p.xyxy(v[1].p).ceil());
 
+	// the texture coordinates are stepped from the first row of the draw, a tile only starts
+	// drawing lower, so it gets the same values as one thread drawing the whole sprite
+
+	int top = std::max<int>(r.top, m_scissor_top);
+
 	r = r.rintersect(m_scissor);
 
 	if(r.rempty()) return;
@@ -834,13 +844,18 @@ void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const u32* index)
 	dedge.t = GSVector4::zero().insert32<1, 1>(dt);
 	dscan.t = GSVector4::zero().insert32<0, 0>(dt);
 
-	GSVector4 prestep = GSVector4(r.left, r.top) - scan.p;
+	GSVector4 prestep = GSVector4(r.left, top) - scan.p;
 
 	int m = (prestep == GSVector4::zero()).mask();
 
 	if((m & 2) == 0) scan.t += dedge.t * prestep.yyyy();
 	if((m & 1) == 0) scan.t += dscan.t * prestep.xxxx();
 
+	for(; top < r.top; top++)
+	{
+		scan.t += dedge.t;
+	}
+
 	m_ds->SetupPrim(vertex, index, dscan);
 
 	while(1)
@@ -1128,9 +1143,23 @@ void GSRasterizer::DrawEdge(int pixels, int left, int top, const GSVertexSW& sca
 //
 
 GSRasterizerList::GSRasterizerList(int threads)
+	: m_binning(theApp.GetConfigB("extrathreads_binning"))
+	, m_ready(threads)
+	, m_pending(0)
+	, m_exit(false)
 {
 	m_thread_height = compute_best_thread_height(threads);
 
+	if(m_binning)
+	{
+		m_tiles.resize((2048 + (1 << m_thread_height) - 1) >> m_thread_height);
+
+		for(Tile& tile : m_tiles)
+		{
+			tile.scheduled = false;
+		}
+	}
+
 	int rows = (2048 >> m_thread_height) + 16;
 	m_scanline = (u8*)_aligned_malloc(rows, 64);
 
@@ -1147,6 +1176,19 @@ GSRasterizerList::GSRasterizerList(int threads)
 
 GSRasterizerList::~GSRasterizerList()
 {
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		m_exit = true;
+	}
+
+	m_notempty.notify_all();
+
+	for(std::thread& t : m_threads)
+	{
+		t.join();
+	}
+
 	_aligned_free(m_scanline);
 }
 
@@ -1156,6 +1198,13 @@ void GSRasterizerList::Queue(const std::shared_ptr<GSRasterizerData>& data)
 
 	ASSERT(r.top >= 0 && r.top < 2048 && r.bottom >= 0 && r.bottom < 2048);
 
+	if(m_binning)
+	{
+		QueueTiles(data, r);
+
+		return;
+	}
+
 	int top = r.top >> m_thread_height;
 	int bottom = std::min<int>((r.bottom + (1 << m_thread_height) - 1) >> m_thread_height, top + m_workers.size());
 
@@ -1165,8 +1214,266 @@ void GSRasterizerList::Queue(const std::shared_ptr<GSRasterizerData>& data)
 	}
 }
 
+void GSRasterizerList::QueueTiles(const std::shared_ptr<GSRasterizerData>& data, const GSVector4i& r)
+{
+	int top = r.top >> m_thread_height;
+	int bottom = (r.bottom + (1 << m_thread_height) - 1) >> m_thread_height;
+
+	if(top >= bottom) return;
+
+	// a draw inside one tile (most of them) or without index is drawn as a whole by each tile
+
+	bool binned = bottom - top > 1 && data->index != NULL;
+
+	if(binned)
+	{
+		Bin(data.get(), top, bottom);
+	}
+
+	int scheduled = 0;
+
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+
+		for(int i = top; i < bottom; i++)
+		{
+			const u32* index = data->index;
+			int index_count = data->index_count;
+
+			if(binned)
+			{
+				index_count = m_bin_count[i - top];
+
+				if(index_count == 0) continue;
+
+				index = &data->tile_index[m_bin_first[i - top]];
+			}
+
+			Tile& tile = m_tiles[i];
+
+			tile.queue.push_back({data, index, index_count});
+
+			m_pending++;
+
+			if(!tile.scheduled)
+			{
+				tile.scheduled = true;
+
+				m_ready[i % m_ready.size()].push_back(i);
+
+				scheduled++;
+			}
+		}
+	}
+
+	if(scheduled > 1)
+	{
+		m_notempty.notify_all();
+	}
+	else if(scheduled == 1)
+	{
+		m_notempty.notify_one();
+	}
+}
+
+void GSRasterizerList::Bin(GSRasterizerData* data, int top, int bottom)
+{
+	static const int s_prim_size[] = {1, 2, 3, 2};
+
+	ASSERT(data->primclass <= GS_SPRITE_CLASS);
+
+	const int n = s_prim_size[data->primclass];
+	const int count = data->index_count / n;
+
+	const GSVertexSW* RESTRICT vertex = data->vertex;
+	const u32* RESTRICT index = data->index;
+
+	// the rows a primitive can draw, in tiles
+	//
+	// - sprites: ceil(top) to ceil(bottom), like DrawSprite
+	// - the others: two more rows around, points and lines truncate their positions and the
+	//   antialiased edges may step below the last row
+
+	const float margin = data->primclass == GS_SPRITE_CLASS ? 0.0f : 2.0f;
+	const float ymin = (float)(top << m_thread_height);
+	const float ymax = (float)(bottom << m_thread_height);
+
+	m_bin_first.assign(bottom - top, 0);
+	m_bin_count.assign(bottom - top, 0);
+	m_bin_prims.resize(count);
+
+	for(int i = 0; i < count; i++, index += n)
+	{
+		float y0 = vertex[index[0]].p.y;
+		float y1 = y0;
+
+		for(int j = 1; j < n; j++)
+		{
+			float y = vertex[index[j]].p.y;
+
+			y0 = std::min(y0, y);
+			y1 = std::max(y1, y);
+		}
+
+		// clamped before the conversion, the positions may be anything
+
+		y0 = std::max(ymin, std::min(ymax, std::ceil(y0) - margin));
+		y1 = std::max(ymin, std::min(ymax, std::ceil(y1) + margin));
+
+		GSVector2i& t = m_bin_prims[i];
+
+		t.x = ((int)y0 >> m_thread_height) - top;
+		t.y = (((int)y1 + (1 << m_thread_height) - 1) >> m_thread_height) - top;
+
+		for(int j = t.x; j < t.y; j++)
+		{
+			m_bin_count[j]++;
+		}
+	}
+
+	int total = 0;
+
+	for(int i = 0; i < bottom - top; i++)
+	{
+		m_bin_first[i] = total;
+
+		total += m_bin_count[i] * n;
+
+		m_bin_count[i] = 0;
+	}
+
+	data->tile_index.resize(total);
+
+	// second pass, the primitives keep their order in each tile, m_bin_count becomes the
+	// number of indices
+
+	index = data->index;
+
+	for(int i = 0; i < count; i++, index += n)
+	{
+		const GSVector2i& t = m_bin_prims[i];
+
+		for(int j = t.x; j < t.y; j++)
+		{
+			u32* RESTRICT dst = &data->tile_index[m_bin_first[j] + m_bin_count[j]];
+
+			for(int k = 0; k < n; k++)
+			{
+				dst[k] = index[k];
+			}
+
+			m_bin_count[j] += n;
+		}
+	}
+}
+
+int GSRasterizerList::PopTile(int id)
+{
+	std::deque<int>& own = m_ready[id];
+
+	if(!own.empty())
+	{
+		int tile = own.front();
+
+		own.pop_front();
+
+		return tile;
+	}
+
+	for(size_t i = 1; i < m_ready.size(); i++)
+	{
+		std::deque<int>& other = m_ready[(id + i) % m_ready.size()];
+
+		if(!other.empty())
+		{
+			int tile = other.back();
+
+			other.pop_back();
+
+			return tile;
+		}
+	}
+
+	return -1;
+}
+
+void GSRasterizerList::TileThreadProc(int id)
+{
+	GSRasterizer* r = m_r[id].get();
+
+	std::vector<TileCommand> commands;
+
+	std::unique_lock<std::mutex> l(m_lock);
+
+	while(true)
+	{
+		int i = PopTile(id);
+
+		if(i < 0)
+		{
+			if(m_exit) return;
+
+			m_notempty.wait(l);
+
+			continue;
+		}
+
+		Tile& tile = m_tiles[i];
+
+		commands.swap(tile.queue);
+
+		l.unlock();
+
+		int count = (int)commands.size();
+
+		for(TileCommand& cmd : commands)
+		{
+			GSVector4i scissor = cmd.data->scissor;
+
+			scissor.top = std::max<int>(scissor.top, i << m_thread_height);
+			scissor.bottom = std::min<int>(scissor.bottom, (i + 1) << m_thread_height);
+
+			r->Draw(cmd.data.get(), cmd.index, cmd.index_count, scissor);
+		}
+
+		// the draws may be released here, outside the lock
+
+		commands.clear();
+
+		l.lock();
+
+		if(tile.queue.empty())
+		{
+			tile.scheduled = false;
+		}
+		else
+		{
+			m_ready[id].push_back(i);
+		}
+
+		m_pending -= count;
+
+		if(m_pending == 0)
+		{
+			m_empty.notify_all();
+		}
+	}
+}
+
 void GSRasterizerList::Sync()
 {
+	if(m_binning)
+	{
+		std::unique_lock<std::mutex> l(m_lock);
+
+		while(m_pending > 0)
+		{
+			m_empty.wait(l);
+		}
+
+		return;
+	}
+
 	if(!IsSynced())
 	{
 		for(size_t i = 0; i < m_workers.size(); i++)
@@ -1176,6 +1483,11 @@ void GSRasterizerList::Sync()
 
 bool GSRasterizerList::IsSynced() const
 {
+	if(m_binning)
+	{
+		return m_pending == 0;
+	}
+
 	for(size_t i = 0; i < m_workers.size(); i++)
 	{
 		if(!m_workers[i]->IsEmpty())
@@ -1189,10 +1501,18 @@ int GSRasterizerList::GetPixels(bool reset)
 {
 	int pixels = 0;
 
-	for(size_t i = 0; i < m_workers.size(); i++)
+	for(size_t i = 0; i < m_r.size(); i++)
 	{
 		pixels += m_r[i]->GetPixels(reset);
 	}
 
 	return pixels;
 }
+
+void GSRasterizerList::GetDrawScanlines(std::vector<IDrawScanline*>& ds)
+{
+	for(size_t i = 0; i < m_r.size(); i++)
+	{
+		m_r[i]->GetDrawScanlines(ds);
+	}
+}
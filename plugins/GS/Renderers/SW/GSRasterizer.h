@@ -28,6 +28,9 @@
 #include "../../GSAlignedClass.h"
 #include "../../GSThread_CXX11.h"
 
+#include <atomic>
+#include <deque>
+
 class alignas(32) GSRasterizerData : public GSAlignedClass<32>
 {
 	static int s_counter;
@@ -44,6 +47,7 @@ public:
 	u64 frame;
 	int pixels;
 	int counter;
+	std::vector<u32> tile_index; // indices sorted by tile, see GSRasterizerList::Bin
 
 	GSRasterizerData() 
 		: scissor(GSVector4i::zero())
@@ -86,6 +90,12 @@ public:
 	virtual void BeginDraw(const GSRasterizerData* data) = 0;
 	virtual void EndDraw(u64 frame, int actual, int total) = 0;
 
+	// JIT compiled functions, see GSSelectorCache. The Prepare calls may come from any thread.
+
+	virtual void PrepareSetupPrim(u64 key) {}
+	virtual void PrepareDrawScanline(u64 key) {}
+	virtual void GetFunctionHits(std::unordered_map<u64, u64>& sp, std::unordered_map<u64, u64>& ds) const {}
+
 	__forceinline void SetupPrim(const GSVertexSW* vertex, const u32* index, const GSVertexSW& dscan) {m_sp(vertex, index, dscan);}
 	__forceinline void DrawScanline(int pixels, int left, int top, const GSVertexSW& scan) {m_ds(pixels, left, top, scan);}
 	__forceinline void DrawEdge(int pixels, int left, int top, const GSVertexSW& scan) {m_de(pixels, left, top, scan);}
@@ -105,6 +115,7 @@ public:
 	virtual void Sync() = 0;
 	virtual bool IsSynced() const = 0;
 	virtual int GetPixels(bool reset = true) = 0;
+	virtual void GetDrawScanlines(std::vector<IDrawScanline*>& ds) = 0;
 };
 
 class alignas(32) GSRasterizer : public IRasterizer
@@ -116,6 +127,7 @@ protected:
 	int m_thread_height;
 	u8* m_scanline;
 	GSVector4i m_scissor;
+	int m_scissor_top; // of the draw, m_scissor may only be one tile of it
 	GSVector4 m_fscissor_x;
 	GSVector4 m_fscissor_y;
 	struct {GSVertexSW* buff; int count;} m_edge;
@@ -152,6 +164,7 @@ public:
 	__forceinline int FindMyNextScanline(int top) const;
 
 	void Draw(GSRasterizerData* data);
+	void Draw(GSRasterizerData* data, const u32* index, int index_count, const GSVector4i& scissor);
 
 	// IRasterizer
 
@@ -159,21 +172,66 @@ public:
 	void Sync() {}
 	bool IsSynced() const {return true;}
 	int GetPixels(bool reset);
+	void GetDrawScanlines(std::vector<IDrawScanline*>& ds) {ds.push_back(m_ds);}
 };
 
+// Two ways to split the draws between the threads:
+//
+// - interleaved: each thread owns every Nth band of scanlines and has its own queue, it walks
+//   all the primitives of the draws it gets and skips the rows it does not own.
+//
+// - binned (extrathreads_binning): the screen is cut into tiles, full width bands of scanlines
+//   so the spans are the same as on one thread. Queue sorts the primitives of a draw into the
+//   tiles they overlap and appends one command per tile. A tile is drawn by one thread at a
+//   time, in order, any thread may take it. Threads take the tiles they are the home of first
+//   (the same bands as the interleaved mode) and steal from the others when they run out.
+
 class GSRasterizerList : public IRasterizer
 {
 protected:
 	using GSWorker = GSJobQueue<std::shared_ptr<GSRasterizerData>, 65536>;
 
+	struct TileCommand
+	{
+		std::shared_ptr<GSRasterizerData> data;
+		const u32* index;
+		int index_count;
+	};
+
+	struct Tile
+	{
+		std::vector<TileCommand> queue;
+		bool scheduled; // in a ready queue or being drawn
+	};
+
 	// Worker threads depend on the rasterizers, so don't change the order.
 	std::vector<std::unique_ptr<GSRasterizer>> m_r;
 	std::vector<std::unique_ptr<GSWorker>> m_workers;
 	u8* m_scanline;
 	int m_thread_height;
 
+	bool m_binning;
+	std::vector<Tile> m_tiles;
+	std::vector<std::deque<int>> m_ready; // per thread
+	std::vector<std::thread> m_threads;
+	std::mutex m_lock;
+	std::condition_variable m_notempty;
+	std::condition_variable m_empty;
+	std::atomic<int> m_pending; // commands not drawn yet
+	bool m_exit;
+
+	// used by Bin, on the queueing thread
+	std::vector<int> m_bin_first;
+	std::vector<int> m_bin_count;
+	std::vector<GSVector2i> m_bin_prims;
+
 	GSRasterizerList(int threads);
 
+	void QueueTiles(const std::shared_ptr<GSRasterizerData>& data, const GSVector4i& r);
+	void Bin(GSRasterizerData* data, int top, int bottom);
+	int PopTile(int id);
+	void TileThreadProc(int id);
+
 public:
 	virtual ~GSRasterizerList();
 
@@ -190,12 +248,27 @@ public:
 
 		for(int i = 0; i < threads; i++)
 		{
+			if(rl->m_binning)
+			{
+				// the tiles are clipped by the scissor, every scanline is ours
+				rl->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(new DS(), 0, 1)));
+				continue;
+			}
+
 			rl->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(new DS(), i, threads)));
 			auto &r = *rl->m_r[i];
 			rl->m_workers.push_back(std::unique_ptr<GSWorker>(new GSWorker(
 				[&r](std::shared_ptr<GSRasterizerData> &item) { r.Draw(item.get()); })));
 		}
 
+		if(rl->m_binning)
+		{
+			for(int i = 0; i < threads; i++)
+			{
+				rl->m_threads.push_back(std::thread(&GSRasterizerList::TileThreadProc, rl, i));
+			}
+		}
+
 		return rl;
 	}
 
@@ -205,4 +278,5 @@ public:
 	void Sync();
 	bool IsSynced() const;
 	int GetPixels(bool reset);
+	void GetDrawScanlines(std::vector<IDrawScanline*>& ds);
 };
@@ -39,6 +39,8 @@ void GSRendererSW::InitVectors()
 
 GSRendererSW::GSRendererSW(int threads)
 	: m_fzb(NULL)
+	, m_selector_cache(theApp.GetConfigS("cache_dir"))
+	, m_prepare_exit(false)
 {
 	m_nativeres = true; // ignore ini, sw is always native
 
@@ -78,10 +80,25 @@ GSRendererSW::GSRendererSW(int threads)
 		m_userhacks_auto_flush = true;
 		ResetHandlers();
 	}
+
+	if(m_selector_cache.Load() && theApp.GetConfigB("jit_pregenerate"))
+	{
+		m_prepare_thread = std::thread(&GSRendererSW::PrepareFunctions, this,
+			m_selector_cache.GetHottest(GSSelectorCache::SetupPrim, 256),
+			m_selector_cache.GetHottest(GSSelectorCache::DrawScanline, 1024));
+	}
 }
 
 GSRendererSW::~GSRendererSW()
 {
+	if(m_prepare_thread.joinable())
+	{
+		m_prepare_exit = true;
+		m_prepare_thread.join();
+	}
+
+	SaveFunctionHits();
+
 	delete m_tc;
 
 	for(size_t i = 0; i < countof(m_texture); i++)
@@ -94,6 +111,52 @@ GSRendererSW::~GSRendererSW()
 	_aligned_free(m_output);
 }
 
+// Generates the functions of the selectors used the most in the previous sessions, the draws
+// which need one of them while it is being generated wait for it instead of generating it again.
+
+void GSRendererSW::PrepareFunctions(std::vector<u64> sp, std::vector<u64> ds)
+{
+	std::vector<IDrawScanline*> rl;
+
+	m_rl->GetDrawScanlines(rl);
+
+	for(size_t i = 0; i < std::max(sp.size(), ds.size()); i++)
+	{
+		for(IDrawScanline* d : rl)
+		{
+			if(m_prepare_exit)
+				return;
+
+			if(i < sp.size())
+				d->PrepareSetupPrim(sp[i]);
+
+			if(i < ds.size())
+				d->PrepareDrawScanline(ds[i]);
+		}
+	}
+}
+
+void GSRendererSW::SaveFunctionHits()
+{
+	if(!m_selector_cache.IsEnabled())
+		return;
+
+	Sync(-1);
+
+	std::vector<IDrawScanline*> rl;
+
+	m_rl->GetDrawScanlines(rl);
+
+	GSSelectorCache::Hits hits[GSSelectorCache::MapCount];
+
+	for(IDrawScanline* d : rl)
+	{
+		d->GetFunctionHits(hits[GSSelectorCache::SetupPrim], hits[GSSelectorCache::DrawScanline]);
+	}
+
+	m_selector_cache.Save(hits);
+}
+
 void GSRendererSW::Reset()
 {
 	Sync(-1);
@@ -25,6 +25,9 @@
 
 #include "GSTextureCacheSW.h"
 #include "GSDrawScanline.h"
+#include "GSSelectorCache.h"
+
+#include <thread>
 
 class GSRendererSW : public GSRenderer
 {
@@ -80,6 +83,12 @@ protected:
 	std::atomic<u32> m_fzb_pages[512]; // uint16 frame/zbuf pages interleaved
 	std::atomic<u16> m_tex_pages[512];
 	u32 m_tmp_pages[512 + 1];
+	GSSelectorCache m_selector_cache;
+	std::thread m_prepare_thread;
+	std::atomic<bool> m_prepare_exit;
+
+	void PrepareFunctions(std::vector<u64> sp, std::vector<u64> ds);
+	void SaveFunctionHits();
 
 	void Reset();
 	void VSync(int field);
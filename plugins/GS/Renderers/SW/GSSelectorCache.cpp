@@ -0,0 +1,255 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "GSSelectorCache.h"
+#include "GSScanlineEnvironment.h"
+#include "../../xbyak/xbyak_util.h"
+#include "svnrev.h"
+
+#include <algorithm>
+
+#define SELECTOR_CACHE_MAGIC 0x43534753 // GSSC
+#define SELECTOR_CACHE_VERSION 1
+#define SELECTOR_CACHE_MAX_ENTRIES 4096
+
+GSSelectorCache::GSSelectorCache(const std::string& dir)
+{
+	if(!dir.empty())
+	{
+		m_path = dir + "/gssw_selectors.bin";
+	}
+}
+
+// The selector bit fields are only stable within a build.
+
+u64 GSSelectorCache::GetBuildId()
+{
+	static const char* build =
+#ifdef GIT_REV
+		GIT_REV " "
+#endif
+		__DATE__ " " __TIME__;
+
+	u64 hash = 0xcbf29ce484222325ull;
+
+	for(const char* p = build; *p; p++)
+	{
+		hash = (hash ^ (u8)*p) * 0x100000001b3ull;
+	}
+
+	return hash ^ (sizeof(GSScanlineSelector) << 56);
+}
+
+// The generators take different paths depending on the instruction sets, and with them the
+// selectors which get used (the x86 and x64 generators don't share selectors either).
+
+u32 GSSelectorCache::GetCPUFeatures()
+{
+	using namespace Xbyak::util;
+
+	static const Cpu::Type types[] =
+	{
+		Cpu::tSSE2, Cpu::tSSE3, Cpu::tSSSE3, Cpu::tSSE41, Cpu::tSSE42,
+		Cpu::tAVX, Cpu::tAVX2, Cpu::tFMA, Cpu::tBMI1, Cpu::tBMI2,
+	};
+
+	Cpu cpu;
+
+	u32 features = sizeof(void*) == 8 ? 0x80000000 : 0;
+
+	for(size_t i = 0; i < countof(types); i++)
+	{
+		if(cpu.has(types[i]))
+		{
+			features |= 1 << i;
+		}
+	}
+
+	return features;
+}
+
+bool GSSelectorCache::Load()
+{
+	for(int i = 0; i < MapCount; i++)
+	{
+		m_hits[i].clear();
+	}
+
+	if(m_path.empty())
+		return false;
+
+	FILE* fp = fopen(m_path.c_str(), "rb");
+
+	if(fp == NULL)
+		return false;
+
+	struct {u32 magic, version; u64 build; u32 features; u32 count[MapCount];} header;
+
+	bool ok = fread(&header, sizeof(header), 1, fp) == 1
+		&& header.magic == SELECTOR_CACHE_MAGIC
+		&& header.version == SELECTOR_CACHE_VERSION
+		&& header.build == GetBuildId()
+		&& header.features == GetCPUFeatures();
+
+	for(int i = 0; ok && i < MapCount; i++)
+	{
+		if(header.count[i] > SELECTOR_CACHE_MAX_ENTRIES)
+		{
+			ok = false;
+			break;
+		}
+
+		std::vector<u64> entries(header.count[i] * 2);
+
+		if(!entries.empty() && fread(entries.data(), sizeof(u64), entries.size(), fp) != entries.size())
+		{
+			ok = false;
+			break;
+		}
+
+		for(size_t j = 0; j < entries.size(); j += 2)
+		{
+			m_hits[i][entries[j]] = entries[j + 1];
+		}
+	}
+
+	fclose(fp);
+
+	if(!ok)
+	{
+		// another build or cpu, or a truncated file, it gets rewritten at the end of the session
+
+		for(int i = 0; i < MapCount; i++)
+		{
+			m_hits[i].clear();
+		}
+	}
+
+	return ok;
+}
+
+void GSSelectorCache::Save(const Hits (&session)[MapCount])
+{
+	if(m_path.empty())
+		return;
+
+	std::vector<std::pair<u64, u64>> entries[MapCount];
+
+	for(int i = 0; i < MapCount; i++)
+	{
+		for(auto& hit : m_hits[i])
+		{
+			hit.second /= 2;
+		}
+
+		for(const auto& hit : session[i])
+		{
+			m_hits[i][hit.first] += hit.second;
+		}
+
+		for(const auto& hit : m_hits[i])
+		{
+			if(hit.second > 0)
+			{
+				entries[i].push_back(hit);
+			}
+		}
+
+		std::sort(entries[i].begin(), entries[i].end(), [](const std::pair<u64, u64>& a, const std::pair<u64, u64>& b)
+		{
+			return a.second > b.second;
+		});
+
+		if(entries[i].size() > SELECTOR_CACHE_MAX_ENTRIES)
+		{
+			entries[i].resize(SELECTOR_CACHE_MAX_ENTRIES);
+		}
+	}
+
+	// written next to the old file and renamed over it, a crash never leaves half a file behind
+
+	std::string tmp = m_path + ".tmp";
+
+	FILE* fp = fopen(tmp.c_str(), "wb");
+
+	if(fp == NULL)
+		return;
+
+	struct {u32 magic, version; u64 build; u32 features; u32 count[MapCount];} header;
+
+	header.magic = SELECTOR_CACHE_MAGIC;
+	header.version = SELECTOR_CACHE_VERSION;
+	header.build = GetBuildId();
+	header.features = GetCPUFeatures();
+
+	for(int i = 0; i < MapCount; i++)
+	{
+		header.count[i] = (u32)entries[i].size();
+	}
+
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+	for(int i = 0; ok && i < MapCount; i++)
+	{
+		for(const auto& entry : entries[i])
+		{
+			u64 data[2] = {entry.first, entry.second};
+
+			if(fwrite(data, sizeof(data), 1, fp) != 1)
+			{
+				ok = false;
+				break;
+			}
+		}
+	}
+
+	ok = fclose(fp) == 0 && ok;
+
+	if(ok)
+	{
+		remove(m_path.c_str());
+		ok = rename(tmp.c_str(), m_path.c_str()) == 0;
+	}
+
+	if(!ok)
+	{
+		remove(tmp.c_str());
+	}
+}
+
+std::vector<u64> GSSelectorCache::GetHottest(Map map, size_t count) const
+{
+	std::vector<std::pair<u64, u64>> entries(m_hits[map].begin(), m_hits[map].end());
+
+	std::sort(entries.begin(), entries.end(), [](const std::pair<u64, u64>& a, const std::pair<u64, u64>& b)
+	{
+		return a.second > b.second;
+	});
+
+	std::vector<u64> keys;
+
+	for(size_t i = 0; i < entries.size() && i < count; i++)
+	{
+		keys.push_back(entries[i].first);
+	}
+
+	return keys;
+}
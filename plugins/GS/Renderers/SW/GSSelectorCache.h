@@ -0,0 +1,79 @@
+/*
+ *	Copyright (C) 2007-2009 Gabest
+ *	http://www.gabest.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNU Make; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "Pcsx2Types.h"
+
+#include "../../GS.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+
+Persistent list of the setup-prim and draw-scanline selectors used by the previous sessions, so
+their functions can be generated before the first draw needs them.
+
+The generated code is not stored. It embeds the addresses of the per-thread scanline data and of
+the constant tables, and in x64 it picks rip relative addressing depending on where these ended up,
+none of which survives a restart. Generating a function is cheap once it happens off the draw path.
+
+File format:
+- [magic/4] [version/4] [build id/8] [cpu features/4] [count/4] [count/4]
+- [selector/8] [weight/8] .. for the setup-prim functions, then the draw-scanline ones
+
+The weight is the number of draws which used the selector, halved for every session it was saved
+through, so the selectors of the games which weren't played recently age out.
+
+*/
+
+class GSSelectorCache
+{
+public:
+	enum Map
+	{
+		SetupPrim,
+		DrawScanline,
+		MapCount
+	};
+
+	typedef std::unordered_map<u64, u64> Hits;
+
+protected:
+	std::string m_path;
+	Hits m_hits[MapCount];
+
+	static u64 GetBuildId();
+	static u32 GetCPUFeatures();
+
+public:
+	GSSelectorCache(const std::string& dir);
+
+	bool IsEnabled() const {return !m_path.empty();}
+
+	bool Load();
+	void Save(const Hits (&session)[MapCount]);
+
+	// The most used selectors first.
+	std::vector<u64> GetHottest(Map map, size_t count) const;
+};
@@ -0,0 +1,262 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// gameindex2bin - compiles GameIndex.yaml into the binary table described in
+// pcsx2/GameIndexBinary.h, written as a C header (like xxd -i) to be embedded.
+//
+// usage: gameindex2bin GameIndex.yaml GameIndexBin.h [GameIndex.bin]
+
+#include "GameIndexBinary.h"
+
+#include "yaml-cpp/yaml.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static std::string strToLower(std::string str)
+{
+	std::transform(str.begin(), str.end(), str.begin(),
+		[](unsigned char c) { return std::tolower(c); });
+	return str;
+}
+
+class StringTable
+{
+	std::unordered_map<std::string, u32> m_offsets;
+
+public:
+	std::vector<char> data;
+
+	u32 Intern(const std::string& str)
+	{
+		auto it = m_offsets.find(str);
+		if (it != m_offsets.end())
+			return it->second;
+
+		u32 offset = (u32)data.size();
+		data.insert(data.end(), str.begin(), str.end());
+		data.push_back(0);
+
+		m_offsets.emplace(str, offset);
+		return offset;
+	}
+};
+
+struct Entry
+{
+	GameIndexBinEntry bin;
+	std::vector<u32> lists;
+};
+
+// Same fields and defaults as entryFromYaml (pcsx2/GameDatabase.cpp)
+static void readEntry(const YAML::Node& node, StringTable& strings, Entry& entry)
+{
+	GameIndexBinEntry& e = entry.bin;
+
+	e.name = strings.Intern(node["name"].as<std::string>(""));
+	e.region = strings.Intern(node["region"].as<std::string>(""));
+	e.compat = (s8)node["compat"].as<int>(0);
+
+	e.eeRoundMode = e.vuRoundMode = -1;
+	e.eeClampMode = e.vuClampMode = -1;
+
+	if (YAML::Node roundModeNode = node["roundModes"])
+	{
+		e.eeRoundMode = (s8)roundModeNode["eeRoundMode"].as<int>(-1);
+		e.vuRoundMode = (s8)roundModeNode["vuRoundMode"].as<int>(-1);
+	}
+	if (YAML::Node clampModeNode = node["clampModes"])
+	{
+		e.eeClampMode = (s8)clampModeNode["eeClampMode"].as<int>(-1);
+		e.vuClampMode = (s8)clampModeNode["vuClampMode"].as<int>(-1);
+	}
+
+	std::vector<u32> fixes, hacks, filters, patches;
+
+	for (const std::string& fix : node["gameFixes"].as<std::vector<std::string>>(std::vector<std::string>()))
+		fixes.push_back(strings.Intern(fix));
+
+	if (YAML::Node speedHacksNode = node["speedHacks"])
+	{
+		for (const auto& hack : speedHacksNode)
+		{
+			hacks.push_back(strings.Intern(hack.first.as<std::string>()));
+			hacks.push_back((u32)hack.second.as<int>());
+		}
+	}
+
+	for (const std::string& filter : node["memcardFilters"].as<std::vector<std::string>>(std::vector<std::string>()))
+		filters.push_back(strings.Intern(filter));
+
+	if (YAML::Node patchesNode = node["patches"])
+	{
+		std::vector<std::string> crcs;
+
+		for (const auto& patch : patchesNode)
+		{
+			std::string crc = strToLower(patch.first.as<std::string>());
+			if (std::find(crcs.begin(), crcs.end(), crc) != crcs.end())
+			{
+				fprintf(stderr, "gameindex2bin: duplicate CRC '%s', skipped\n", crc.c_str());
+				continue;
+			}
+			crcs.push_back(crc);
+
+			patches.push_back(strings.Intern(crc));
+			patches.push_back(strings.Intern(patch.second["author"].as<std::string>("")));
+			patches.push_back(strings.Intern(patch.second["content"].as<std::string>("")));
+		}
+	}
+
+	if (fixes.size() > 0xffff || hacks.size() / 2 > 0xffff || filters.size() > 0xffff || patches.size() / 3 > 0xffff)
+		throw std::runtime_error("too many items");
+
+	e.gameFixes = (u16)fixes.size();
+	e.speedHacks = (u16)(hacks.size() / 2);
+	e.memcardFilters = (u16)filters.size();
+	e.patches = (u16)(patches.size() / 3);
+
+	for (const std::vector<u32>* list : {&fixes, &hacks, &filters, &patches})
+		entry.lists.insert(entry.lists.end(), list->begin(), list->end());
+}
+
+static void append(std::vector<u8>& out, const void* data, size_t size)
+{
+	out.insert(out.end(), (const u8*)data, (const u8*)data + size);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "usage: gameindex2bin GameIndex.yaml GameIndexBin.h [GameIndex.bin]\n");
+		return 1;
+	}
+
+	YAML::Node data;
+	try
+	{
+		data = YAML::LoadFile(argv[1]);
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "gameindex2bin: can't read %s: %s\n", argv[1], e.what());
+		return 1;
+	}
+
+	StringTable strings;
+	std::map<std::string, Entry> entries; // sorted like strcmp
+
+	for (const auto& node : data)
+	{
+		std::string serial;
+		try
+		{
+			serial = strToLower(node.first.as<std::string>());
+		}
+		catch (const std::exception& e)
+		{
+			fprintf(stderr, "gameindex2bin: invalid serial: %s\n", e.what());
+			continue;
+		}
+
+		if (entries.count(serial))
+		{
+			fprintf(stderr, "gameindex2bin: duplicate serial '%s', skipped\n", serial.c_str());
+			continue;
+		}
+
+		Entry& entry = entries[serial];
+		memset(&entry.bin, 0, sizeof(entry.bin));
+
+		try
+		{
+			readEntry(node.second, strings, entry);
+		}
+		catch (const std::exception& e)
+		{
+			// kept so the lookup reports the entry as invalid, like the yaml parser
+			fprintf(stderr, "gameindex2bin: invalid entry '%s': %s\n", serial.c_str(), e.what());
+			memset(&entry.bin, 0, sizeof(entry.bin));
+			entry.bin.flags = GameIndexBin_Invalid;
+			entry.lists.clear();
+		}
+
+		entry.bin.serial = strings.Intern(serial);
+	}
+
+	std::vector<GameIndexBinEntry> table;
+	std::vector<u32> lists;
+
+	for (auto& it : entries)
+	{
+		it.second.bin.lists = (u32)lists.size();
+		lists.insert(lists.end(), it.second.lists.begin(), it.second.lists.end());
+		table.push_back(it.second.bin);
+	}
+
+	GameIndexBinHeader header;
+	header.magic = GAMEINDEX_BIN_MAGIC;
+	header.version = GAMEINDEX_BIN_VERSION;
+	header.entryCount = (u32)table.size();
+	header.listCount = (u32)lists.size();
+	header.stringsSize = (u32)strings.data.size();
+
+	std::vector<u8> out;
+	append(out, &header, sizeof(header));
+	append(out, table.data(), table.size() * sizeof(GameIndexBinEntry));
+	append(out, lists.data(), lists.size() * sizeof(u32));
+	append(out, strings.data.data(), strings.data.size());
+
+	FILE* fp = fopen(argv[2], "w");
+	if (!fp)
+	{
+		fprintf(stderr, "gameindex2bin: can't write %s\n", argv[2]);
+		return 1;
+	}
+
+	// aligned so the table can be read in place
+	fprintf(fp, "alignas(16) unsigned char GameIndex_bin[] = {\n");
+	for (size_t i = 0; i < out.size(); i++)
+		fprintf(fp, "%s0x%02x,%s", i % 16 ? " " : "  ", out[i], i % 16 == 15 || i == out.size() - 1 ? "\n" : "");
+	fprintf(fp, "};\nunsigned int GameIndex_bin_len = %u;\n", (unsigned)out.size());
+
+	bool ok = fclose(fp) == 0;
+
+	if (ok && argc > 3)
+	{
+		fp = fopen(argv[3], "wb");
+		ok = fp && fwrite(out.data(), out.size(), 1, fp) == 1;
+		ok = fp && fclose(fp) == 0 && ok;
+	}
+
+	if (!ok)
+	{
+		fprintf(stderr, "gameindex2bin: write error\n");
+		return 1;
+	}
+
+	printf("gameindex2bin: %u entries, %u bytes of strings, %u bytes\n",
+		header.entryCount, header.stringsSize, (unsigned)out.size());
+
+	return 0;
+}
@@ -0,0 +1,229 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2020  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// pnach2bin - compiles one of the embedded pnach archives into the patch table described
+// in pcsx2/PatchTableBinary.h, written as a C header (like xxd -i) to be embedded.
+//
+// usage: pnach2bin cheats_ws.zip cheats_ws_bin.h cheats_ws_bin
+
+#include "PatchTableBinary.h"
+#include "MemoryPatchDatabase.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+static const char* const s_whitespace = " \t\r\n\v\f";
+
+static std::string trim(const std::string& str)
+{
+	size_t begin = str.find_first_not_of(s_whitespace);
+	if (begin == std::string::npos)
+		return std::string();
+
+	return str.substr(begin, str.find_last_not_of(s_whitespace) - begin + 1);
+}
+
+// Same codes as the dataType and cpuCore tables (pcsx2/Patch.cpp)
+static u8 lookup(const std::string& str, const char* const* names)
+{
+	for (u8 i = 0; names[i]; i++)
+	{
+		if (str == names[i])
+			return i + 1;
+	}
+
+	return 0;
+}
+
+static const char* const s_types[] = {"byte", "short", "word", "double", "extended", nullptr};
+static const char* const s_cpus[] = {"EE", "IOP", nullptr};
+
+// Follows inifile_processString and PatchFunc::patch, returns false for the lines
+// which don't produce a patch (the comments, authors, ... and the invalid lines).
+static bool parseLine(const std::string& key, const std::string& line, PatchTableBinRecord& record)
+{
+	// inifile_trim
+	std::string str = line;
+	size_t begin = str.find_first_not_of(s_whitespace);
+	str = begin == std::string::npos ? std::string() : str.substr(begin);
+
+	if (str.size() <= 1 || str.compare(0, 2, "//") == 0)
+		return false;
+
+	// pxParseAssignmentString
+	if (str.compare(0, 2, "--") == 0 || str[0] == ';')
+		return false;
+
+	size_t equal = str.find('=');
+	std::string lvalue = trim(str.substr(0, equal));
+	std::string rvalue = equal == std::string::npos ? std::string() : trim(str.substr(equal + 1));
+
+	if (lvalue != "patch")
+		return false;
+
+	if (rvalue.empty())
+		rvalue = lvalue;
+
+	std::vector<std::string> pieces;
+	for (size_t pos = 0;;)
+	{
+		size_t comma = rvalue.find(',', pos);
+		pieces.push_back(rvalue.substr(pos, comma - pos));
+		if (comma == std::string::npos)
+			break;
+		pos = comma + 1;
+	}
+
+	const char* error = nullptr;
+
+	if (pieces.size() < 5)
+		error = "missing fields";
+	else
+	{
+		memset(&record, 0, sizeof(record));
+
+		const u32 place = (u32)strtoul(pieces[0].c_str(), nullptr, 10);
+		record.cpu = lookup(trim(pieces[1]), s_cpus);
+		record.addr = (u32)strtoul(pieces[2].c_str(), nullptr, 16);
+		record.type = lookup(trim(pieces[3]), s_types);
+		record.data = strtoull(pieces[4].c_str(), nullptr, 16);
+		record.place = (u8)place;
+
+		// PPT_ONCE_ON_LOAD and PPT_CONTINUOUSLY
+		if (place > 1)
+			error = "invalid place";
+		else if (record.cpu == 0)
+			error = "unrecognized CPU target";
+		else if (record.type == 0)
+			error = "unrecognized operand size";
+	}
+
+	if (error)
+	{
+		fprintf(stderr, "pnach2bin: %s: %s, skipped: %s\n", key.c_str(), error, trim(line).c_str());
+		return false;
+	}
+
+	return true;
+}
+
+static void append(std::vector<u8>& out, const void* data, size_t size)
+{
+	out.insert(out.end(), (const u8*)data, (const u8*)data + size);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		fprintf(stderr, "usage: pnach2bin archive.zip table.h symbol\n");
+		return 1;
+	}
+
+	std::vector<u8> archive;
+
+	FILE* fp = fopen(argv[1], "rb");
+	if (fp)
+	{
+		u8 buffer[65536];
+		size_t size;
+		while ((size = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+			archive.insert(archive.end(), buffer, buffer + size);
+		fclose(fp);
+	}
+
+	if (archive.empty())
+	{
+		fprintf(stderr, "pnach2bin: can't read %s\n", argv[1]);
+		return 1;
+	}
+
+	MemoryPatchDatabase database(archive.data(), archive.size());
+	database.InitEntries();
+
+	std::map<u32, std::vector<PatchTableBinRecord>> games; // sorted by crc
+
+	for (const std::string& key : database.GetKeys())
+	{
+		char* end;
+		const u32 crc = (u32)strtoul(key.c_str(), &end, 16);
+
+		if (key.empty() || *end)
+		{
+			fprintf(stderr, "pnach2bin: invalid crc '%s', skipped\n", key.c_str());
+			continue;
+		}
+
+		std::vector<PatchTableBinRecord>& records = games[crc];
+
+		for (const std::string& line : database.GetPatchLines(key))
+		{
+			PatchTableBinRecord record;
+			if (parseLine(key, line, record))
+				records.push_back(record);
+		}
+	}
+
+	std::vector<PatchTableBinRecord> records;
+	std::vector<PatchTableBinCrc> index;
+
+	for (const auto& game : games)
+	{
+		if (game.second.empty())
+			continue;
+
+		index.push_back({game.first, (u32)records.size(), (u32)game.second.size()});
+		records.insert(records.end(), game.second.begin(), game.second.end());
+	}
+
+	PatchTableBinHeader header;
+	header.magic = PATCH_TABLE_BIN_MAGIC;
+	header.version = PATCH_TABLE_BIN_VERSION;
+	header.recordCount = (u32)records.size();
+	header.crcCount = (u32)index.size();
+
+	std::vector<u8> out;
+	append(out, &header, sizeof(header));
+	append(out, records.data(), records.size() * sizeof(PatchTableBinRecord));
+	append(out, index.data(), index.size() * sizeof(PatchTableBinCrc));
+
+	fp = fopen(argv[2], "w");
+	if (!fp)
+	{
+		fprintf(stderr, "pnach2bin: can't write %s\n", argv[2]);
+		return 1;
+	}
+
+	// aligned so the table can be read in place
+	fprintf(fp, "alignas(16) unsigned char %s[] = {\n", argv[3]);
+	for (size_t i = 0; i < out.size(); i++)
+		fprintf(fp, "%s0x%02x,%s", i % 16 ? " " : "  ", out[i], i % 16 == 15 || i == out.size() - 1 ? "\n" : "");
+	fprintf(fp, "};\nunsigned int %s_len = %u;\n", argv[3], (unsigned)out.size());
+
+	if (fclose(fp) != 0)
+	{
+		fprintf(stderr, "pnach2bin: write error\n");
+		return 1;
+	}
+
+	printf("pnach2bin: %u games, %u patches, %u bytes\n",
+		header.crcCount, header.recordCount, (unsigned)out.size());
+
+	return 0;
+}